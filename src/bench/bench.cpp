@@ -4,12 +4,69 @@
 
 #include "bench.h"
 
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
 #include <iomanip>
+#include <new>
 #include <sys/time.h>
 
 using namespace benchmark;
 
+static std::atomic<uint64_t> nAllocations(0);
+
+// Count every heap allocation, so benchmarks can report allocations per operation.
+// This file is only linked into bench_zurcoin, so the replacement doesn't affect
+// zurcoind or the tests.
+void* operator new(std::size_t size)
+{
+    nAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    nAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+uint64_t benchmark::GetAllocationCount()
+{
+    return nAllocations.load(std::memory_order_relaxed);
+}
+
 std::map<std::string, BenchFunction> BenchRunner::benchmarks;
 
 static double gettimedouble(void) {
@@ -26,7 +83,7 @@ BenchRunner::BenchRunner(std::string name, BenchFunction func)
 void
 BenchRunner::RunAll(double elapsedTimeForOne)
 {
-    std::cout << "#Benchmark" << "," << "count" << "," << "min" << "," << "max" << "," << "average" << "\n";
+    std::cout << "#Benchmark" << "," << "count" << "," << "min" << "," << "max" << "," << "average" << "," << "allocs" << "\n";
 
     for (std::map<std::string,BenchFunction>::iterator it = benchmarks.begin();
          it != benchmarks.end(); ++it) {
@@ -46,6 +103,7 @@ bool State::KeepRunning()
     double now;
     if (count == 0) {
         lastTime = beginTime = now = gettimedouble();
+        beginAllocs = GetAllocationCount();
     }
     else {
         now = gettimedouble();
@@ -80,7 +138,9 @@ bool State::KeepRunning()
 
     // Output results
     double average = (now-beginTime)/count;
-    std::cout << std::fixed << std::setprecision(15) << name << "," << count << "," << minTime << "," << maxTime << "," << average << "\n";
+    double allocs = (double)(GetAllocationCount() - beginAllocs)/count;
+    std::cout << std::fixed << std::setprecision(15) << name << "," << count << "," << minTime << "," << maxTime << "," << average << ","
+              << std::setprecision(1) << allocs << "\n";
 
     return false;
 }
@@ -5,7 +5,9 @@
 #ifndef BITCOIN_BENCH_BENCH_H
 #define BITCOIN_BENCH_BENCH_H
 
+#include <limits>
 #include <map>
+#include <stdint.h>
 #include <string>
 
 #include <boost/function.hpp>
@@ -43,8 +45,9 @@ namespace benchmark {
         double lastTime, minTime, maxTime, countMaskInv;
         int64_t count;
         int64_t countMask;
+        uint64_t beginAllocs;
     public:
-        State(std::string _name, double _maxElapsed) : name(_name), maxElapsed(_maxElapsed), count(0) {
+        State(std::string _name, double _maxElapsed) : name(_name), maxElapsed(_maxElapsed), count(0), beginAllocs(0) {
             minTime = std::numeric_limits<double>::max();
             maxTime = std::numeric_limits<double>::min();
             countMask = 1;
@@ -53,6 +56,9 @@ namespace benchmark {
         bool KeepRunning();
     };
 
+    /** Returns the number of heap allocations made by the process so far. */
+    uint64_t GetAllocationCount();
+
     typedef boost::function<void(State&)> BenchFunction;
 
     class BenchRunner
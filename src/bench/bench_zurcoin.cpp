@@ -4,6 +4,8 @@
 
 #include "bench.h"
 
+#include "crypto/quark.h"
+#include "crypto/sha256.h"
 #include "key.h"
 #include "main.h"
 #include "util.h"
@@ -13,6 +15,8 @@ main(int argc, char** argv)
 {
     ECC_Start();
     SetupEnvironment();
+    QuarkAutoDetect();
+    SHA256AutoDetect();
     fPrintToDebugLog = false; // don't want to write to debug.log file
 
     benchmark::BenchRunner::RunAll();
@@ -0,0 +1,90 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "checkqueue.h"
+#include "key.h"
+#include "pubkey.h"
+#include "random.h"
+#include "uint256.h"
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+/** Number of signature checks per simulated block */
+static const int CHECKS_PER_BLOCK = 4000;
+/** Number of checks added at once, like the inputs of a transaction */
+static const int CHECKS_PER_TX = 2;
+
+/** A signature check, which is the bulk of the cost of a script check. */
+class CSigCheck
+{
+private:
+    const CPubKey* pubkey;
+    const uint256* hash;
+    const std::vector<unsigned char>* sig;
+
+public:
+    CSigCheck() : pubkey(NULL), hash(NULL), sig(NULL) {}
+    CSigCheck(const CPubKey& pubkeyIn, const uint256& hashIn, const std::vector<unsigned char>& sigIn) :
+        pubkey(&pubkeyIn), hash(&hashIn), sig(&sigIn) {}
+
+    bool operator()()
+    {
+        return pubkey->Verify(*hash, *sig);
+    }
+
+    void swap(CSigCheck& check)
+    {
+        std::swap(pubkey, check.pubkey);
+        std::swap(hash, check.hash);
+        std::swap(sig, check.sig);
+    }
+};
+
+/** Verify the signatures of a simulated block with the given number of threads, including the master. */
+static void CheckQueueSpeed(benchmark::State& state, int nThreads)
+{
+    ECCVerifyHandle verifyHandle;
+    CKey key;
+    key.MakeNewKey(true);
+    CPubKey pubkey = key.GetPubKey();
+    uint256 hash = GetRandHash();
+    std::vector<unsigned char> sig;
+    key.Sign(hash, sig);
+
+    CCheckQueue<CSigCheck> queue(128);
+    boost::thread_group threadGroup;
+    for (int i = 0; i < nThreads - 1; i++)
+        threadGroup.create_thread(boost::bind(&CCheckQueue<CSigCheck>::Thread, boost::ref(queue)));
+
+    while (state.KeepRunning()) {
+        CCheckQueueControl<CSigCheck> control(&queue);
+        for (int i = 0; i < CHECKS_PER_BLOCK; i += CHECKS_PER_TX) {
+            std::vector<CSigCheck> vChecks(CHECKS_PER_TX, CSigCheck(pubkey, hash, sig));
+            control.Add(vChecks);
+        }
+        bool fOk = control.Wait();
+        assert(fOk);
+    }
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+}
+
+static void CheckQueue_1(benchmark::State& state) { CheckQueueSpeed(state, 1); }
+static void CheckQueue_2(benchmark::State& state) { CheckQueueSpeed(state, 2); }
+static void CheckQueue_4(benchmark::State& state) { CheckQueueSpeed(state, 4); }
+static void CheckQueue_8(benchmark::State& state) { CheckQueueSpeed(state, 8); }
+static void CheckQueue_16(benchmark::State& state) { CheckQueueSpeed(state, 16); }
+static void CheckQueue_32(benchmark::State& state) { CheckQueueSpeed(state, 32); }
+
+BENCHMARK(CheckQueue_1);
+BENCHMARK(CheckQueue_2);
+BENCHMARK(CheckQueue_4);
+BENCHMARK(CheckQueue_8);
+BENCHMARK(CheckQueue_16);
+BENCHMARK(CheckQueue_32);
@@ -0,0 +1,90 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "coins.h"
+#include "random.h"
+#include "uint256.h"
+
+#include <vector>
+
+/** Number of transactions in the cache */
+static const size_t CACHE_ENTRIES = 100000;
+
+/** Number of entries accessed or added per iteration */
+static const size_t ENTRIES_PER_ITERATION = 1000;
+
+static std::vector<uint256> RandomTxids(size_t n)
+{
+    std::vector<uint256> txids(n);
+    for (size_t i = 0; i < n; i++) {
+        txids[i] = GetRandHash();
+    }
+    return txids;
+}
+
+static void AddCoins(CCoinsViewCache& cache, const uint256& txid)
+{
+    CCoinsModifier coins = cache.ModifyNewCoins(txid, false);
+    coins->nVersion = 1;
+    coins->nHeight = 100000;
+    coins->vout.resize(2);
+    coins->vout[0].nValue = 50 * COIN;
+    coins->vout[0].scriptPubKey.resize(25);
+    coins->vout[1].nValue = 1 * COIN;
+    coins->vout[1].scriptPubKey.resize(25);
+}
+
+// Creating new coins in the cache, as done when connecting blocks.
+static void CoinsCacheAdd(benchmark::State& state)
+{
+    CCoinsView dummy;
+    CCoinsViewCache cache(&dummy);
+    std::vector<uint256> txids = RandomTxids(CACHE_ENTRIES);
+    size_t n = 0;
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < ENTRIES_PER_ITERATION; i++) {
+            AddCoins(cache, txids[n++ % txids.size()]);
+        }
+    }
+}
+
+// Looking up coins of a full cache, half of which are hits.
+static void CoinsCacheAccess(benchmark::State& state)
+{
+    CCoinsView dummy;
+    CCoinsViewCache cache(&dummy);
+    std::vector<uint256> txids = RandomTxids(CACHE_ENTRIES);
+    for (size_t i = 0; i < txids.size(); i++) {
+        AddCoins(cache, txids[i]);
+    }
+    std::vector<uint256> misses = RandomTxids(ENTRIES_PER_ITERATION);
+    size_t n = 0;
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < ENTRIES_PER_ITERATION; i += 2) {
+            cache.AccessCoins(txids[n++ % txids.size()]);
+            cache.AccessCoins(misses[i]);
+        }
+    }
+}
+
+// Flushing a per-block cache into the cache of the chain tip.
+static void CoinsCacheFlush(benchmark::State& state)
+{
+    CCoinsView dummy;
+    CCoinsViewCache base(&dummy);
+    std::vector<uint256> txids = RandomTxids(CACHE_ENTRIES);
+    size_t n = 0;
+    while (state.KeepRunning()) {
+        CCoinsViewCache cache(&base);
+        for (size_t i = 0; i < ENTRIES_PER_ITERATION; i++) {
+            AddCoins(cache, txids[n++ % txids.size()]);
+        }
+        cache.Flush();
+    }
+}
+
+BENCHMARK(CoinsCacheAdd);
+BENCHMARK(CoinsCacheAccess);
+BENCHMARK(CoinsCacheFlush);
@@ -6,9 +6,11 @@
 
 #include "bench.h"
 #include "bloom.h"
+#include "consensus/merkle.h"
 #include "hash.h"
 #include "uint256.h"
 #include "utiltime.h"
+#include "crypto/quark.h"
 #include "crypto/ripemd160.h"
 #include "crypto/sha1.h"
 #include "crypto/sha256.h"
@@ -59,6 +61,50 @@ static void SHA512(benchmark::State& state)
         CSHA512().Write(begin_ptr(in), in.size()).Finalize(hash);
 }
 
+static void SHA256D64_1024(benchmark::State& state)
+{
+    // A merkle tree level of 2048 transactions
+    std::vector<uint8_t> in(64*1024,0);
+    while (state.KeepRunning()) {
+        SHA256D64(&in[0], &in[0], 1024);
+    }
+}
+
+static void MerkleRoot(benchmark::State& state)
+{
+    std::vector<uint256> leaves(2000);
+    for (size_t i = 0; i < leaves.size(); i++) {
+        leaves[i].begin()[0] = i & 0xff;
+        leaves[i].begin()[1] = i >> 8;
+    }
+    while (state.KeepRunning()) {
+        bool mutated = false;
+        leaves[0] = ComputeMerkleRoot(leaves, &mutated);
+    }
+}
+
+static void Quark_80b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(80,0);
+    while (state.KeepRunning()) {
+        for (int i = 0; i < 10000; i++) {
+            uint256 hash = HashQuark(in.begin(), in.end());
+            memcpy(&in[0], hash.begin(), 32);
+        }
+    }
+}
+
+static void Quark80_2000(benchmark::State& state)
+{
+    // A full headers message
+    std::vector<uint8_t> in(80*2000,0);
+    std::vector<uint8_t> out(32*2000);
+    while (state.KeepRunning()) {
+        Quark80(&out[0], &in[0], 2000);
+        memcpy(&in[0], &out[0], 32);
+    }
+}
+
 static void SipHash_32b(benchmark::State& state)
 {
     uint256 x;
@@ -75,4 +121,8 @@ BENCHMARK(SHA256);
 BENCHMARK(SHA512);
 
 BENCHMARK(SHA256_32b);
+BENCHMARK(SHA256D64_1024);
+BENCHMARK(MerkleRoot);
 BENCHMARK(SipHash_32b);
+BENCHMARK(Quark_80b);
+BENCHMARK(Quark80_2000);
@@ -0,0 +1,60 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "cuckoocache.h"
+#include "random.h"
+#include "script/sigcache.h"
+#include "uint256.h"
+
+#include <vector>
+
+typedef CuckooCache::cache<uint256, SignatureCacheHasher> SigCache;
+
+/** Number of entries looked up or inserted per iteration */
+static const size_t ENTRIES_PER_ITERATION = 1000;
+
+static std::vector<uint256> RandomEntries(size_t n)
+{
+    std::vector<uint256> entries(n);
+    for (size_t i = 0; i < n; i++) {
+        entries[i] = GetRandHash();
+    }
+    return entries;
+}
+
+static void SigCacheInsert(benchmark::State& state)
+{
+    SigCache cache;
+    size_t nCapacity = cache.setup_bytes(DEFAULT_MAX_SIG_CACHE_SIZE << 20);
+    std::vector<uint256> entries = RandomEntries(nCapacity);
+    size_t n = 0;
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < ENTRIES_PER_ITERATION; i++) {
+            cache.insert(entries[n++ % entries.size()]);
+        }
+    }
+}
+
+static void SigCacheLookup(benchmark::State& state)
+{
+    // A cache at 90% load, which is hit half of the time
+    SigCache cache;
+    size_t nCapacity = cache.setup_bytes(DEFAULT_MAX_SIG_CACHE_SIZE << 20);
+    std::vector<uint256> entries = RandomEntries(nCapacity * 9 / 10);
+    for (size_t i = 0; i < entries.size(); i++) {
+        cache.insert(entries[i]);
+    }
+    std::vector<uint256> misses = RandomEntries(ENTRIES_PER_ITERATION);
+    size_t n = 0;
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < ENTRIES_PER_ITERATION; i += 2) {
+            cache.contains(entries[n++ % entries.size()], false);
+            cache.contains(misses[i], false);
+        }
+    }
+}
+
+BENCHMARK(SigCacheInsert);
+BENCHMARK(SigCacheLookup);
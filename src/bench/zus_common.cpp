@@ -0,0 +1,120 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "zus_common.h"
+
+#include "zurbank/dbfees.h"
+#include "zurbank/dbspinfo.h"
+#include "zurbank/dbstolist.h"
+#include "zurbank/dbtradelist.h"
+#include "zurbank/dbtransaction.h"
+#include "zurbank/dbtxlist.h"
+#include "zurbank/mdex.h"
+#include "zurbank/sp.h"
+#include "zurbank/zurbank.h"
+
+#include "arith_uint256.h"
+#include "chainparams.h"
+#include "chainparamsbase.h"
+#include "random.h"
+#include "tinyformat.h"
+#include "uint256.h"
+#include "util.h"
+#include "utiltime.h"
+
+#include <stdint.h>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+using namespace mastercore;
+
+//! Path for file based persistence, defined in zurbank.cpp
+extern boost::filesystem::path pathStateFiles;
+
+namespace benchmark {
+
+static void ClearZusState()
+{
+    LOCK(cs_tally);
+    mp_tally_map.clear();
+    MetaDEx_CLEAR();
+}
+
+ZusBenchSetup::ZusBenchSetup(const std::string& chainName)
+{
+    SelectParams(chainName);
+
+    pathTemp = boost::filesystem::temp_directory_path() / strprintf("bench_zurcoin_%lu_%i", (unsigned long)GetTime(), (int)(GetRand(100000)));
+    boost::filesystem::create_directories(pathTemp);
+    mapArgs["-datadir"] = pathTemp.string();
+    ClearDatadirCache();
+
+    const boost::filesystem::path& pathData = GetDataDir();
+    pDbTradeList = new CMPTradeList(pathData / "MP_tradelist", true);
+    pDbStoList = new CMPSTOList(pathData / "MP_stolist", true);
+    pDbTransactionList = new CMPTxList(pathData / "MP_txlist", true);
+    pDbSpInfo = new CMPSPInfo(pathData / "MP_spinfo", true);
+    pDbTransaction = new COmniTransactionDB(pathData / "Omni_TXDB", true);
+    pDbFeeCache = new COmniFeeCache(pathData / "OMNI_feecache", true);
+    pDbFeeHistory = new COmniFeeHistory(pathData / "OMNI_feehistory", true);
+
+    pathStateFiles = pathData / "MP_persist";
+    boost::filesystem::create_directories(pathStateFiles);
+
+    ClearZusState();
+}
+
+ZusBenchSetup::~ZusBenchSetup()
+{
+    ClearZusState();
+
+    delete pDbTradeList;
+    pDbTradeList = NULL;
+    delete pDbStoList;
+    pDbStoList = NULL;
+    delete pDbTransactionList;
+    pDbTransactionList = NULL;
+    delete pDbSpInfo;
+    pDbSpInfo = NULL;
+    delete pDbTransaction;
+    pDbTransaction = NULL;
+    delete pDbFeeCache;
+    pDbFeeCache = NULL;
+    delete pDbFeeHistory;
+    pDbFeeHistory = NULL;
+
+    mapArgs.erase("-datadir");
+    ClearDatadirCache();
+    boost::filesystem::remove_all(pathTemp);
+}
+
+uint32_t ZusBenchSetup::CreateTestProperty(bool fDivisible)
+{
+    CMPSPInfo::Entry entry;
+    entry.issuer = BenchAddress(0);
+    entry.prop_type = fDivisible ? MSC_PROPERTY_TYPE_DIVISIBLE : MSC_PROPERTY_TYPE_INDIVISIBLE;
+    entry.num_tokens = 1000000000;
+    entry.category = "Benchmark";
+    entry.subcategory = "Benchmark";
+    entry.name = "Benchmark token";
+    entry.txid = NextBenchTxid();
+    entry.fixed = true;
+    entry.updateIssuer(0, 0, entry.issuer);
+
+    return pDbSpInfo->putSP(2, entry); // test ecosystem
+}
+
+uint256 NextBenchTxid()
+{
+    static uint64_t nTxid = 0;
+    return ArithToUint256(arith_uint256(++nTxid));
+}
+
+std::string BenchAddress(unsigned int n)
+{
+    return strprintf("zusbench%08x", n);
+}
+
+}
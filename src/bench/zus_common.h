@@ -0,0 +1,46 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BENCH_ZUS_COMMON_H
+#define BITCOIN_BENCH_ZUS_COMMON_H
+
+#include "chainparamsbase.h"
+#include "uint256.h"
+
+#include <stdint.h>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+
+namespace benchmark {
+
+/**
+ * Prepares an isolated Zus layer environment for a benchmark.
+ *
+ * The chain parameters are selected and empty Zus databases are created in a
+ * temporary data directory. The in-memory state is cleared on construction
+ * and destruction, so each benchmark starts from a blank tally and order book.
+ */
+class ZusBenchSetup
+{
+public:
+    explicit ZusBenchSetup(const std::string& chainName = CBaseChainParams::REGTEST);
+    ~ZusBenchSetup();
+
+    /** Creates a test ecosystem property and returns its identifier. */
+    uint32_t CreateTestProperty(bool fDivisible = false);
+
+private:
+    boost::filesystem::path pathTemp;
+};
+
+/** Returns a unique transaction hash for each call. */
+uint256 NextBenchTxid();
+
+/** Returns a distinct dummy address for the given index. */
+std::string BenchAddress(unsigned int n);
+
+}
+
+#endif // BITCOIN_BENCH_ZUS_COMMON_H
@@ -0,0 +1,168 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "zus_common.h"
+
+#include "zurbank/createpayload.h"
+#include "zurbank/parsing.h"
+#include "zurbank/sto.h"
+#include "zurbank/tally.h"
+#include "zurbank/tx.h"
+#include "zurbank/zurbank.h"
+
+#include "sync.h"
+#include "uint256.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+static const int BENCH_BLOCK = 1000;
+
+/** Executes the logic of a transaction with the given payload. */
+static int ProcessPayload(const std::string& sender, const std::string& receiver, std::vector<unsigned char>& vchPayload)
+{
+    CMPTransaction mp_obj;
+    mp_obj.Set(sender, receiver, 0, benchmark::NextBenchTxid(), BENCH_BLOCK, 1, &vchPayload[0], vchPayload.size(), OMNI_CLASS_C, 0);
+    mp_obj.unlockLogic();
+
+    return mp_obj.interpretPacket();
+}
+
+/** Credits the given address with tokens, which can be spent by benchmarks. */
+static void Fund(const std::string& address, uint32_t propertyId)
+{
+    assert(update_tally_map(address, propertyId, MAX_INT_8_BYTES / 4, BALANCE));
+}
+
+static void InterpretSimpleSend(benchmark::State& state)
+{
+    benchmark::ZusBenchSetup setup;
+    const uint32_t propertyId = setup.CreateTestProperty();
+    const std::string sender = benchmark::BenchAddress(1);
+    const std::string receiver = benchmark::BenchAddress(2);
+    Fund(sender, propertyId);
+
+    std::vector<unsigned char> vchPayload = CreatePayload_SimpleSend(propertyId, 1);
+    while (state.KeepRunning()) {
+        assert(0 == ProcessPayload(sender, receiver, vchPayload));
+    }
+}
+
+static void InterpretSendAll(benchmark::State& state)
+{
+    benchmark::ZusBenchSetup setup;
+    const std::string addressA = benchmark::BenchAddress(1);
+    const std::string addressB = benchmark::BenchAddress(2);
+    for (int n = 0; n < 10; ++n) {
+        Fund(addressA, setup.CreateTestProperty());
+    }
+
+    std::vector<unsigned char> vchPayload = CreatePayload_SendAll(2);
+    bool fForward = true;
+    while (state.KeepRunning()) {
+        if (fForward) {
+            assert(0 == ProcessPayload(addressA, addressB, vchPayload));
+        } else {
+            assert(0 == ProcessPayload(addressB, addressA, vchPayload));
+        }
+        fForward = !fForward;
+    }
+}
+
+/** Executes send to owners transactions, which are distributed to a number of holders. */
+static void SendToOwners(benchmark::State& state, unsigned int nHolders)
+{
+    benchmark::ZusBenchSetup setup;
+    const uint32_t propertyId = setup.CreateTestProperty();
+    const std::string sender = benchmark::BenchAddress(0);
+    Fund(sender, propertyId);
+    Fund(sender, OMNI_PROPERTY_TMSC);
+    for (unsigned int n = 1; n <= nHolders; ++n) {
+        assert(update_tally_map(benchmark::BenchAddress(n), propertyId, n, BALANCE));
+    }
+
+    std::vector<unsigned char> vchPayload = CreatePayload_SendToOwners(propertyId, 1000 * nHolders, propertyId);
+    while (state.KeepRunning()) {
+        assert(0 == ProcessPayload(sender, "", vchPayload));
+    }
+}
+
+static void InterpretSendToOwners(benchmark::State& state)
+{
+    SendToOwners(state, 100);
+}
+
+static void InterpretSendToOwners_10000Holders(benchmark::State& state)
+{
+    SendToOwners(state, 10000);
+}
+
+static void InterpretSendToOwners_100000Holders(benchmark::State& state)
+{
+    SendToOwners(state, 100000);
+}
+
+/** Places a trade and cancels it again, which leaves the order book empty. */
+static void InterpretMetaDExTradeAndCancel(benchmark::State& state)
+{
+    benchmark::ZusBenchSetup setup;
+    const uint32_t propertyId = setup.CreateTestProperty();
+    const std::string sender = benchmark::BenchAddress(1);
+    Fund(sender, OMNI_PROPERTY_TMSC);
+
+    std::vector<unsigned char> vchTrade = CreatePayload_MetaDExTrade(OMNI_PROPERTY_TMSC, 1000, propertyId, 2000);
+    std::vector<unsigned char> vchCancel = CreatePayload_MetaDExCancelPair(OMNI_PROPERTY_TMSC, propertyId);
+    while (state.KeepRunning()) {
+        assert(0 == ProcessPayload(sender, "", vchTrade));
+        assert(0 == ProcessPayload(sender, "", vchCancel));
+    }
+}
+
+/** Determines the receivers of a send to owners transaction for a number of holders. */
+static void StoGetReceivers(benchmark::State& state, unsigned int nHolders)
+{
+    benchmark::ZusBenchSetup setup;
+    const uint32_t propertyId = TEST_ECO_PROPERTY_1;
+    const std::string sender = benchmark::BenchAddress(0);
+    for (unsigned int n = 1; n <= nHolders; ++n) {
+        assert(update_tally_map(benchmark::BenchAddress(n), propertyId, n, BALANCE));
+        // holders of other properties are visited, but ignored
+        assert(update_tally_map(benchmark::BenchAddress(nHolders + n), OMNI_PROPERTY_TMSC, n, BALANCE));
+    }
+
+    while (state.KeepRunning()) {
+        OwnerAddrType receivers = STO_GetReceivers(sender, propertyId, 1000000);
+        assert(!receivers.empty());
+    }
+}
+
+static void StoGetReceivers_1000Holders(benchmark::State& state)
+{
+    StoGetReceivers(state, 1000);
+}
+
+static void StoGetReceivers_10000Holders(benchmark::State& state)
+{
+    StoGetReceivers(state, 10000);
+}
+
+static void StoGetReceivers_100000Holders(benchmark::State& state)
+{
+    StoGetReceivers(state, 100000);
+}
+
+BENCHMARK(InterpretSimpleSend);
+BENCHMARK(InterpretSendAll);
+BENCHMARK(InterpretSendToOwners);
+BENCHMARK(InterpretSendToOwners_10000Holders);
+BENCHMARK(InterpretSendToOwners_100000Holders);
+BENCHMARK(InterpretMetaDExTradeAndCancel);
+BENCHMARK(StoGetReceivers_1000Holders);
+BENCHMARK(StoGetReceivers_10000Holders);
+BENCHMARK(StoGetReceivers_100000Holders);
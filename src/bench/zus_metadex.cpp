@@ -0,0 +1,135 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "zus_common.h"
+
+#include "zurbank/mdex.h"
+#include "zurbank/tally.h"
+#include "zurbank/tx.h"
+#include "zurbank/zurbank.h"
+
+#include "sync.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string>
+
+using namespace mastercore;
+
+static const int64_t ORDER_AMOUNT = 100;
+
+/**
+ * Matches a single incoming order against a book with the given number of
+ * price levels for each of the given number of trading pairs.
+ *
+ * All pairs share the property for sale, so the orders of the other pairs are
+ * visited, but not matched, when walking the price levels. Every iteration
+ * fully fills the best order of the first pair, which is then placed back into
+ * the book, so the depth stays constant.
+ */
+static void MetaDExMatch(benchmark::State& state, unsigned int nLevels, unsigned int nPairs)
+{
+    benchmark::ZusBenchSetup setup;
+
+    const uint32_t propertyForSale = TEST_ECO_PROPERTY_1;
+    const uint32_t propertyDesired = TEST_ECO_PROPERTY_1 + 1;
+    const std::string seller = benchmark::BenchAddress(1);
+    const std::string taker = benchmark::BenchAddress(2);
+
+    LOCK(cs_tally);
+
+    for (unsigned int pair = 0; pair < nPairs; ++pair) {
+        for (unsigned int level = 0; level < nLevels; ++level) {
+            CMPMetaDEx order(seller, 1, propertyForSale, ORDER_AMOUNT, propertyDesired + pair, ORDER_AMOUNT + level,
+                    benchmark::NextBenchTxid(), pair, CMPTransaction::ADD);
+            assert(MetaDEx_INSERT(order));
+            assert(update_tally_map(seller, propertyForSale, ORDER_AMOUNT, METADEX_RESERVE));
+        }
+    }
+    assert(update_tally_map(taker, propertyDesired, MAX_INT_8_BYTES / 2, BALANCE));
+
+    int nBlock = 2;
+    while (state.KeepRunning()) {
+        assert(0 == MetaDEx_ADD(taker, propertyDesired, ORDER_AMOUNT, nBlock, propertyForSale, ORDER_AMOUNT,
+                benchmark::NextBenchTxid(), 1));
+
+        // restore the filled order
+        CMPMetaDEx order(seller, nBlock, propertyForSale, ORDER_AMOUNT, propertyDesired, ORDER_AMOUNT,
+                benchmark::NextBenchTxid(), 2, CMPTransaction::ADD);
+        assert(MetaDEx_INSERT(order));
+        assert(update_tally_map(seller, propertyForSale, ORDER_AMOUNT, METADEX_RESERVE));
+        ++nBlock;
+    }
+}
+
+/**
+ * Matches a single incoming order against the oldest of the given number of
+ * orders at the best price level, which is only partially filled, as is
+ * common for the large orders of market makers.
+ */
+static void MetaDExPartialFill(benchmark::State& state, unsigned int nOrders)
+{
+    benchmark::ZusBenchSetup setup;
+
+    const uint32_t propertyForSale = TEST_ECO_PROPERTY_1;
+    const uint32_t propertyDesired = TEST_ECO_PROPERTY_1 + 1;
+    const int64_t makerAmount = MAX_INT_8_BYTES / 4;
+    const std::string seller = benchmark::BenchAddress(1);
+    const std::string taker = benchmark::BenchAddress(2);
+
+    LOCK(cs_tally);
+
+    for (unsigned int n = 0; n < nOrders; ++n) {
+        CMPMetaDEx order(seller, 1, propertyForSale, makerAmount, propertyDesired, makerAmount,
+                benchmark::NextBenchTxid(), n, CMPTransaction::ADD);
+        assert(MetaDEx_INSERT(order));
+    }
+    assert(update_tally_map(seller, propertyForSale, MAX_INT_8_BYTES / 2, METADEX_RESERVE));
+    assert(update_tally_map(taker, propertyDesired, MAX_INT_8_BYTES / 2, BALANCE));
+
+    int nBlock = 2;
+    while (state.KeepRunning()) {
+        assert(0 == MetaDEx_ADD(taker, propertyDesired, ORDER_AMOUNT, nBlock, propertyForSale, ORDER_AMOUNT,
+                benchmark::NextBenchTxid(), 1));
+        ++nBlock;
+    }
+}
+
+static void MetaDExMatch_1Pair_10Levels(benchmark::State& state)
+{
+    MetaDExMatch(state, 10, 1);
+}
+
+static void MetaDExMatch_1Pair_1000Levels(benchmark::State& state)
+{
+    MetaDExMatch(state, 1000, 1);
+}
+
+static void MetaDExMatch_10Pairs_100Levels(benchmark::State& state)
+{
+    MetaDExMatch(state, 100, 10);
+}
+
+static void MetaDExMatch_100Pairs_100Levels(benchmark::State& state)
+{
+    MetaDExMatch(state, 100, 100);
+}
+
+static void MetaDExPartialFill_1Order(benchmark::State& state)
+{
+    MetaDExPartialFill(state, 1);
+}
+
+static void MetaDExPartialFill_1000Orders(benchmark::State& state)
+{
+    MetaDExPartialFill(state, 1000);
+}
+
+BENCHMARK(MetaDExMatch_1Pair_10Levels);
+BENCHMARK(MetaDExMatch_1Pair_1000Levels);
+BENCHMARK(MetaDExMatch_10Pairs_100Levels);
+BENCHMARK(MetaDExMatch_100Pairs_100Levels);
+BENCHMARK(MetaDExPartialFill_1Order);
+BENCHMARK(MetaDExPartialFill_1000Orders);
@@ -0,0 +1,147 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "zus_common.h"
+
+#include "zurbank/createpayload.h"
+#include "zurbank/encoding.h"
+#include "zurbank/parsing.h"
+#include "zurbank/tx.h"
+#include "zurbank/zurbank.h"
+
+#include "base58.h"
+#include "chainparamsbase.h"
+#include "coins.h"
+#include "key.h"
+#include "primitives/transaction.h"
+#include "pubkey.h"
+#include "script/script.h"
+#include "script/standard.h"
+#include "sync.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace mastercore;
+
+// Note: the benchmarks run on testnet, because the Exodus address is not valid on regtest
+static const int BENCH_BLOCK = 1000;
+
+/** Creates a transaction spending a single output of the given key, and adds the input to the cache. */
+static CTransaction CreateBenchTx(const CKey& key, const std::vector<std::pair<CScript, int64_t> >& vecOutputs)
+{
+    CMutableTransaction inputTx;
+    inputTx.vout.push_back(CTxOut(50000000, GetScriptForDestination(key.GetPubKey().GetID())));
+    CTransaction txPrev(inputTx);
+
+    {
+        LOCK(cs_tx_cache);
+        CCoinsModifier coins = view.ModifyCoins(txPrev.GetHash());
+        coins->vout.resize(1);
+        coins->vout[0] = txPrev.vout[0];
+    }
+
+    CMutableTransaction mutableTx;
+    mutableTx.vin.push_back(CTxIn(txPrev.GetHash(), 0));
+    for (std::vector<std::pair<CScript, int64_t> >::const_iterator it = vecOutputs.begin(); it != vecOutputs.end(); ++it) {
+        mutableTx.vout.push_back(CTxOut(it->second, it->first));
+    }
+
+    return CTransaction(mutableTx);
+}
+
+/** Returns a reference output to a freshly generated key. */
+static std::pair<CScript, int64_t> CreateReferenceOutput()
+{
+    CKey key;
+    key.MakeNewKey(true);
+    return std::make_pair(GetScriptForDestination(key.GetPubKey().GetID()), 5460);
+}
+
+static void ParseBenchTx(benchmark::State& state, const CTransaction& tx, int expectedClass)
+{
+    while (state.KeepRunning()) {
+        CMPTransaction mp_obj;
+        int rc = ParseTransaction(tx, BENCH_BLOCK, 1, mp_obj);
+        assert(expectedClass == NO_MARKER ? rc != 0 : rc == 0);
+        assert(expectedClass == NO_MARKER || mp_obj.getEncodingClass() == expectedClass);
+    }
+}
+
+static void ParseClassB(benchmark::State& state)
+{
+    benchmark::ZusBenchSetup setup(CBaseChainParams::TESTNET);
+    CKey key;
+    key.MakeNewKey(true);
+    const std::string strSender = CBitcoinAddress(key.GetPubKey().GetID()).ToString();
+
+    std::vector<unsigned char> vchPayload = CreatePayload_MetaDExTrade(OMNI_PROPERTY_TMSC, 1000, TEST_ECO_PROPERTY_1, 2000);
+    std::vector<std::pair<CScript, int64_t> > vecOutputs;
+    assert(ZurBank_Encode_ClassB(strSender, key.GetPubKey(), vchPayload, vecOutputs));
+    vecOutputs.push_back(CreateReferenceOutput());
+
+    ParseBenchTx(state, CreateBenchTx(key, vecOutputs), OMNI_CLASS_B);
+}
+
+static void ParseClassC(benchmark::State& state)
+{
+    benchmark::ZusBenchSetup setup(CBaseChainParams::TESTNET);
+    CKey key;
+    key.MakeNewKey(true);
+
+    std::vector<unsigned char> vchPayload = CreatePayload_MetaDExTrade(OMNI_PROPERTY_TMSC, 1000, TEST_ECO_PROPERTY_1, 2000);
+    std::vector<std::pair<CScript, int64_t> > vecOutputs;
+    assert(ZurBank_Encode_ClassC(vchPayload, vecOutputs));
+    vecOutputs.push_back(CreateReferenceOutput());
+
+    ParseBenchTx(state, CreateBenchTx(key, vecOutputs), OMNI_CLASS_C);
+}
+
+/** Transactions without marker are dismissed by the encoding class check. */
+static void ParseNoMarker(benchmark::State& state)
+{
+    benchmark::ZusBenchSetup setup(CBaseChainParams::TESTNET);
+    CKey key;
+    key.MakeNewKey(true);
+
+    std::vector<std::pair<CScript, int64_t> > vecOutputs;
+    vecOutputs.push_back(CreateReferenceOutput());
+    vecOutputs.push_back(CreateReferenceOutput());
+
+    ParseBenchTx(state, CreateBenchTx(key, vecOutputs), NO_MARKER);
+}
+
+static void EncodeClassB(benchmark::State& state)
+{
+    benchmark::ZusBenchSetup setup(CBaseChainParams::TESTNET);
+    CKey key;
+    key.MakeNewKey(true);
+    const std::string strSender = CBitcoinAddress(key.GetPubKey().GetID()).ToString();
+    const CPubKey pubKey = key.GetPubKey();
+
+    std::vector<unsigned char> vchPayload = CreatePayload_MetaDExTrade(OMNI_PROPERTY_TMSC, 1000, TEST_ECO_PROPERTY_1, 2000);
+    while (state.KeepRunning()) {
+        std::vector<std::pair<CScript, int64_t> > vecOutputs;
+        assert(ZurBank_Encode_ClassB(strSender, pubKey, vchPayload, vecOutputs));
+    }
+}
+
+static void EncodeClassC(benchmark::State& state)
+{
+    std::vector<unsigned char> vchPayload = CreatePayload_MetaDExTrade(OMNI_PROPERTY_TMSC, 1000, TEST_ECO_PROPERTY_1, 2000);
+    while (state.KeepRunning()) {
+        std::vector<std::pair<CScript, int64_t> > vecOutputs;
+        assert(ZurBank_Encode_ClassC(vchPayload, vecOutputs));
+    }
+}
+
+BENCHMARK(ParseClassB);
+BENCHMARK(ParseClassC);
+BENCHMARK(ParseNoMarker);
+BENCHMARK(EncodeClassB);
+BENCHMARK(EncodeClassC);
@@ -0,0 +1,120 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "zus_common.h"
+
+#include "zurbank/consensushash.h"
+#include "zurbank/mdex.h"
+#include "zurbank/persistence.h"
+#include "zurbank/tally.h"
+#include "zurbank/tx.h"
+#include "zurbank/zurbank.h"
+
+#include "chain.h"
+#include "main.h"
+#include "sync.h"
+#include "tinyformat.h"
+#include "uint256.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+using namespace mastercore;
+
+//! Path for file based persistence, defined in zurbank.cpp
+extern boost::filesystem::path pathStateFiles;
+
+/** Fills the tally map and order book with the given number of entries. */
+static void PopulateState(unsigned int nAddresses, unsigned int nOrders)
+{
+    LOCK(cs_tally);
+
+    for (unsigned int n = 0; n < nAddresses; ++n) {
+        const std::string address = benchmark::BenchAddress(n);
+        assert(update_tally_map(address, OMNI_PROPERTY_TMSC, 100000000 + n, BALANCE));
+        assert(update_tally_map(address, TEST_ECO_PROPERTY_1, 1000 + n, BALANCE));
+        assert(update_tally_map(address, TEST_ECO_PROPERTY_1 + 1 + (n % 10), 1 + n, BALANCE));
+    }
+    for (unsigned int n = 0; n < nOrders; ++n) {
+        const std::string address = benchmark::BenchAddress(n % nAddresses);
+        CMPMetaDEx order(address, 1, TEST_ECO_PROPERTY_1, 100, OMNI_PROPERTY_TMSC, 100 + n,
+                benchmark::NextBenchTxid(), n, CMPTransaction::ADD);
+        assert(MetaDEx_INSERT(order));
+        assert(update_tally_map(address, TEST_ECO_PROPERTY_1, 100, METADEX_RESERVE));
+    }
+}
+
+static void ConsensusHash(benchmark::State& state, unsigned int nAddresses, unsigned int nOrders)
+{
+    benchmark::ZusBenchSetup setup;
+    PopulateState(nAddresses, nOrders);
+
+    while (state.KeepRunning()) {
+        GetConsensusHash();
+    }
+}
+
+static void ConsensusHash_1000Addresses(benchmark::State& state)
+{
+    ConsensusHash(state, 1000, 1000);
+}
+
+static void ConsensusHash_100000Addresses(benchmark::State& state)
+{
+    ConsensusHash(state, 100000, 10000);
+}
+
+/**
+ * Stores the in-memory state in files and loads the balances and orders
+ * again, as done when the state is restored after a restart.
+ */
+static void PersistRestoreState(benchmark::State& state, unsigned int nAddresses, unsigned int nOrders)
+{
+    benchmark::ZusBenchSetup setup;
+    PopulateState(nAddresses, nOrders);
+
+    // a block index entry is required, otherwise the files are pruned right away
+    const uint256 hashBlock = benchmark::NextBenchTxid();
+    CBlockIndex blockIndex;
+    blockIndex.nHeight = 1000;
+    blockIndex.phashBlock = &hashBlock;
+    {
+        LOCK(cs_main);
+        mapBlockIndex[hashBlock] = &blockIndex;
+    }
+
+    const std::string strBalances = (pathStateFiles / strprintf("balances-%s.dat", hashBlock.ToString())).string();
+    const std::string strOrders = (pathStateFiles / strprintf("mdexorders-%s.dat", hashBlock.ToString())).string();
+
+    while (state.KeepRunning()) {
+        LOCK(cs_tally);
+        assert(0 == PersistInMemoryState(&blockIndex));
+        assert(0 == RestoreInMemoryState(strBalances, FILETYPE_BALANCES, true));
+        assert(0 == RestoreInMemoryState(strOrders, FILETYPE_MDEXORDERS, true));
+    }
+
+    {
+        LOCK(cs_main);
+        mapBlockIndex.erase(hashBlock);
+    }
+}
+
+static void PersistRestoreState_1000Addresses(benchmark::State& state)
+{
+    PersistRestoreState(state, 1000, 1000);
+}
+
+static void PersistRestoreState_100000Addresses(benchmark::State& state)
+{
+    PersistRestoreState(state, 100000, 10000);
+}
+
+BENCHMARK(ConsensusHash_1000Addresses);
+BENCHMARK(ConsensusHash_100000Addresses);
+BENCHMARK(PersistRestoreState_1000Addresses);
+BENCHMARK(PersistRestoreState_100000Addresses);
@@ -6,6 +6,9 @@
 #define BITCOIN_CHECKQUEUE_H
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 
 #include <boost/foreach.hpp>
@@ -16,6 +19,9 @@
 template <typename T>
 class CCheckQueueControl;
 
+/** The maximum number of threads (including the master) with their own queue of checks */
+static const unsigned int MAX_CHECKQUEUE_WORKERS = 64;
+
 /** 
  * Queue for verifications that have to be performed.
   * The verifications are represented by a type T, which must provide an
@@ -25,12 +31,36 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Every thread has its own queue of checks, which the master fills in turn.
+  * Threads take batches from their own queue, and steal from the queues of
+  * others when theirs is empty, so the threads rarely contend on a lock.
+  * The shared mutex is only used to sleep and to wake up, and to register
+  * the workers, whose queues are only allocated when they start.
   */
 template <typename T>
 class CCheckQueue
 {
 private:
-    //! Mutex to protect the inner state
+    /** The checks of one thread. The owner pops from the back, others steal from the front. */
+    struct WorkerQueue
+    {
+        boost::mutex mutex;
+        std::deque<T> checks;
+        //! The number of queued checks, which can be read without the lock
+        std::atomic<size_t> nSize;
+
+        WorkerQueue() : nSize(0) {}
+    };
+
+    //! The queues of the master (index 0) and the registered workers
+    std::unique_ptr<WorkerQueue> queues[MAX_CHECKQUEUE_WORKERS];
+
+    //! The number of registered workers, excluding the master. The queues up to this
+    //! number are allocated before it's increased.
+    std::atomic<unsigned int> nWorkers;
+
+    //! Mutex to sleep on when out of work
     boost::mutex mutex;
 
     //! Worker threads block on this when out of work
@@ -39,121 +69,172 @@ private:
     //! Master thread blocks on this when out of work
     boost::condition_variable condMaster;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue;
+    //! Incremented whenever checks are added, so sleeping workers know when to look for work
+    std::atomic<uint64_t> nGeneration;
 
-    //! The number of workers (including the master) that are idle.
+    //! The number of workers that are asleep, protected by mutex
     int nIdle;
 
-    //! The total number of workers (including the master).
-    int nTotal;
-
     //! The temporary evaluation result.
-    bool fAllOk;
+    std::atomic<bool> fAllOk;
 
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
      * worker's own batches.
      */
-    unsigned int nTodo;
+    std::atomic<unsigned int> nTodo;
 
-    //! Whether we're shutting down.
-    bool fQuit;
+    //! The queue that receives the next checks, used by the master only
+    unsigned int nNextQueue;
 
     //! The maximum number of elements to be processed in one batch
     unsigned int nBatchSize;
 
-    /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster = false)
+    //! The number of queues in use.
+    unsigned int GetQueueCount() const
     {
-        boost::condition_variable& cond = fMaster ? condMaster : condWorker;
-        std::vector<T> vChecks;
-        vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
-        do {
-            {
-                boost::unique_lock<boost::mutex> lock(mutex);
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster)
-                        // We processed the last element; inform the master it can exit and return the result
-                        condMaster.notify_one();
+        return std::min(nWorkers.load() + 1, MAX_CHECKQUEUE_WORKERS);
+    }
+
+    /**
+     * Take a batch of checks from the own queue, or else steal one from the
+     * queue of another thread. Returns false if there is no work anywhere.
+     */
+    bool Pop(unsigned int nQueue, std::vector<T>& vChecks)
+    {
+        const unsigned int nQueues = GetQueueCount();
+        for (unsigned int n = 0; n < nQueues; n++) {
+            const bool fOwn = n == 0;
+            WorkerQueue& queue = *queues[(nQueue + n) % nQueues];
+            if (queue.nSize.load() == 0)
+                continue;
+            boost::unique_lock<boost::mutex> lock(queue.mutex);
+            if (queue.checks.empty())
+                continue;
+            // Take at most half of the queue, so the remainder can be shared
+            // with others, and no more than nBatchSize.
+            size_t nNow = std::max<size_t>(1, std::min<size_t>(nBatchSize, queue.checks.size() / 2));
+            vChecks.resize(nNow);
+            for (size_t i = 0; i < nNow; i++) {
+                if (fOwn) {
+                    vChecks[i].swap(queue.checks.back());
+                    queue.checks.pop_back();
                 } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty()) {
-                    if ((fMaster || fQuit) && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        if (fMaster)
-                            fAllOk = true;
-                        // return the current status
-                        return fRet;
-                    }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
+                    vChecks[i].swap(queue.checks.front());
+                    queue.checks.pop_front();
                 }
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so
-                //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                vChecks.resize(nNow);
-                for (unsigned int i = 0; i < nNow; i++) {
-                    // We want the lock on the mutex to be as short as possible, so swap jobs from the global
-                    // queue to the local batch vector instead of copying.
-                    vChecks[i].swap(queue.back());
-                    queue.pop_back();
-                }
-                // Check whether we need to do work at all
-                fOk = fAllOk;
             }
-            // execute work
-            BOOST_FOREACH (T& check, vChecks)
-                if (fOk)
-                    fOk = check();
-            vChecks.clear();
-        } while (true);
+            queue.nSize = queue.checks.size();
+            return true;
+        }
+        return false;
+    }
+
+    /** Run a batch of checks, and account for them. */
+    void Execute(std::vector<T>& vChecks)
+    {
+        // Stop as soon as any check failed, including those of other threads
+        bool fOk = true;
+        BOOST_FOREACH (T& check, vChecks) {
+            fOk = fAllOk.load(std::memory_order_relaxed) && check();
+            if (!fOk)
+                break;
+        }
+        if (!fOk)
+            fAllOk = false;
+        const unsigned int nNow = vChecks.size();
+        vChecks.clear();
+        if (nTodo.fetch_sub(nNow) == nNow) {
+            // We processed the last element; inform the master it can exit and return the result
+            boost::unique_lock<boost::mutex> lock(mutex);
+            condMaster.notify_one();
+        }
     }
 
 public:
     //! Create a new check queue
-    CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), fQuit(false), nBatchSize(nBatchSizeIn) {}
+    CCheckQueue(unsigned int nBatchSizeIn) : nWorkers(0), nGeneration(0), nIdle(0), fAllOk(true), nTodo(0), nNextQueue(0), nBatchSize(nBatchSizeIn)
+    {
+        queues[0].reset(new WorkerQueue());
+    }
 
     //! Worker thread
     void Thread()
     {
-        Loop();
+        unsigned int nQueue;
+        {
+            // Threads beyond the maximum share the last queue
+            boost::unique_lock<boost::mutex> lock(mutex);
+            nQueue = std::min(nWorkers.load() + 1, MAX_CHECKQUEUE_WORKERS - 1);
+            if (!queues[nQueue])
+                queues[nQueue].reset(new WorkerQueue());
+            nWorkers++;
+        }
+        std::vector<T> vChecks;
+        vChecks.reserve(nBatchSize);
+        while (true) {
+            const uint64_t nGenerationSeen = nGeneration.load();
+            if (Pop(nQueue, vChecks)) {
+                Execute(vChecks);
+                continue;
+            }
+            // Nothing to do: sleep until new checks are added
+            boost::unique_lock<boost::mutex> lock(mutex);
+            while (nGeneration.load() == nGenerationSeen) {
+                nIdle++;
+                try {
+                    condWorker.wait(lock); // wait
+                } catch (...) {
+                    nIdle--;
+                    throw;
+                }
+                nIdle--;
+            }
+        }
     }
 
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait()
     {
-        return Loop(true);
+        std::vector<T> vChecks;
+        vChecks.reserve(nBatchSize);
+        while (Pop(0, vChecks))
+            Execute(vChecks);
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            while (nTodo.load() != 0)
+                condMaster.wait(lock);
+        }
+        // reset the status for new work later
+        return fAllOk.exchange(true);
     }
 
     //! Add a batch of checks to the queue
     void Add(std::vector<T>& vChecks)
     {
-        boost::unique_lock<boost::mutex> lock(mutex);
-        BOOST_FOREACH (T& check, vChecks) {
-            queue.push_back(T());
-            check.swap(queue.back());
-        }
+        if (vChecks.empty())
+            return;
+        // Account for the checks before anyone can run them
         nTodo += vChecks.size();
+        const unsigned int nQueues = GetQueueCount();
+        const size_t nPerQueue = (vChecks.size() + nQueues - 1) / nQueues;
+        for (size_t i = 0; i < vChecks.size(); ) {
+            WorkerQueue& queue = *queues[nNextQueue++ % nQueues];
+            boost::unique_lock<boost::mutex> lock(queue.mutex);
+            for (size_t nEnd = std::min(i + nPerQueue, vChecks.size()); i < nEnd; i++) {
+                queue.checks.push_back(T());
+                vChecks[i].swap(queue.checks.back());
+            }
+            queue.nSize = queue.checks.size();
+        }
+        boost::unique_lock<boost::mutex> lock(mutex);
+        nGeneration++;
+        if (nIdle == 0)
+            return;
         if (vChecks.size() == 1)
             condWorker.notify_one();
-        else if (vChecks.size() > 1)
+        else
             condWorker.notify_all();
     }
 
@@ -163,8 +244,7 @@ public:
 
     bool IsIdle()
     {
-        boost::unique_lock<boost::mutex> lock(mutex);
-        return (nTotal == nIdle && nTodo == 0 && fAllOk == true);
+        return (nTodo.load() == 0 && fAllOk.load() == true);
     }
 
 };
@@ -226,6 +226,14 @@ void CCoinsViewCache::Uncache(const uint256& hash)
     }
 }
 
+void CCoinsViewCache::Swap(CCoinsViewCache& other) {
+    assert(!hasModifier && !other.hasModifier);
+    std::swap(base, other.base);
+    std::swap(hashBlock, other.hashBlock);
+    cacheCoins.swap(other.cacheCoins);
+    std::swap(cachedCoinsUsage, other.cachedCoinsUsage);
+}
+
 unsigned int CCoinsViewCache::GetCacheSize() const {
     return cacheCoins.size();
 }
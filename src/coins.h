@@ -6,8 +6,13 @@
 #ifndef BITCOIN_COINS_H
 #define BITCOIN_COINS_H
 
+#if defined(HAVE_CONFIG_H)
+#include "config/zurcoin-config.h"
+#endif
+
 #include "compressor.h"
 #include "core_memusage.h"
+#include "flatmap.h"
 #include "hash.h"
 #include "memusage.h"
 #include "serialize.h"
@@ -268,8 +273,8 @@ public:
 class SaltedTxidHasher
 {
 private:
-    /** Salt */
-    const uint64_t k0, k1;
+    /** Salt (not const, so that maps using it can be swapped) */
+    uint64_t k0, k1;
 
 public:
     SaltedTxidHasher();
@@ -297,7 +302,17 @@ struct CCoinsCacheEntry
     CCoinsCacheEntry() : coins(), flags(0) {}
 };
 
+/**
+ * The cache of a CCoinsViewCache. An open addressing table with pooled entries
+ * needs a lot less memory per entry than a node based map, which lets the same
+ * -dbcache hold more transactions. The node based map is still available with
+ * --disable-flatmap-coins.
+ */
+#ifdef USE_BOOST_COINS_MAP
 typedef boost::unordered_map<uint256, CCoinsCacheEntry, SaltedTxidHasher> CCoinsMap;
+#else
+typedef flatmap<uint256, CCoinsCacheEntry, SaltedTxidHasher> CCoinsMap;
+#endif
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -335,7 +350,7 @@ public:
     virtual uint256 GetBestBlock() const;
 
     //! Do a bulk modification (multiple CCoins changes + BestBlock change).
-    //! The passed mapCoins can be modified.
+    //! The passed mapCoins can be modified, and is empty afterwards.
     virtual bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock);
 
     //! Get a cursor to iterate over the whole state
@@ -459,6 +474,9 @@ public:
      */
     void Uncache(const uint256 &txid);
 
+    //! Exchange the cached coins, the best block and the backing view with another cache
+    void Swap(CCoinsViewCache& other);
+
     //! Calculate the size of the cache (in number of transactions)
     unsigned int GetCacheSize() const;
 
@@ -0,0 +1,270 @@
+// Copyright (c) 2014 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "crypto/quark.h"
+
+#include "crypto/common.h"
+#include "crypto/sph_blake.h"
+#include "crypto/sph_bmw.h"
+#include "crypto/sph_groestl.h"
+#include "crypto/sph_jh.h"
+#include "crypto/sph_keccak.h"
+#include "crypto/sph_skein.h"
+
+#include <assert.h>
+#include <string.h>
+#include <vector>
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace quark_avx2
+{
+void Blake512(unsigned char* out[4], const unsigned char* const in[4], size_t len);
+void Bmw512(unsigned char* out[4], const unsigned char* const in[4], size_t len);
+void Jh512(unsigned char* out[4], const unsigned char* const in[4], size_t len);
+void Keccak512(unsigned char* out[4], const unsigned char* const in[4], size_t len);
+void Skein512(unsigned char* out[4], const unsigned char* const in[4], size_t len);
+}
+#endif
+
+#if defined(ENABLE_AESNI) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace quark_aesni
+{
+void Groestl512(unsigned char* out[4], const unsigned char* const in[4], size_t len);
+}
+#endif
+
+// Internal implementation code.
+namespace
+{
+/// Internal Quark implementation.
+namespace quark
+{
+/** The 512-bit primitives of the Quark chain. */
+enum Algo
+{
+    BLAKE = 0,
+    BMW,
+    GROESTL,
+    JH,
+    KECCAK,
+    SKEIN,
+    NUM_ALGOS
+};
+
+/** Hashes a single input with one of the primitives. */
+typedef void (*Hash512Fn)(unsigned char* out, const unsigned char* in, size_t len);
+
+/** Hashes four independent inputs of the same length at once. */
+typedef void (*Hash512x4Fn)(unsigned char* out[4], const unsigned char* const in[4], size_t len);
+
+void Blake512(unsigned char* out, const unsigned char* in, size_t len)
+{
+    sph_blake512_context ctx;
+    sph_blake512_init(&ctx);
+    sph_blake512(&ctx, in, len);
+    sph_blake512_close(&ctx, out);
+}
+
+void Bmw512(unsigned char* out, const unsigned char* in, size_t len)
+{
+    sph_bmw512_context ctx;
+    sph_bmw512_init(&ctx);
+    sph_bmw512(&ctx, in, len);
+    sph_bmw512_close(&ctx, out);
+}
+
+void Groestl512(unsigned char* out, const unsigned char* in, size_t len)
+{
+    sph_groestl512_context ctx;
+    sph_groestl512_init(&ctx);
+    sph_groestl512(&ctx, in, len);
+    sph_groestl512_close(&ctx, out);
+}
+
+void Jh512(unsigned char* out, const unsigned char* in, size_t len)
+{
+    sph_jh512_context ctx;
+    sph_jh512_init(&ctx);
+    sph_jh512(&ctx, in, len);
+    sph_jh512_close(&ctx, out);
+}
+
+void Keccak512(unsigned char* out, const unsigned char* in, size_t len)
+{
+    sph_keccak512_context ctx;
+    sph_keccak512_init(&ctx);
+    sph_keccak512(&ctx, in, len);
+    sph_keccak512_close(&ctx, out);
+}
+
+void Skein512(unsigned char* out, const unsigned char* in, size_t len)
+{
+    sph_skein512_context ctx;
+    sph_skein512_init(&ctx);
+    sph_skein512(&ctx, in, len);
+    sph_skein512_close(&ctx, out);
+}
+
+const Hash512Fn hash1[NUM_ALGOS] = { Blake512, Bmw512, Groestl512, Jh512, Keccak512, Skein512 };
+
+//! Multi-buffer implementations, which are selected by QuarkAutoDetect()
+Hash512x4Fn hash4[NUM_ALGOS] = { NULL, NULL, NULL, NULL, NULL, NULL };
+
+/** Hashes all inputs with one primitive, four at a time, if possible. */
+void HashLanes(Algo algo, unsigned char** out, const unsigned char** in, size_t lanes, size_t len)
+{
+    size_t i = 0;
+    Hash512x4Fn fn = hash4[algo];
+    if (fn != NULL) {
+        for (; i + 4 <= lanes; i += 4) {
+            fn(out + i, in + i, len);
+        }
+        if (i + 1 < lanes) {
+            // Fill the unused lanes of the last group with copies, which are discarded
+            unsigned char scratch[64];
+            unsigned char* pout[4];
+            const unsigned char* pin[4];
+            for (size_t n = 0; n < 4; ++n) {
+                pout[n] = (i + n < lanes) ? out[i + n] : scratch;
+                pin[n] = (i + n < lanes) ? in[i + n] : in[i];
+            }
+            fn(pout, pin, len);
+            i = lanes;
+        }
+    }
+    for (; i < lanes; ++i) {
+        hash1[algo](out[i], in[i], len);
+    }
+}
+
+/** Hashes every input with the first primitive, if bit 3 of its first byte is set, or with the second otherwise. */
+void HashLanesIf(Algo algoSet, Algo algoUnset, unsigned char* out, const unsigned char* in, size_t blocks)
+{
+    std::vector<unsigned char*> vOut[2];
+    std::vector<const unsigned char*> vIn[2];
+    for (size_t n = 0; n < 2; ++n) {
+        vOut[n].reserve(blocks);
+        vIn[n].reserve(blocks);
+    }
+    for (size_t i = 0; i < blocks; ++i) {
+        int n = (in[64 * i] & 8) ? 0 : 1;
+        vOut[n].push_back(out + 64 * i);
+        vIn[n].push_back(in + 64 * i);
+    }
+    if (!vIn[0].empty()) HashLanes(algoSet, &vOut[0][0], &vIn[0][0], vIn[0].size(), 64);
+    if (!vIn[1].empty()) HashLanes(algoUnset, &vOut[1][0], &vIn[1][0], vIn[1].size(), 64);
+}
+
+/** Hashes every input with one primitive. */
+void HashAll(Algo algo, unsigned char* out, const unsigned char* in, size_t blocks, size_t len)
+{
+    std::vector<unsigned char*> vOut(blocks);
+    std::vector<const unsigned char*> vIn(blocks);
+    for (size_t i = 0; i < blocks; ++i) {
+        vOut[i] = out + 64 * i;
+        vIn[i] = in + len * i;
+    }
+    HashLanes(algo, &vOut[0], &vIn[0], blocks, len);
+}
+
+#if (defined(__x86_64__) || defined(__amd64__) || defined(__i386__)) && defined(__GNUC__)
+void inline cpuid(uint32_t leaf, uint32_t subleaf, uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d)
+{
+    __asm__ ("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "0"(leaf), "2"(subleaf));
+}
+
+/** Checks whether the OS saves the AVX (YMM) registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__ ("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+
+/** Checks whether the CPU and OS support AVX2. */
+bool HaveAVX2()
+{
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(0, 0, eax, ebx, ecx, edx);
+    if (eax < 7) return false;
+    cpuid(1, 0, eax, ebx, ecx, edx);
+    bool fOSXSAVE = (ecx >> 27) & 1;
+    bool fAVX = (ecx >> 28) & 1;
+    if (!fOSXSAVE || !fAVX || !AVXEnabled()) return false;
+    cpuid(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 5) & 1;
+}
+
+/** Checks whether the CPU supports the AES instructions and SSE4.1. */
+bool HaveAESNI()
+{
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, 0, eax, ebx, ecx, edx);
+    bool fSSE41 = (ecx >> 19) & 1;
+    bool fAES = (ecx >> 25) & 1;
+    return fSSE41 && fAES;
+}
+#else
+bool HaveAVX2()
+{
+    return false;
+}
+
+bool HaveAESNI()
+{
+    return false;
+}
+#endif
+} // namespace quark
+} // namespace
+
+std::string QuarkAutoDetect()
+{
+    std::string ret = "standard";
+    for (int n = 0; n < quark::NUM_ALGOS; ++n) {
+        quark::hash4[n] = NULL;
+    }
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (quark::HaveAVX2()) {
+        quark::hash4[quark::BLAKE] = quark_avx2::Blake512;
+        quark::hash4[quark::BMW] = quark_avx2::Bmw512;
+        quark::hash4[quark::JH] = quark_avx2::Jh512;
+        quark::hash4[quark::KECCAK] = quark_avx2::Keccak512;
+        quark::hash4[quark::SKEIN] = quark_avx2::Skein512;
+        ret = "avx2(4way)";
+    }
+#endif
+#if defined(ENABLE_AESNI) && !defined(BUILD_BITCOIN_INTERNAL)
+    // Groestl is not vectorized over the lanes, but its S-box is computed
+    // by the AES instructions, which also helps CPUs without AVX2
+    if (quark::HaveAESNI()) {
+        quark::hash4[quark::GROESTL] = quark_aesni::Groestl512;
+        ret = (ret == "standard") ? "aesni" : ret + ",aesni";
+    }
+#endif
+    return ret;
+}
+
+void Quark80(unsigned char* output, const unsigned char* input, size_t blocks)
+{
+    if (blocks == 0) return;
+
+    // The intermediate hashes alternate between the two buffers
+    std::vector<unsigned char> a(64 * blocks);
+    std::vector<unsigned char> b(64 * blocks);
+
+    quark::HashAll(quark::BLAKE, &a[0], input, blocks, 80);
+    quark::HashAll(quark::BMW, &b[0], &a[0], blocks, 64);
+    quark::HashLanesIf(quark::GROESTL, quark::SKEIN, &a[0], &b[0], blocks);
+    quark::HashAll(quark::GROESTL, &b[0], &a[0], blocks, 64);
+    quark::HashAll(quark::JH, &a[0], &b[0], blocks, 64);
+    quark::HashLanesIf(quark::BLAKE, quark::BMW, &b[0], &a[0], blocks);
+    quark::HashAll(quark::KECCAK, &a[0], &b[0], blocks, 64);
+    quark::HashAll(quark::SKEIN, &b[0], &a[0], blocks, 64);
+    quark::HashLanesIf(quark::KECCAK, quark::JH, &a[0], &b[0], blocks);
+
+    for (size_t i = 0; i < blocks; ++i) {
+        memcpy(output + 32 * i, &a[64 * i], 32);
+    }
+}
@@ -0,0 +1,22 @@
+// Copyright (c) 2014 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_QUARK_H
+#define BITCOIN_CRYPTO_QUARK_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+/** Autodetect the best available Quark implementation. Returns the name of the implementation. */
+std::string QuarkAutoDetect();
+
+/** Compute the Quark hashes of multiple inputs of 80 bytes each, such as serialized block headers.
+ *
+ * The inputs are consecutive in `input`, and the 32 byte hashes are written consecutively
+ * to `output`. The result is identical to HashQuark() of every single input.
+ */
+void Quark80(unsigned char* output, const unsigned char* input, size_t blocks);
+
+#endif // BITCOIN_CRYPTO_QUARK_H
@@ -0,0 +1,217 @@
+// Copyright (c) 2014 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// This is an implementation of Groestl-512 with the AES instructions, which
+// compute the S-box of Groestl, as it's the same as the one of AES. The state
+// of 8 rows and 16 columns is held as one SSE register per row, so that the
+// rows are shifted with a byte shuffle, and the columns are mixed by XOR and
+// doubling of whole rows. The P and Q permutations are interleaved, as they
+// are independent. Only the short inputs of the Quark chain are supported.
+
+#ifdef ENABLE_AESNI
+
+#include "crypto/common.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+namespace quark_aesni
+{
+namespace
+{
+__m128i inline Xor(__m128i x, __m128i y) { return _mm_xor_si128(x, y); }
+__m128i inline K(uint8_t x) { return _mm_set1_epi8(x); }
+
+/** Multiplies every byte by 2 in the field of AES. */
+__m128i inline Double(__m128i x)
+{
+    __m128i high = _mm_cmplt_epi8(x, _mm_setzero_si128());
+    return Xor(_mm_add_epi8(x, x), _mm_and_si128(high, K(0x1B)));
+}
+
+//! The shifts of the rows of P and Q
+const int SHIFT_P[8] = { 0, 1, 2, 3, 4, 5, 6, 11 };
+const int SHIFT_Q[8] = { 1, 3, 5, 11, 0, 2, 4, 6 };
+
+/**
+ * Returns the shuffle, which rotates a row left by `shift` columns, followed
+ * by the inverse of the ShiftRows step of AES, which moves byte i to byte
+ * 13 * i of the row. The AESENCLAST instruction applies ShiftRows again, so
+ * that only the rotation and the S-box remain.
+ */
+__m128i inline Shuffle(int shift)
+{
+    const __m128i base = _mm_setr_epi8(0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3);
+    return _mm_and_si128(_mm_add_epi8(base, K(shift)), K(0x0F));
+}
+
+/** SubBytes and ShiftBytes of all rows. */
+void inline SubShift(__m128i x[8], const __m128i shuffle[8])
+{
+    const __m128i zero = _mm_setzero_si128();
+    x[0] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[0], shuffle[0]), zero);
+    x[1] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[1], shuffle[1]), zero);
+    x[2] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[2], shuffle[2]), zero);
+    x[3] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[3], shuffle[3]), zero);
+    x[4] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[4], shuffle[4]), zero);
+    x[5] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[5], shuffle[5]), zero);
+    x[6] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[6], shuffle[6]), zero);
+    x[7] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[7], shuffle[7]), zero);
+}
+
+/**
+ * Row i of MixBytes, which multiplies every column by the circulant matrix with
+ * the first row 2, 2, 3, 4, 5, 3, 5, 7. The factors are split into their bits,
+ * so that the row becomes a1 ^ 2 * (a2 ^ 2 * a4), where a1, a2 and a4 are the
+ * sums of the rows with the respective bit set in their factor. The sums are
+ * built from the sums of adjacent rows t[k] = a[k] ^ a[k + 1].
+ */
+template <int i>
+__m128i inline MixRow(const __m128i a[8], const __m128i t[8])
+{
+    __m128i c = Xor(a[(i + 2) & 7], a[(i + 7) & 7]);
+    __m128i a1 = Xor(Xor(c, a[(i + 4) & 7]), t[(i + 5) & 7]);
+    __m128i a2 = Xor(Xor(c, a[(i + 5) & 7]), t[i]);
+    __m128i a4 = Xor(t[(i + 3) & 7], t[(i + 6) & 7]);
+    return Xor(a1, Double(Xor(a2, Double(a4))));
+}
+
+/** MixBytes of all rows. */
+void inline MixBytes(__m128i x[8])
+{
+    const __m128i t[8] = {
+        Xor(x[0], x[1]), Xor(x[1], x[2]), Xor(x[2], x[3]), Xor(x[3], x[4]),
+        Xor(x[4], x[5]), Xor(x[5], x[6]), Xor(x[6], x[7]), Xor(x[7], x[0])
+    };
+    __m128i y0 = MixRow<0>(x, t);
+    __m128i y1 = MixRow<1>(x, t);
+    __m128i y2 = MixRow<2>(x, t);
+    __m128i y3 = MixRow<3>(x, t);
+    __m128i y4 = MixRow<4>(x, t);
+    __m128i y5 = MixRow<5>(x, t);
+    __m128i y6 = MixRow<6>(x, t);
+    __m128i y7 = MixRow<7>(x, t);
+    x[0] = y0; x[1] = y1; x[2] = y2; x[3] = y3;
+    x[4] = y4; x[5] = y5; x[6] = y6; x[7] = y7;
+}
+
+/** Computes P(p) and Q(q) of Groestl-1024, with the rows in the registers. */
+void inline PermutePQ(__m128i p[8], __m128i q[8])
+{
+    __m128i shuffleP[8];
+    __m128i shuffleQ[8];
+    for (int i = 0; i < 8; ++i) {
+        shuffleP[i] = Shuffle(SHIFT_P[i]);
+        shuffleQ[i] = Shuffle(SHIFT_Q[i]);
+    }
+    // Byte j of the round constants is (j << 4) ^ round, and its complement for Q
+    const __m128i columns = _mm_setr_epi8(0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+            (char)0x80, (char)0x90, (char)0xA0, (char)0xB0, (char)0xC0, (char)0xD0, (char)0xE0, (char)0xF0);
+    for (int round = 0; round < 14; ++round) {
+        __m128i rc = Xor(columns, K(round));
+        const __m128i ones = K(0xFF);
+        p[0] = Xor(p[0], rc);
+        q[0] = Xor(q[0], ones); q[1] = Xor(q[1], ones); q[2] = Xor(q[2], ones); q[3] = Xor(q[3], ones);
+        q[4] = Xor(q[4], ones); q[5] = Xor(q[5], ones); q[6] = Xor(q[6], ones); q[7] = Xor(q[7], Xor(rc, ones));
+        SubShift(p, shuffleP);
+        SubShift(q, shuffleQ);
+        MixBytes(p);
+        MixBytes(q);
+    }
+}
+
+/** Computes P(p) of Groestl-1024. */
+void inline PermuteP(__m128i p[8])
+{
+    __m128i shuffleP[8];
+    for (int i = 0; i < 8; ++i) {
+        shuffleP[i] = Shuffle(SHIFT_P[i]);
+    }
+    const __m128i columns = _mm_setr_epi8(0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+            (char)0x80, (char)0x90, (char)0xA0, (char)0xB0, (char)0xC0, (char)0xD0, (char)0xE0, (char)0xF0);
+    for (int round = 0; round < 14; ++round) {
+        p[0] = Xor(p[0], Xor(columns, K(round)));
+        SubShift(p, shuffleP);
+        MixBytes(p);
+    }
+}
+
+/** Loads a block of 16 columns of 8 bytes as rows. */
+void inline LoadRows(__m128i x[8], const unsigned char block[128])
+{
+    unsigned char rows[8][16];
+    for (int j = 0; j < 16; ++j) {
+        for (int i = 0; i < 8; ++i) {
+            rows[i][j] = block[8 * j + i];
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        x[i] = _mm_loadu_si128((const __m128i*)rows[i]);
+    }
+}
+
+/** Stores the last 8 columns of the rows, which are the output of Groestl-512. */
+void inline StoreOutput(unsigned char out[64], const __m128i x[8])
+{
+    unsigned char rows[8][16];
+    for (int i = 0; i < 8; ++i) {
+        _mm_storeu_si128((__m128i*)rows[i], x[i]);
+    }
+    for (int j = 8; j < 16; ++j) {
+        for (int i = 0; i < 8; ++i) {
+            out[8 * (j - 8) + i] = rows[i][j];
+        }
+    }
+}
+
+void inline Transform(unsigned char* out, const unsigned char* in, size_t len)
+{
+    // The padding: a single set bit, and the number of blocks as 64-bit big endian number
+    unsigned char block[128] = {0};
+    memcpy(block, in, len);
+    block[len] = 0x80;
+    WriteBE64(block + 120, 1);
+
+    // The initial value is the output size of 512 bits
+    unsigned char iv[128] = {0};
+    iv[126] = 0x02;
+
+    __m128i h[8];
+    __m128i m[8];
+    __m128i p[8];
+    LoadRows(h, iv);
+    LoadRows(m, block);
+
+    // h = P(h ^ m) ^ Q(m) ^ h
+    for (int i = 0; i < 8; ++i) {
+        p[i] = Xor(h[i], m[i]);
+    }
+    PermutePQ(p, m);
+    for (int i = 0; i < 8; ++i) {
+        h[i] = Xor(Xor(p[i], m[i]), h[i]);
+        p[i] = h[i];
+    }
+
+    // The output is the truncation of P(h) ^ h
+    PermuteP(p);
+    for (int i = 0; i < 8; ++i) {
+        h[i] = Xor(p[i], h[i]);
+    }
+    StoreOutput(out, h);
+}
+} // namespace
+
+void Groestl512(unsigned char* out[4], const unsigned char* const in[4], size_t len)
+{
+    assert(len <= 119);
+
+    for (int lane = 0; lane < 4; ++lane) {
+        Transform(out[lane], in[lane], len);
+    }
+}
+}
+
+#endif // ENABLE_AESNI
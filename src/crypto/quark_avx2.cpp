@@ -0,0 +1,692 @@
+// Copyright (c) 2014 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// This is a multi-buffer implementation of some of the 512-bit primitives of
+// the Quark chain, which hashes four independent inputs at once, with each
+// input in one 64-bit lane of the AVX2 registers. Only the short inputs of
+// the Quark chain are supported.
+
+#ifdef ENABLE_AVX2
+
+#include "crypto/common.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <immintrin.h>
+
+namespace quark_avx2
+{
+namespace
+{
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline And(__m256i x, __m256i y) { return _mm256_and_si256(x, y); }
+__m256i inline Or(__m256i x, __m256i y) { return _mm256_or_si256(x, y); }
+__m256i inline AndNot(__m256i x, __m256i y) { return _mm256_andnot_si256(x, y); }
+__m256i inline Not(__m256i x) { return _mm256_xor_si256(x, _mm256_set1_epi64x(-1)); }
+__m256i inline K(uint64_t x) { return _mm256_set1_epi64x(x); }
+template <int n> __m256i inline Shl(__m256i x) { return _mm256_slli_epi64(x, n); }
+template <int n> __m256i inline Shr(__m256i x) { return _mm256_srli_epi64(x, n); }
+template <int n> __m256i inline Rotl(__m256i x) { return Or(Shl<n>(x), Shr<64 - n>(x)); }
+template <int n> __m256i inline Rotr(__m256i x) { return Or(Shr<n>(x), Shl<64 - n>(x)); }
+template <> __m256i inline Rotr<32>(__m256i x) { return _mm256_shuffle_epi32(x, 0xB1); }
+__m256i inline Sub(__m256i x, __m256i y) { return _mm256_sub_epi64(x, y); }
+
+/** Combines the words of the four lanes. */
+__m256i inline Load(const uint64_t w[4])
+{
+    return _mm256_set_epi64x(w[3], w[2], w[1], w[0]);
+}
+
+/** Splits the four lanes. */
+void inline Store(uint64_t w[4], __m256i x)
+{
+    _mm256_storeu_si256((__m256i*)w, x);
+}
+
+namespace blake
+{
+const uint64_t IV[8] = {
+    0x6A09E667F3BCC908ull, 0xBB67AE8584CAA73Bull, 0x3C6EF372FE94F82Bull, 0xA54FF53A5F1D36F1ull,
+    0x510E527FADE682D1ull, 0x9B05688C2B3E6C1Full, 0x1F83D9ABFB41BD6Bull, 0x5BE0CD19137E2179ull
+};
+
+const uint64_t C[16] = {
+    0x243F6A8885A308D3ull, 0x13198A2E03707344ull, 0xA4093822299F31D0ull, 0x082EFA98EC4E6C89ull,
+    0x452821E638D01377ull, 0xBE5466CF34E90C6Cull, 0xC0AC29B7C97C50DDull, 0x3F84D5B5B5470917ull,
+    0x9216D5D98979FB1Bull, 0xD1310BA698DFB5ACull, 0x2FFD72DBD01ADFB7ull, 0xB8E1AFED6A267E96ull,
+    0xBA7C9045F12C7F99ull, 0x24A19947B3916CF7ull, 0x0801F2E2858EFC16ull, 0x636920D871574E69ull
+};
+
+const uint8_t SIGMA[10][16] = {
+    { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15},
+    {14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3},
+    {11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4},
+    { 7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8},
+    { 9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13},
+    { 2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9},
+    {12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11},
+    {13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10},
+    { 6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5},
+    {10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0}
+};
+
+void inline G(__m256i& a, __m256i& b, __m256i& c, __m256i& d, const __m256i m[16], const uint8_t* s, int i)
+{
+    a = Add(Add(a, b), Xor(m[s[2 * i]], K(C[s[2 * i + 1]])));
+    d = Rotr<32>(Xor(d, a));
+    c = Add(c, d);
+    b = Rotr<25>(Xor(b, c));
+    a = Add(Add(a, b), Xor(m[s[2 * i + 1]], K(C[s[2 * i]])));
+    d = Rotr<16>(Xor(d, a));
+    c = Add(c, d);
+    b = Rotr<11>(Xor(b, c));
+}
+} // namespace blake
+
+namespace bmw
+{
+const uint64_t IV[16] = {
+    0x8081828384858687ull, 0x88898A8B8C8D8E8Full, 0x9091929394959697ull, 0x98999A9B9C9D9E9Full,
+    0xA0A1A2A3A4A5A6A7ull, 0xA8A9AAABACADAEAFull, 0xB0B1B2B3B4B5B6B7ull, 0xB8B9BABBBCBDBEBFull,
+    0xC0C1C2C3C4C5C6C7ull, 0xC8C9CACBCCCDCECFull, 0xD0D1D2D3D4D5D6D7ull, 0xD8D9DADBDCDDDEDFull,
+    0xE0E1E2E3E4E5E6E7ull, 0xE8E9EAEBECEDEEEFull, 0xF0F1F2F3F4F5F6F7ull, 0xF8F9FAFBFCFDFEFFull
+};
+
+//! The chaining value of the final compression
+const uint64_t FINAL[16] = {
+    0xAAAAAAAAAAAAAAA0ull, 0xAAAAAAAAAAAAAAA1ull, 0xAAAAAAAAAAAAAAA2ull, 0xAAAAAAAAAAAAAAA3ull,
+    0xAAAAAAAAAAAAAAA4ull, 0xAAAAAAAAAAAAAAA5ull, 0xAAAAAAAAAAAAAAA6ull, 0xAAAAAAAAAAAAAAA7ull,
+    0xAAAAAAAAAAAAAAA8ull, 0xAAAAAAAAAAAAAAA9ull, 0xAAAAAAAAAAAAAAAAull, 0xAAAAAAAAAAAAAAABull,
+    0xAAAAAAAAAAAAAAACull, 0xAAAAAAAAAAAAAAADull, 0xAAAAAAAAAAAAAAAEull, 0xAAAAAAAAAAAAAAAFull
+};
+
+//! The words of M ^ H, which are added (1) or subtracted (-1) for W[i], as in the specification
+const int8_t W_IDX[16][5] = {
+    { 5,  7, 10, 13, 14}, { 6,  8, 11, 14, 15}, { 0,  7,  9, 12, 15}, { 0,  1,  8, 10, 13},
+    { 1,  2,  9, 11, 14}, { 3,  2, 10, 12, 15}, { 4,  0,  3, 11, 13}, { 1,  4,  5, 12, 14},
+    { 2,  5,  6, 13, 15}, { 0,  3,  6,  7, 14}, { 8,  1,  4,  7, 15}, { 8,  0,  2,  5,  9},
+    { 1,  3,  6,  9, 10}, { 2,  4,  7, 10, 11}, { 3,  5,  8, 11, 12}, {12,  4,  6,  9, 13}
+};
+const int8_t W_SIGN[16][4] = {
+    {-1,  1,  1,  1}, {-1,  1,  1, -1}, { 1,  1, -1,  1}, {-1,  1, -1,  1},
+    { 1,  1, -1, -1}, {-1,  1, -1,  1}, {-1, -1, -1,  1}, {-1, -1, -1, -1},
+    {-1, -1,  1, -1}, {-1,  1, -1,  1}, {-1, -1, -1,  1}, {-1, -1, -1,  1},
+    { 1, -1, -1,  1}, { 1,  1,  1,  1}, {-1,  1, -1, -1}, {-1, -1, -1,  1}
+};
+
+__m256i inline S0(__m256i x) { return Xor(Xor(Shr<1>(x), Shl<3>(x)), Xor(Rotl<4>(x), Rotl<37>(x))); }
+__m256i inline S1(__m256i x) { return Xor(Xor(Shr<1>(x), Shl<2>(x)), Xor(Rotl<13>(x), Rotl<43>(x))); }
+__m256i inline S2(__m256i x) { return Xor(Xor(Shr<2>(x), Shl<1>(x)), Xor(Rotl<19>(x), Rotl<53>(x))); }
+__m256i inline S3(__m256i x) { return Xor(Xor(Shr<2>(x), Shl<2>(x)), Xor(Rotl<28>(x), Rotl<59>(x))); }
+__m256i inline S4(__m256i x) { return Xor(Shr<1>(x), x); }
+__m256i inline S5(__m256i x) { return Xor(Shr<2>(x), x); }
+
+__m256i inline S(int n, __m256i x)
+{
+    switch (n) {
+        case 0: return S0(x);
+        case 1: return S1(x);
+        case 2: return S2(x);
+        case 3: return S3(x);
+        default: return S4(x);
+    }
+}
+
+__m256i inline RotlVar(__m256i x, int n)
+{
+    return Or(_mm256_sll_epi64(x, _mm_cvtsi32_si128(n)), _mm256_srl_epi64(x, _mm_cvtsi32_si128(64 - n)));
+}
+
+/** The compression function of BMW-512, which returns the new chaining value in `dh`. */
+void inline Compress(const __m256i m[16], const __m256i h[16], __m256i dh[16])
+{
+    __m256i mh[16];
+    __m256i rm[16];
+    for (int i = 0; i < 16; ++i) {
+        mh[i] = Xor(m[i], h[i]);
+        rm[i] = RotlVar(m[i], i + 1);
+    }
+
+    // f0: the first 16 words of the quadruple pipe
+    __m256i q[32];
+    for (int i = 0; i < 16; ++i) {
+        const int8_t* idx = W_IDX[i];
+        const int8_t* sign = W_SIGN[i];
+        __m256i w = mh[idx[0]];
+        for (int k = 0; k < 4; ++k) {
+            w = (sign[k] > 0) ? Add(w, mh[idx[k + 1]]) : Sub(w, mh[idx[k + 1]]);
+        }
+        q[i] = Add(S(i % 5, w), h[(i + 1) & 15]);
+    }
+
+    // f1: the expansion of the other 16 words
+    for (int i = 16; i < 32; ++i) {
+        int j = i - 16;
+        __m256i e = Xor(Sub(Add(Add(rm[j], rm[(j + 3) & 15]), K((uint64_t) i * 0x0555555555555555ull)), rm[(j + 10) & 15]), h[(j + 7) & 15]);
+        if (i < 18) {
+            for (int k = 0; k < 16; ++k) {
+                e = Add(e, S((k + 1) & 3, q[j + k]));
+            }
+        } else {
+            e = Add(e, Add(q[j], Rotl<5>(q[j + 1])));
+            e = Add(e, Add(q[j + 2], Rotl<11>(q[j + 3])));
+            e = Add(e, Add(q[j + 4], Rotl<27>(q[j + 5])));
+            e = Add(e, Add(q[j + 6], Rotr<32>(q[j + 7])));
+            e = Add(e, Add(q[j + 8], Rotl<37>(q[j + 9])));
+            e = Add(e, Add(q[j + 10], Rotl<43>(q[j + 11])));
+            e = Add(e, Add(q[j + 12], Rotl<53>(q[j + 13])));
+            e = Add(e, Add(S4(q[j + 14]), S5(q[j + 15])));
+        }
+        q[i] = e;
+    }
+
+    // f2: the folding into the new chaining value
+    __m256i xl = Xor(Xor(Xor(q[16], q[17]), Xor(q[18], q[19])), Xor(Xor(q[20], q[21]), Xor(q[22], q[23])));
+    __m256i xh = Xor(xl, Xor(Xor(Xor(q[24], q[25]), Xor(q[26], q[27])), Xor(Xor(q[28], q[29]), Xor(q[30], q[31]))));
+    dh[0] = Add(Xor(Xor(Shl<5>(xh), Shr<5>(q[16])), m[0]), Xor(Xor(xl, q[24]), q[0]));
+    dh[1] = Add(Xor(Xor(Shr<7>(xh), Shl<8>(q[17])), m[1]), Xor(Xor(xl, q[25]), q[1]));
+    dh[2] = Add(Xor(Xor(Shr<5>(xh), Shl<5>(q[18])), m[2]), Xor(Xor(xl, q[26]), q[2]));
+    dh[3] = Add(Xor(Xor(Shr<1>(xh), Shl<5>(q[19])), m[3]), Xor(Xor(xl, q[27]), q[3]));
+    dh[4] = Add(Xor(Xor(Shr<3>(xh), q[20]), m[4]), Xor(Xor(xl, q[28]), q[4]));
+    dh[5] = Add(Xor(Xor(Shl<6>(xh), Shr<6>(q[21])), m[5]), Xor(Xor(xl, q[29]), q[5]));
+    dh[6] = Add(Xor(Xor(Shr<4>(xh), Shl<6>(q[22])), m[6]), Xor(Xor(xl, q[30]), q[6]));
+    dh[7] = Add(Xor(Xor(Shr<11>(xh), Shl<2>(q[23])), m[7]), Xor(Xor(xl, q[31]), q[7]));
+    dh[8] = Add(Add(Rotl<9>(dh[4]), Xor(Xor(xh, q[24]), m[8])), Xor(Xor(Shl<8>(xl), q[23]), q[8]));
+    dh[9] = Add(Add(Rotl<10>(dh[5]), Xor(Xor(xh, q[25]), m[9])), Xor(Xor(Shr<6>(xl), q[16]), q[9]));
+    dh[10] = Add(Add(Rotl<11>(dh[6]), Xor(Xor(xh, q[26]), m[10])), Xor(Xor(Shl<6>(xl), q[17]), q[10]));
+    dh[11] = Add(Add(Rotl<12>(dh[7]), Xor(Xor(xh, q[27]), m[11])), Xor(Xor(Shl<4>(xl), q[18]), q[11]));
+    dh[12] = Add(Add(Rotl<13>(dh[0]), Xor(Xor(xh, q[28]), m[12])), Xor(Xor(Shr<3>(xl), q[19]), q[12]));
+    dh[13] = Add(Add(Rotl<14>(dh[1]), Xor(Xor(xh, q[29]), m[13])), Xor(Xor(Shr<4>(xl), q[20]), q[13]));
+    dh[14] = Add(Add(Rotl<15>(dh[2]), Xor(Xor(xh, q[30]), m[14])), Xor(Xor(Shr<7>(xl), q[21]), q[14]));
+    dh[15] = Add(Add(Rotl<16>(dh[3]), Xor(Xor(xh, q[31]), m[15])), Xor(Xor(Shr<2>(xl), q[22]), q[15]));
+}
+} // namespace bmw
+
+namespace keccak
+{
+const uint64_t RC[24] = {
+    0x0000000000000001ull, 0x0000000000008082ull, 0x800000000000808Aull, 0x8000000080008000ull,
+    0x000000000000808Bull, 0x0000000080000001ull, 0x8000000080008081ull, 0x8000000000008009ull,
+    0x000000000000008Aull, 0x0000000000000088ull, 0x0000000080008009ull, 0x000000008000000Aull,
+    0x000000008000808Bull, 0x800000000000008Bull, 0x8000000000008089ull, 0x8000000000008003ull,
+    0x8000000000008002ull, 0x8000000000000080ull, 0x000000000000800Aull, 0x800000008000000Aull,
+    0x8000000080008081ull, 0x8000000000008080ull, 0x0000000080000001ull, 0x8000000080008008ull
+};
+
+/** The Keccak-f[1600] permutation, with lane (x, y) in A[x + 5 * y]. */
+void inline Permute(__m256i A[25])
+{
+    __m256i B[25];
+    __m256i C[5];
+    __m256i D[5];
+
+    for (int round = 0; round < 24; ++round) {
+        // Theta
+        for (int x = 0; x < 5; ++x) {
+            C[x] = Xor(Xor(Xor(A[x], A[x + 5]), Xor(A[x + 10], A[x + 15])), A[x + 20]);
+        }
+        for (int x = 0; x < 5; ++x) {
+            D[x] = Xor(C[(x + 4) % 5], Rotl<1>(C[(x + 1) % 5]));
+        }
+        for (int i = 0; i < 25; ++i) {
+            A[i] = Xor(A[i], D[i % 5]);
+        }
+        // Rho and pi
+        B[0] = A[0];
+        B[1] = Rotl<44>(A[6]);
+        B[2] = Rotl<43>(A[12]);
+        B[3] = Rotl<21>(A[18]);
+        B[4] = Rotl<14>(A[24]);
+        B[5] = Rotl<28>(A[3]);
+        B[6] = Rotl<20>(A[9]);
+        B[7] = Rotl<3>(A[10]);
+        B[8] = Rotl<45>(A[16]);
+        B[9] = Rotl<61>(A[22]);
+        B[10] = Rotl<1>(A[1]);
+        B[11] = Rotl<6>(A[7]);
+        B[12] = Rotl<25>(A[13]);
+        B[13] = Rotl<8>(A[19]);
+        B[14] = Rotl<18>(A[20]);
+        B[15] = Rotl<27>(A[4]);
+        B[16] = Rotl<36>(A[5]);
+        B[17] = Rotl<10>(A[11]);
+        B[18] = Rotl<15>(A[17]);
+        B[19] = Rotl<56>(A[23]);
+        B[20] = Rotl<62>(A[2]);
+        B[21] = Rotl<55>(A[8]);
+        B[22] = Rotl<39>(A[14]);
+        B[23] = Rotl<41>(A[15]);
+        B[24] = Rotl<2>(A[21]);
+        // Chi
+        for (int y = 0; y < 25; y += 5) {
+            for (int x = 0; x < 5; ++x) {
+                A[y + x] = Xor(B[y + x], AndNot(B[y + (x + 1) % 5], B[y + (x + 2) % 5]));
+            }
+        }
+        // Iota
+        A[0] = Xor(A[0], K(RC[round]));
+    }
+}
+} // namespace keccak
+
+namespace skein
+{
+const uint64_t IV[8] = {
+    0x4903ADFF749C51CEull, 0x0D95DE399746DF03ull, 0x8FD1934127C79BCEull, 0x9A255629FF352CB1ull,
+    0x5DB62599DF6CA7B0ull, 0xEABE394CA9D5C3F4ull, 0x991112C71A75B523ull, 0xAE18A40B660FCC33ull
+};
+
+//! Tweak of the single, final message block and the output block
+const uint64_t T1_MSG = 0xF000000000000000ull;
+const uint64_t T1_OUT = 0xFF00000000000000ull;
+
+/** One round of Threefish-512, which mixes the words, and permutes them implicitly. */
+template <int r0, int r1, int r2, int r3>
+void inline Round(__m256i& x0, __m256i& x1, __m256i& x2, __m256i& x3, __m256i& x4, __m256i& x5, __m256i& x6, __m256i& x7)
+{
+    x0 = Add(x0, x1); x1 = Xor(Rotl<r0>(x1), x0);
+    x2 = Add(x2, x3); x3 = Xor(Rotl<r1>(x3), x2);
+    x4 = Add(x4, x5); x5 = Xor(Rotl<r2>(x5), x4);
+    x6 = Add(x6, x7); x7 = Xor(Rotl<r3>(x7), x6);
+}
+
+/** Adds the subkey s to the words. */
+void inline Inject(__m256i x[8], const __m256i k[9], const uint64_t t[3], int s)
+{
+    for (int i = 0; i < 8; ++i) {
+        x[i] = Add(x[i], k[(s + i) % 9]);
+    }
+    x[5] = Add(x[5], K(t[s % 3]));
+    x[6] = Add(x[6], K(t[(s + 1) % 3]));
+    x[7] = Add(x[7], K(s));
+}
+
+/** Threefish-512 encryption of the block `x` with key `key` and tweak (t0, t1). */
+void inline Threefish(__m256i x[8], const __m256i key[8], uint64_t t0, uint64_t t1)
+{
+    __m256i k[9];
+    k[8] = K(0x1BD11BDAA9FC1A22ull);
+    for (int i = 0; i < 8; ++i) {
+        k[i] = key[i];
+        k[8] = Xor(k[8], key[i]);
+    }
+    const uint64_t t[3] = { t0, t1, t0 ^ t1 };
+
+    // The word permutation 2, 1, 4, 7, 6, 5, 0, 3 after every round is
+    // applied by renaming the arguments of the next rounds.
+    for (int s = 0; s < 18; s += 2) {
+        Inject(x, k, t, s);
+        Round<46, 36, 19, 37>(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]);
+        Round<33, 27, 14, 42>(x[2], x[1], x[4], x[7], x[6], x[5], x[0], x[3]);
+        Round<17, 49, 36, 39>(x[4], x[1], x[6], x[3], x[0], x[5], x[2], x[7]);
+        Round<44,  9, 54, 56>(x[6], x[1], x[0], x[7], x[2], x[5], x[4], x[3]);
+        Inject(x, k, t, s + 1);
+        Round<39, 30, 34, 24>(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]);
+        Round<13, 50, 10, 17>(x[2], x[1], x[4], x[7], x[6], x[5], x[0], x[3]);
+        Round<25, 29, 39, 43>(x[4], x[1], x[6], x[3], x[0], x[5], x[2], x[7]);
+        Round< 8, 35, 56, 22>(x[6], x[1], x[0], x[7], x[2], x[5], x[4], x[3]);
+    }
+    Inject(x, k, t, 18);
+}
+} // namespace skein
+
+namespace jh
+{
+//! Round constants in the little-endian bitslice representation of sph_jh
+const uint64_t C[168] = {
+    0x67F815DFA2DED572ull, 0x571523B70A15847Bull, 0xF6875A4D90D6AB81ull, 0x402BD1C3C54F9F4Eull,
+    0x9CFA455CE03A98EAull, 0x9A99B26699D2C503ull, 0x8A53BBF2B4960266ull, 0x31A2DB881A1456B5ull,
+    0xDB0E199A5C5AA303ull, 0x1044C1870AB23F40ull, 0x1D959E848019051Cull, 0xDCCDE75EADEB336Full,
+    0x416BBF029213BA10ull, 0xD027BBF7156578DCull, 0x5078AA3739812C0Aull, 0xD3910041D2BF1A3Full,
+    0x907ECCF60D5A2D42ull, 0xCE97C0929C9F62DDull, 0xAC442BC70BA75C18ull, 0x23FCC663D665DFD1ull,
+    0x1AB8E09E036C6E97ull, 0xA8EC6C447E450521ull, 0xFA618E5DBB03F1EEull, 0x97818394B29796FDull,
+    0x2F3003DB37858E4Aull, 0x956A9FFB2D8D672Aull, 0x6C69B8F88173FE8Aull, 0x14427FC04672C78Aull,
+    0xC45EC7BD8F15F4C5ull, 0x80BB118FA76F4475ull, 0xBC88E4AEB775DE52ull, 0xF4A3A6981E00B882ull,
+    0x1563A3A9338FF48Eull, 0x89F9B7D524565FAAull, 0xFDE05A7C20EDF1B6ull, 0x362C42065AE9CA36ull,
+    0x3D98FE4E433529CEull, 0xA74B9A7374F93A53ull, 0x86814E6F591FF5D0ull, 0x9F5AD8AF81AD9D0Eull,
+    0x6A6234EE670605A7ull, 0x2717B96EBE280B8Bull, 0x3F1080C626077447ull, 0x7B487EC66F7EA0E0ull,
+    0xC0A4F84AA50A550Dull, 0x9EF18E979FE7E391ull, 0xD48D605081727686ull, 0x62B0E5F3415A9E7Eull,
+    0x7A205440EC1F9FFCull, 0x84C9F4CE001AE4E3ull, 0xD895FA9DF594D74Full, 0xA554C324117E2E55ull,
+    0x286EFEBD2872DF5Bull, 0xB2C4A50FE27FF578ull, 0x2ED349EEEF7C8905ull, 0x7F5928EB85937E44ull,
+    0x4A3124B337695F70ull, 0x65E4D61DF128865Eull, 0xE720B95104771BC7ull, 0x8A87D423E843FE74ull,
+    0xF2947692A3E8297Dull, 0xC1D9309B097ACBDDull, 0xE01BDC5BFB301B1Dull, 0xBF829CF24F4924DAull,
+    0xFFBF70B431BAE7A4ull, 0x48BCF8DE0544320Dull, 0x39D3BB5332FCAE3Bull, 0xA08B29E0C1C39F45ull,
+    0x0F09AEF7FD05C9E5ull, 0x34F1904212347094ull, 0x95ED44E301B771A2ull, 0x4A982F4F368E3BE9ull,
+    0x15F66CA0631D4088ull, 0xFFAF52874B44C147ull, 0x30C60AE2F14ABB7Eull, 0xE68C6ECCC5B67046ull,
+    0x00CA4FBD56A4D5A4ull, 0xAE183EC84B849DDAull, 0xADD1643045CE5773ull, 0x67255C1468CEA6E8ull,
+    0x16E10ECBF28CDAA3ull, 0x9A99949A5806E933ull, 0x7B846FC220B2601Full, 0x1885D1A07FACCED1ull,
+    0xD319DD8DA15B5932ull, 0x46B4A5AAC01C9A50ull, 0xBA6B04E467633D9Full, 0x7EEE560BAB19CAF6ull,
+    0x742128A9EA79B11Full, 0xEE51363B35F7BDE9ull, 0x76D350755AAC571Dull, 0x01707DA3FEC2463Aull,
+    0x42D8A498AFC135F7ull, 0x79676B9E20ECED78ull, 0xA8DB3AEA15638341ull, 0x832C83324D3BC3FAull,
+    0xF347271C1F3B40A7ull, 0x9A762DB734F04059ull, 0xFD4F21D26C4E3EE7ull, 0xEF5957DC398DFDB8ull,
+    0xDAEB492B490C9B8Dull, 0x0D70F36849D7A25Bull, 0x84558D7AD0AE3B7Dull, 0x658EF8E4F0E9A5F5ull,
+    0x533B1036F4A2B8A0ull, 0x5AEC3E759E07A80Cull, 0x4F88E85692946891ull, 0x4CBCBAF8555CB05Bull,
+    0x7B9487F3993BBBE3ull, 0x5D1C6B72D6F4DA75ull, 0x6DB334DC28ACAE64ull, 0x71DB28B850A5346Cull,
+    0x2A518D10F2E261F8ull, 0xFC75DD593364DBE3ull, 0xA23FCE43F1BCAC1Cull, 0xB043E8023CD1BB67ull,
+    0x75A12988CA5B0A33ull, 0x5C5316B44D19347Full, 0x1E4D790EC3943B92ull, 0x3FAFEEB6D7757479ull,
+    0x21391ABEF7D4A8EAull, 0x5127234C097EF45Cull, 0xD23C32BA5324A326ull, 0xADD5A66D4A17A344ull,
+    0x08C9F2AFA63E1DB5ull, 0x563C6B91983D5983ull, 0x4D608672A17CF84Cull, 0xF6C76E08CC3EE246ull,
+    0x5E76BCB1B333982Full, 0x2AE6C4EFA566D62Bull, 0x36D4C1BEE8B6F406ull, 0x6321EFBC1582EE74ull,
+    0x69C953F40D4EC1FDull, 0x26585806C45A7DA7ull, 0x16FAE0061614C17Eull, 0x3F9D63283DAF907Eull,
+    0x0CD29B00E3F2C9D2ull, 0x300CD4B730CEAA5Full, 0x9832E0F216512A74ull, 0x9AF8CEE3D830EB0Dull,
+    0x9279F1B57B9EC54Bull, 0xD36886046EE651FFull, 0x316796E6574D239Bull, 0x05750A17F3A6E6CCull,
+    0xCE6C3213D98176B1ull, 0x62A205F88452173Cull, 0x47154778B3CB2BF4ull, 0x486A9323825446FFull,
+    0x65655E4E0758DF38ull, 0x8E5086FC897CFCF2ull, 0x86CA0BD0442E7031ull, 0x4E477830A20940F0ull,
+    0x8338F7D139EEA065ull, 0xBD3A2CE437E95EF7ull, 0x6FF8130126B29721ull, 0xE7DE9FEFD1ED44A3ull,
+    0xD992257615DFA08Bull, 0xBE42DC12F6F7853Cull, 0x7EB027AB7CECA7D8ull, 0xDEA83EAADA7D8D53ull,
+    0xD86902BD93CE25AAull, 0xF908731AFD43F65Aull, 0xA5194A17DAEF5FC0ull, 0x6A21FD4C33664D97ull,
+    0x701541DB3198B435ull, 0x9B54CDEDBB0F1EEAull, 0x72409751A163D09Aull, 0xE26F4791BF9D75F6ull
+};
+
+const uint64_t IV[16] = {
+    0x17AA003E964BD16Full, 0x43D5157A052E6A63ull, 0x0BEF970C8D5E228Aull, 0x61C3B3F2591234E9ull,
+    0x1E806F53C1A01D89ull, 0x806D2BEA6B05A92Aull, 0xA6BA7520DBCC8E58ull, 0xF73BF8BA763A0FA9ull,
+    0x694AE34105E66901ull, 0x5AE66F2E8E8AB546ull, 0x243C84C1D0A74710ull, 0x99C15A2DB1716E3Bull,
+    0x56F8B19DECF657CFull, 0x56B116577C8806A7ull, 0xFB1785E6DFFCC2E3ull, 0x4BDD8CCC78465A54ull
+};
+
+/** The bitsliced S-boxes, with the round constant `c`. */
+void inline Sb(__m256i& x0, __m256i& x1, __m256i& x2, __m256i& x3, __m256i c)
+{
+    x3 = Not(x3);
+    x0 = Xor(x0, AndNot(x2, c));
+    __m256i tmp = Xor(c, And(x0, x1));
+    x0 = Xor(x0, And(x2, x3));
+    x3 = Xor(x3, AndNot(x1, x2));
+    x1 = Xor(x1, And(x0, x2));
+    x2 = Xor(x2, AndNot(x3, x0));
+    x0 = Xor(x0, Or(x1, x3));
+    x3 = Xor(x3, And(x1, x2));
+    x1 = Xor(x1, And(tmp, x0));
+    x2 = Xor(x2, tmp);
+}
+
+/** The linear transformation. */
+void inline Lb(__m256i& x0, __m256i& x1, __m256i& x2, __m256i& x3, __m256i& x4, __m256i& x5, __m256i& x6, __m256i& x7)
+{
+    x4 = Xor(x4, x1);
+    x5 = Xor(x5, x2);
+    x6 = Xor(x6, Xor(x3, x0));
+    x7 = Xor(x7, x0);
+    x0 = Xor(x0, x5);
+    x1 = Xor(x1, x6);
+    x2 = Xor(x2, Xor(x7, x4));
+    x3 = Xor(x3, x4);
+}
+
+/** Swaps the adjacent groups of n bits, which are selected by the mask `c`. */
+template <int n>
+void inline Wz(__m256i& x, uint64_t c)
+{
+    __m256i m = K(c);
+    x = Or(And(Shr<n>(x), m), Shl<n>(And(x, m)));
+}
+
+/** The permutation of round ro of seven, applied to both halves of a word. */
+template <int ro>
+void inline W(__m256i& h, __m256i& l)
+{
+    switch (ro) {
+        case 0: Wz<1>(h, 0x5555555555555555ull); Wz<1>(l, 0x5555555555555555ull); break;
+        case 1: Wz<2>(h, 0x3333333333333333ull); Wz<2>(l, 0x3333333333333333ull); break;
+        case 2: Wz<4>(h, 0x0F0F0F0F0F0F0F0Full); Wz<4>(l, 0x0F0F0F0F0F0F0F0Full); break;
+        case 3: Wz<8>(h, 0x00FF00FF00FF00FFull); Wz<8>(l, 0x00FF00FF00FF00FFull); break;
+        case 4: Wz<16>(h, 0x0000FFFF0000FFFFull); Wz<16>(l, 0x0000FFFF0000FFFFull); break;
+        case 5: Wz<32>(h, 0x00000000FFFFFFFFull); Wz<32>(l, 0x00000000FFFFFFFFull); break;
+        case 6: std::swap(h, l); break;
+    }
+}
+
+/** One round of E8 on the state of 8 words, each split into the halves h[2 * i] and h[2 * i + 1]. */
+template <int ro>
+void inline SL(__m256i h[16], int r)
+{
+    Sb(h[0], h[4], h[8], h[12], K(C[4 * r + 0]));
+    Sb(h[1], h[5], h[9], h[13], K(C[4 * r + 1]));
+    Sb(h[2], h[6], h[10], h[14], K(C[4 * r + 2]));
+    Sb(h[3], h[7], h[11], h[15], K(C[4 * r + 3]));
+    Lb(h[0], h[4], h[8], h[12], h[2], h[6], h[10], h[14]);
+    Lb(h[1], h[5], h[9], h[13], h[3], h[7], h[11], h[15]);
+    W<ro>(h[2], h[3]);
+    W<ro>(h[6], h[7]);
+    W<ro>(h[10], h[11]);
+    W<ro>(h[14], h[15]);
+}
+
+/** The compression function F8 with the message block `m` of 8 words. */
+void inline Compress(__m256i h[16], const __m256i m[8])
+{
+    for (int i = 0; i < 8; ++i) {
+        h[i] = Xor(h[i], m[i]);
+    }
+    for (int r = 0; r < 42; r += 7) {
+        SL<0>(h, r);
+        SL<1>(h, r + 1);
+        SL<2>(h, r + 2);
+        SL<3>(h, r + 3);
+        SL<4>(h, r + 4);
+        SL<5>(h, r + 5);
+        SL<6>(h, r + 6);
+    }
+    for (int i = 0; i < 8; ++i) {
+        h[i + 8] = Xor(h[i + 8], m[i]);
+    }
+}
+} // namespace jh
+} // namespace
+
+void Blake512(unsigned char* out[4], const unsigned char* const in[4], size_t len)
+{
+    assert(len <= 111);
+
+    uint64_t w[16][4];
+    for (int lane = 0; lane < 4; ++lane) {
+        unsigned char block[128] = {0};
+        memcpy(block, in[lane], len);
+        block[len] = 0x80;
+        block[111] |= 0x01;
+        WriteBE64(block + 120, len * 8);
+        for (int i = 0; i < 16; ++i) {
+            w[i][lane] = ReadBE64(block + 8 * i);
+        }
+    }
+
+    __m256i m[16];
+    for (int i = 0; i < 16; ++i) {
+        m[i] = Load(w[i]);
+    }
+
+    __m256i v[16];
+    for (int i = 0; i < 8; ++i) {
+        v[i] = K(blake::IV[i]);
+    }
+    v[8] = K(blake::C[0]);
+    v[9] = K(blake::C[1]);
+    v[10] = K(blake::C[2]);
+    v[11] = K(blake::C[3]);
+    v[12] = K(blake::C[4] ^ (len * 8));
+    v[13] = K(blake::C[5] ^ (len * 8));
+    v[14] = K(blake::C[6]);
+    v[15] = K(blake::C[7]);
+
+    for (int round = 0; round < 16; ++round) {
+        const uint8_t* s = blake::SIGMA[round % 10];
+        blake::G(v[0], v[4], v[8], v[12], m, s, 0);
+        blake::G(v[1], v[5], v[9], v[13], m, s, 1);
+        blake::G(v[2], v[6], v[10], v[14], m, s, 2);
+        blake::G(v[3], v[7], v[11], v[15], m, s, 3);
+        blake::G(v[0], v[5], v[10], v[15], m, s, 4);
+        blake::G(v[1], v[6], v[11], v[12], m, s, 5);
+        blake::G(v[2], v[7], v[8], v[13], m, s, 6);
+        blake::G(v[3], v[4], v[9], v[14], m, s, 7);
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        Store(w[i], Xor(K(blake::IV[i]), Xor(v[i], v[i + 8])));
+    }
+    for (int lane = 0; lane < 4; ++lane) {
+        for (int i = 0; i < 8; ++i) {
+            WriteBE64(out[lane] + 8 * i, w[i][lane]);
+        }
+    }
+}
+
+void Bmw512(unsigned char* out[4], const unsigned char* const in[4], size_t len)
+{
+    assert(len <= 119);
+
+    uint64_t w[16][4];
+    for (int lane = 0; lane < 4; ++lane) {
+        unsigned char block[128] = {0};
+        memcpy(block, in[lane], len);
+        block[len] = 0x80;
+        WriteLE64(block + 120, len * 8);
+        for (int i = 0; i < 16; ++i) {
+            w[i][lane] = ReadLE64(block + 8 * i);
+        }
+    }
+
+    __m256i m[16];
+    __m256i h[16];
+    __m256i dh[16];
+    for (int i = 0; i < 16; ++i) {
+        m[i] = Load(w[i]);
+        h[i] = K(bmw::IV[i]);
+    }
+    bmw::Compress(m, h, dh);
+
+    // The final compression of the chaining value as message
+    for (int i = 0; i < 16; ++i) {
+        h[i] = K(bmw::FINAL[i]);
+    }
+    bmw::Compress(dh, h, m);
+
+    for (int i = 0; i < 8; ++i) {
+        Store(w[i], m[i + 8]);
+    }
+    for (int lane = 0; lane < 4; ++lane) {
+        for (int i = 0; i < 8; ++i) {
+            WriteLE64(out[lane] + 8 * i, w[i][lane]);
+        }
+    }
+}
+
+void Jh512(unsigned char* out[4], const unsigned char* const in[4], size_t len)
+{
+    assert(len == 64);
+
+    uint64_t w[16][4];
+    for (int lane = 0; lane < 4; ++lane) {
+        for (int i = 0; i < 8; ++i) {
+            w[i][lane] = ReadLE64(in[lane] + 8 * i);
+        }
+    }
+
+    __m256i h[16];
+    __m256i m[8];
+    for (int i = 0; i < 16; ++i) {
+        h[i] = K(jh::IV[i]);
+    }
+    for (int i = 0; i < 8; ++i) {
+        m[i] = Load(w[i]);
+    }
+    jh::Compress(h, m);
+
+    // The padding block: a single set bit, and the length of 512 bits as 128-bit big endian number
+    unsigned char pad[64] = {0x80};
+    WriteBE64(pad + 56, 512);
+    for (int i = 0; i < 8; ++i) {
+        m[i] = K(ReadLE64(pad + 8 * i));
+    }
+    jh::Compress(h, m);
+
+    for (int i = 0; i < 8; ++i) {
+        Store(w[i], h[i + 8]);
+    }
+    for (int lane = 0; lane < 4; ++lane) {
+        for (int i = 0; i < 8; ++i) {
+            WriteLE64(out[lane] + 8 * i, w[i][lane]);
+        }
+    }
+}
+
+void Keccak512(unsigned char* out[4], const unsigned char* const in[4], size_t len)
+{
+    assert(len < 72);
+
+    uint64_t w[25][4];
+    for (int lane = 0; lane < 4; ++lane) {
+        unsigned char block[72] = {0};
+        memcpy(block, in[lane], len);
+        block[len] ^= 0x01;
+        block[71] ^= 0x80;
+        for (int i = 0; i < 9; ++i) {
+            w[i][lane] = ReadLE64(block + 8 * i);
+        }
+    }
+
+    __m256i A[25];
+    for (int i = 0; i < 25; ++i) {
+        A[i] = (i < 9) ? Load(w[i]) : _mm256_setzero_si256();
+    }
+
+    keccak::Permute(A);
+
+    for (int i = 0; i < 8; ++i) {
+        Store(w[i], A[i]);
+    }
+    for (int lane = 0; lane < 4; ++lane) {
+        for (int i = 0; i < 8; ++i) {
+            WriteLE64(out[lane] + 8 * i, w[i][lane]);
+        }
+    }
+}
+
+void Skein512(unsigned char* out[4], const unsigned char* const in[4], size_t len)
+{
+    assert(0 < len && len <= 64);
+
+    uint64_t w[8][4];
+    for (int lane = 0; lane < 4; ++lane) {
+        unsigned char block[64] = {0};
+        memcpy(block, in[lane], len);
+        for (int i = 0; i < 8; ++i) {
+            w[i][lane] = ReadLE64(block + 8 * i);
+        }
+    }
+
+    __m256i h[8];
+    __m256i m[8];
+    __m256i x[8];
+    for (int i = 0; i < 8; ++i) {
+        h[i] = K(skein::IV[i]);
+        m[i] = Load(w[i]);
+        x[i] = m[i];
+    }
+
+    // Process the message block
+    skein::Threefish(x, h, len, skein::T1_MSG);
+    for (int i = 0; i < 8; ++i) {
+        h[i] = Xor(x[i], m[i]);
+        x[i] = _mm256_setzero_si256();
+    }
+
+    // Produce the output with a counter of zero
+    skein::Threefish(x, h, 8, skein::T1_OUT);
+
+    for (int i = 0; i < 8; ++i) {
+        Store(w[i], x[i]);
+    }
+    for (int lane = 0; lane < 4; ++lane) {
+        for (int i = 0; i < 8; ++i) {
+            WriteLE64(out[lane] + 8 * i, w[i][lane]);
+        }
+    }
+}
+}
+
+#endif // ENABLE_AVX2
@@ -6,8 +6,27 @@
 
 #include "crypto/common.h"
 
+#include <assert.h>
 #include <string.h>
 
+#if defined(ENABLE_SHANI) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace sha256_shani
+{
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
+}
+namespace sha256d64_shani
+{
+void Transform_2way(unsigned char* out, const unsigned char* in);
+}
+#endif
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace sha256d64_avx2
+{
+void Transform_8way(unsigned char* out, const unsigned char* in);
+}
+#endif
+
 // Internal implementation code.
 namespace
 {
@@ -43,9 +62,10 @@ void inline Initialize(uint32_t* s)
     s[7] = 0x5be0cd19ul;
 }
 
-/** Perform one SHA-256 transformation, processing a 64-byte chunk. */
-void Transform(uint32_t* s, const unsigned char* chunk)
+/** Perform a number of SHA-256 transformations, processing 64-byte chunks. */
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
 {
+    while (blocks--) {
     uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
     uint32_t w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
 
@@ -125,11 +145,137 @@ void Transform(uint32_t* s, const unsigned char* chunk)
     s[5] += f;
     s[6] += g;
     s[7] += h;
+    chunk += 64;
+    }
+}
+
+typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
+typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
+
+/** The padding block of a 64-byte message. */
+const unsigned char pad64[64] = {
+    0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02, 0x00
+};
+
+/** Compute the double-SHA256 of a 64-byte input with a given transformation. */
+template<TransformType tr>
+void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
+{
+    uint32_t s[8];
+    unsigned char buffer2[64] = {0};
+    Initialize(s);
+    tr(s, in, 1);
+    tr(s, pad64, 1);
+    for (int i = 0; i < 8; i++) {
+        WriteBE32(buffer2 + 4 * i, s[i]);
+    }
+    // The padding of the 32-byte first hash.
+    buffer2[32] = 0x80;
+    buffer2[62] = 0x01;
+    Initialize(s);
+    tr(s, buffer2, 1);
+    for (int i = 0; i < 8; i++) {
+        WriteBE32(out + 4 * i, s[i]);
+    }
 }
 
+#if (defined(__x86_64__) || defined(__amd64__) || defined(__i386__)) && defined(__GNUC__)
+void inline cpuid(uint32_t leaf, uint32_t subleaf, uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d)
+{
+    __asm__ ("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "0"(leaf), "2"(subleaf));
+}
+
+/** Checks whether the OS saves the AVX (YMM) registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__ ("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
 } // namespace sha256
+
+sha256::TransformType Transform = sha256::Transform;
+sha256::TransformD64Type TransformD64 = sha256::TransformD64Wrapper<sha256::Transform>;
+sha256::TransformD64Type TransformD64_2way = NULL;
+sha256::TransformD64Type TransformD64_8way = NULL;
+
+/** Check the selected implementations against the generic code. */
+bool SelfTest()
+{
+    static const size_t nBlocks = 19;
+    unsigned char data[64 * nBlocks];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (unsigned char)(i * 7 + (i >> 6) * 13 + 1);
+    }
+
+    // Multi-block transformation
+    uint32_t s1[8], s2[8];
+    sha256::Initialize(s1);
+    sha256::Initialize(s2);
+    Transform(s1, data, nBlocks);
+    sha256::Transform(s2, data, nBlocks);
+    if (memcmp(s1, s2, sizeof(s1)) != 0) return false;
+
+    // Batched double-SHA256 of 64-byte inputs, which uses all of the multi-way code
+    unsigned char out1[32 * nBlocks], out2[32 * nBlocks];
+    SHA256D64(out1, data, nBlocks);
+    for (size_t i = 0; i < nBlocks; i++) {
+        sha256::TransformD64Wrapper<sha256::Transform>(out2 + 32 * i, data + 64 * i);
+    }
+    return memcmp(out1, out2, sizeof(out1)) == 0;
+}
 } // namespace
 
+std::string SHA256AutoDetect()
+{
+    std::string ret = "standard";
+    Transform = sha256::Transform;
+    TransformD64 = sha256::TransformD64Wrapper<sha256::Transform>;
+    TransformD64_2way = NULL;
+    TransformD64_8way = NULL;
+#if (defined(__x86_64__) || defined(__amd64__) || defined(__i386__)) && defined(__GNUC__) && !defined(BUILD_BITCOIN_INTERNAL)
+    uint32_t eax, ebx, ecx, edx;
+    sha256::cpuid(0, 0, eax, ebx, ecx, edx);
+    uint32_t nMaxLeaf = eax;
+    sha256::cpuid(1, 0, eax, ebx, ecx, edx);
+    bool fSSE41 = (ecx >> 19) & 1;
+    bool fAVX = ((ecx >> 27) & 1) && ((ecx >> 28) & 1) && sha256::AVXEnabled();
+    bool fAVX2 = false, fSHANI = false;
+    if (nMaxLeaf >= 7) {
+        sha256::cpuid(7, 0, eax, ebx, ecx, edx);
+        fAVX2 = fAVX && ((ebx >> 5) & 1);
+        fSHANI = fSSE41 && ((ebx >> 29) & 1);
+    }
+
+#if defined(ENABLE_SHANI)
+    if (fSHANI) {
+        // The SHA extensions are faster than the AVX2 code, even with 8 lanes
+        Transform = sha256_shani::Transform;
+        TransformD64 = sha256::TransformD64Wrapper<sha256_shani::Transform>;
+        TransformD64_2way = sha256d64_shani::Transform_2way;
+        ret = "shani(1way,2way)";
+        fAVX2 = false;
+    }
+#endif
+
+#if defined(ENABLE_AVX2)
+    if (fAVX2) {
+        TransformD64_8way = sha256d64_avx2::Transform_8way;
+        ret += ",avx2(8way)";
+    }
+#endif
+    (void)fAVX2;
+    (void)fSHANI;
+#endif
+
+    assert(SelfTest());
+    return ret;
+}
+
 
 ////// SHA-256
 
@@ -147,14 +293,15 @@ CSHA256& CSHA256::Write(const unsigned char* data, size_t len)
         memcpy(buf + bufsize, data, 64 - bufsize);
         bytes += 64 - bufsize;
         data += 64 - bufsize;
-        sha256::Transform(s, buf);
+        Transform(s, buf, 1);
         bufsize = 0;
     }
-    while (end >= data + 64) {
+    if (end - data >= 64) {
         // Process full chunks directly from the source.
-        sha256::Transform(s, data);
-        bytes += 64;
-        data += 64;
+        size_t blocks = (end - data) / 64;
+        Transform(s, data, blocks);
+        data += 64 * blocks;
+        bytes += 64 * blocks;
     }
     if (end > data) {
         // Fill the buffer with what remains.
@@ -187,3 +334,29 @@ CSHA256& CSHA256::Reset()
     sha256::Initialize(s);
     return *this;
 }
+
+void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
+{
+    if (TransformD64_8way) {
+        while (blocks >= 8) {
+            TransformD64_8way(out, in);
+            out += 256;
+            in += 512;
+            blocks -= 8;
+        }
+    }
+    if (TransformD64_2way) {
+        while (blocks >= 2) {
+            TransformD64_2way(out, in);
+            out += 64;
+            in += 128;
+            blocks -= 2;
+        }
+    }
+    while (blocks) {
+        TransformD64(out, in);
+        out += 32;
+        in += 64;
+        --blocks;
+    }
+}
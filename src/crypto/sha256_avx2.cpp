@@ -0,0 +1,214 @@
+// Copyright (c) 2014 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// This is an 8-way implementation of the double-SHA256 of 64-byte inputs,
+// which keeps one input in each 32-bit lane of the AVX2 registers.
+
+#ifdef ENABLE_AVX2
+
+#include "crypto/common.h"
+
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace sha256d64_avx2
+{
+namespace
+{
+__m256i inline K(uint32_t x) { return _mm256_set1_epi32(x); }
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z) { return Add(Add(x, y), z); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z, __m256i w) { return Add(Add(x, y), Add(z, w)); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z, __m256i w, __m256i v) { return Add(Add(x, y, z), Add(w, v)); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Xor(__m256i x, __m256i y, __m256i z) { return Xor(Xor(x, y), z); }
+__m256i inline Or(__m256i x, __m256i y) { return _mm256_or_si256(x, y); }
+__m256i inline And(__m256i x, __m256i y) { return _mm256_and_si256(x, y); }
+template <int n> __m256i inline ShR(__m256i x) { return _mm256_srli_epi32(x, n); }
+template <int n> __m256i inline ShL(__m256i x) { return _mm256_slli_epi32(x, n); }
+template <int n> __m256i inline RotR(__m256i x) { return Or(ShR<n>(x), ShL<32 - n>(x)); }
+
+__m256i inline Ch(__m256i x, __m256i y, __m256i z) { return Xor(z, And(x, Xor(y, z))); }
+__m256i inline Maj(__m256i x, __m256i y, __m256i z) { return Or(And(x, y), And(z, Or(x, y))); }
+__m256i inline Sigma0(__m256i x) { return Xor(RotR<2>(x), RotR<13>(x), RotR<22>(x)); }
+__m256i inline Sigma1(__m256i x) { return Xor(RotR<6>(x), RotR<11>(x), RotR<25>(x)); }
+__m256i inline sigma0(__m256i x) { return Xor(RotR<7>(x), RotR<18>(x), ShR<3>(x)); }
+__m256i inline sigma1(__m256i x) { return Xor(RotR<17>(x), RotR<19>(x), ShR<10>(x)); }
+
+/** One round of SHA-256. */
+void inline __attribute__((always_inline)) Round(__m256i a, __m256i b, __m256i c, __m256i& d, __m256i e, __m256i f, __m256i g, __m256i& h, __m256i k, __m256i w)
+{
+    __m256i t1 = Add(h, Sigma1(e), Ch(e, f, g), k, w);
+    __m256i t2 = Add(Sigma0(a), Maj(a, b, c));
+    d = Add(d, t1);
+    h = Add(t1, t2);
+}
+
+/** Reads the big endian word at offset of each of the eight inputs. */
+__m256i inline Read8(const unsigned char* chunk, int offset)
+{
+    __m256i ret = _mm256_set_epi32(
+        ReadLE32(chunk + 448 + offset),
+        ReadLE32(chunk + 384 + offset),
+        ReadLE32(chunk + 320 + offset),
+        ReadLE32(chunk + 256 + offset),
+        ReadLE32(chunk + 192 + offset),
+        ReadLE32(chunk + 128 + offset),
+        ReadLE32(chunk + 64 + offset),
+        ReadLE32(chunk + 0 + offset)
+    );
+    return _mm256_shuffle_epi8(ret, _mm256_set_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203, 0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203));
+}
+
+/** Writes the word of each lane as big endian to the 32-byte outputs at offset. */
+void inline Write8(unsigned char* out, int offset, __m256i v)
+{
+    v = _mm256_shuffle_epi8(v, _mm256_set_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203, 0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203));
+    WriteLE32(out + 0 + offset, _mm256_extract_epi32(v, 0));
+    WriteLE32(out + 32 + offset, _mm256_extract_epi32(v, 1));
+    WriteLE32(out + 64 + offset, _mm256_extract_epi32(v, 2));
+    WriteLE32(out + 96 + offset, _mm256_extract_epi32(v, 3));
+    WriteLE32(out + 128 + offset, _mm256_extract_epi32(v, 4));
+    WriteLE32(out + 160 + offset, _mm256_extract_epi32(v, 5));
+    WriteLE32(out + 192 + offset, _mm256_extract_epi32(v, 6));
+    WriteLE32(out + 224 + offset, _mm256_extract_epi32(v, 7));
+}
+
+/** Initialize the SHA-256 state of all lanes. */
+void inline Initialize(__m256i* s)
+{
+    s[0] = K(0x6a09e667ul);
+    s[1] = K(0xbb67ae85ul);
+    s[2] = K(0x3c6ef372ul);
+    s[3] = K(0xa54ff53aul);
+    s[4] = K(0x510e527ful);
+    s[5] = K(0x9b05688cul);
+    s[6] = K(0x1f83d9abul);
+    s[7] = K(0x5be0cd19ul);
+}
+
+/** Perform one SHA-256 transformation in each lane, processing the 16 message words in. */
+void Transform(__m256i* s, const __m256i* in)
+{
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    __m256i w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
+
+    Round(a, b, c, d, e, f, g, h, K(0x428a2f98), w0 = in[0]);
+    Round(h, a, b, c, d, e, f, g, K(0x71374491), w1 = in[1]);
+    Round(g, h, a, b, c, d, e, f, K(0xb5c0fbcf), w2 = in[2]);
+    Round(f, g, h, a, b, c, d, e, K(0xe9b5dba5), w3 = in[3]);
+    Round(e, f, g, h, a, b, c, d, K(0x3956c25b), w4 = in[4]);
+    Round(d, e, f, g, h, a, b, c, K(0x59f111f1), w5 = in[5]);
+    Round(c, d, e, f, g, h, a, b, K(0x923f82a4), w6 = in[6]);
+    Round(b, c, d, e, f, g, h, a, K(0xab1c5ed5), w7 = in[7]);
+    Round(a, b, c, d, e, f, g, h, K(0xd807aa98), w8 = in[8]);
+    Round(h, a, b, c, d, e, f, g, K(0x12835b01), w9 = in[9]);
+    Round(g, h, a, b, c, d, e, f, K(0x243185be), w10 = in[10]);
+    Round(f, g, h, a, b, c, d, e, K(0x550c7dc3), w11 = in[11]);
+    Round(e, f, g, h, a, b, c, d, K(0x72be5d74), w12 = in[12]);
+    Round(d, e, f, g, h, a, b, c, K(0x80deb1fe), w13 = in[13]);
+    Round(c, d, e, f, g, h, a, b, K(0x9bdc06a7), w14 = in[14]);
+    Round(b, c, d, e, f, g, h, a, K(0xc19bf174), w15 = in[15]);
+
+    Round(a, b, c, d, e, f, g, h, K(0xe49b69c1), w0 = Add(w0, sigma1(w14), w9, sigma0(w1)));
+    Round(h, a, b, c, d, e, f, g, K(0xefbe4786), w1 = Add(w1, sigma1(w15), w10, sigma0(w2)));
+    Round(g, h, a, b, c, d, e, f, K(0x0fc19dc6), w2 = Add(w2, sigma1(w0), w11, sigma0(w3)));
+    Round(f, g, h, a, b, c, d, e, K(0x240ca1cc), w3 = Add(w3, sigma1(w1), w12, sigma0(w4)));
+    Round(e, f, g, h, a, b, c, d, K(0x2de92c6f), w4 = Add(w4, sigma1(w2), w13, sigma0(w5)));
+    Round(d, e, f, g, h, a, b, c, K(0x4a7484aa), w5 = Add(w5, sigma1(w3), w14, sigma0(w6)));
+    Round(c, d, e, f, g, h, a, b, K(0x5cb0a9dc), w6 = Add(w6, sigma1(w4), w15, sigma0(w7)));
+    Round(b, c, d, e, f, g, h, a, K(0x76f988da), w7 = Add(w7, sigma1(w5), w0, sigma0(w8)));
+    Round(a, b, c, d, e, f, g, h, K(0x983e5152), w8 = Add(w8, sigma1(w6), w1, sigma0(w9)));
+    Round(h, a, b, c, d, e, f, g, K(0xa831c66d), w9 = Add(w9, sigma1(w7), w2, sigma0(w10)));
+    Round(g, h, a, b, c, d, e, f, K(0xb00327c8), w10 = Add(w10, sigma1(w8), w3, sigma0(w11)));
+    Round(f, g, h, a, b, c, d, e, K(0xbf597fc7), w11 = Add(w11, sigma1(w9), w4, sigma0(w12)));
+    Round(e, f, g, h, a, b, c, d, K(0xc6e00bf3), w12 = Add(w12, sigma1(w10), w5, sigma0(w13)));
+    Round(d, e, f, g, h, a, b, c, K(0xd5a79147), w13 = Add(w13, sigma1(w11), w6, sigma0(w14)));
+    Round(c, d, e, f, g, h, a, b, K(0x06ca6351), w14 = Add(w14, sigma1(w12), w7, sigma0(w15)));
+    Round(b, c, d, e, f, g, h, a, K(0x14292967), w15 = Add(w15, sigma1(w13), w8, sigma0(w0)));
+
+    Round(a, b, c, d, e, f, g, h, K(0x27b70a85), w0 = Add(w0, sigma1(w14), w9, sigma0(w1)));
+    Round(h, a, b, c, d, e, f, g, K(0x2e1b2138), w1 = Add(w1, sigma1(w15), w10, sigma0(w2)));
+    Round(g, h, a, b, c, d, e, f, K(0x4d2c6dfc), w2 = Add(w2, sigma1(w0), w11, sigma0(w3)));
+    Round(f, g, h, a, b, c, d, e, K(0x53380d13), w3 = Add(w3, sigma1(w1), w12, sigma0(w4)));
+    Round(e, f, g, h, a, b, c, d, K(0x650a7354), w4 = Add(w4, sigma1(w2), w13, sigma0(w5)));
+    Round(d, e, f, g, h, a, b, c, K(0x766a0abb), w5 = Add(w5, sigma1(w3), w14, sigma0(w6)));
+    Round(c, d, e, f, g, h, a, b, K(0x81c2c92e), w6 = Add(w6, sigma1(w4), w15, sigma0(w7)));
+    Round(b, c, d, e, f, g, h, a, K(0x92722c85), w7 = Add(w7, sigma1(w5), w0, sigma0(w8)));
+    Round(a, b, c, d, e, f, g, h, K(0xa2bfe8a1), w8 = Add(w8, sigma1(w6), w1, sigma0(w9)));
+    Round(h, a, b, c, d, e, f, g, K(0xa81a664b), w9 = Add(w9, sigma1(w7), w2, sigma0(w10)));
+    Round(g, h, a, b, c, d, e, f, K(0xc24b8b70), w10 = Add(w10, sigma1(w8), w3, sigma0(w11)));
+    Round(f, g, h, a, b, c, d, e, K(0xc76c51a3), w11 = Add(w11, sigma1(w9), w4, sigma0(w12)));
+    Round(e, f, g, h, a, b, c, d, K(0xd192e819), w12 = Add(w12, sigma1(w10), w5, sigma0(w13)));
+    Round(d, e, f, g, h, a, b, c, K(0xd6990624), w13 = Add(w13, sigma1(w11), w6, sigma0(w14)));
+    Round(c, d, e, f, g, h, a, b, K(0xf40e3585), w14 = Add(w14, sigma1(w12), w7, sigma0(w15)));
+    Round(b, c, d, e, f, g, h, a, K(0x106aa070), w15 = Add(w15, sigma1(w13), w8, sigma0(w0)));
+
+    Round(a, b, c, d, e, f, g, h, K(0x19a4c116), w0 = Add(w0, sigma1(w14), w9, sigma0(w1)));
+    Round(h, a, b, c, d, e, f, g, K(0x1e376c08), w1 = Add(w1, sigma1(w15), w10, sigma0(w2)));
+    Round(g, h, a, b, c, d, e, f, K(0x2748774c), w2 = Add(w2, sigma1(w0), w11, sigma0(w3)));
+    Round(f, g, h, a, b, c, d, e, K(0x34b0bcb5), w3 = Add(w3, sigma1(w1), w12, sigma0(w4)));
+    Round(e, f, g, h, a, b, c, d, K(0x391c0cb3), w4 = Add(w4, sigma1(w2), w13, sigma0(w5)));
+    Round(d, e, f, g, h, a, b, c, K(0x4ed8aa4a), w5 = Add(w5, sigma1(w3), w14, sigma0(w6)));
+    Round(c, d, e, f, g, h, a, b, K(0x5b9cca4f), w6 = Add(w6, sigma1(w4), w15, sigma0(w7)));
+    Round(b, c, d, e, f, g, h, a, K(0x682e6ff3), w7 = Add(w7, sigma1(w5), w0, sigma0(w8)));
+    Round(a, b, c, d, e, f, g, h, K(0x748f82ee), w8 = Add(w8, sigma1(w6), w1, sigma0(w9)));
+    Round(h, a, b, c, d, e, f, g, K(0x78a5636f), w9 = Add(w9, sigma1(w7), w2, sigma0(w10)));
+    Round(g, h, a, b, c, d, e, f, K(0x84c87814), w10 = Add(w10, sigma1(w8), w3, sigma0(w11)));
+    Round(f, g, h, a, b, c, d, e, K(0x8cc70208), w11 = Add(w11, sigma1(w9), w4, sigma0(w12)));
+    Round(e, f, g, h, a, b, c, d, K(0x90befffa), w12 = Add(w12, sigma1(w10), w5, sigma0(w13)));
+    Round(d, e, f, g, h, a, b, c, K(0xa4506ceb), w13 = Add(w13, sigma1(w11), w6, sigma0(w14)));
+    Round(c, d, e, f, g, h, a, b, K(0xbef9a3f7), Add(w14, sigma1(w12), w7, sigma0(w15)));
+    Round(b, c, d, e, f, g, h, a, K(0xc67178f2), Add(w15, sigma1(w13), w8, sigma0(w0)));
+
+    s[0] = Add(s[0], a);
+    s[1] = Add(s[1], b);
+    s[2] = Add(s[2], c);
+    s[3] = Add(s[3], d);
+    s[4] = Add(s[4], e);
+    s[5] = Add(s[5], f);
+    s[6] = Add(s[6], g);
+    s[7] = Add(s[7], h);
+}
+} // namespace
+
+void Transform_8way(unsigned char* out, const unsigned char* in)
+{
+    __m256i s[8], w[16];
+
+    // Transform 1: the 64-byte inputs
+    for (int i = 0; i < 16; i++) {
+        w[i] = Read8(in, 4 * i);
+    }
+    Initialize(s);
+    Transform(s, w);
+
+    // Transform 2: the padding of the 64-byte inputs
+    w[0] = K(0x80000000ul);
+    for (int i = 1; i < 15; i++) {
+        w[i] = K(0);
+    }
+    w[15] = K(0x200);
+    Transform(s, w);
+
+    // Transform 3: the padded 32-byte first hashes
+    for (int i = 0; i < 8; i++) {
+        w[i] = s[i];
+    }
+    w[8] = K(0x80000000ul);
+    for (int i = 9; i < 15; i++) {
+        w[i] = K(0);
+    }
+    w[15] = K(0x100);
+    Initialize(s);
+    Transform(s, w);
+
+    for (int i = 0; i < 8; i++) {
+        Write8(out, 4 * i, s[i]);
+    }
+}
+} // namespace sha256d64_avx2
+
+#endif
@@ -0,0 +1,208 @@
+// Copyright (c) 2014 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// Based on https://github.com/noloader/SHA-Intrinsics/blob/master/sha256-x86.c,
+// Written and placed in public domain by Jeffrey Walton.
+// Based on code from Intel, and by Sean Gulley for the miTLS project.
+
+#ifdef ENABLE_SHANI
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <immintrin.h>
+
+namespace
+{
+/** The state is kept in the ABEF/CDGH layout of the SHA extensions. */
+__m128i inline Init0() { return _mm_set_epi32(0x6a09e667, 0xbb67ae85, 0x510e527f, 0x9b05688c); }
+__m128i inline Init1() { return _mm_set_epi32(0x3c6ef372, 0xa54ff53a, 0x1f83d9ab, 0x5be0cd19); }
+
+/** Loads four big endian words. */
+__m128i inline __attribute__((always_inline)) Load(const unsigned char* in)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)in), mask);
+}
+
+/** Stores four big endian words. */
+void inline __attribute__((always_inline)) Save(unsigned char* out, __m128i s)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+    _mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(s, mask));
+}
+
+/** Converts the state from the ABCD/EFGH to the ABEF/CDGH layout. */
+void inline __attribute__((always_inline)) Shuffle(__m128i& s0, __m128i& s1)
+{
+    const __m128i t1 = _mm_shuffle_epi32(s0, 0xB1);
+    const __m128i t2 = _mm_shuffle_epi32(s1, 0x1B);
+    s0 = _mm_alignr_epi8(t1, t2, 0x08);
+    s1 = _mm_blend_epi16(t2, t1, 0xF0);
+}
+
+/** Converts the state from the ABEF/CDGH to the ABCD/EFGH layout. */
+void inline __attribute__((always_inline)) Unshuffle(__m128i& s0, __m128i& s1)
+{
+    const __m128i t1 = _mm_shuffle_epi32(s0, 0x1B);
+    const __m128i t2 = _mm_shuffle_epi32(s1, 0xB1);
+    s0 = _mm_blend_epi16(t1, t2, 0xF0);
+    s1 = _mm_alignr_epi8(t2, t1, 0x08);
+}
+
+// The helpers below operate on N independent states at once, which lets the
+// CPU overlap the latency of the SHA instructions of different inputs.
+
+/** Four rounds of SHA-256. */
+template<int N>
+void inline __attribute__((always_inline)) QuadRound(__m128i* s0, __m128i* s1, const __m128i* m, uint64_t k1, uint64_t k0)
+{
+    const __m128i k = _mm_set_epi64x(k1, k0);
+    for (int i = 0; i < N; i++) {
+        const __m128i msg = _mm_add_epi32(m[i], k);
+        s1[i] = _mm_sha256rnds2_epu32(s1[i], s0[i], msg);
+        s0[i] = _mm_sha256rnds2_epu32(s0[i], s1[i], _mm_shuffle_epi32(msg, 0x0e));
+    }
+}
+
+template<int N>
+void inline __attribute__((always_inline)) ShiftMessageA(__m128i* m0, const __m128i* m1)
+{
+    for (int i = 0; i < N; i++) {
+        m0[i] = _mm_sha256msg1_epu32(m0[i], m1[i]);
+    }
+}
+
+template<int N>
+void inline __attribute__((always_inline)) ShiftMessageC(const __m128i* m0, const __m128i* m1, __m128i* m2)
+{
+    for (int i = 0; i < N; i++) {
+        m2[i] = _mm_sha256msg2_epu32(_mm_add_epi32(m2[i], _mm_alignr_epi8(m1[i], m0[i], 4)), m1[i]);
+    }
+}
+
+template<int N>
+void inline __attribute__((always_inline)) ShiftMessageB(__m128i* m0, const __m128i* m1, __m128i* m2)
+{
+    ShiftMessageC<N>(m0, m1, m2);
+    ShiftMessageA<N>(m0, m1);
+}
+
+/** The 64 rounds of SHA-256, without the final addition of the old state. */
+template<int N>
+void inline __attribute__((always_inline)) Rounds(__m128i* s0, __m128i* s1, __m128i* m0, __m128i* m1, __m128i* m2, __m128i* m3)
+{
+    QuadRound<N>(s0, s1, m0, 0xe9b5dba5b5c0fbcfull, 0x71374491428a2f98ull);
+    QuadRound<N>(s0, s1, m1, 0xab1c5ed5923f82a4ull, 0x59f111f13956c25bull);
+    ShiftMessageA<N>(m0, m1);
+    QuadRound<N>(s0, s1, m2, 0x550c7dc3243185beull, 0x12835b01d807aa98ull);
+    ShiftMessageA<N>(m1, m2);
+    QuadRound<N>(s0, s1, m3, 0xc19bf1749bdc06a7ull, 0x80deb1fe72be5d74ull);
+    ShiftMessageB<N>(m2, m3, m0);
+    QuadRound<N>(s0, s1, m0, 0x240ca1cc0fc19dc6ull, 0xefbe4786e49b69c1ull);
+    ShiftMessageB<N>(m3, m0, m1);
+    QuadRound<N>(s0, s1, m1, 0x76f988da5cb0a9dcull, 0x4a7484aa2de92c6full);
+    ShiftMessageB<N>(m0, m1, m2);
+    QuadRound<N>(s0, s1, m2, 0xbf597fc7b00327c8ull, 0xa831c66d983e5152ull);
+    ShiftMessageB<N>(m1, m2, m3);
+    QuadRound<N>(s0, s1, m3, 0x1429296706ca6351ull, 0xd5a79147c6e00bf3ull);
+    ShiftMessageB<N>(m2, m3, m0);
+    QuadRound<N>(s0, s1, m0, 0x53380d134d2c6dfcull, 0x2e1b213827b70a85ull);
+    ShiftMessageB<N>(m3, m0, m1);
+    QuadRound<N>(s0, s1, m1, 0x92722c8581c2c92eull, 0x766a0abb650a7354ull);
+    ShiftMessageB<N>(m0, m1, m2);
+    QuadRound<N>(s0, s1, m2, 0xc76c51a3c24b8b70ull, 0xa81a664ba2bfe8a1ull);
+    ShiftMessageB<N>(m1, m2, m3);
+    QuadRound<N>(s0, s1, m3, 0x106aa070f40e3585ull, 0xd6990624d192e819ull);
+    ShiftMessageB<N>(m2, m3, m0);
+    QuadRound<N>(s0, s1, m0, 0x34b0bcb52748774cull, 0x1e376c0819a4c116ull);
+    ShiftMessageB<N>(m3, m0, m1);
+    QuadRound<N>(s0, s1, m1, 0x682e6ff35b9cca4full, 0x4ed8aa4a391c0cb3ull);
+    ShiftMessageC<N>(m0, m1, m2);
+    QuadRound<N>(s0, s1, m2, 0x8cc7020884c87814ull, 0x78a5636f748f82eeull);
+    ShiftMessageC<N>(m1, m2, m3);
+    QuadRound<N>(s0, s1, m3, 0xc67178f2bef9a3f7ull, 0xa4506ceb90befffaull);
+}
+}
+
+namespace sha256_shani
+{
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+{
+    __m128i m0[1], m1[1], m2[1], m3[1], s0[1], s1[1];
+
+    s0[0] = _mm_loadu_si128((const __m128i*)s);
+    s1[0] = _mm_loadu_si128((const __m128i*)(s + 4));
+    Shuffle(s0[0], s1[0]);
+
+    while (blocks--) {
+        const __m128i so0 = s0[0], so1 = s1[0];
+
+        m0[0] = Load(chunk);
+        m1[0] = Load(chunk + 16);
+        m2[0] = Load(chunk + 32);
+        m3[0] = Load(chunk + 48);
+        Rounds<1>(s0, s1, m0, m1, m2, m3);
+
+        s0[0] = _mm_add_epi32(s0[0], so0);
+        s1[0] = _mm_add_epi32(s1[0], so1);
+        chunk += 64;
+    }
+
+    Unshuffle(s0[0], s1[0]);
+    _mm_storeu_si128((__m128i*)s, s0[0]);
+    _mm_storeu_si128((__m128i*)(s + 4), s1[0]);
+}
+}
+
+namespace sha256d64_shani
+{
+void Transform_2way(unsigned char* out, const unsigned char* in)
+{
+    __m128i m0[2], m1[2], m2[2], m3[2], s0[2], s1[2], so0[2], so1[2];
+
+    // Transform 1: the 64-byte inputs
+    for (int i = 0; i < 2; i++) {
+        s0[i] = Init0();
+        s1[i] = Init1();
+        m0[i] = Load(in + 64 * i);
+        m1[i] = Load(in + 64 * i + 16);
+        m2[i] = Load(in + 64 * i + 32);
+        m3[i] = Load(in + 64 * i + 48);
+    }
+    Rounds<2>(s0, s1, m0, m1, m2, m3);
+
+    // Transform 2: the padding of the 64-byte inputs
+    for (int i = 0; i < 2; i++) {
+        s0[i] = so0[i] = _mm_add_epi32(s0[i], Init0());
+        s1[i] = so1[i] = _mm_add_epi32(s1[i], Init1());
+        m0[i] = _mm_set_epi32(0, 0, 0, 0x80000000);
+        m1[i] = _mm_setzero_si128();
+        m2[i] = _mm_setzero_si128();
+        m3[i] = _mm_set_epi32(0x200, 0, 0, 0);
+    }
+    Rounds<2>(s0, s1, m0, m1, m2, m3);
+
+    // Transform 3: the padded 32-byte first hashes
+    for (int i = 0; i < 2; i++) {
+        m0[i] = _mm_add_epi32(s0[i], so0[i]);
+        m1[i] = _mm_add_epi32(s1[i], so1[i]);
+        Unshuffle(m0[i], m1[i]);
+        m2[i] = _mm_set_epi32(0, 0, 0, 0x80000000);
+        m3[i] = _mm_set_epi32(0x100, 0, 0, 0);
+        s0[i] = Init0();
+        s1[i] = Init1();
+    }
+    Rounds<2>(s0, s1, m0, m1, m2, m3);
+
+    for (int i = 0; i < 2; i++) {
+        s0[i] = _mm_add_epi32(s0[i], Init0());
+        s1[i] = _mm_add_epi32(s1[i], Init1());
+        Unshuffle(s0[i], s1[i]);
+        Save(out + 32 * i, s0[i]);
+        Save(out + 32 * i + 16, s1[i]);
+    }
+}
+}
+
+#endif
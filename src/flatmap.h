@@ -0,0 +1,273 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_FLATMAP_H
+#define BITCOIN_FLATMAP_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* Hash map with open addressing, whose entries live in a pooled arena.
+ *
+ * The table itself is a flat array of 8 byte slots, which hold a part of the
+ * hash of the key and the index of the entry in the arena, and is probed
+ * linearly. The entries are allocated in fixed size chunks, so that there is
+ * no per-entry allocation overhead, and pointers and references to them stay
+ * valid until the entry is erased, even if the table is resized.
+ *
+ * Iterators are invalidated by insertions, as with std::unordered_map, but
+ * not by erasing other entries: erased slots are marked as deleted and reused
+ * later, so the common pattern of erasing while iterating works. clear()
+ * releases all memory at once.
+ */
+template <class K, class T, class Hash>
+class flatmap {
+public:
+    typedef K key_type;
+    typedef T mapped_type;
+    typedef std::pair<const K, T> value_type;
+    typedef size_t size_type;
+
+    /** A slot of the table. */
+    struct slot {
+        uint32_t tag;
+        uint32_t index;
+    };
+
+    /** Number of entries per arena chunk. */
+    static const uint32_t CHUNK_BITS = 7;
+    static const uint32_t CHUNK_SIZE = 1 << CHUNK_BITS;
+
+private:
+    typedef typename std::aligned_storage<sizeof(value_type), std::alignment_of<value_type>::value>::type node;
+
+    /** Tags of unused slots; tags of used slots always have bit 1 set. */
+    static const uint32_t TAG_EMPTY = 0;
+    static const uint32_t TAG_DELETED = 1;
+    static const uint32_t NO_INDEX = 0xffffffff;
+
+    Hash hasher;
+    std::vector<slot> slots;
+    std::vector<node*> chunks;
+    //! Number of arena entries ever handed out, and the head of the list of freed ones
+    uint32_t nAllocated;
+    uint32_t nFreeHead;
+    size_t nLive;
+    size_t nDeleted;
+
+    flatmap(const flatmap&);
+    flatmap& operator=(const flatmap&);
+
+    static uint32_t Tag(size_t hash) { return (uint32_t)(hash >> (sizeof(size_t) * 8 - 32)) | 2; }
+
+    node* Node(uint32_t index) const { return &chunks[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)]; }
+    value_type* Value(uint32_t index) const { return reinterpret_cast<value_type*>(Node(index)); }
+
+    uint32_t AllocateNode()
+    {
+        if (nFreeHead != NO_INDEX) {
+            uint32_t index = nFreeHead;
+            nFreeHead = *reinterpret_cast<uint32_t*>(Node(index));
+            return index;
+        }
+        assert(nAllocated != NO_INDEX);
+        if ((nAllocated >> CHUNK_BITS) == chunks.size()) {
+            chunks.push_back(new node[CHUNK_SIZE]);
+        }
+        return nAllocated++;
+    }
+
+    void FreeNode(uint32_t index)
+    {
+        Value(index)->~value_type();
+        *reinterpret_cast<uint32_t*>(Node(index)) = nFreeHead;
+        nFreeHead = index;
+    }
+
+    /** Rebuilds the table with nSlots slots, which drops all deleted slots. */
+    void Rehash(size_t nSlots)
+    {
+        std::vector<slot> vNew(nSlots, slot());
+        const size_t mask = nSlots - 1;
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].tag <= TAG_DELETED) continue;
+            size_t pos = hasher(Value(slots[i].index)->first) & mask;
+            while (vNew[pos].tag != TAG_EMPTY) {
+                pos = (pos + 1) & mask;
+            }
+            vNew[pos] = slots[i];
+        }
+        slots.swap(vNew);
+        nDeleted = 0;
+    }
+
+    /** Makes room for one more entry, keeping the load (including deleted slots) at most 3/4. */
+    void Grow()
+    {
+        if ((nLive + nDeleted + 1) * 4 <= slots.size() * 3) return;
+        if (slots.empty()) {
+            Rehash(16);
+        } else if ((nLive + 1) * 2 > slots.size()) {
+            Rehash(slots.size() * 2);
+        } else {
+            // Mostly deleted slots; clean them up without growing
+            Rehash(slots.size());
+        }
+    }
+
+    size_t FindSlot(const K& key) const
+    {
+        if (slots.empty()) return 0;
+        const size_t mask = slots.size() - 1;
+        const size_t hash = hasher(key);
+        const uint32_t tag = Tag(hash);
+        for (size_t pos = hash & mask; slots[pos].tag != TAG_EMPTY; pos = (pos + 1) & mask) {
+            if (slots[pos].tag == tag && Value(slots[pos].index)->first == key) return pos;
+        }
+        return slots.size();
+    }
+
+public:
+    template <class V, class M>
+    class iter {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename std::remove_const<V>::type value_type;
+        typedef ptrdiff_t difference_type;
+        typedef V* pointer;
+        typedef V& reference;
+
+    private:
+        M* m;
+        size_t pos;
+        friend class flatmap;
+
+        void Skip() {
+            while (pos < m->slots.size() && m->slots[pos].tag <= TAG_DELETED) ++pos;
+        }
+
+    public:
+        iter() : m(NULL), pos(0) {}
+        iter(M* m_, size_t pos_) : m(m_), pos(pos_) { Skip(); }
+        iter(const iter<typename flatmap::value_type, flatmap>& it) : m(it.m), pos(it.pos) {}
+
+        V& operator*() const { return *m->Value(m->slots[pos].index); }
+        V* operator->() const { return m->Value(m->slots[pos].index); }
+        iter& operator++() { ++pos; Skip(); return *this; }
+        iter operator++(int) { iter ret = *this; ++*this; return ret; }
+
+        template <class V2, class M2>
+        bool operator==(const iter<V2, M2>& it) const { return pos == it.pos; }
+        template <class V2, class M2>
+        bool operator!=(const iter<V2, M2>& it) const { return pos != it.pos; }
+
+        template <class V2, class M2> friend class iter;
+    };
+
+    typedef iter<value_type, flatmap> iterator;
+    typedef iter<const value_type, const flatmap> const_iterator;
+
+    flatmap() : nAllocated(0), nFreeHead(NO_INDEX), nLive(0), nDeleted(0) {}
+    ~flatmap() { clear(); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slots.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, slots.size()); }
+
+    size_type size() const { return nLive; }
+    bool empty() const { return nLive == 0; }
+
+    iterator find(const K& key) { return iterator(this, FindSlot(key)); }
+    const_iterator find(const K& key) const { return const_iterator(this, FindSlot(key)); }
+    size_type count(const K& key) const { return FindSlot(key) != slots.size(); }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        size_t pos = FindSlot(value.first);
+        if (pos != slots.size()) return std::make_pair(iterator(this, pos), false);
+        Grow();
+        const size_t mask = slots.size() - 1;
+        const size_t hash = hasher(value.first);
+        pos = hash & mask;
+        while (slots[pos].tag > TAG_DELETED) {
+            pos = (pos + 1) & mask;
+        }
+        if (slots[pos].tag == TAG_DELETED) nDeleted--;
+        uint32_t index = AllocateNode();
+        new (Node(index)) value_type(value);
+        slots[pos].tag = Tag(hash);
+        slots[pos].index = index;
+        nLive++;
+        return std::make_pair(iterator(this, pos), true);
+    }
+
+    T& operator[](const K& key) { return insert(value_type(key, T())).first->second; }
+
+    void erase(iterator it)
+    {
+        FreeNode(slots[it.pos].index);
+        slots[it.pos].tag = TAG_DELETED;
+        nLive--;
+        nDeleted++;
+    }
+
+    size_type erase(const K& key)
+    {
+        iterator it = find(key);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+
+    /** Destroys all entries and releases the table and the arena. */
+    void clear()
+    {
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].tag > TAG_DELETED) Value(slots[i].index)->~value_type();
+        }
+        for (size_t i = 0; i < chunks.size(); i++) {
+            delete[] chunks[i];
+        }
+        std::vector<slot>().swap(slots);
+        std::vector<node*>().swap(chunks);
+        nAllocated = 0;
+        nFreeHead = NO_INDEX;
+        nLive = 0;
+        nDeleted = 0;
+    }
+
+    void swap(flatmap& other)
+    {
+        std::swap(hasher, other.hasher);
+        slots.swap(other.slots);
+        chunks.swap(other.chunks);
+        std::swap(nAllocated, other.nAllocated);
+        std::swap(nFreeHead, other.nFreeHead);
+        std::swap(nLive, other.nLive);
+        std::swap(nDeleted, other.nDeleted);
+    }
+
+    /** Sizes the table for at least n entries without further resizing. */
+    void reserve(size_t n)
+    {
+        size_t nSlots = 16;
+        while (n * 4 > nSlots * 3) nSlots *= 2;
+        if (nSlots > slots.size()) Rehash(nSlots);
+    }
+
+    size_t bucket_count() const { return slots.size(); }
+    size_t chunk_count() const { return chunks.size(); }
+    size_t chunk_capacity() const { return chunks.capacity(); }
+    static size_t chunk_bytes() { return sizeof(node) * CHUNK_SIZE; }
+};
+
+#endif // BITCOIN_FLATMAP_H
@@ -7,6 +7,7 @@
 #include "base58.h"
 #include "chainparams.h"
 #include "httpserver.h"
+#include "rpc/jsonstream.h"
 #include "rpc/protocol.h"
 #include "rpc/server.h"
 #include "random.h"
@@ -21,6 +22,7 @@
 #include "zurbank/rpcmbstring.h" // SanitizeInvalidUTF8
 
 #include <boost/algorithm/string.hpp> // boost::trim
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp> //BOOST_FOREACH
 
 /** Sanitize UTF-8 encoded strings in RPC responses */
@@ -88,6 +90,80 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     req->WriteReply(nStatus, strReply);
 }
 
+/** Hands output of streamed JSON-RPC replies to the HTTP request as chunks.
+ * The chunked reply is only started, once the first chunk is written.
+ * Throws, if the client went away, to stop producing the result.
+ */
+class HTTPRPCStreamSink
+{
+public:
+    HTTPRPCStreamSink(HTTPRequest* req) : req(req), fStarted(false)
+    {
+    }
+    void Write(const std::string& strChunk)
+    {
+        if (!fStarted) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->StartChunkedReply(HTTP_OK);
+            fStarted = true;
+        }
+        // Chunks end between JSON tokens, so no multibyte sequence is split
+        if (!req->WriteReplyChunk(fSanitizeResponse ? mastercore::SanitizeInvalidUTF8(strChunk) : strChunk))
+            throw std::runtime_error("Connection closed");
+    }
+    bool IsStarted() const { return fStarted; }
+private:
+    HTTPRequest* req;
+    bool fStarted;
+};
+
+/** Executes a JSON-RPC request with a streaming actor, if available, and writes
+ * the reply incrementally. Results smaller than a chunk are sent as regular reply.
+ * Returns false, if the method doesn't support streaming.
+ */
+static bool JSONRPCReplyStreamed(HTTPRequest* req, const JSONRequest& jreq)
+{
+    const CRPCCommand* pcmd = tableRPC[jreq.strMethod];
+    if (!pcmd || !pcmd->streamActor)
+        return false;
+
+    HTTPRPCStreamSink sink(req);
+    JSONStreamWriter writer(boost::bind(&HTTPRPCStreamSink::Write, &sink, _1));
+    try {
+        writer.BeginObject();
+        writer.Key("result");
+        tableRPC.executeStream(jreq.strMethod, jreq.params, writer);
+        writer.Key("error");
+        writer.Null();
+        writer.Key("id");
+        writer.Value(jreq.id);
+        writer.EndObject();
+        writer.Raw("\n");
+        if (writer.HasFlushed())
+            writer.Flush();
+    } catch (...) {
+        // Errors can only be reported, as long as nothing was sent yet
+        if (!sink.IsStarted())
+            throw;
+        // Otherwise the connection is closed, so the status of the reply doesn't claim success
+        LogPrintf("%s: %s failed after the reply was started, reply is aborted\n", __func__, jreq.strMethod);
+        req->AbortChunkedReply();
+        return true;
+    }
+
+    if (sink.IsStarted()) {
+        req->EndChunkedReply();
+    } else {
+        std::string strReply = writer.GetPending();
+        if (fSanitizeResponse) {
+            strReply = mastercore::SanitizeInvalidUTF8(strReply);
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strReply);
+    }
+    return true;
+}
+
 //This function checks username and password against -rpcauth
 //entries from config file.
 static bool multiUserAuthorized(std::string strUserPass)
@@ -189,6 +265,10 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
 
+            // large results are written incrementally, if supported
+            if (JSONRPCReplyStreamed(req, jreq))
+                return true;
+
             UniValue result = tableRPC.execute(jreq.strMethod, jreq.params);
 
             // Send reply
@@ -535,12 +535,17 @@ void HTTPEvent::trigger(struct timeval* tv)
         evtimer_add(ev, tv); // trigger after timeval passed
 }
 HTTPRequest::HTTPRequest(struct evhttp_request* req) : req(req),
-                                                       replySent(false)
+                                                       replySent(false),
+                                                       chunkedReplyStarted(false)
 {
 }
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (chunkedReplyStarted) {
+        // Don't complete partially sent replies, the body is likely truncated
+        LogPrintf("%s: Incomplete chunked reply\n", __func__);
+        AbortChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -593,7 +598,7 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 {
-    assert(!replySent && req);
+    assert(!replySent && !chunkedReplyStarted && req);
     // Send event to main http thread to send reply message
     struct evbuffer* evb = evhttp_request_get_output_buffer(req);
     assert(evb);
@@ -605,6 +610,155 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     req = 0; // transferred back to main thread
 }
 
+/** Progress of a chunked reply, shared between the worker and the main http thread. */
+struct HTTPChunkedReply
+{
+    boost::mutex mutex;
+    boost::condition_variable cond;
+    //! Bytes queued by the worker, which were not yet written to the connection
+    size_t nBacklog;
+    //! Bytes handed to libevent, which were not yet written to the connection
+    size_t nUnwritten;
+    //! Whether the connection was closed
+    bool fClosed;
+
+    HTTPChunkedReply() : nBacklog(0), nUnwritten(0), fClosed(false) {}
+};
+
+/** Called by libevent, when the connection of a chunked reply is closed. */
+static void http_chunked_reply_closed(struct evhttp_connection* evcon, void* arg)
+{
+    HTTPChunkedReply* reply = static_cast<HTTPChunkedReply*>(arg);
+    boost::unique_lock<boost::mutex> lock(reply->mutex);
+    reply->fClosed = true;
+    reply->cond.notify_all();
+}
+
+/** Called by libevent, when all output of a connection was written. */
+static void http_chunked_reply_written(struct evhttp_connection* evcon, void* arg)
+{
+    HTTPChunkedReply* reply = static_cast<HTTPChunkedReply*>(arg);
+    boost::unique_lock<boost::mutex> lock(reply->mutex);
+    reply->nBacklog -= reply->nUnwritten;
+    reply->nUnwritten = 0;
+    reply->cond.notify_all();
+}
+
+/** Starts a chunked reply in the main http thread, and watches the connection. */
+static void http_send_reply_start(struct evhttp_request* req, int nStatus, boost::shared_ptr<HTTPChunkedReply> reply)
+{
+    evhttp_send_reply_start(req, nStatus, NULL);
+    struct evhttp_connection* evcon = evhttp_request_get_connection(req);
+    if (evcon) {
+        evhttp_connection_set_closecb(evcon, http_chunked_reply_closed, reply.get());
+    } else {
+        http_chunked_reply_closed(NULL, reply.get());
+    }
+}
+
+/** Sends a chunk in the main http thread, and releases the buffer afterwards. */
+static void http_send_reply_chunk(struct evhttp_request* req, struct evbuffer* evb, boost::shared_ptr<HTTPChunkedReply> reply)
+{
+    if (evhttp_request_get_connection(req)) {
+        {
+            boost::unique_lock<boost::mutex> lock(reply->mutex);
+            reply->nUnwritten += evbuffer_get_length(evb);
+        }
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+        evhttp_send_reply_chunk_with_cb(req, evb, http_chunked_reply_written, reply.get());
+#else
+        // older versions don't report the progress, so the backlog can't be limited
+        evhttp_send_reply_chunk(req, evb);
+        http_chunked_reply_written(NULL, reply.get());
+#endif
+    } else {
+        // the connection was closed, while the chunk was queued
+        http_chunked_reply_closed(NULL, reply.get());
+    }
+    evbuffer_free(evb);
+}
+
+/** Completes a chunked reply in the main http thread. */
+static void http_send_reply_end(struct evhttp_request* req, boost::shared_ptr<HTTPChunkedReply> reply)
+{
+    struct evhttp_connection* evcon = evhttp_request_get_connection(req);
+    if (evcon) evhttp_connection_set_closecb(evcon, NULL, NULL);
+    evhttp_send_reply_end(req);
+}
+
+/** Closes the connection of an incomplete chunked reply in the main http thread. */
+static void http_abort_reply(struct evhttp_request* req, boost::shared_ptr<HTTPChunkedReply> reply)
+{
+    struct evhttp_connection* evcon = evhttp_request_get_connection(req);
+    if (evcon) {
+        // releases the request as well
+        evhttp_connection_set_closecb(evcon, NULL, NULL);
+        evhttp_connection_free(evcon);
+    } else {
+        // the request was already detached from the closed connection
+        evhttp_send_reply_end(req);
+    }
+}
+
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && !chunkedReplyStarted && req);
+    chunkedReply.reset(new HTTPChunkedReply());
+    HTTPEvent* ev = new HTTPEvent(eventBase, true,
+        boost::bind(http_send_reply_start, req, nStatus, chunkedReply));
+    ev->trigger(0);
+    chunkedReplyStarted = true;
+}
+
+bool HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(chunkedReplyStarted && req);
+    if (strChunk.empty())
+        return true; // an empty chunk would terminate the reply
+    {
+        // Wait for the client to catch up, so a slow reader doesn't cause the
+        // whole body to be buffered. The server timeout closes stalled connections.
+        boost::unique_lock<boost::mutex> lock(chunkedReply->mutex);
+        while (!chunkedReply->fClosed && chunkedReply->nBacklog > 0 &&
+                chunkedReply->nBacklog + strChunk.size() > MAX_HTTP_CHUNKED_BACKLOG) {
+            chunkedReply->cond.wait(lock);
+        }
+        if (chunkedReply->fClosed)
+            return false;
+        chunkedReply->nBacklog += strChunk.size();
+    }
+    // The buffer is not shared with the main http thread until the event fires
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    HTTPEvent* ev = new HTTPEvent(eventBase, true,
+        boost::bind(http_send_reply_chunk, req, evb, chunkedReply));
+    ev->trigger(0);
+    return true;
+}
+
+void HTTPRequest::EndChunkedReply()
+{
+    assert(chunkedReplyStarted && req);
+    HTTPEvent* ev = new HTTPEvent(eventBase, true,
+        boost::bind(http_send_reply_end, req, chunkedReply));
+    ev->trigger(0);
+    chunkedReplyStarted = false;
+    replySent = true;
+    req = 0; // transferred back to main thread
+}
+
+void HTTPRequest::AbortChunkedReply()
+{
+    assert(chunkedReplyStarted && req);
+    HTTPEvent* ev = new HTTPEvent(eventBase, true,
+        boost::bind(http_abort_reply, req, chunkedReply));
+    ev->trigger(0);
+    chunkedReplyStarted = false;
+    replySent = true;
+    req = 0; // transferred back to main thread
+}
+
 CService HTTPRequest::GetPeer()
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
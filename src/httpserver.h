@@ -9,16 +9,20 @@
 #include <stdint.h>
 #include <boost/thread.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+/** Maximum number of bytes of a chunked reply, which are queued but not yet sent */
+static const size_t MAX_HTTP_CHUNKED_BACKLOG=1024*1024;
 
 struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPChunkedReply;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -57,6 +61,9 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    bool chunkedReplyStarted;
+    //! Progress of a chunked reply, shared with the main http thread
+    boost::shared_ptr<HTTPChunkedReply> chunkedReply;
 
 public:
     HTTPRequest(struct evhttp_request* req);
@@ -112,6 +119,44 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply.
+     * nStatus is the HTTP status code to send.
+     *
+     * @note Can be called only once, instead of WriteReply. The body is sent
+     * with WriteReplyChunk and the reply must be completed by EndChunkedReply.
+     */
+    void StartChunkedReply(int nStatus);
+
+    /**
+     * Write a chunk of the body of a chunked HTTP reply.
+     * Returns false, if the connection was closed and the chunk was dropped.
+     *
+     * @note The data is queued for the main http thread. If more than
+     * MAX_HTTP_CHUNKED_BACKLOG bytes are not yet sent, this blocks until the
+     * client caught up, so don't hold any locks while writing.
+     */
+    bool WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Complete a chunked HTTP reply.
+     *
+     * @note As this will give the request back to the main thread, do not call
+     * any other HTTPRequest methods after calling this.
+     */
+    void EndChunkedReply();
+
+    /**
+     * Abort a chunked HTTP reply, which can't be completed.
+     *
+     * The connection is closed without the final chunk, so the client doesn't
+     * mistake the truncated body for the complete reply.
+     *
+     * @note As this will give the request back to the main thread, do not call
+     * any other HTTPRequest methods after calling this.
+     */
+    void AbortChunkedReply();
 };
 
 /** Event handler closure.
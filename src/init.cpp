@@ -16,6 +16,8 @@
 #include "checkpoints.h"
 #include "compat/sanity.h"
 #include "consensus/validation.h"
+#include "crypto/quark.h"
+#include "crypto/sha256.h"
 #include "httpserver.h"
 #include "httprpc.h"
 #include "key.h"
@@ -329,6 +331,8 @@ std::string HelpMessage(HelpMessageMode mode)
     }
     strUsage += HelpMessageOpt("-datadir=<dir>", _("Specify data directory"));
     strUsage += HelpMessageOpt("-dbcache=<n>", strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), nMinDbCache, nMaxDbCache, nDefaultDbCache));
+    strUsage += HelpMessageOpt("-dbflushbackground", strprintf(_("Write the database cache to disk in the background, without pausing block processing; this can temporarily use up to twice the -dbcache memory (default: %u)"), DEFAULT_DB_FLUSH_BACKGROUND));
+    strUsage += HelpMessageOpt("-dbflushbatch=<n>", strprintf(_("Write background database flushes in batches of at most <n> megabytes (default: %d)"), nDefaultDbFlushBatch));
     if (showDebug)
         strUsage += HelpMessageOpt("-feefilter", strprintf("Tell other nodes to filter invs to us by our mempool min fee (default: %u)", DEFAULT_FEEFILTER));
     strUsage += HelpMessageOpt("-loadblock=<file>", _("Imports blocks from external blk000??.dat file on startup"));
@@ -340,7 +344,7 @@ std::string HelpMessage(HelpMessageMode mode)
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file (default: %s)"), BITCOIN_PID_FILENAME));
 #endif
-    strUsage += HelpMessageOpt("-prune=<n>", strprintf(_("Reduce storage requirements by pruning (deleting) old blocks. This mode is incompatible with -txindex and -rescan. "
+    strUsage += HelpMessageOpt("-prune=<n>", strprintf(_("Reduce storage requirements by pruning (deleting) old blocks. This mode is incompatible with -txindex, -rescan and -dbflushbackground. "
             "Warning: Reverting this setting requires re-downloading the entire blockchain. "
             "(default: 0 = disable pruning blocks, >%u = target size in MiB to use for block files)"), MIN_DISK_SPACE_FOR_BLOCK_FILES / 1024 / 1024));
     strUsage += HelpMessageOpt("-reindex-chainstate", _("Rebuild chain state from the currently indexed blocks"));
@@ -367,6 +371,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-maxreceivebuffer=<n>", strprintf(_("Maximum per-connection receive buffer, <n>*1000 bytes (default: %u)"), DEFAULT_MAXRECEIVEBUFFER));
     strUsage += HelpMessageOpt("-maxsendbuffer=<n>", strprintf(_("Maximum per-connection send buffer, <n>*1000 bytes (default: %u)"), DEFAULT_MAXSENDBUFFER));
     strUsage += HelpMessageOpt("-maxtimeadjustment", strprintf(_("Maximum allowed median peer time offset adjustment. Local perspective of time may be influenced by peers forward or backward by this amount. (default: %u seconds)"), DEFAULT_MAX_TIME_ADJUSTMENT));
+    strUsage += HelpMessageOpt("-msghandthreads=<n>", strprintf(_("Set the number of threads that process peer messages (1 to %d, default: %d)"), MAX_MSGHAND_THREADS, DEFAULT_MSGHAND_THREADS));
     strUsage += HelpMessageOpt("-onion=<ip:port>", strprintf(_("Use separate SOCKS5 proxy to reach peers via Tor hidden services (default: %s)"), "-proxy"));
     strUsage += HelpMessageOpt("-onlynet=<net>", _("Only connect to nodes in network <net> (ipv4, ipv6 or onion)"));
     strUsage += HelpMessageOpt("-permitbaremultisig", strprintf(_("Relay non-P2SH multisig (default: %u)"), DEFAULT_PERMIT_BAREMULTISIG));
@@ -403,6 +408,10 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-zmqpubhashtx=<address>", _("Enable publish hash transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawblock=<address>", _("Enable publish raw block in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtx=<address>", _("Enable publish raw transaction in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubzustx=<address>", _("Enable publish Zus transaction in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubzustrade=<address>", _("Enable publish Zus trade in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubzusbalance=<address>", _("Enable publish Zus balance changes in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubzusreorg=<address>", _("Enable publish Zus reorganization in <address>"));
 #endif
 
     strUsage += HelpMessageGroup(_("Debugging/Testing options:"));
@@ -439,7 +448,7 @@ std::string HelpMessage(HelpMessageMode mode)
         strUsage += HelpMessageOpt("-mocktime=<n>", "Replace actual time with <n> seconds since epoch (default: 0)");
         strUsage += HelpMessageOpt("-limitfreerelay=<n>", strprintf("Continuously rate-limit free transactions to <n>*1000 bytes per minute (default: %u)", DEFAULT_LIMITFREERELAY));
         strUsage += HelpMessageOpt("-relaypriority", strprintf("Require high priority for relaying free or low-fee transactions (default: %u)", DEFAULT_RELAYPRIORITY));
-        strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit size of signature cache to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit size of signature cache to <n> MiB (maximum: %d, default: %u)", MAX_MAX_SIG_CACHE_SIZE, DEFAULT_MAX_SIG_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE));
     }
     strUsage += HelpMessageOpt("-minrelaytxfee=<amt>", strprintf(_("Fees (in %s/kB) smaller than this are considered zero fee for relaying, mining and transaction creation (default: %s)"),
@@ -505,6 +514,12 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-disclaimer", "Explicitly show QT disclaimer on startup (default: 0)");
     strUsage += HelpMessageOpt("-omniuiwalletscope", "Max. transactions to show in trade and transaction history (default: 65535)");
     strUsage += HelpMessageOpt("-omnishowblockconsensushash", "Calculate and log the consensus hash for the specified block");
+    strUsage += HelpMessageOpt("-omniperfstats=<n>", "Log processing statistics every <n> blocks (default: 0)");
+    strUsage += HelpMessageOpt("-omnidbcache=<n>", "Size of the block cache shared by the Zus databases in megabytes (default: 32)");
+    strUsage += HelpMessageOpt("-omnidatadir=<dir>", "Store the Zus databases and state files in <dir> (default: the data directory)");
+    strUsage += HelpMessageOpt("-omnipersist", "Store the in-memory state in files while processing blocks (default: 1)");
+    strUsage += HelpMessageOpt("-omnitradearchivedepth=<n>", "Move matched trades older than <n> blocks into the trade archive, 0 to disable (default: 1000)");
+    strUsage += HelpMessageOpt("-omnithreads=<n>", "Number of threads used for the parallel parts of the Zus processing (default: number of cores)");
 
     return strUsage;
 }
@@ -877,6 +892,9 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     if (GetArg("-prune", 0)) {
         if (GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        // Pruned block files must not be deleted before the chainstate that no longer needs them is on disk
+        if (GetBoolArg("-dbflushbackground", DEFAULT_DB_FLUSH_BACKGROUND))
+            return InitError(_("Prune mode is incompatible with -dbflushbackground."));
 #ifdef ENABLE_WALLET
         if (GetBoolArg("-rescan", false)) {
             return InitError(_("Rescans are not possible in pruned mode. You will need to use -reindex which will download the whole blockchain again."));
@@ -951,6 +969,8 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
 
+    nMessageHandlerThreads = std::max(1, std::min((int)GetArg("-msghandthreads", DEFAULT_MSGHAND_THREADS), MAX_MSGHAND_THREADS));
+
     fServer = GetBoolArg("-server", false);
 
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
@@ -1067,6 +1087,9 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
 
     // ********************************************************* Step 4: application initialization: dir lock, daemonize, pidfile, debug log
 
+    // Select the SHA256 implementation before anything is hashed
+    std::string strSHA256Algo = SHA256AutoDetect();
+
     // Initialize elliptic curve code
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
@@ -1105,12 +1128,22 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     LogPrintf("Using data directory %s\n", strDataDir);
     LogPrintf("Using config file %s\n", GetConfigFile().string());
     LogPrintf("Using at most %i connections (%i file descriptors available)\n", nMaxConnections, nFD);
+    LogPrintf("Using %d message handler threads\n", nMessageHandlerThreads);
+
+    std::string strQuarkAlgo = QuarkAutoDetect();
+    LogPrintf("Using the '%s' Quark implementation\n", strQuarkAlgo);
+    LogPrintf("Using the '%s' SHA256 implementation\n", strSHA256Algo);
+
     std::ostringstream strErrors;
 
+    InitSignatureCache();
+
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
         for (int i=0; i<nScriptCheckThreads-1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
+        for (int i=0; i<nScriptCheckThreads-1; i++)
+            threadGroup.create_thread(&ThreadPoWCheck);
     }
 
     // Start the lightweight task scheduler thread
@@ -1318,6 +1351,10 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     LogPrintf("* Using %.1fMiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set\n", nCoinCacheUsage * (1.0 / 1024 / 1024));
+    bool fFlushBackground = GetBoolArg("-dbflushbackground", DEFAULT_DB_FLUSH_BACKGROUND);
+    int64_t nFlushBatch = std::max((int64_t)1, GetArg("-dbflushbatch", nDefaultDbFlushBatch)) << 20;
+    if (fFlushBackground)
+        LogPrintf("* Flushing the UTXO set in the background, in batches of up to %.1fMiB\n", nFlushBatch * (1.0 / 1024 / 1024));
 
     bool fLoaded = false;
     while (!fLoaded) {
@@ -1337,6 +1374,8 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
 
                 pblocktree = new CBlockTreeDB(nBlockTreeDBCache, false, fReindex);
                 pcoinsdbview = new CCoinsViewDB(nCoinDBCache, false, fReindex || fReindexChainState);
+                if (fFlushBackground)
+                    pcoinsdbview->StartBackgroundFlush(nFlushBatch);
                 pcoinscatcher = new CCoinsViewErrorCatcher(pcoinsdbview);
                 pcoinsTip = new CCoinsViewCache(pcoinscatcher);
 
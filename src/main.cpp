@@ -2288,6 +2288,53 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+static CCheckQueue<CPoWCheck> powcheckqueue(16);
+/** The queue has a single master, and headers may arrive on several message handler threads */
+static CCriticalSection cs_powcheckqueue;
+
+void ThreadPoWCheck() {
+    RenameThread("zurcoin-powch");
+    powcheckqueue.Thread();
+}
+
+bool CPoWCheck::operator()() {
+    CBlockHeader::PrecomputeHashes(pheaders, nCount);
+    for (size_t i = 0; i < nCount; i++) {
+        if (!CheckProofOfWork(pheaders[i].GetHash(), pheaders[i].nBits, *pparams))
+            return false;
+    }
+    return true;
+}
+
+/** Number of headers verified by a single CPoWCheck */
+static const size_t POW_CHECK_BATCH_SIZE = 32;
+
+/**
+ * Check the proof-of-work of many headers, using the proof-of-work checking
+ * threads if available. The hashes are added to the cache of header hashes.
+ */
+static bool CheckHeadersProofOfWork(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams)
+{
+    std::vector<CPoWCheck> vChecks;
+    vChecks.reserve((headers.size() + POW_CHECK_BATCH_SIZE - 1) / POW_CHECK_BATCH_SIZE);
+    for (size_t i = 0; i < headers.size(); i += POW_CHECK_BATCH_SIZE) {
+        vChecks.push_back(CPoWCheck(&headers[i], std::min(POW_CHECK_BATCH_SIZE, headers.size() - i), consensusParams));
+    }
+
+    if (nScriptCheckThreads == 0) {
+        for (size_t i = 0; i < vChecks.size(); i++) {
+            if (!vChecks[i]())
+                return false;
+        }
+        return true;
+    }
+
+    LOCK(cs_powcheckqueue);
+    CCheckQueueControl<CPoWCheck> control(&powcheckqueue);
+    control.Add(vChecks);
+    return control.Wait();
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -4800,6 +4847,80 @@ bool static AlreadyHave(const CInv& inv) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
     return true;
 }
 
+/**
+ * Verify the scripts of a transaction received from a peer before cs_main is
+ * taken for AcceptToMemoryPool, so that the valid signatures are found in the
+ * signature cache there. Only the cheap checks of AcceptToMemoryPool are done
+ * under the lock, and transactions that fail them are not verified at all, so
+ * that a peer can't make us verify scripts that would be rejected anyway.
+ * Coins that were not cached are uncached again.
+ */
+bool WarmSignatureCache(const CTransaction& tx)
+{
+    CValidationState state;
+    if (tx.IsCoinBase() || !CheckTransaction(tx, state))
+        return false;
+
+    std::vector<CTxOut> vSpent;
+    {
+        LOCK2(cs_main, mempool.cs);
+        if (AlreadyHave(CInv(MSG_TX, tx.GetHash())))
+            return false;
+        bool witnessEnabled = IsWitnessEnabled(chainActive.Tip(), Params().GetConsensus());
+        if (!tx.wit.IsNull() && !witnessEnabled)
+            return false;
+        string reason;
+        if (fRequireStandard && !IsStandardTx(tx, reason, witnessEnabled))
+            return false;
+        if (!CheckFinalTx(tx, STANDARD_LOCKTIME_VERIFY_FLAGS))
+            return false;
+        // Replacements are rare, they are left to AcceptToMemoryPool
+        BOOST_FOREACH(const CTxIn& txin, tx.vin) {
+            if (mempool.mapNextTx.count(txin.prevout))
+                return false;
+        }
+
+        CCoinsView dummy;
+        CCoinsViewCache view(&dummy);
+        CCoinsViewMemPool viewMemPool(pcoinsTip, mempool);
+        view.SetBackend(viewMemPool);
+        std::vector<uint256> vHashToUncache;
+        BOOST_FOREACH(const CTxIn& txin, tx.vin) {
+            if (!pcoinsTip->HaveCoinsInCache(txin.prevout.hash))
+                vHashToUncache.push_back(txin.prevout.hash);
+        }
+        bool fHaveInputs = view.HaveInputs(tx);
+        view.SetBackend(dummy);
+        BOOST_FOREACH(const uint256& hash, vHashToUncache)
+            pcoinsTip->Uncache(hash);
+        if (!fHaveInputs)
+            return false;
+
+        if (fRequireStandard && (!AreInputsStandard(tx, view) || (!tx.wit.IsNull() && !IsWitnessStandard(tx, view))))
+            return false;
+        int64_t nSigOpsCost = GetTransactionSigOpCost(tx, view, STANDARD_SCRIPT_VERIFY_FLAGS);
+        if (nSigOpsCost > MAX_STANDARD_TX_SIGOPS_COST)
+            return false;
+        // Free and low fee transactions may still be accepted by priority, but they aren't verified early
+        CAmount nFees = view.GetValueIn(tx) - tx.GetValueOut();
+        int64_t nSize = GetVirtualTransactionSize(tx, nSigOpsCost);
+        if (nFees < ::minRelayTxFee.GetFee(nSize) || nFees < mempool.GetMinFee(GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000).GetFee(nSize))
+            return false;
+
+        vSpent.reserve(tx.vin.size());
+        BOOST_FOREACH(const CTxIn& txin, tx.vin)
+            vSpent.push_back(view.GetOutputFor(txin));
+    }
+
+    PrecomputedTransactionData txdata(tx);
+    for (unsigned int i = 0; i < tx.vin.size(); i++) {
+        const CScriptWitness* witness = i < tx.wit.vtxinwit.size() ? &tx.wit.vtxinwit[i].scriptWitness : NULL;
+        if (!VerifyScript(tx.vin[i].scriptSig, vSpent[i].scriptPubKey, witness, STANDARD_SCRIPT_VERIFY_FLAGS, CachingTransactionSignatureChecker(&tx, i, vSpent[i].nValue, true, txdata)))
+            return false;
+    }
+    return true;
+}
+
 void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParams)
 {
     std::deque<CInv>::iterator it = pfrom->vRecvGetData.begin();
@@ -5541,6 +5662,10 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
         CInv inv(MSG_TX, tx.GetHash());
         pfrom->AddInventoryKnown(inv);
 
+        // Do the expensive script checks while the peers of the other handler threads can use cs_main
+        if (nMessageHandlerThreads > 1)
+            WarmSignatureCache(tx);
+
         LOCK(cs_main);
 
         bool fMissingInputs = false;
@@ -5955,6 +6080,15 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
             ReadCompactSize(vRecv); // ignore tx count; assume it is 0.
         }
 
+        // Check the proof-of-work of all headers in parallel and outside of cs_main, and
+        // cache their hashes. A single invalid header rejects the whole message, and the
+        // peer is punished as for a header with a high hash in CheckBlockHeader.
+        if (!CheckHeadersProofOfWork(headers, chainparams.GetConsensus())) {
+            LOCK(cs_main);
+            Misbehaving(pfrom->GetId(), 50);
+            return error("headers message with invalid proof-of-work (peer=%d)", pfrom->id);
+        }
+
         {
         LOCK(cs_main);
 
@@ -6134,7 +6268,10 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
         }
         pfrom->fSentAddr = true;
 
-        pfrom->vAddrToSend.clear();
+        {
+            LOCK(pfrom->cs_addrSend);
+            pfrom->vAddrToSend.clear();
+        }
         vector<CAddress> vAddr = addrman.GetAddr();
         BOOST_FOREACH(const CAddress &addr, vAddr)
             pfrom->PushAddress(addr);
@@ -6545,27 +6682,26 @@ bool SendMessages(CNode* pto)
         if (pto->nNextAddrSend < nNow) {
             pto->nNextAddrSend = PoissonNextSend(nNow, AVG_ADDRESS_BROADCAST_INTERVAL);
             vector<CAddress> vAddr;
-            vAddr.reserve(pto->vAddrToSend.size());
-            BOOST_FOREACH(const CAddress& addr, pto->vAddrToSend)
             {
-                if (!pto->addrKnown.contains(addr.GetKey()))
+                LOCK(pto->cs_addrSend);
+                vAddr.reserve(pto->vAddrToSend.size());
+                BOOST_FOREACH(const CAddress& addr, pto->vAddrToSend)
                 {
-                    pto->addrKnown.insert(addr.GetKey());
-                    vAddr.push_back(addr);
-                    // receiver rejects addr messages larger than 1000
-                    if (vAddr.size() >= 1000)
+                    if (!pto->addrKnown.contains(addr.GetKey()))
                     {
-                        pto->PushMessage(NetMsgType::ADDR, vAddr);
-                        vAddr.clear();
+                        pto->addrKnown.insert(addr.GetKey());
+                        vAddr.push_back(addr);
                     }
                 }
+                pto->vAddrToSend.clear();
+                // we only send the big addr message once
+                if (pto->vAddrToSend.capacity() > 40)
+                    pto->vAddrToSend.shrink_to_fit();
+            }
+            // receiver rejects addr messages larger than 1000
+            for (size_t i = 0; i < vAddr.size(); i += 1000) {
+                pto->PushMessage(NetMsgType::ADDR, vector<CAddress>(vAddr.begin() + i, vAddr.begin() + std::min(i + 1000, vAddr.size())));
             }
-            pto->vAddrToSend.clear();
-            if (!vAddr.empty())
-                pto->PushMessage(NetMsgType::ADDR, vAddr);
-            // we only send the big addr message once
-            if (pto->vAddrToSend.capacity() > 40)
-                pto->vAddrToSend.shrink_to_fit();
         }
 
         CNodeState &state = *State(pto->GetId());
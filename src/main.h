@@ -254,6 +254,8 @@ bool ProcessMessages(CNode* pfrom);
 bool SendMessages(CNode* pto);
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the proof-of-work checking thread */
+void ThreadPoWCheck();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Format a string that describes several potential problems detected by the core.
@@ -307,6 +309,13 @@ void FlushStateToDisk();
 /** Prune block files and flush state to disk. */
 void PruneAndFlush();
 
+/**
+ * Verify the scripts of a transaction from a peer without holding cs_main, if it
+ * passes the cheap checks of AcceptToMemoryPool, and store the valid signatures
+ * in the signature cache. Returns whether the scripts were verified and valid.
+ */
+bool WarmSignatureCache(const CTransaction& tx);
+
 /** (try to) add transaction to memory pool **/
 bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransaction &tx, bool fLimitFree,
                         bool* pfMissingInputs, bool fOverrideMempoolLimit=false, const CAmount nAbsurdFee=0);
@@ -442,6 +451,33 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
+/**
+ * Closure representing the proof-of-work check of a range of block headers.
+ * The hashes are looked up in the shared cache of header hashes, which
+ * CBlockHeader::PrecomputeHashes fills, so only the range of headers itself
+ * must outlive the check.
+ */
+class CPoWCheck
+{
+private:
+    const CBlockHeader *pheaders;
+    size_t nCount;
+    const Consensus::Params *pparams;
+
+public:
+    CPoWCheck(): pheaders(NULL), nCount(0), pparams(NULL) {}
+    CPoWCheck(const CBlockHeader* pheadersIn, size_t nCountIn, const Consensus::Params& paramsIn) :
+        pheaders(pheadersIn), nCount(nCountIn), pparams(&paramsIn) { }
+
+    bool operator()();
+
+    void swap(CPoWCheck &check) {
+        std::swap(pheaders, check.pheaders);
+        std::swap(nCount, check.nCount);
+        std::swap(pparams, check.pparams);
+    }
+};
+
 
 /** Functions for disk access for blocks */
 bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
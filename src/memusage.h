@@ -5,7 +5,9 @@
 #ifndef BITCOIN_MEMUSAGE_H
 #define BITCOIN_MEMUSAGE_H
 
+#include "flatmap.h"
 #include "indirectmap.h"
+#include "prevector.h"
 
 #include <stdlib.h>
 
@@ -146,6 +148,12 @@ static inline size_t DynamicUsage(const std::shared_ptr<X>& p)
     return p ? MallocUsage(sizeof(X)) + MallocUsage(sizeof(stl_shared_counter)) : 0;
 }
 
+template<typename X, typename Y, typename Z>
+static inline size_t DynamicUsage(const flatmap<X, Y, Z>& m)
+{
+    return MallocUsage(sizeof(typename flatmap<X, Y, Z>::slot) * m.bucket_count()) + MallocUsage(sizeof(void*) * m.chunk_capacity()) + MallocUsage(flatmap<X, Y, Z>::chunk_bytes()) * m.chunk_count();
+}
+
 // Boost data structures
 
 template<typename X>
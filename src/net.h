@@ -65,6 +65,10 @@ static const size_t MAPASKFOR_MAX_SZ = MAX_INV_SZ;
 static const size_t SETASKFOR_MAX_SZ = 2 * MAX_INV_SZ;
 /** The maximum number of peer connections to maintain. */
 static const unsigned int DEFAULT_MAX_PEER_CONNECTIONS = 125;
+/** The default number of message handler threads */
+static const int DEFAULT_MSGHAND_THREADS = 1;
+/** The maximum number of message handler threads */
+static const int MAX_MSGHAND_THREADS = 16;
 /** The default for -maxuploadtarget. 0 = Unlimited */
 static const uint64_t DEFAULT_MAX_UPLOAD_TARGET = 0;
 /** Default for blocks only*/
@@ -166,6 +170,9 @@ extern CAddrMan addrman;
 /** Maximum number of connections to simultaneously allow (aka connection slots) */
 extern int nMaxConnections;
 
+/** Number of message handler threads. Every peer is handled by one of them, so its messages stay in order. */
+extern int nMessageHandlerThreads;
+
 extern std::vector<CNode*> vNodes;
 extern CCriticalSection cs_vNodes;
 extern limitedmap<uint256, int64_t> mapAlreadyAskedFor;
@@ -396,8 +403,10 @@ public:
     int nStartingHeight;
 
     // flood relay
-    std::vector<CAddress> vAddrToSend;
-    CRollingBloomFilter addrKnown;
+    // Addresses are relayed to a peer from the threads handling other peers
+    CCriticalSection cs_addrSend;
+    std::vector<CAddress> vAddrToSend; // protected by cs_addrSend
+    CRollingBloomFilter addrKnown; // protected by cs_addrSend
     bool fGetAddr;
     std::set<uint256> setKnown;
     int64_t nNextAddrSend;
@@ -514,6 +523,7 @@ public:
 
     void AddAddressKnown(const CAddress& addr)
     {
+        LOCK(cs_addrSend);
         addrKnown.insert(addr.GetKey());
     }
 
@@ -522,6 +532,7 @@ public:
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
+        LOCK(cs_addrSend);
         if (addr.IsValid() && !addrKnown.contains(addr.GetKey())) {
             if (vAddrToSend.size() >= MAX_ADDR_TO_SEND) {
                 vAddrToSend[insecure_rand() % vAddrToSend.size()] = addr;
@@ -10,10 +10,115 @@
 #include "tinyformat.h"
 #include "utilstrencodings.h"
 #include "crypto/common.h"
+#include "crypto/quark.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <mutex>
+#include <vector>
+
+namespace {
+//! Size of the serialized header, which is hashed
+static const size_t HEADER_SIZE = 80;
+
+/**
+ * Recently computed hashes of block headers, shared by all threads.
+ *
+ * Headers are hashed several times during validation, e.g. by the threads
+ * checking the proof-of-work of a headers message, and again when each of them
+ * is accepted. Entries are looked up by all bytes of the header, so a modified
+ * header never yields a stale hash. The cache is direct mapped, and each group
+ * of entries is guarded by its own lock.
+ */
+class CHeaderHashCache
+{
+private:
+    //! Enough for the headers of a full headers message, with few collisions
+    static const size_t NUM_ENTRIES = 8192;
+    static const size_t NUM_LOCKS = 64;
+
+    struct Entry
+    {
+        unsigned char header[HEADER_SIZE];
+        unsigned char hash[32];
+        bool fValid;
+    };
+
+    Entry entries[NUM_ENTRIES];
+    std::mutex locks[NUM_LOCKS];
+
+    static size_t GetIndex(const unsigned char* header)
+    {
+        // part of the merkle root, mixed with the nonce, which changes while mining
+        return (ReadLE32(header + 36) ^ ReadLE32(header + 76)) % NUM_ENTRIES;
+    }
+
+public:
+    bool Get(const unsigned char* header, uint256& hash)
+    {
+        size_t nIndex = GetIndex(header);
+        std::lock_guard<std::mutex> lock(locks[nIndex % NUM_LOCKS]);
+        const Entry& entry = entries[nIndex];
+        if (!entry.fValid || memcmp(entry.header, header, HEADER_SIZE) != 0) {
+            return false;
+        }
+        memcpy(hash.begin(), entry.hash, 32);
+        return true;
+    }
+
+    void Set(const unsigned char* header, const unsigned char* hash)
+    {
+        size_t nIndex = GetIndex(header);
+        std::lock_guard<std::mutex> lock(locks[nIndex % NUM_LOCKS]);
+        Entry& entry = entries[nIndex];
+        memcpy(entry.header, header, HEADER_SIZE);
+        memcpy(entry.hash, hash, 32);
+        entry.fValid = true;
+    }
+};
+
+CHeaderHashCache& GetHeaderHashCache()
+{
+    // constructed on first use, since headers are already hashed during static
+    // initialization; as a static object, all entries start zeroed, i.e. invalid
+    static CHeaderHashCache cache;
+    return cache;
+}
+}
 
 uint256 CBlockHeader::GetHash() const
 {
-    return HashQuark(BEGIN(nVersion), END(nNonce));
+    assert(END(nNonce) - BEGIN(nVersion) == HEADER_SIZE);
+    const unsigned char* header = (const unsigned char*) BEGIN(nVersion);
+
+    uint256 hash;
+    if (GetHeaderHashCache().Get(header, hash)) {
+        return hash;
+    }
+
+    hash = HashQuark(BEGIN(nVersion), END(nNonce));
+    GetHeaderHashCache().Set(header, hash.begin());
+
+    return hash;
+}
+
+void CBlockHeader::PrecomputeHashes(const CBlockHeader* pheaders, size_t nCount)
+{
+    if (nCount == 0) return;
+
+    std::vector<unsigned char> vInput(HEADER_SIZE * nCount);
+    std::vector<unsigned char> vOutput(32 * nCount);
+    for (size_t i = 0; i < nCount; ++i) {
+        memcpy(&vInput[HEADER_SIZE * i], BEGIN(pheaders[i].nVersion), HEADER_SIZE);
+    }
+
+    Quark80(&vOutput[0], &vInput[0], nCount);
+
+    CHeaderHashCache& cache = GetHeaderHashCache();
+    for (size_t i = 0; i < nCount; ++i) {
+        cache.Set(&vInput[HEADER_SIZE * i], &vOutput[32 * i]);
+    }
 }
 
 std::string CBlock::ToString() const
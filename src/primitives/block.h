@@ -60,8 +60,25 @@ public:
         return (nBits == 0);
     }
 
+    /**
+     * Returns the Quark hash of the header.
+     *
+     * Recently computed hashes are kept in a cache shared by all threads, which
+     * is looked up by all header fields, so the fields can still be modified
+     * directly, e.g. by the miner's nonce loop.
+     */
     uint256 GetHash() const;
 
+    /**
+     * Computes the hashes of many headers at once, which is faster than
+     * hashing them one by one, and adds them to the cache of header hashes.
+     */
+    static void PrecomputeHashes(const CBlockHeader* pheaders, size_t nCount);
+    static void PrecomputeHashes(const std::vector<CBlockHeader>& headers)
+    {
+        if (!headers.empty()) PrecomputeHashes(&headers[0], headers.size());
+    }
+
     int64_t GetBlockTime() const
     {
         return (int64_t)nTime;
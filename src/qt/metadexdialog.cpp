@@ -27,6 +27,7 @@
 #include "zurbank/walletutils.h"
 
 #include "amount.h"
+#include "rpc/jsonstream.h"
 #include "sync.h"
 #include "uint256.h"
 // TODO #include "wallet_ismine.h"
@@ -34,6 +35,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/rational.hpp>
 
+#include <assert.h>
 #include <stdint.h>
 #include <map>
 #include <sstream>
@@ -350,36 +352,39 @@ void MetaDExDialog::UpdateOffers()
     bool divisSale = isPropertyDivisible(GetPropForSale());
     bool divisDes = isPropertyDivisible(GetPropDesired());
 
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        if ((my_it->first != GetPropForSale())) continue; // not the property we're looking for, don't waste any more work
-        md_PricesMap & prices = my_it->second;
-        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) { // loop through the sell prices for the property
-            std::string unitPriceStr;
-            bool includesMe = false;
-            md_Set & indexes = (it->second);
-            for (md_Set::iterator it = indexes.begin(); it != indexes.end(); ++it) { // multiple sell offers can exist at the same price, sum them for the UI
-                const CMPMetaDEx& obj = *it;
-                if ((obj.getDesProperty() != GetPropDesired())) continue; // not the property we're interested in
-                if (IsMyAddress(obj.getAddr())) includesMe = true;
-                std::string strAvail;
-                if (divisSale) {
-                    strAvail = FormatDivisibleShortMP(obj.getAmountRemaining());
-                } else {
-                    strAvail = FormatIndivisibleMP(obj.getAmountRemaining());
-                }
-                std::string strDesired;
-                if (divisDes) {
-                    strDesired = FormatDivisibleShortMP(obj.getAmountToFill());
-                } else {
-                    strDesired = FormatIndivisibleMP(obj.getAmountToFill());
-                }
-                std::string priceStr = StripTrailingZeros(obj.displayFullUnitPrice());
-                if (priceStr.length() > 10) {
-                    priceStr.resize(10); // keep price in UI managable
-                    priceStr += "...";
-                }
-                AddRow(includesMe, obj.getHash().GetHex(), obj.getAddr(), priceStr, strAvail, strDesired);
+    // the aggregated depth tells which price levels hold orders of this market, without scanning the others
+    std::vector<CMPMetaDExLevel> vLevels;
+    MetaDEx_getDepth(GetPropForSale(), GetPropDesired(), 0, vLevels);
+    if (vLevels.empty()) return;
+
+    md_PricesMap* prices = get_Prices(GetPropForSale());
+    assert(prices != NULL);
+
+    for (std::vector<CMPMetaDExLevel>::const_iterator itLevel = vLevels.begin(); itLevel != vLevels.end(); ++itLevel) { // loop through the sell prices for the pair
+        md_Set* indexes = get_Indexes(prices, itLevel->price);
+        assert(indexes != NULL);
+        for (md_Set::iterator it = indexes->begin(); it != indexes->end(); ++it) { // multiple sell offers can exist at the same price
+            const CMPMetaDEx& obj = *it;
+            if ((obj.getDesProperty() != GetPropDesired())) continue; // not the property we're interested in
+            bool includesMe = IsMyAddress(obj.getAddr());
+            std::string strAvail;
+            if (divisSale) {
+                strAvail = FormatDivisibleShortMP(obj.getAmountRemaining());
+            } else {
+                strAvail = FormatIndivisibleMP(obj.getAmountRemaining());
+            }
+            std::string strDesired;
+            if (divisDes) {
+                strDesired = FormatDivisibleShortMP(obj.getAmountToFill());
+            } else {
+                strDesired = FormatIndivisibleMP(obj.getAmountToFill());
             }
+            std::string priceStr = StripTrailingZeros(obj.displayFullUnitPrice());
+            if (priceStr.length() > 10) {
+                priceStr.resize(10); // keep price in UI managable
+                priceStr += "...";
+            }
+            AddRow(includesMe, obj.getHash().GetHex(), obj.getAddr(), priceStr, strAvail, strDesired);
         }
     }
 }
@@ -440,9 +445,14 @@ void MetaDExDialog::ShowDetails()
 void MetaDExDialog::ShowHistory()
 {
     UniValue history(UniValue::VARR);
-    LOCK(cs_tally);
-    pDbTradeList->getTradesForPair(GetPropForSale(), GetPropDesired(), history, 50);
+    bool fComplete = false;
+    {
+        JSONStreamWriter writer(history);
+        LOCK(cs_tally);
+        fComplete = pDbTradeList->getTradesForPair(GetPropForSale(), GetPropDesired(), writer, 50);
+    }
     std::string strHistory = history.write(true);
+    if (!fComplete) strHistory = "Potential database corruption: Archived trades can't be read";
 
     if (!strHistory.empty()) {
         PopulateSimpleDialog(strHistory, "Trade History", "Trade History");
@@ -13,6 +13,7 @@
 #include "policy/policy.h"
 #include "primitives/transaction.h"
 #include "rpc/server.h"
+#include "script/sigcache.h"
 #include "streams.h"
 #include "sync.h"
 #include "txmempool.h"
@@ -1113,6 +1114,10 @@ UniValue mempoolInfoToJSON()
     size_t maxmempool = GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
     ret.push_back(Pair("maxmempool", (int64_t) maxmempool));
     ret.push_back(Pair("mempoolminfee", ValueFromAmount(mempool.GetMinFee(maxmempool).GetFeePerK())));
+    SignatureCacheStats sigcache = GetSignatureCacheStats();
+    ret.push_back(Pair("sigcachesize", sigcache.nCapacity));
+    ret.push_back(Pair("sigcachelookups", sigcache.nLookups));
+    ret.push_back(Pair("sigcachehits", sigcache.nHits));
 
     return ret;
 }
@@ -1129,7 +1134,10 @@ UniValue getmempoolinfo(const UniValue& params, bool fHelp)
             "  \"bytes\": xxxxx,              (numeric) Sum of all tx sizes\n"
             "  \"usage\": xxxxx,              (numeric) Total memory usage for the mempool\n"
             "  \"maxmempool\": xxxxx,         (numeric) Maximum memory usage for the mempool\n"
-            "  \"mempoolminfee\": xxxxx       (numeric) Minimum fee for tx to be accepted\n"
+            "  \"mempoolminfee\": xxxxx,      (numeric) Minimum fee for tx to be accepted\n"
+            "  \"sigcachesize\": xxxxx,       (numeric) Number of signatures the signature cache can hold\n"
+            "  \"sigcachelookups\": xxxxx,    (numeric) Number of signature cache lookups since startup\n"
+            "  \"sigcachehits\": xxxxx        (numeric) Number of those lookups that found a verified signature\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getmempoolinfo", "")
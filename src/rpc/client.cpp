@@ -113,22 +113,39 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "zus_gettradehistoryforpair", 0 },
     { "zus_gettradehistoryforpair", 1 },
     { "zus_gettradehistoryforpair", 2 },
+    { "zus_gettradehistoryforpair", 3 },
+    { "zus_gettradecandles", 0 },
+    { "zus_gettradecandles", 1 },
+    { "zus_gettradecandles", 2 },
+    { "zus_gettradecandles", 3 },
+    { "zus_gettradecandles", 4 },
     { "zus_setautocommit", 0 },
     { "zus_getcrowdsale", 0 },
     { "zus_getcrowdsale", 1 },
     { "zus_getgrants", 0 },
     { "zus_getbalance", 1 },
+    { "zus_getbalance", 2 },
+    { "zus_getbalances", 0 },
+    { "zus_getbalances", 1 },
     { "zus_getproperty", 0 },
     { "zus_listtransactions", 1 },
     { "zus_listtransactions", 2 },
     { "zus_listtransactions", 3 },
     { "zus_listtransactions", 4 },
     { "zus_getallbalancesforid", 0 },
+    { "zus_getallbalancesforid", 1 },
+    { "zus_getallbalancesforid", 2 },
     { "zus_listblocktransactions", 0 },
     { "zus_listblockstransactions", 0 },
     { "zus_listblockstransactions", 1 },
     { "zus_getorderbook", 0 },
     { "zus_getorderbook", 1 },
+    { "zus_getorderbook", 2 },
+    { "zus_getorderbook", 3 },
+    { "zus_getorderbookdepth", 0 },
+    { "zus_getorderbookdepth", 1 },
+    { "zus_getorderbookdepth", 2 },
+    { "zus_getperfstats", 0 },
     { "zus_getseedblocks", 0 },
     { "zus_getseedblocks", 1 },
     { "zus_getmetadexhash", 0 },
@@ -143,6 +160,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
 
     /* ZURBank - transaction calls */
     { "zus_send", 2 },
+    { "zus_sendmany", 0 },
     { "zus_sendsto", 1 },
     { "zus_sendsto", 4 },
     { "zus_sendall", 2 },
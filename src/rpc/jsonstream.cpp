@@ -0,0 +1,231 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/jsonstream.h"
+
+#include "tinyformat.h"
+
+#include <assert.h>
+
+JSONStreamWriter::JSONStreamWriter(const Sink& sinkIn, size_t nChunkSizeIn) :
+    sink(sinkIn), nChunkSize(nChunkSizeIn), fFlushed(false), fAfterKey(false), pResult(NULL)
+{
+    strBuffer.reserve(nChunkSize < DEFAULT_JSON_STREAM_CHUNK_SIZE ? nChunkSize : DEFAULT_JSON_STREAM_CHUNK_SIZE);
+}
+
+JSONStreamWriter::JSONStreamWriter(UniValue& result) :
+    nChunkSize(0), fFlushed(false), fAfterKey(false), pResult(&result)
+{
+    pResult->setNull();
+}
+
+void JSONStreamWriter::BeginContainer(UniValue::VType type)
+{
+    if (vHasElements.empty()) {
+        // the outermost array or object is built in place
+        *pResult = UniValue(type);
+    } else {
+        vOpen.push_back(UniValue(type));
+        vOpenKeys.push_back(strKey);
+    }
+    fAfterKey = false;
+    vHasElements.push_back(false);
+}
+
+void JSONStreamWriter::EndContainer()
+{
+    assert(!vHasElements.empty() && !fAfterKey);
+    vHasElements.pop_back();
+    if (vHasElements.empty()) return;
+
+    UniValue value = vOpen.back();
+    vOpen.pop_back();
+    strKey = vOpenKeys.back();
+    vOpenKeys.pop_back();
+    Append(value);
+}
+
+void JSONStreamWriter::Append(const UniValue& value)
+{
+    fAfterKey = false;
+    if (vHasElements.empty()) {
+        *pResult = value;
+        return;
+    }
+    UniValue& parent = vOpen.empty() ? *pResult : vOpen.back();
+    if (parent.isObject()) {
+        parent.pushKV(strKey, value);
+    } else {
+        parent.push_back(value);
+    }
+}
+
+void JSONStreamWriter::Separate()
+{
+    if (fAfterKey) {
+        fAfterKey = false;
+        return;
+    }
+    if (!vHasElements.empty()) {
+        if (vHasElements.back()) strBuffer += ',';
+        vHasElements.back() = true;
+    }
+}
+
+void JSONStreamWriter::MaybeFlush()
+{
+    // only flush between tokens, and never between a key and its value
+    if (!fAfterKey && strBuffer.size() >= nChunkSize) Flush();
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    if (pResult) {
+        BeginContainer(UniValue::VOBJ);
+        return;
+    }
+    Separate();
+    strBuffer += '{';
+    vHasElements.push_back(false);
+}
+
+void JSONStreamWriter::EndObject()
+{
+    if (pResult) {
+        EndContainer();
+        return;
+    }
+    assert(!vHasElements.empty() && !fAfterKey);
+    vHasElements.pop_back();
+    strBuffer += '}';
+    MaybeFlush();
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    if (pResult) {
+        BeginContainer(UniValue::VARR);
+        return;
+    }
+    Separate();
+    strBuffer += '[';
+    vHasElements.push_back(false);
+}
+
+void JSONStreamWriter::EndArray()
+{
+    if (pResult) {
+        EndContainer();
+        return;
+    }
+    assert(!vHasElements.empty() && !fAfterKey);
+    vHasElements.pop_back();
+    strBuffer += ']';
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Key(const std::string& key)
+{
+    assert(!vHasElements.empty() && !fAfterKey);
+    if (pResult) {
+        strKey = key;
+        fAfterKey = true;
+        return;
+    }
+    Separate();
+    strBuffer += UniValue(key).write();
+    strBuffer += ':';
+    fAfterKey = true;
+}
+
+void JSONStreamWriter::Value(const std::string& value)
+{
+    if (pResult) {
+        Append(UniValue(value));
+        return;
+    }
+    Separate();
+    strBuffer += UniValue(value).write();
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Value(const char* value)
+{
+    Value(std::string(value));
+}
+
+void JSONStreamWriter::Value(int64_t value)
+{
+    if (pResult) {
+        Append(UniValue(value));
+        return;
+    }
+    Separate();
+    strBuffer += strprintf("%d", value);
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Value(uint64_t value)
+{
+    if (pResult) {
+        Append(UniValue(value));
+        return;
+    }
+    Separate();
+    strBuffer += strprintf("%d", value);
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Value(int value)
+{
+    Value((int64_t) value);
+}
+
+void JSONStreamWriter::Value(bool value)
+{
+    if (pResult) {
+        Append(UniValue(value));
+        return;
+    }
+    Separate();
+    strBuffer += value ? "true" : "false";
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    if (pResult) {
+        Append(value);
+        return;
+    }
+    Separate();
+    strBuffer += value.write();
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Null()
+{
+    if (pResult) {
+        Append(NullUniValue);
+        return;
+    }
+    Separate();
+    strBuffer += "null";
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Raw(const std::string& data)
+{
+    assert(!pResult);
+    strBuffer += data;
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (pResult || strBuffer.empty()) return;
+    sink(strBuffer);
+    strBuffer.clear();
+    fFlushed = true;
+}
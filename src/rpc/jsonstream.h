@@ -0,0 +1,106 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSONSTREAM_H
+#define BITCOIN_RPC_JSONSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include <univalue.h>
+
+/** Default number of buffered bytes, before output is handed to the sink */
+static const size_t DEFAULT_JSON_STREAM_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * Incremental JSON writer.
+ *
+ * Output is produced token by token into an internal buffer, which is handed
+ * to the sink whenever it exceeds the chunk size. Large responses therefore
+ * never have to be materialized as a UniValue tree or as a single string.
+ *
+ * The buffer is only flushed between tokens, so a chunk never ends within a
+ * string or a multibyte character. Scalar values are written in the same
+ * format as UniValue::write().
+ *
+ * Alternatively the writer builds the result as UniValue, for callers which
+ * need the result as object anyway, e.g. batch requests or the GUI.
+ */
+class JSONStreamWriter
+{
+public:
+    typedef boost::function<void(const std::string&)> Sink;
+
+    JSONStreamWriter(const Sink& sink, size_t nChunkSize = DEFAULT_JSON_STREAM_CHUNK_SIZE);
+
+    /** Builds the result in the given UniValue, instead of writing to a sink. */
+    explicit JSONStreamWriter(UniValue& result);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    /** Writes an object key. It must be followed by exactly one value. */
+    void Key(const std::string& key);
+
+    void Value(const std::string& value);
+    void Value(const char* value);
+    void Value(int64_t value);
+    void Value(uint64_t value);
+    void Value(int value);
+    void Value(bool value);
+    void Value(const UniValue& value);
+    void Null();
+
+    /** Convenience wrapper for Key(), followed by Value(). */
+    template <typename T>
+    void Pair(const std::string& key, const T& value)
+    {
+        Key(key);
+        Value(value);
+    }
+
+    /** Appends raw, already encoded data, e.g. a trailing newline. Not supported, when building a UniValue. */
+    void Raw(const std::string& data);
+
+    /** Hands all buffered output to the sink. */
+    void Flush();
+
+    /** Whether any output was handed to the sink so far. */
+    bool HasFlushed() const { return fFlushed; }
+
+    /** Output not yet handed to the sink. */
+    const std::string& GetPending() const { return strBuffer; }
+
+private:
+    Sink sink;
+    size_t nChunkSize;
+    bool fFlushed;
+    bool fAfterKey;
+    std::string strBuffer;
+    //! One entry per open array or object, true once it holds an element
+    std::vector<bool> vHasElements;
+
+    //! The result, if a UniValue is built
+    UniValue* pResult;
+    //! The open arrays and objects below the result
+    std::vector<UniValue> vOpen;
+    //! The keys of the open objects and arrays in their parent objects
+    std::vector<std::string> vOpenKeys;
+    //! The key of the next value
+    std::string strKey;
+
+    void Separate();
+    void MaybeFlush();
+    void BeginContainer(UniValue::VType type);
+    void EndContainer();
+    void Append(const UniValue& value);
+};
+
+#endif // BITCOIN_RPC_JSONSTREAM_H
@@ -8,6 +8,7 @@
 #include "base58.h"
 #include "init.h"
 #include "random.h"
+#include "rpc/jsonstream.h"
 #include "sync.h"
 #include "ui_interface.h"
 #include "util.h"
@@ -447,6 +448,46 @@ UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params
     g_rpcSignals.PostCommand(*pcmd);
 }
 
+bool CRPCTable::executeStream(const std::string &strMethod, const UniValue &params, JSONStreamWriter& writer) const
+{
+    // Return immediately if in warmup
+    {
+        LOCK(cs_rpcWarmup);
+        if (fRPCInWarmup)
+            throw JSONRPCError(RPC_IN_WARMUP, rpcWarmupStatus);
+    }
+
+    // Find method, which supports streaming
+    const CRPCCommand *pcmd = tableRPC[strMethod];
+    if (!pcmd || !pcmd->streamActor)
+        return false;
+
+    g_rpcSignals.PreCommand(*pcmd);
+
+    try
+    {
+        // Execute
+        pcmd->streamActor(params, false, writer);
+    }
+    catch (const std::exception& e)
+    {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+
+    g_rpcSignals.PostCommand(*pcmd);
+
+    return true;
+}
+
+UniValue CallStreamingRPC(rpcstreamfn_type pfn, const UniValue& params, bool fHelp)
+{
+    UniValue result;
+    JSONStreamWriter writer(result);
+    (*pfn)(params, fHelp, writer);
+
+    return result;
+}
+
 std::vector<std::string> CRPCTable::listCommands() const
 {
     std::vector<std::string> commandList;
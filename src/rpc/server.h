@@ -33,6 +33,7 @@ namespace RPCServer
 
 class CBlockIndex;
 class CNetAddr;
+class JSONStreamWriter;
 
 /** Wrapper for UniValue::VType, which includes typeAny:
  * Used to denote don't care type. Only used by RPCTypeCheckObj */
@@ -125,6 +126,7 @@ void RPCUnsetTimerInterface(RPCTimerInterface *iface);
 void RPCRunLater(const std::string& name, boost::function<void(void)> func, int64_t nSeconds);
 
 typedef UniValue(*rpcfn_type)(const UniValue& params, bool fHelp);
+typedef void(*rpcstreamfn_type)(const UniValue& params, bool fHelp, JSONStreamWriter& writer);
 
 class CRPCCommand
 {
@@ -133,8 +135,18 @@ public:
     std::string name;
     rpcfn_type actor;
     bool okSafeMode;
+    //! Optional actor, which writes the result incrementally
+    rpcstreamfn_type streamActor;
 };
 
+/**
+ * Runs a streaming actor and collects its output into a UniValue.
+ *
+ * This is used to provide the regular actor of commands with a streaming
+ * actor, e.g. for batch requests or the GUI console.
+ */
+UniValue CallStreamingRPC(rpcstreamfn_type pfn, const UniValue& params, bool fHelp);
+
 /**
  * Bitcoin RPC command dispatcher.
  */
@@ -156,6 +168,16 @@ public:
      */
     UniValue execute(const std::string &method, const UniValue &params) const;
 
+    /**
+     * Execute a method, which supports streaming, and write the result.
+     * @param method   Method to execute
+     * @param params   UniValue Array of arguments (JSON objects)
+     * @param writer   Writer the result is written to
+     * @returns False, if the method doesn't exist or doesn't support streaming.
+     * @throws an exception (UniValue) when an error happens.
+     */
+    bool executeStream(const std::string &method, const UniValue &params, JSONStreamWriter& writer) const;
+
     /**
     * Returns a list of registered commands
     * @returns List of registered commands.
@@ -8,14 +8,50 @@
 
 #include "script/interpreter.h"
 
+#include <stdint.h>
+#include <string.h>
 #include <vector>
 
-// DoS prevention: limit cache size to less than 40MB (over 500000
+// DoS prevention: limit cache size to 40MB (over 1000000
 // entries on 64-bit systems).
 static const unsigned int DEFAULT_MAX_SIG_CACHE_SIZE = 40;
+// Maximum sig cache size allowed
+static const int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
 
 class CPubKey;
 
+/**
+ * We're hashing a nonce into the entries themselves, so we don't need extra
+ * blinding in the set hash computation.
+ *
+ * This may exhibit platform endian dependent behavior but because these are
+ * nonced hashes (random) and this state is only ever used locally it is safe.
+ * All that matters is local consistency.
+ */
+class SignatureCacheHasher
+{
+public:
+    template <uint8_t hash_select>
+    uint32_t operator()(const uint256& key) const
+    {
+        static_assert(hash_select < 8, "SignatureCacheHasher only has 8 hashes available.");
+        uint32_t u;
+        memcpy(&u, key.begin() + 4 * hash_select, 4);
+        return u;
+    }
+};
+
+/** Lookup statistics of the signature cache */
+struct SignatureCacheStats
+{
+    //! The number of signatures the cache can hold
+    uint64_t nCapacity;
+    //! The number of lookups
+    uint64_t nLookups;
+    //! The number of lookups that found the signature
+    uint64_t nHits;
+};
+
 class CachingTransactionSignatureChecker : public TransactionSignatureChecker
 {
 private:
@@ -27,4 +63,10 @@ public:
     bool VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& vchPubKey, const uint256& sighash) const;
 };
 
+/** Allocate the signature cache, as configured with -maxsigcachesize */
+void InitSignatureCache();
+
+/** Return the lookup statistics of the signature cache */
+SignatureCacheStats GetSignatureCacheStats();
+
 #endif // BITCOIN_SCRIPT_SIGCACHE_H
@@ -0,0 +1,96 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "checkqueue.h"
+#include "test/test_zurcoin.h"
+
+#include <atomic>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+namespace
+{
+/** A check, which counts its executions, and fails if requested. */
+class CountingCheck
+{
+private:
+    std::atomic<int>* pcount;
+    bool fOk;
+
+public:
+    CountingCheck() : pcount(NULL), fOk(true) {}
+    CountingCheck(std::atomic<int>* pcountIn, bool fOkIn) : pcount(pcountIn), fOk(fOkIn) {}
+
+    bool operator()()
+    {
+        ++*pcount;
+        return fOk;
+    }
+
+    void swap(CountingCheck& check)
+    {
+        std::swap(pcount, check.pcount);
+        std::swap(fOk, check.fOk);
+    }
+};
+
+/** Runs the checks with one counter per check, and fails the check at nFail, if any. */
+bool RunChecks(CCheckQueue<CountingCheck>& queue, std::vector<std::atomic<int> >& counts, int nFail)
+{
+    CCheckQueueControl<CountingCheck> control(&queue);
+    // Add the checks in groups of different sizes, like the inputs of transactions
+    for (size_t i = 0; i < counts.size(); ) {
+        std::vector<CountingCheck> vChecks;
+        for (size_t nEnd = std::min(counts.size(), i + 1 + i % 7); i < nEnd; i++) {
+            counts[i] = 0;
+            vChecks.push_back(CountingCheck(&counts[i], (int) i != nFail));
+        }
+        control.Add(vChecks);
+    }
+    return control.Wait();
+}
+}
+
+BOOST_FIXTURE_TEST_SUITE(checkqueue_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(checkqueue_threads)
+{
+    const int threads[] = {1, 2, 3, 4, 8, 16, 32};
+    for (size_t n = 0; n < sizeof(threads) / sizeof(threads[0]); n++) {
+        // The number of threads includes the master
+        CCheckQueue<CountingCheck> queue(16);
+        boost::thread_group threadGroup;
+        for (int i = 0; i < threads[n] - 1; i++)
+            threadGroup.create_thread(boost::bind(&CCheckQueue<CountingCheck>::Thread, boost::ref(queue)));
+
+        const size_t sizes[] = {0, 1, 2, 17, 1000, 10000};
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            std::vector<std::atomic<int> > counts(sizes[s]);
+
+            // every check is executed exactly once
+            BOOST_CHECK(RunChecks(queue, counts, -1));
+            for (size_t i = 0; i < counts.size(); i++)
+                BOOST_CHECK_EQUAL(counts[i].load(), 1);
+
+            // a single failure fails the whole run, and the remaining checks may be skipped
+            if (sizes[s] > 0) {
+                BOOST_CHECK(!RunChecks(queue, counts, sizes[s] / 2));
+                BOOST_CHECK_EQUAL(counts[sizes[s] / 2].load(), 1);
+                for (size_t i = 0; i < counts.size(); i++)
+                    BOOST_CHECK(counts[i].load() <= 1);
+            }
+
+            // the failure is not carried over to the next run
+            BOOST_CHECK(RunChecks(queue, counts, -1));
+        }
+
+        threadGroup.interrupt_all();
+        threadGroup.join_all();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
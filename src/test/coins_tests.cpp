@@ -5,6 +5,7 @@
 #include "coins.h"
 #include "random.h"
 #include "script/standard.h"
+#include "txdb.h"
 #include "uint256.h"
 #include "utilstrencodings.h"
 #include "test/test_zurcoin.h"
@@ -65,6 +66,16 @@ public:
     }
 };
 
+/** Coin database which gives access to its journal */
+class CCoinsViewDBTest : public CCoinsViewDB
+{
+public:
+    CCoinsViewDBTest() : CCoinsViewDB(1 << 20, true, true) {}
+
+    CDBWrapper& GetDB() { return db; }
+    void Recover() { FinishInterruptedFlush(); }
+};
+
 class CCoinsViewCacheTest : public CCoinsViewCache
 {
 public:
@@ -346,6 +357,96 @@ BOOST_AUTO_TEST_CASE(updatecoins_simulation_test)
     BOOST_CHECK(spent_a_duplicate_coinbase);
 }
 
+// Flush to a coin database which writes in the background, in small batches,
+// and check that its contents are always up to date.
+BOOST_FIXTURE_TEST_CASE(coins_background_flush, TestingSetup)
+{
+    CCoinsViewDBTest base;
+    base.StartBackgroundFlush(4096);
+
+    std::vector<uint256> txids(1000);
+    for (unsigned int i = 0; i < txids.size(); i++) {
+        txids[i] = GetRandHash();
+    }
+    // Create all coins, then spend every other one
+    for (int round = 0; round < 2; round++) {
+        uint256 hashBlock = GetRandHash();
+        {
+            CCoinsViewCache cache(&base);
+            for (unsigned int i = 0; i < txids.size(); i++) {
+                if (round == 0) {
+                    CCoinsModifier coins = cache.ModifyNewCoins(txids[i], false);
+                    coins->nVersion = 1;
+                    coins->nHeight = 1;
+                    coins->vout.resize(1);
+                    coins->vout[0].nValue = i;
+                } else if (i % 2) {
+                    cache.ModifyCoins(txids[i])->Spend(0);
+                }
+            }
+            cache.SetBestBlock(hashBlock);
+            BOOST_CHECK(cache.Flush());
+        }
+        // First while the flush may still be in progress, then once it is on disk
+        for (int wait = 0; wait < 2; wait++) {
+            if (wait)
+                BOOST_CHECK(base.WaitForFlush());
+            BOOST_CHECK(base.GetBestBlock() == hashBlock);
+            for (unsigned int i = 0; i < txids.size(); i++) {
+                bool fUnspent = round == 0 || i % 2 == 0;
+                CCoins coins;
+                BOOST_CHECK_EQUAL(base.GetCoins(txids[i], coins), fUnspent);
+                BOOST_CHECK_EQUAL(base.HaveCoins(txids[i]), fUnspent);
+                if (fUnspent)
+                    BOOST_CHECK_EQUAL(coins.vout[0].nValue, i);
+            }
+        }
+    }
+
+    size_t count = 0;
+    boost::scoped_ptr<CCoinsViewCursor> pcursor(base.Cursor());
+    for (; pcursor->Valid(); pcursor->Next()) {
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, txids.size() / 2);
+}
+
+// Open a coin database in which a flush was interrupted.
+BOOST_FIXTURE_TEST_CASE(coins_interrupted_flush, TestingSetup)
+{
+    CCoinsViewDBTest base;
+    CDBWrapper& db = base.GetDB();
+    CCoins coins;
+    coins.nVersion = 1;
+    coins.vout.resize(1);
+    coins.vout[0].nValue = 1;
+    uint256 txidNew = GetRandHash();
+    uint256 txidSpent = GetRandHash();
+    uint256 hashBlock = GetRandHash();
+    BOOST_CHECK(db.Write(std::make_pair('c', txidSpent), coins));
+
+    // A journal that was not completed is dropped
+    BOOST_CHECK(db.Write(std::make_pair('j', txidNew), coins));
+    BOOST_CHECK(db.Write(std::make_pair('p', txidSpent), '1'));
+    base.Recover();
+    BOOST_CHECK(!base.HaveCoins(txidNew));
+    BOOST_CHECK(base.HaveCoins(txidSpent));
+    BOOST_CHECK(base.GetBestBlock().IsNull());
+    BOOST_CHECK(!db.Exists(std::make_pair('j', txidNew)));
+
+    // A completed one is applied
+    BOOST_CHECK(db.Write(std::make_pair('j', txidNew), coins));
+    BOOST_CHECK(db.Write(std::make_pair('p', txidSpent), '1'));
+    BOOST_CHECK(db.Write('H', hashBlock));
+    base.Recover();
+    BOOST_CHECK(base.HaveCoins(txidNew));
+    BOOST_CHECK(!base.HaveCoins(txidSpent));
+    BOOST_CHECK(base.GetBestBlock() == hashBlock);
+    BOOST_CHECK(!db.Exists(std::make_pair('j', txidNew)));
+    BOOST_CHECK(!db.Exists(std::make_pair('p', txidSpent)));
+    BOOST_CHECK(!db.Exists('H'));
+}
+
 BOOST_AUTO_TEST_CASE(ccoins_serialization)
 {
     // Good example
@@ -3,12 +3,14 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "crypto/aes.h"
+#include "crypto/quark.h"
 #include "crypto/ripemd160.h"
 #include "crypto/sha1.h"
 #include "crypto/sha256.h"
 #include "crypto/sha512.h"
 #include "crypto/hmac_sha256.h"
 #include "crypto/hmac_sha512.h"
+#include "hash.h"
 #include "random.h"
 #include "utilstrencodings.h"
 #include "test/test_zurcoin.h"
@@ -439,4 +441,54 @@ BOOST_AUTO_TEST_CASE(aes_cbc_testvectors) {
                   "b2eb05e2c39be9fcda6c19078c6a9d1b3f461796d6b0d6b2e0c2a72b4d80e644");
 }
 
+BOOST_AUTO_TEST_CASE(quark80_batch)
+{
+    // Every batch size exercises different combinations of full and partially filled
+    // groups of the multi-buffer implementation, if available.
+    BOOST_TEST_MESSAGE("Using the '" + QuarkAutoDetect() + "' Quark implementation");
+
+    for (size_t blocks = 0; blocks <= 67; blocks += (blocks < 9) ? 1 : 29) {
+        std::vector<unsigned char> in(80 * blocks);
+        std::vector<unsigned char> out(32 * blocks);
+        for (size_t i = 0; i < in.size(); ++i) {
+            in[i] = insecure_rand();
+        }
+        Quark80(out.data(), in.data(), blocks);
+
+        for (size_t i = 0; i < blocks; ++i) {
+            uint256 hash = HashQuark(in.begin() + 80 * i, in.begin() + 80 * (i + 1));
+            BOOST_CHECK(memcmp(hash.begin(), &out[32 * i], 32) == 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sha256d64)
+{
+    BOOST_TEST_MESSAGE("Using the '" + SHA256AutoDetect() + "' SHA256 implementation");
+
+    for (int i = 0; i <= 32; ++i) {
+        unsigned char in[64 * 32];
+        unsigned char out1[32 * 32], out2[32 * 32];
+        for (int j = 0; j < 64 * i; ++j) {
+            in[j] = insecure_rand();
+        }
+        for (int j = 0; j < i; ++j) {
+            CHash256().Write(in + 64 * j, 64).Finalize(out1 + 32 * j);
+        }
+        SHA256D64(out2, in, i);
+        BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+    }
+
+    // Hashing a level of a merkle tree in place
+    unsigned char buf[64 * 9], expected[32 * 9];
+    for (int j = 0; j < 64 * 9; ++j) {
+        buf[j] = insecure_rand();
+    }
+    for (int j = 0; j < 9; ++j) {
+        CHash256().Write(buf + 64 * j, 64).Finalize(expected + 32 * j);
+    }
+    SHA256D64(buf, buf, 9);
+    BOOST_CHECK(memcmp(buf, expected, 32 * 9) == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "cuckoocache.h"
+#include "random.h"
+#include "script/sigcache.h"
+#include "test/test_zurcoin.h"
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(cuckoocache_tests, BasicTestingSetup)
+
+typedef CuckooCache::cache<uint256, SignatureCacheHasher> SigCache;
+
+static uint256 RandomEntry()
+{
+    uint256 entry;
+    for (int i = 0; i < 8; i++) {
+        uint32_t r = insecure_rand();
+        memcpy(entry.begin() + 4 * i, &r, 4);
+    }
+    return entry;
+}
+
+/** Returns the fraction of the last n entries that are still in the cache */
+static double HitRate(const SigCache& cache, const std::vector<uint256>& entries, size_t n)
+{
+    size_t nHits = 0;
+    for (size_t i = entries.size() - n; i < entries.size(); i++) {
+        nHits += cache.contains(entries[i], false);
+    }
+    return double(nHits) / n;
+}
+
+BOOST_AUTO_TEST_CASE(cuckoocache_insert_contains)
+{
+    seed_insecure_rand(true);
+    SigCache cache;
+    size_t nCapacity = cache.setup_bytes(1 << 20);
+    BOOST_CHECK_EQUAL(nCapacity, (1 << 20) / sizeof(uint256));
+
+    // A cache at 80% load keeps almost all entries
+    std::vector<uint256> entries;
+    for (size_t i = 0; i < nCapacity * 8 / 10; i++) {
+        entries.push_back(RandomEntry());
+        cache.insert(entries.back());
+    }
+    BOOST_CHECK(HitRate(cache, entries, entries.size()) > 0.99);
+    BOOST_CHECK(!cache.contains(RandomEntry(), false));
+
+    // Inserting an entry twice does not take another slot
+    cache.insert(entries[0]);
+    BOOST_CHECK(cache.contains(entries[0], false));
+}
+
+BOOST_AUTO_TEST_CASE(cuckoocache_eviction)
+{
+    seed_insecure_rand(true);
+    SigCache cache;
+    size_t nCapacity = cache.setup_bytes(1 << 20);
+
+    // Overfilling the cache evicts the oldest generations first
+    std::vector<uint256> entries;
+    for (size_t i = 0; i < nCapacity * 4; i++) {
+        entries.push_back(RandomEntry());
+        cache.insert(entries.back());
+    }
+    BOOST_CHECK(HitRate(cache, entries, nCapacity * 4 / 10) > 0.95);
+    std::vector<uint256> vOld(entries.begin(), entries.begin() + nCapacity);
+    BOOST_CHECK(HitRate(cache, vOld, vOld.size()) < 0.05);
+}
+
+BOOST_AUTO_TEST_CASE(cuckoocache_erase)
+{
+    seed_insecure_rand(true);
+    SigCache cache;
+    size_t nCapacity = cache.setup_bytes(1 << 20);
+
+    std::vector<uint256> entries;
+    for (size_t i = 0; i < nCapacity / 2; i++) {
+        entries.push_back(RandomEntry());
+        cache.insert(entries.back());
+    }
+    // Erasing only flags the entries, they are still found until their slots are needed
+    for (size_t i = 0; i < entries.size() / 2; i++) {
+        BOOST_CHECK(cache.contains(entries[i], true));
+    }
+    BOOST_CHECK(HitRate(cache, entries, entries.size()) > 0.99);
+
+    // New entries replace the erased ones rather than the others
+    std::vector<uint256> vKept(entries.begin() + entries.size() / 2, entries.end());
+    for (size_t i = 0; i < nCapacity / 4; i++) {
+        entries.push_back(RandomEntry());
+        cache.insert(entries.back());
+    }
+    BOOST_CHECK(HitRate(cache, vKept, vKept.size()) > 0.95);
+    BOOST_CHECK(HitRate(cache, entries, nCapacity / 4) > 0.95);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
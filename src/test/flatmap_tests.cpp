@@ -0,0 +1,100 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "flatmap.h"
+#include "memusage.h"
+#include "random.h"
+#include "test/test_zurcoin.h"
+
+#include <map>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(flatmap_tests, BasicTestingSetup)
+
+/** A bad hash, which makes sure that long probe sequences are exercised */
+struct WeakHasher
+{
+    size_t operator()(uint32_t key) const { return key % 61; }
+};
+
+typedef flatmap<uint32_t, uint64_t, WeakHasher> TestMap;
+
+static void CheckEqual(const TestMap& map, const std::map<uint32_t, uint64_t>& ref)
+{
+    BOOST_CHECK_EQUAL(map.size(), ref.size());
+    size_t n = 0;
+    for (TestMap::const_iterator it = map.begin(); it != map.end(); ++it) {
+        std::map<uint32_t, uint64_t>::const_iterator itRef = ref.find(it->first);
+        BOOST_CHECK(itRef != ref.end() && itRef->second == it->second);
+        n++;
+    }
+    BOOST_CHECK_EQUAL(n, ref.size());
+}
+
+// Randomly insert, update and erase entries, and compare the result with a std::map.
+BOOST_AUTO_TEST_CASE(flatmap_simulation)
+{
+    TestMap map;
+    std::map<uint32_t, uint64_t> ref;
+    for (int i = 0; i < 100000; i++) {
+        uint32_t key = insecure_rand() % 2000;
+        switch (insecure_rand() % 4) {
+        case 0:
+        case 1: {
+            uint64_t value = insecure_rand();
+            std::pair<TestMap::iterator, bool> ret = map.insert(std::make_pair(key, value));
+            BOOST_CHECK_EQUAL(ret.second, ref.count(key) == 0);
+            ref.insert(std::make_pair(key, value));
+            BOOST_CHECK_EQUAL(ret.first->second, ref[key]);
+            break;
+        }
+        case 2:
+            map[key] += i;
+            ref[key] += i;
+            break;
+        case 3:
+            BOOST_CHECK_EQUAL(map.erase(key), ref.erase(key));
+            break;
+        }
+        BOOST_CHECK_EQUAL(map.count(key), ref.count(key));
+        if (i % 10000 == 0) {
+            CheckEqual(map, ref);
+        }
+    }
+    CheckEqual(map, ref);
+}
+
+// Entries stay in place while the table grows, and can be erased while iterating.
+BOOST_AUTO_TEST_CASE(flatmap_stability)
+{
+    TestMap map;
+    uint64_t* first = &map[0];
+    *first = 12345;
+    for (uint32_t i = 1; i < 10000; i++) {
+        map[i] = i;
+    }
+    BOOST_CHECK(first == &map.find(0)->second);
+    BOOST_CHECK_EQUAL(*first, 12345U);
+
+    for (TestMap::iterator it = map.begin(); it != map.end(); ) {
+        if (it->first % 3 == 0) {
+            map.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+    BOOST_CHECK_EQUAL(map.size(), 6666U);
+    for (uint32_t i = 0; i < 10000; i++) {
+        BOOST_CHECK_EQUAL(map.count(i), i % 3 != 0);
+    }
+
+    BOOST_CHECK(memusage::DynamicUsage(map) > 0);
+    map.clear();
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.begin() == map.end());
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
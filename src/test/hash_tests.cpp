@@ -3,15 +3,29 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "hash.h"
+#include "primitives/block.h"
 #include "utilstrencodings.h"
 #include "test/test_zurcoin.h"
 
 #include <vector>
 
+#include <boost/bind.hpp>
 #include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
 
 using namespace std;
 
+static void HashHeaders(CBlockHeader header, int nStart, int nCount, bool* pfCorrect)
+{
+    for (int i = 0; i < nCount; ++i) {
+        // neighbouring threads overlap, so each header is hashed and looked up concurrently
+        header.nNonce = nStart + i;
+        if (header.GetHash() != HashQuark(BEGIN(header.nVersion), END(header.nNonce))) {
+            *pfCorrect = false;
+        }
+    }
+}
+
 BOOST_FIXTURE_TEST_SUITE(hash_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(murmurhash3)
@@ -128,4 +142,66 @@ BOOST_AUTO_TEST_CASE(siphash)
     BOOST_CHECK_EQUAL(SipHashUint256(1, 2, ss.GetHash()), 0x79751e980c2a0a35ULL);
 }
 
+BOOST_AUTO_TEST_CASE(blockheader_hash_cache)
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashPrevBlock = uint256S("0x0000000000000000000000000000000000000000000000000000000000000001");
+    header.nTime = 1231006505;
+    header.nBits = 0x1d00ffff;
+
+    // the cache is kept outside of the header
+    BOOST_CHECK_EQUAL(sizeof(CBlockHeader), 80U);
+
+    const uint256 hash = header.GetHash();
+    BOOST_CHECK(hash == HashQuark(BEGIN(header.nVersion), END(header.nNonce)));
+    BOOST_CHECK(hash == header.GetHash());
+
+    // Modified fields invalidate the cached hash
+    ++header.nNonce;
+    BOOST_CHECK(hash != header.GetHash());
+    BOOST_CHECK(header.GetHash() == HashQuark(BEGIN(header.nVersion), END(header.nNonce)));
+    --header.nNonce;
+    BOOST_CHECK(hash == header.GetHash());
+
+    header.hashMerkleRoot = hash;
+    BOOST_CHECK(header.GetHash() == HashQuark(BEGIN(header.nVersion), END(header.nNonce)));
+
+    // Copies and headers of blocks carry the same hash
+    CBlock block(header);
+    BOOST_CHECK(block.GetHash() == header.GetHash());
+    BOOST_CHECK(block.GetBlockHeader().GetHash() == header.GetHash());
+
+    // Precomputed hashes match the individually computed ones
+    std::vector<CBlockHeader> headers(5, header);
+    for (size_t i = 0; i < headers.size(); ++i) {
+        headers[i].nNonce = i;
+    }
+    std::vector<CBlockHeader> precomputed(headers);
+    CBlockHeader::PrecomputeHashes(precomputed);
+    for (size_t i = 0; i < headers.size(); ++i) {
+        BOOST_CHECK(precomputed[i].GetHash() == HashQuark(BEGIN(headers[i].nVersion), END(headers[i].nNonce)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(blockheader_hash_cache_threads)
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashMerkleRoot = uint256S("0x4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b");
+    header.nTime = 1231006505;
+    header.nBits = 0x1d00ffff;
+
+    bool vCorrect[4] = { true, true, true, true };
+    boost::thread_group threads;
+    for (int n = 0; n < 4; ++n) {
+        threads.create_thread(boost::bind(&HashHeaders, header, n * 100, 300, &vCorrect[n]));
+    }
+    threads.join_all();
+
+    for (int n = 0; n < 4; ++n) {
+        BOOST_CHECK(vCorrect[n]);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
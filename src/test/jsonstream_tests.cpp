@@ -0,0 +1,153 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/jsonstream.h"
+#include "test/test_zurcoin.h"
+
+#include <univalue.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+
+static void AppendChunk(std::vector<std::string>* pchunks, const std::string& data)
+{
+    pchunks->push_back(data);
+}
+
+static std::string Join(const std::vector<std::string>& chunks)
+{
+    std::string result;
+    for (std::vector<std::string>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        result += *it;
+    }
+    return result;
+}
+
+BOOST_FIXTURE_TEST_SUITE(jsonstream_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(jsonstream_matches_univalue)
+{
+    UniValue expected(UniValue::VOBJ);
+    UniValue array(UniValue::VARR);
+    UniValue inner(UniValue::VOBJ);
+    inner.push_back(Pair("name", "quote \" and \\ and \n"));
+    inner.push_back(Pair("amount", (int64_t) -5));
+    inner.push_back(Pair("max", (uint64_t) 18446744073709551615ULL));
+    inner.push_back(Pair("flag", true));
+    array.push_back(inner);
+    array.push_back(UniValue(UniValue::VARR));
+    array.push_back(NullUniValue);
+    expected.push_back(Pair("result", array));
+    expected.push_back(Pair("id", 1));
+
+    std::vector<std::string> chunks;
+    JSONStreamWriter writer(boost::bind(&AppendChunk, &chunks, _1));
+    writer.BeginObject();
+    writer.Key("result");
+    writer.BeginArray();
+    writer.BeginObject();
+    writer.Pair("name", "quote \" and \\ and \n");
+    writer.Pair("amount", (int64_t) -5);
+    writer.Pair("max", (uint64_t) 18446744073709551615ULL);
+    writer.Pair("flag", true);
+    writer.EndObject();
+    writer.BeginArray();
+    writer.EndArray();
+    writer.Null();
+    writer.EndArray();
+    writer.Pair("id", 1);
+    writer.EndObject();
+
+    // nothing is handed to the sink, until the chunk size is reached
+    BOOST_CHECK(!writer.HasFlushed());
+    BOOST_CHECK(chunks.empty());
+    BOOST_CHECK_EQUAL(writer.GetPending(), expected.write());
+    writer.Flush();
+    BOOST_CHECK(writer.HasFlushed());
+    BOOST_CHECK_EQUAL(Join(chunks), expected.write());
+}
+
+BOOST_AUTO_TEST_CASE(jsonstream_chunks_between_tokens)
+{
+    std::vector<std::string> chunks;
+    JSONStreamWriter writer(boost::bind(&AppendChunk, &chunks, _1), 16);
+    UniValue expected(UniValue::VARR);
+    writer.BeginArray();
+    for (int n = 0; n < 100; ++n) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("n", n));
+        obj.push_back(Pair("s", "\xe5\x8d\x9a\xe6\x84\x9b"));
+        expected.push_back(obj);
+        writer.Value(obj);
+    }
+    writer.EndArray();
+    writer.Flush();
+
+    BOOST_CHECK(chunks.size() > 1);
+    BOOST_CHECK_EQUAL(Join(chunks), expected.write());
+
+    // each chunk ends after a complete value or a closing bracket
+    for (std::vector<std::string>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        char last = (*it)[it->size() - 1];
+        BOOST_CHECK(last == '}' || last == ']');
+    }
+}
+
+BOOST_AUTO_TEST_CASE(jsonstream_key_and_value_not_split)
+{
+    std::vector<std::string> chunks;
+    JSONStreamWriter writer(boost::bind(&AppendChunk, &chunks, _1), 1);
+    writer.BeginObject();
+    writer.Pair("a", "b");
+    writer.Pair("c", (int64_t) 2);
+    writer.EndObject();
+    writer.Flush();
+
+    BOOST_CHECK_EQUAL(Join(chunks), "{\"a\":\"b\",\"c\":2}");
+    for (std::vector<std::string>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        BOOST_CHECK((*it)[it->size() - 1] != ':');
+    }
+}
+
+BOOST_AUTO_TEST_CASE(jsonstream_builds_univalue)
+{
+    std::vector<std::string> chunks;
+    JSONStreamWriter text(boost::bind(&AppendChunk, &chunks, _1));
+    UniValue result;
+    JSONStreamWriter tree(result);
+
+    JSONStreamWriter* writers[] = { &text, &tree };
+    for (size_t n = 0; n < 2; ++n) {
+        JSONStreamWriter& writer = *writers[n];
+        writer.BeginObject();
+        writer.Key("list");
+        writer.BeginArray();
+        writer.BeginObject();
+        writer.Pair("name", "a");
+        writer.Key("nested");
+        writer.BeginArray();
+        writer.Value((int64_t) -1);
+        writer.Value((uint64_t) 18446744073709551615ULL);
+        writer.EndArray();
+        writer.EndObject();
+        writer.Null();
+        writer.Value(UniValue(UniValue::VOBJ));
+        writer.EndArray();
+        writer.Pair("flag", false);
+        writer.EndObject();
+        writer.Flush();
+    }
+
+    // the tree is built in place, and nothing is handed to a sink
+    BOOST_CHECK(!tree.HasFlushed());
+    BOOST_CHECK(result.isObject());
+    BOOST_CHECK_EQUAL(result["list"].size(), 3U);
+    BOOST_CHECK_EQUAL(result.write(), Join(chunks));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
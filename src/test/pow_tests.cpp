@@ -4,6 +4,7 @@
 
 #include "chain.h"
 #include "chainparams.h"
+#include "main.h"
 #include "pow.h"
 #include "random.h"
 #include "util.h"
@@ -95,4 +96,25 @@ BOOST_AUTO_TEST_CASE(GetBlockProofEquivalentTime_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(pow_check_headers)
+{
+    SelectParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = Params().GetConsensus();
+
+    std::vector<CBlockHeader> headers(5, Params().GenesisBlock().GetBlockHeader());
+    BOOST_CHECK(CPoWCheck(&headers[0], headers.size(), params)());
+    for (size_t i = 0; i < headers.size(); i++) {
+        BOOST_CHECK(headers[i].GetHash() == Params().GenesisBlock().GetHash());
+    }
+
+    // A header which doesn't meet its target fails the whole range
+    headers[3].nNonce++;
+    BOOST_CHECK(CPoWCheck(&headers[0], 3, params)());
+    BOOST_CHECK(!CPoWCheck(&headers[0], headers.size(), params)());
+
+    // An empty check succeeds
+    CPoWCheck check;
+    BOOST_CHECK(check());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
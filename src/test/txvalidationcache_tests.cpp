@@ -83,4 +83,69 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_block_doublespend, TestChain100Setup)
     BOOST_CHECK_EQUAL(mempool.size(), 0);
 }
 
+static CMutableTransaction
+SpendCoinbase(const CTransaction& coinbase, const CKey& key, CAmount nValue)
+{
+    CScript scriptPubKey = CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction spend;
+    spend.vin.resize(1);
+    spend.vin[0].prevout.hash = coinbase.GetHash();
+    spend.vin[0].prevout.n = 0;
+    spend.vout.resize(1);
+    spend.vout[0].nValue = nValue;
+    spend.vout[0].scriptPubKey = scriptPubKey;
+
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(scriptPubKey, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(key.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+    return spend;
+}
+
+BOOST_FIXTURE_TEST_CASE(tx_warm_signature_cache, TestChain100Setup)
+{
+    // Only transactions, which pass the cheap checks of AcceptToMemoryPool, are verified early
+    CMutableTransaction spend = SpendCoinbase(coinbaseTxns[0], coinbaseKey, 11*CENT);
+    BOOST_CHECK(WarmSignatureCache(spend));
+    BOOST_CHECK(ToMemPool(spend));
+
+    // already in the mempool, and a conflict with it
+    BOOST_CHECK(!WarmSignatureCache(spend));
+    BOOST_CHECK(!WarmSignatureCache(SpendCoinbase(coinbaseTxns[0], coinbaseKey, 12*CENT)));
+    mempool.clear();
+
+    // an invalid signature
+    CKey otherKey;
+    otherKey.MakeNewKey(true);
+    BOOST_CHECK(!WarmSignatureCache(SpendCoinbase(coinbaseTxns[1], otherKey, 11*CENT)));
+
+    // missing inputs
+    CMutableTransaction orphan = SpendCoinbase(coinbaseTxns[1], coinbaseKey, 11*CENT);
+    orphan.vin[0].prevout.hash = GetRandHash();
+    BOOST_CHECK(!WarmSignatureCache(orphan));
+
+    // not final
+    CMutableTransaction nonFinal = SpendCoinbase(coinbaseTxns[1], coinbaseKey, 11*CENT);
+    nonFinal.nLockTime = chainActive.Height() + 10;
+    nonFinal.vin[0].nSequence = 0;
+    BOOST_CHECK(!WarmSignatureCache(nonFinal));
+
+    // no fee
+    BOOST_CHECK(!WarmSignatureCache(SpendCoinbase(coinbaseTxns[1], coinbaseKey, coinbaseTxns[1].vout[0].nValue)));
+
+    // the coins looked up for the checks don't stay in the cache
+    uint256 hashUncached = coinbaseTxns[2].GetHash();
+    FlushStateToDisk();
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!pcoinsTip->HaveCoinsInCache(hashUncached));
+    }
+    BOOST_CHECK(WarmSignatureCache(SpendCoinbase(coinbaseTxns[2], coinbaseKey, 11*CENT)));
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!pcoinsTip->HaveCoinsInCache(hashUncached));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
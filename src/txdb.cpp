@@ -26,20 +26,64 @@ static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 
+static const char DB_JOURNAL_COINS = 'j';
+static const char DB_JOURNAL_PRUNED = 'p';
+static const char DB_JOURNAL_HEAD = 'H';
 
-CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe, true) 
+
+CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe, true),
+    nBatchSize(nDefaultDbFlushBatch << 20), fFlushing(false), fFlushFailed(false), fStopFlushing(false)
+{
+    FinishInterruptedFlush();
+}
+
+CCoinsViewDB::~CCoinsViewDB()
 {
+    if (threadFlush.joinable()) {
+        {
+            boost::unique_lock<boost::mutex> lock(csFlush);
+            fStopFlushing = true;
+            condFlush.notify_all();
+        }
+        // The thread completes the current flush before it exits
+        threadFlush.join();
+    }
 }
 
 bool CCoinsViewDB::GetCoins(const uint256 &txid, CCoins &coins) const {
+    {
+        boost::unique_lock<boost::mutex> lock(csFlush);
+        if (fFlushing) {
+            CCoinsMap::const_iterator it = mapFlushing.find(txid);
+            if (it != mapFlushing.end()) {
+                if (it->second.coins.IsPruned())
+                    return false;
+                coins = it->second.coins;
+                return true;
+            }
+        }
+    }
     return db.Read(make_pair(DB_COINS, txid), coins);
 }
 
 bool CCoinsViewDB::HaveCoins(const uint256 &txid) const {
+    {
+        boost::unique_lock<boost::mutex> lock(csFlush);
+        if (fFlushing) {
+            CCoinsMap::const_iterator it = mapFlushing.find(txid);
+            if (it != mapFlushing.end())
+                return !it->second.coins.IsPruned();
+        }
+    }
     return db.Exists(make_pair(DB_COINS, txid));
 }
 
 uint256 CCoinsViewDB::GetBestBlock() const {
+    {
+        boost::unique_lock<boost::mutex> lock(csFlush);
+        if (fFlushing && !hashFlushing.IsNull())
+            return hashFlushing;
+    }
     uint256 hashBestChain;
     if (!db.Read(DB_BEST_BLOCK, hashBestChain))
         return uint256();
@@ -47,6 +91,23 @@ uint256 CCoinsViewDB::GetBestBlock() const {
 }
 
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+    if (threadFlush.joinable()) {
+        boost::unique_lock<boost::mutex> lock(csFlush);
+        if (fFlushing && !fFlushFailed) {
+            LogPrint("coindb", "Waiting for the previous flush to complete...\n");
+            while (fFlushing && !fFlushFailed)
+                condFlush.wait(lock);
+        }
+        if (fFlushFailed)
+            return false;
+        // Take over the coins, which leaves mapCoins empty
+        mapFlushing.swap(mapCoins);
+        hashFlushing = hashBlock;
+        fFlushing = true;
+        condFlush.notify_all();
+        return true;
+    }
+
     CDBBatch batch(db);
     size_t count = 0;
     size_t changed = 0;
@@ -92,8 +153,152 @@ bool CBlockTreeDB::ReadLastBlockFile(int &nFile) {
     return Read(DB_LAST_BLOCK, nFile);
 }
 
+void CCoinsViewDB::StartBackgroundFlush(size_t nBatchSizeIn)
+{
+    assert(!threadFlush.joinable());
+    nBatchSize = nBatchSizeIn;
+    threadFlush = boost::thread(boost::bind(&CCoinsViewDB::ThreadFlush, this));
+}
+
+bool CCoinsViewDB::WaitForFlush() const
+{
+    boost::unique_lock<boost::mutex> lock(csFlush);
+    while (fFlushing && !fFlushFailed)
+        condFlush.wait(lock);
+    return !fFlushFailed;
+}
+
+void CCoinsViewDB::ThreadFlush()
+{
+    RenameThread("zurcoin-dbflush");
+    boost::unique_lock<boost::mutex> lock(csFlush);
+    while (true) {
+        while (!fStopFlushing && (!fFlushing || fFlushFailed))
+            condFlush.wait(lock);
+        if (!fFlushing || fFlushFailed)
+            return;
+
+        // mapFlushing is not modified until fFlushing is reset, so it can be read without the lock
+        lock.unlock();
+        bool fOk = false;
+        try {
+            WriteCoinsInBatches(mapFlushing, hashFlushing);
+            fOk = true;
+        } catch (const std::exception& e) {
+            LogPrintf("%s: %s\n", __func__, e.what());
+        }
+
+        CCoinsMap mapDone;
+        lock.lock();
+        if (fOk) {
+            mapDone.swap(mapFlushing);
+            fFlushing = false;
+        } else {
+            // Keep serving the coins from memory; the next BatchWrite() fails
+            fFlushFailed = true;
+        }
+        condFlush.notify_all();
+        lock.unlock();
+        mapDone.clear();
+        lock.lock();
+    }
+}
+
+void CCoinsViewDB::WriteCoinsInBatches(const CCoinsMap &mapCoins, const uint256 &hashBlock)
+{
+    CDBBatch batch(db);
+    size_t count = 0;
+    size_t changed = 0;
+    // First write all changes to the journal, which leaves the coins untouched
+    for (CCoinsMap::const_iterator it = mapCoins.begin(); it != mapCoins.end(); ++it) {
+        count++;
+        if (!(it->second.flags & CCoinsCacheEntry::DIRTY))
+            continue;
+        if (it->second.coins.IsPruned())
+            batch.Write(make_pair(DB_JOURNAL_PRUNED, it->first), '1');
+        else
+            batch.Write(make_pair(DB_JOURNAL_COINS, it->first), it->second.coins);
+        changed++;
+        if (batch.SizeEstimate() > nBatchSize) {
+            db.WriteBatch(batch);
+            batch.Clear();
+        }
+    }
+    // From here on, an interrupted flush is finished on restart
+    batch.Write(DB_JOURNAL_HEAD, hashBlock);
+    db.WriteBatch(batch);
+    batch.Clear();
+
+    // Then apply the changes to the coins
+    for (CCoinsMap::const_iterator it = mapCoins.begin(); it != mapCoins.end(); ++it) {
+        if (!(it->second.flags & CCoinsCacheEntry::DIRTY))
+            continue;
+        if (it->second.coins.IsPruned()) {
+            batch.Erase(make_pair(DB_COINS, it->first));
+            batch.Erase(make_pair(DB_JOURNAL_PRUNED, it->first));
+        } else {
+            batch.Write(make_pair(DB_COINS, it->first), it->second.coins);
+            batch.Erase(make_pair(DB_JOURNAL_COINS, it->first));
+        }
+        if (batch.SizeEstimate() > nBatchSize) {
+            db.WriteBatch(batch);
+            batch.Clear();
+        }
+    }
+    // And update the best block last
+    if (!hashBlock.IsNull())
+        batch.Write(DB_BEST_BLOCK, hashBlock);
+    batch.Erase(DB_JOURNAL_HEAD);
+    db.WriteBatch(batch);
+
+    LogPrint("coindb", "Committed %u changed transactions (out of %u) to coin database in the background\n", (unsigned int)changed, (unsigned int)count);
+}
+
+void CCoinsViewDB::FinishInterruptedFlush()
+{
+    uint256 hashBlock;
+    bool fComplete = db.Read(DB_JOURNAL_HEAD, hashBlock);
+    boost::scoped_ptr<CDBIterator> pcursor(db.NewIterator());
+    CDBBatch batch(db);
+    size_t count = 0;
+    const char journal[] = { DB_JOURNAL_COINS, DB_JOURNAL_PRUNED };
+    for (unsigned int i = 0; i < sizeof(journal); i++) {
+        std::pair<char, uint256> key;
+        for (pcursor->Seek(make_pair(journal[i], uint256())); pcursor->Valid() && pcursor->GetKey(key) && key.first == journal[i]; pcursor->Next()) {
+            if (fComplete) {
+                if (key.first == DB_JOURNAL_COINS) {
+                    CCoins coins;
+                    if (!pcursor->GetValue(coins))
+                        throw dbwrapper_error("Failed to read the coin database journal");
+                    batch.Write(make_pair(DB_COINS, key.second), coins);
+                } else {
+                    batch.Erase(make_pair(DB_COINS, key.second));
+                }
+            }
+            batch.Erase(key);
+            count++;
+            if (batch.SizeEstimate() > nBatchSize) {
+                db.WriteBatch(batch);
+                batch.Clear();
+            }
+        }
+    }
+    if (fComplete) {
+        if (!hashBlock.IsNull())
+            batch.Write(DB_BEST_BLOCK, hashBlock);
+        batch.Erase(DB_JOURNAL_HEAD);
+        db.WriteBatch(batch, true);
+        LogPrintf("Finished an interrupted flush of %u transactions to the coin database\n", (unsigned int)count);
+    } else if (count > 0) {
+        db.WriteBatch(batch, true);
+        LogPrintf("Dropped an incomplete flush of %u transactions to the coin database\n", (unsigned int)count);
+    }
+}
+
 CCoinsViewCursor *CCoinsViewDB::Cursor() const
 {
+    // The cursor only sees what is on disk
+    WaitForFlush();
     CCoinsViewDBCursor *i = new CCoinsViewDBCursor(const_cast<CDBWrapper*>(&db)->NewIterator(), GetBestBlock());
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
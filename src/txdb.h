@@ -16,6 +16,7 @@
 #include <vector>
 
 #include <boost/function.hpp>
+#include <boost/thread.hpp>
 
 class CBlockIndex;
 class CCoinsViewDBCursor;
@@ -35,6 +36,10 @@ static const int64_t nMaxBlockDBCache = 2;
 static const int64_t nMaxBlockDBAndTxIndexCache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! -dbflushbatch default (MiB)
+static const int64_t nDefaultDbFlushBatch = 16;
+//! -dbflushbackground default
+static const bool DEFAULT_DB_FLUSH_BACKGROUND = false;
 
 struct CDiskTxPos : public CDiskBlockPos
 {
@@ -61,19 +66,52 @@ struct CDiskTxPos : public CDiskBlockPos
     }
 };
 
-/** CCoinsView backed by the coin database (chainstate/) */
+/**
+ * CCoinsView backed by the coin database (chainstate/)
+ *
+ * Flushes can be written by a background thread. BatchWrite() then only takes
+ * over the coins, which are served from memory until they are on disk. The
+ * thread first writes the changes to a journal and then applies them to the
+ * coins, both in batches of bounded size, and updates the best block last. A
+ * flush that is interrupted after its journal was completed is finished when
+ * the database is opened again, and one that is interrupted before is dropped.
+ */
 class CCoinsViewDB : public CCoinsView
 {
 protected:
     CDBWrapper db;
+
+    //! Maximum size of the batches of a background flush
+    size_t nBatchSize;
+
+    mutable boost::mutex csFlush;
+    mutable boost::condition_variable condFlush;
+    //! The coins being written in the background, and their best block
+    CCoinsMap mapFlushing;
+    uint256 hashFlushing;
+    bool fFlushing;
+    bool fFlushFailed;
+    bool fStopFlushing;
+    boost::thread threadFlush;
+
+    void WriteCoinsInBatches(const CCoinsMap &mapCoins, const uint256 &hashBlock);
+    void ThreadFlush();
+    void FinishInterruptedFlush();
+
 public:
     CCoinsViewDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    ~CCoinsViewDB();
 
     bool GetCoins(const uint256 &txid, CCoins &coins) const;
     bool HaveCoins(const uint256 &txid) const;
     uint256 GetBestBlock() const;
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock);
     CCoinsViewCursor *Cursor() const;
+
+    //! Write all further flushes in the background, in batches of about nBatchSizeIn bytes
+    void StartBackgroundFlush(size_t nBatchSizeIn);
+    //! Wait until the current background flush is on disk; returns false if it failed
+    bool WaitForFlush() const;
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
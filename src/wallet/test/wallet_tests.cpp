@@ -4,6 +4,12 @@
 
 #include "wallet/wallet.h"
 
+#include "key.h"
+#include "main.h"
+#include "random.h"
+#include "script/standard.h"
+#include "wallet/walletdb.h"
+
 #include <set>
 #include <stdint.h>
 #include <utility>
@@ -351,4 +357,88 @@ BOOST_AUTO_TEST_CASE(ApproximateBestSubset)
     BOOST_CHECK_EQUAL(setCoinsRet.size(), 2U);
 }
 
+/** Adds a transaction, which spends the outpoint and pays 1 coin to every script, to the wallet. */
+static uint256 AddWalletTx(const COutPoint& spent, const std::vector<CScript>& vScripts, bool fConfirmed)
+{
+    CMutableTransaction tx;
+    tx.vin.push_back(CTxIn(spent));
+    BOOST_FOREACH(const CScript& script, vScripts)
+        tx.vout.push_back(CTxOut(COIN, script));
+
+    CWalletTx wtx(pwalletMain, tx);
+    if (fConfirmed) {
+        LOCK(cs_main);
+        wtx.hashBlock = chainActive.Genesis()->GetBlockHash();
+        wtx.nIndex = 0;
+    }
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+    BOOST_CHECK(pwalletMain->AddToWallet(wtx, false, &walletdb));
+    return wtx.GetHash();
+}
+
+static std::vector<COutPoint> ListOutputs(const CKey& key)
+{
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+    return pwalletMain->ListAddressOutputs(key.GetPubKey().GetID());
+}
+
+BOOST_AUTO_TEST_CASE(address_outputs)
+{
+    CKey key1, key2, key3, keyOther;
+    key1.MakeNewKey(true);
+    key2.MakeNewKey(true);
+    key3.MakeNewKey(true);
+    keyOther.MakeNewKey(true);
+    {
+        LOCK(pwalletMain->cs_wallet);
+        BOOST_CHECK(pwalletMain->AddKeyPubKey(key1, key1.GetPubKey()));
+        BOOST_CHECK(pwalletMain->AddKeyPubKey(key2, key2.GetPubKey()));
+    }
+    CScript script1 = GetScriptForDestination(key1.GetPubKey().GetID());
+    CScript script2 = GetScriptForDestination(key2.GetPubKey().GetID());
+    CScript script3 = GetScriptForDestination(key3.GetPubKey().GetID());
+    CScript scriptOther = GetScriptForDestination(keyOther.GetPubKey().GetID());
+
+    std::vector<CScript> vScripts;
+    vScripts.push_back(script1);
+    vScripts.push_back(script2);
+    vScripts.push_back(scriptOther);
+    vScripts.push_back(script1);
+    vScripts.push_back(script3);
+    uint256 hash1 = AddWalletTx(COutPoint(GetRandHash(), 0), vScripts, true);
+
+    // the index is built on first use, with the outputs, which are ours
+    std::vector<COutPoint> vExpected;
+    vExpected.push_back(COutPoint(hash1, 0));
+    vExpected.push_back(COutPoint(hash1, 3));
+    BOOST_CHECK(ListOutputs(key1) == vExpected);
+    BOOST_CHECK_EQUAL(ListOutputs(key2).size(), 1U);
+    BOOST_CHECK(ListOutputs(keyOther).empty());
+    BOOST_CHECK(ListOutputs(key3).empty());
+
+    // new transactions are added, and spent outputs are dropped
+    uint256 hash2 = AddWalletTx(COutPoint(hash1, 0), std::vector<CScript>(2, script1), false);
+    std::set<COutPoint> setExpected;
+    setExpected.insert(COutPoint(hash1, 3));
+    setExpected.insert(COutPoint(hash2, 0));
+    setExpected.insert(COutPoint(hash2, 1));
+    vExpected.assign(setExpected.begin(), setExpected.end());
+    BOOST_CHECK(ListOutputs(key1) == vExpected);
+
+    // the outputs spent by an abandoned transaction are unspent again
+    BOOST_CHECK(pwalletMain->AbandonTransaction(hash2));
+    setExpected.insert(COutPoint(hash1, 0));
+    vExpected.assign(setExpected.begin(), setExpected.end());
+    BOOST_CHECK(ListOutputs(key1) == vExpected);
+
+    // imported keys are picked up, when the wallet is marked dirty
+    {
+        LOCK(pwalletMain->cs_wallet);
+        BOOST_CHECK(pwalletMain->AddKeyPubKey(key3, key3.GetPubKey()));
+    }
+    pwalletMain->MarkDirty();
+    vExpected.assign(1, COutPoint(hash1, 4));
+    BOOST_CHECK(ListOutputs(key3) == vExpected);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -738,6 +738,9 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         BOOST_FOREACH(PAIRTYPE(const uint256, CWalletTx)& item, mapWallet)
             item.second.MarkDirty();
+        // What is ours may have changed, so rebuild the index on next use
+        mapAddressOutputs.clear();
+        fAddressOutputsValid = false;
     }
 }
 
@@ -820,6 +823,8 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFromLoadWallet, CWalletD
                              wtxIn.hashBlock.ToString());
             }
             AddToSpends(hash);
+            if (fAddressOutputsValid)
+                AddToAddressOutputs(wtx);
         }
 
         bool fUpdated = false;
@@ -968,8 +973,13 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
             // available of the outputs it spends. So force those to be recomputed
             BOOST_FOREACH(const CTxIn& txin, wtx.vin)
             {
-                if (mapWallet.count(txin.prevout.hash))
-                    mapWallet[txin.prevout.hash].MarkDirty();
+                if (mapWallet.count(txin.prevout.hash)) {
+                    CWalletTx& prevtx = mapWallet[txin.prevout.hash];
+                    prevtx.MarkDirty();
+                    // The output may be unspent again
+                    if (fAddressOutputsValid && txin.prevout.n < prevtx.vout.size())
+                        AddToAddressOutputs(prevtx, txin.prevout.n);
+                }
             }
         }
     }
@@ -1029,8 +1039,13 @@ void CWallet::MarkConflicted(const uint256& hashBlock, const uint256& hashTx)
             // available of the outputs it spends. So force those to be recomputed
             BOOST_FOREACH(const CTxIn& txin, wtx.vin)
             {
-                if (mapWallet.count(txin.prevout.hash))
-                    mapWallet[txin.prevout.hash].MarkDirty();
+                if (mapWallet.count(txin.prevout.hash)) {
+                    CWalletTx& prevtx = mapWallet[txin.prevout.hash];
+                    prevtx.MarkDirty();
+                    // The output may be unspent again
+                    if (fAddressOutputsValid && txin.prevout.n < prevtx.vout.size())
+                        AddToAddressOutputs(prevtx, txin.prevout.n);
+                }
             }
         }
     }
@@ -3128,6 +3143,55 @@ void CWallet::ListLockedCoins(std::vector<COutPoint>& vOutpts)
     }
 }
 
+void CWallet::AddToAddressOutputs(const CWalletTx& wtx, unsigned int n)
+{
+    const CTxOut& txout = wtx.vout[n];
+    if (IsMine(txout) == ISMINE_NO)
+        return;
+    CTxDestination dest;
+    if (!ExtractDestination(txout.scriptPubKey, dest))
+        return;
+    mapAddressOutputs[dest].insert(COutPoint(wtx.GetHash(), n));
+}
+
+void CWallet::AddToAddressOutputs(const CWalletTx& wtx)
+{
+    for (unsigned int n = 0; n < wtx.vout.size(); n++)
+        AddToAddressOutputs(wtx, n);
+}
+
+std::vector<COutPoint> CWallet::ListAddressOutputs(const CTxDestination& dest)
+{
+    AssertLockHeld(cs_main); // IsSpent
+    AssertLockHeld(cs_wallet); // mapWallet, mapAddressOutputs
+
+    if (!fAddressOutputsValid) {
+        mapAddressOutputs.clear();
+        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+            AddToAddressOutputs(it->second);
+        fAddressOutputsValid = true;
+    }
+
+    std::vector<COutPoint> vOutpts;
+    AddressOutputs::iterator it = mapAddressOutputs.find(dest);
+    if (it == mapAddressOutputs.end())
+        return vOutpts;
+
+    std::set<COutPoint>& setOutpts = it->second;
+    for (std::set<COutPoint>::iterator itOut = setOutpts.begin(); itOut != setOutpts.end(); ) {
+        if (IsSpent(itOut->hash, itOut->n)) {
+            setOutpts.erase(itOut++);
+        } else {
+            vOutpts.push_back(*itOut);
+            ++itOut;
+        }
+    }
+    if (setOutpts.empty())
+        mapAddressOutputs.erase(it);
+
+    return vOutpts;
+}
+
 /** @} */ // end of Actions
 
 class CAffectedKeysVisitor : public boost::static_visitor<void> {
@@ -580,6 +580,19 @@ private:
 
     void SyncMetaData(std::pair<TxSpends::iterator, TxSpends::iterator>);
 
+    /**
+     * Outputs of wallet transactions that pay to us, by destination.
+     * Spent outputs are dropped lazily when the outputs of a destination are
+     * listed, and added again when the spending transaction is conflicted or
+     * abandoned. The index is built on first use, and rebuilt after MarkDirty(),
+     * which is called when keys or scripts are imported.
+     */
+    typedef std::map<CTxDestination, std::set<COutPoint> > AddressOutputs;
+    AddressOutputs mapAddressOutputs;
+    bool fAddressOutputsValid;
+    void AddToAddressOutputs(const CWalletTx& wtx, unsigned int n);
+    void AddToAddressOutputs(const CWalletTx& wtx);
+
     /* the HD chain data model (external chain counters) */
     CHDChain hdChain;
 
@@ -634,6 +647,7 @@ public:
         nLastResend = 0;
         nTimeFirstKey = 0;
         fBroadcastTransactions = false;
+        fAddressOutputsValid = false;
     }
 
     std::map<uint256, CWalletTx> mapWallet;
@@ -680,6 +694,12 @@ public:
     void UnlockAllCoins();
     void ListLockedCoins(std::vector<COutPoint>& vOutpts);
 
+    /**
+     * Returns the unspent outputs of wallet transactions to a destination,
+     * ordered by transaction hash, without scanning the whole wallet.
+     */
+    std::vector<COutPoint> ListAddressOutputs(const CTxDestination& dest);
+
     /**
      * keystore implementation
      * Generate a new key
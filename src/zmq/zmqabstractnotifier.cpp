@@ -20,3 +20,23 @@ bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/
 {
     return true;
 }
+
+bool CZMQAbstractNotifier::NotifyZusTransaction(const CMPTransaction &/*mptx*/, int /*result*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyZusTrade(const mastercore::CZusTradeEvent &/*trade*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyZusBalances(int /*block*/, const uint256 &/*blockHash*/, const std::vector<mastercore::CZusBalanceDelta> &/*deltas*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyZusReorg(int /*block*/, const uint256 &/*blockHash*/)
+{
+    return true;
+}
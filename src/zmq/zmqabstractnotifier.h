@@ -7,8 +7,18 @@
 
 #include "zmqconfig.h"
 
+#include <vector>
+
 class CBlockIndex;
+class CMPTransaction;
 class CZMQAbstractNotifier;
+class uint256;
+
+namespace mastercore
+{
+struct CZusBalanceDelta;
+struct CZusTradeEvent;
+}
 
 typedef CZMQAbstractNotifier* (*CZMQNotifierFactory)();
 
@@ -35,6 +45,12 @@ public:
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyTransaction(const CTransaction &transaction);
 
+    // Zus layer
+    virtual bool NotifyZusTransaction(const CMPTransaction &mptx, int result);
+    virtual bool NotifyZusTrade(const mastercore::CZusTradeEvent &trade);
+    virtual bool NotifyZusBalances(int block, const uint256 &blockHash, const std::vector<mastercore::CZusBalanceDelta> &deltas);
+    virtual bool NotifyZusReorg(int block, const uint256 &blockHash);
+
 protected:
     void *psocket;
     std::string type;
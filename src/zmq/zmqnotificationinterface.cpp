@@ -9,6 +9,9 @@
 #include "main.h"
 #include "streams.h"
 #include "util.h"
+#include "zurbank/events.h"
+
+#include <boost/bind.hpp>
 
 void zmqError(const char *str)
 {
@@ -39,6 +42,10 @@ CZMQNotificationInterface* CZMQNotificationInterface::CreateWithArguments(const
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubzustx"] = CZMQAbstractNotifier::Create<CZMQPublishZusTransactionNotifier>;
+    factories["pubzustrade"] = CZMQAbstractNotifier::Create<CZMQPublishZusTradeNotifier>;
+    factories["pubzusbalance"] = CZMQAbstractNotifier::Create<CZMQPublishZusBalanceNotifier>;
+    factories["pubzusreorg"] = CZMQAbstractNotifier::Create<CZMQPublishZusReorgNotifier>;
 
     for (std::map<std::string, CZMQNotifierFactory>::const_iterator i=factories.begin(); i!=factories.end(); ++i)
     {
@@ -103,6 +110,12 @@ bool CZMQNotificationInterface::Initialize()
         return false;
     }
 
+    mastercore::CZusSignals& zusSignals = mastercore::GetZusSignals();
+    zusSignals.TransactionProcessed.connect(boost::bind(&CZMQNotificationInterface::ZusTransactionProcessed, this, _1, _2));
+    zusSignals.TradeMatched.connect(boost::bind(&CZMQNotificationInterface::ZusTradeMatched, this, _1));
+    zusSignals.BalancesChanged.connect(boost::bind(&CZMQNotificationInterface::ZusBalancesChanged, this, _1, _2, _3));
+    zusSignals.Reorg.connect(boost::bind(&CZMQNotificationInterface::ZusReorg, this, _1, _2));
+
     return true;
 }
 
@@ -112,6 +125,12 @@ void CZMQNotificationInterface::Shutdown()
     LogPrint("zmq", "zmq: Shutdown notification interface\n");
     if (pcontext)
     {
+        mastercore::CZusSignals& zusSignals = mastercore::GetZusSignals();
+        zusSignals.TransactionProcessed.disconnect(boost::bind(&CZMQNotificationInterface::ZusTransactionProcessed, this, _1, _2));
+        zusSignals.TradeMatched.disconnect(boost::bind(&CZMQNotificationInterface::ZusTradeMatched, this, _1));
+        zusSignals.BalancesChanged.disconnect(boost::bind(&CZMQNotificationInterface::ZusBalancesChanged, this, _1, _2, _3));
+        zusSignals.Reorg.disconnect(boost::bind(&CZMQNotificationInterface::ZusReorg, this, _1, _2));
+
         for (std::list<CZMQAbstractNotifier*>::iterator i=notifiers.begin(); i!=notifiers.end(); ++i)
         {
             CZMQAbstractNotifier *notifier = *i;
@@ -157,3 +176,71 @@ void CZMQNotificationInterface::SyncTransaction(const CTransaction& tx, const CB
         }
     }
 }
+
+void CZMQNotificationInterface::ZusTransactionProcessed(const CMPTransaction& mptx, int result)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifyZusTransaction(mptx, result))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
+void CZMQNotificationInterface::ZusTradeMatched(const mastercore::CZusTradeEvent& trade)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifyZusTrade(trade))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
+void CZMQNotificationInterface::ZusBalancesChanged(int block, const uint256& blockHash, const std::vector<mastercore::CZusBalanceDelta>& deltas)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifyZusBalances(block, blockHash, deltas))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
+void CZMQNotificationInterface::ZusReorg(int block, const uint256& blockHash)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifyZusReorg(block, blockHash))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
@@ -8,10 +8,18 @@
 #include "validationinterface.h"
 #include <string>
 #include <map>
+#include <vector>
 
 class CBlockIndex;
+class CMPTransaction;
 class CZMQAbstractNotifier;
 
+namespace mastercore
+{
+struct CZusBalanceDelta;
+struct CZusTradeEvent;
+}
+
 class CZMQNotificationInterface : public CValidationInterface
 {
 public:
@@ -27,6 +35,12 @@ protected:
     void SyncTransaction(const CTransaction& tx, const CBlockIndex *pindex, const CBlock* pblock);
     void UpdatedBlockTip(const CBlockIndex *pindex);
 
+    // Zus layer signals
+    void ZusTransactionProcessed(const CMPTransaction& mptx, int result);
+    void ZusTradeMatched(const mastercore::CZusTradeEvent& trade);
+    void ZusBalancesChanged(int block, const uint256& blockHash, const std::vector<mastercore::CZusBalanceDelta>& deltas);
+    void ZusReorg(int block, const uint256& blockHash);
+
 private:
     CZMQNotificationInterface();
 
@@ -7,6 +7,9 @@
 #include "main.h"
 #include "util.h"
 #include "rpc/server.h"
+#include "streams.h"
+#include "zurbank/events.h"
+#include "zurbank/tx.h"
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
@@ -14,6 +17,10 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_ZUSTX     = "zustx";
+static const char *MSG_ZUSTRADE  = "zustrade";
+static const char *MSG_ZUSBALANCE = "zusbalance";
+static const char *MSG_ZUSREORG  = "zusreorg";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -190,3 +197,62 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+bool CZMQPublishZusTransactionNotifier::NotifyZusTransaction(const CMPTransaction &mptx, int result)
+{
+    LogPrint("zmq", "zmq: Publish zustx %s\n", mptx.getHash().GetHex());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << mptx.getHash();
+    ss << (int32_t) mptx.getBlock();
+    ss << (uint32_t) mptx.getIndexInBlock();
+    ss << (uint16_t) mptx.getType();
+    ss << (uint16_t) mptx.getVersion();
+    ss << (uint32_t) mptx.getProperty();
+    ss << mptx.getAmount();
+    ss << (int32_t) result;
+    ss << mptx.getSender();
+    ss << mptx.getReceiver();
+    return SendMessage(MSG_ZUSTX, &(*ss.begin()), ss.size());
+}
+
+bool CZMQPublishZusTradeNotifier::NotifyZusTrade(const mastercore::CZusTradeEvent &trade)
+{
+    LogPrint("zmq", "zmq: Publish zustrade %s %s\n", trade.txid1.GetHex(), trade.txid2.GetHex());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << (int32_t) trade.block;
+    ss << trade.txid1;
+    ss << trade.txid2;
+    ss << trade.property1;
+    ss << trade.property2;
+    ss << trade.amount1;
+    ss << trade.amount2;
+    ss << trade.fee;
+    ss << trade.address1;
+    ss << trade.address2;
+    return SendMessage(MSG_ZUSTRADE, &(*ss.begin()), ss.size());
+}
+
+bool CZMQPublishZusBalanceNotifier::NotifyZusBalances(int block, const uint256 &blockHash, const std::vector<mastercore::CZusBalanceDelta> &deltas)
+{
+    LogPrint("zmq", "zmq: Publish zusbalance %s (%d changes)\n", blockHash.GetHex(), deltas.size());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << (int32_t) block;
+    ss << blockHash;
+    WriteCompactSize(ss, deltas.size());
+    for (std::vector<mastercore::CZusBalanceDelta>::const_iterator it = deltas.begin(); it != deltas.end(); ++it) {
+        ss << it->address;
+        ss << it->propertyId;
+        ss << (uint8_t) it->ttype;
+        ss << it->amount;
+    }
+    return SendMessage(MSG_ZUSBALANCE, &(*ss.begin()), ss.size());
+}
+
+bool CZMQPublishZusReorgNotifier::NotifyZusReorg(int block, const uint256 &blockHash)
+{
+    LogPrint("zmq", "zmq: Publish zusreorg %s\n", blockHash.GetHex());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << (int32_t) block;
+    ss << blockHash;
+    return SendMessage(MSG_ZUSREORG, &(*ss.begin()), ss.size());
+}
@@ -52,4 +52,28 @@ public:
     bool NotifyTransaction(const CTransaction &transaction);
 };
 
+class CZMQPublishZusTransactionNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyZusTransaction(const CMPTransaction &mptx, int result);
+};
+
+class CZMQPublishZusTradeNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyZusTrade(const mastercore::CZusTradeEvent &trade);
+};
+
+class CZMQPublishZusBalanceNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyZusBalances(int block, const uint256 &blockHash, const std::vector<mastercore::CZusBalanceDelta> &deltas);
+};
+
+class CZMQPublishZusReorgNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyZusReorg(int block, const uint256 &blockHash);
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
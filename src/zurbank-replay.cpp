@@ -0,0 +1,304 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/**
+ * @file zurbank-replay.cpp
+ *
+ * Processes a range of blocks of an existing data directory into a separate,
+ * throwaway Zus state, and reports the time spent per block, as well as the
+ * consensus hashes, to compare the performance and results of builds.
+ *
+ * The blocks, the block index and the chainstate are only read, but the node
+ * using the data directory must not be running.
+ */
+
+#if defined(HAVE_CONFIG_H)
+#include "config/zurcoin-config.h"
+#endif
+
+#include "zurbank/consensushash.h"
+#include "zurbank/perfstats.h"
+#include "zurbank/rules.h"
+#include "zurbank/seedblocks.h"
+#include "zurbank/utilsui.h"
+#include "zurbank/zurbank.h"
+
+#include "chain.h"
+#include "chainparams.h"
+#include "clientversion.h"
+#include "coins.h"
+#include "crypto/quark.h"
+#include "crypto/sha256.h"
+#include "init.h"
+#include "key.h"
+#include "main.h"
+#include "noui.h"
+#include "primitives/block.h"
+#include "pubkey.h"
+#include "sync.h"
+#include "txdb.h"
+#include "util.h"
+#include "utiltime.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+//! Cache sizes of the block index and the chainstate, which are only read
+static const size_t REPLAY_BLOCKTREE_CACHE = 64 << 20;
+static const size_t REPLAY_COINS_CACHE = 8 << 20;
+
+static const int CONTINUE_EXECUTION = -1;
+
+//! Chainstate of the data directory, used to load the block index
+static CCoinsViewDB* pcoinsdbview = NULL;
+
+static std::string HelpMessageReplay()
+{
+    std::string strUsage = strprintf("ZURBank replay version %s\n", FormatFullVersion()) + "\n" +
+        "Usage:\n" +
+        "  zurbank-replay -replaydir=<dir> [options]   Process blocks of the data directory into <dir>\n";
+
+    strUsage += HelpMessageGroup("Options:");
+    strUsage += HelpMessageOpt("-datadir=<dir>", "Data directory with the blocks to process, which must have a transaction index");
+    strUsage += HelpMessageOpt("-replaydir=<dir>", "Directory of the Zus state, which is wiped, unless -startclean=0 is set");
+    strUsage += HelpMessageOpt("-from=<n>", "First block to time; the blocks before are processed beforehand (default: Zus genesis block)");
+    strUsage += HelpMessageOpt("-to=<n>", "Last block to process (default: tip of the data directory)");
+    strUsage += HelpMessageOpt("-checkpoints=<n>", "Print the consensus hash every <n> blocks, and after the last block (default: 0, last block only)");
+    strUsage += HelpMessageOpt("-omnithreads=<n>", "Number of threads used for the parallel parts of the Zus processing (default: number of cores)");
+    strUsage += HelpMessageOpt("-omnidbcache=<n>", "Size of the block cache shared by the Zus databases in megabytes (default: 32)");
+    strUsage += HelpMessageOpt("-omnipersist", "Store the in-memory state in files while processing blocks (default: 1)");
+    strUsage += HelpMessageOpt("-omniseedblockfilter", "Skip blocks without Zus transactions (default: 1)");
+    strUsage += HelpMessageOpt("-testnet", "Use the test chain");
+    strUsage += HelpMessageOpt("-regtest", "Use the regression test chain");
+
+    return strUsage;
+}
+
+/** Prints the total time spent in each stage of the Zus processing, and in the databases. */
+static void PrintStageTotals()
+{
+    std::map<int, CPerfHistogram> mapStages;
+    std::map<uint16_t, CPerfHistogram> mapTxTypes;
+    GetPerfStats(mapStages, mapTxTypes);
+
+    for (std::map<int, CPerfHistogram>::const_iterator it = mapStages.begin(); it != mapStages.end(); ++it) {
+        const CPerfHistogram& histogram = it->second;
+        if (histogram.nCount == 0) continue;
+        fprintf(stdout, "stage %-16s count=%llu total=%.3fms max=%.3fms\n", GetPerfStageName(it->first).c_str(),
+                (unsigned long long) histogram.nCount, histogram.nTotalMicros * 0.001, histogram.nMaxMicros * 0.001);
+    }
+
+    std::vector<CPerfDBStats> vDBStats;
+    GetPerfDBStats(vDBStats);
+    for (std::vector<CPerfDBStats>::const_iterator it = vDBStats.begin(); it != vDBStats.end(); ++it) {
+        fprintf(stdout, "db %-16s lookups=%llu misses=%llu lookup=%.3fms writes=%llu write=%.3fms\n", it->name.c_str(),
+                (unsigned long long) it->nLookups, (unsigned long long) it->nLookupMisses, it->nLookupMicros * 0.001,
+                (unsigned long long) it->nWrites, it->nWriteMicros * 0.001);
+    }
+}
+
+/** Processes the blocks in the range, and prints one line per block. */
+static bool ReplayBlocks(CBlockIndex* pindexLast, int nFirstBlock, int nCheckpointInterval)
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    const bool fSeedBlockFilter = GetBoolArg("-omniseedblockfilter", true);
+
+    int64_t nTimeRead = 0;
+    int64_t nTimeProcess = 0;
+    unsigned int nTxsTotal = 0;
+    unsigned int nTxsFoundTotal = 0;
+
+    fprintf(stdout, "height hash txs zustxs read_ms process_ms\n");
+
+    for (int nBlock = nFirstBlock; nBlock <= pindexLast->nHeight; ++nBlock) {
+        if (ShutdownRequested()) {
+            fprintf(stderr, "Error: Processing stopped at block %d\n", nBlock);
+            return false;
+        }
+
+        CBlockIndex* pindex = pindexLast->GetAncestor(nBlock);
+        unsigned int nTxNum = 0;
+        unsigned int nTxsFound = 0;
+
+        int64_t nTime1 = GetTimeMicros();
+        CBlock block;
+        bool fSkip = fSeedBlockFilter && SkipBlock(nBlock);
+        if (!fSkip && !ReadBlockFromDisk(block, pindex, consensusParams)) {
+            fprintf(stderr, "Error: Failed to read block %d\n", nBlock);
+            return false;
+        }
+        int64_t nTime2 = GetTimeMicros();
+
+        // same order as when connecting a block
+        mastercore_handler_block_begin(nBlock - 1, pindex);
+        {
+            LOCK(cs_main);
+            chainActive.SetTip(pindex);
+        }
+        BOOST_FOREACH(const CTransaction& tx, block.vtx) {
+            if (mastercore_handler_tx(tx, nBlock, nTxNum, pindex)) ++nTxsFound;
+            ++nTxNum;
+        }
+        mastercore_handler_block_end(nBlock, pindex, nTxsFound);
+        int64_t nTime3 = GetTimeMicros();
+
+        nTimeRead += nTime2 - nTime1;
+        nTimeProcess += nTime3 - nTime2;
+        nTxsTotal += nTxNum;
+        nTxsFoundTotal += nTxsFound;
+
+        fprintf(stdout, "%d %s %u %u %.3f %.3f\n", nBlock, pindex->GetBlockHash().GetHex().c_str(), nTxNum, nTxsFound,
+                (nTime2 - nTime1) * 0.001, (nTime3 - nTime2) * 0.001);
+
+        if (nBlock == pindexLast->nHeight || (nCheckpointInterval > 0 && nBlock % nCheckpointInterval == 0)) {
+            fprintf(stdout, "consensushash %d %s\n", nBlock, GetConsensusHash().GetHex().c_str());
+        }
+    }
+
+    int nBlocks = pindexLast->nHeight - nFirstBlock + 1;
+    fprintf(stdout, "blocks=%d txs=%u zustxs=%u read=%.3fs process=%.3fs (%.3fms/block)\n", nBlocks, nTxsTotal, nTxsFoundTotal,
+            nTimeRead * 0.000001, nTimeProcess * 0.000001, nBlocks > 0 ? nTimeProcess * 0.001 / nBlocks : 0.0);
+    PrintStageTotals();
+
+    return true;
+}
+
+//
+// This function returns either one of EXIT_ codes when it's expected to stop the process or
+// CONTINUE_EXECUTION when it's expected to continue further.
+//
+static int AppInitReplay(int argc, char* argv[])
+{
+    ParseParameters(argc, argv);
+
+    if (mapArgs.count("-?") || mapArgs.count("-h") || mapArgs.count("-help") || !mapArgs.count("-replaydir")) {
+        fprintf(stdout, "%s", HelpMessageReplay().c_str());
+        return mapArgs.count("-replaydir") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (!boost::filesystem::is_directory(GetDataDir(false))) {
+        fprintf(stderr, "Error: Specified data directory \"%s\" does not exist.\n", mapArgs["-datadir"].c_str());
+        return EXIT_FAILURE;
+    }
+    try {
+        ReadConfigFile(mapArgs, mapMultiArgs);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Error reading configuration file: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    try {
+        SelectParams(ChainNameFromCommandLine());
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Error: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    // the Zus state and log go into the replay directory, nothing is written to the data directory
+    boost::filesystem::path pathReplay = boost::filesystem::system_complete(mapArgs["-replaydir"]);
+    if (boost::filesystem::exists(pathReplay) &&
+            (boost::filesystem::equivalent(pathReplay, GetDataDir(false)) || boost::filesystem::equivalent(pathReplay, GetDataDir(true)))) {
+        fprintf(stderr, "Error: The replay directory \"%s\" must not be the data directory, as its Zus state would be wiped.\n", pathReplay.string().c_str());
+        return EXIT_FAILURE;
+    }
+    TryCreateDirectory(pathReplay);
+    mapArgs["-omnidatadir"] = pathReplay.string();
+    SoftSetArg("-omnilogfile", (pathReplay / "zurbank.log").string());
+    SoftSetBoolArg("-startclean", true);
+    fPrintToDebugLog = false;
+
+    return CONTINUE_EXECUTION;
+}
+
+int main(int argc, char* argv[])
+{
+    SetupEnvironment();
+
+    // Indicate no-UI mode
+    fQtMode = false;
+    noui_connect();
+
+    try {
+        int ret = AppInitReplay(argc, argv);
+        if (ret != CONTINUE_EXECUTION) return ret;
+    } catch (const std::exception& e) {
+        PrintExceptionContinue(&e, "AppInitReplay()");
+        return EXIT_FAILURE;
+    }
+
+    // the same implementations as the node, so that the timings are comparable
+    SHA256AutoDetect();
+    QuarkAutoDetect();
+
+    ECC_Start();
+    ECCVerifyHandle verifyHandle;
+    bool fRet = false;
+
+    try {
+        pblocktree = new CBlockTreeDB(REPLAY_BLOCKTREE_CACHE, false, false);
+        pcoinsdbview = new CCoinsViewDB(REPLAY_COINS_CACHE, false, false);
+        pcoinsTip = new CCoinsViewCache(pcoinsdbview);
+
+        CBlockIndex* pindexTip = NULL;
+        {
+            LOCK(cs_main);
+            if (!LoadBlockIndex()) {
+                throw std::runtime_error("failed to load the block index");
+            }
+            if (!fTxIndex) {
+                throw std::runtime_error("the data directory has no transaction index, see -txindex");
+            }
+            pindexTip = chainActive.Tip();
+        }
+        if (pindexTip == NULL) {
+            throw std::runtime_error("the data directory has no blocks");
+        }
+
+        int nFirstBlock = std::max((int) GetArg("-from", ConsensusParams().GENESIS_BLOCK), 1);
+        int nLastBlock = std::min((int) GetArg("-to", pindexTip->nHeight), pindexTip->nHeight);
+        if (nLastBlock < nFirstBlock) {
+            throw std::runtime_error(strprintf("invalid block range %d to %d", nFirstBlock, nLastBlock));
+        }
+        CBlockIndex* pindexLast = pindexTip->GetAncestor(nLastBlock);
+
+        // initialize the state, which processes the blocks before the range
+        {
+            LOCK(cs_main);
+            chainActive.SetTip(pindexLast->GetAncestor(nFirstBlock - 1));
+        }
+        int64_t nTimeStart = GetTimeMicros();
+        mastercore_init();
+        fprintf(stdout, "Initialized the state up to block %d in %.3fs\n", nFirstBlock - 1, (GetTimeMicros() - nTimeStart) * 0.000001);
+        ResetPerfStats();
+
+        fRet = ReplayBlocks(pindexLast, nFirstBlock, GetArg("-checkpoints", 0));
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Error: %s\n", e.what());
+    }
+
+    mastercore_shutdown();
+    {
+        LOCK(cs_main);
+        UnloadBlockIndex();
+    }
+    delete pcoinsTip;
+    pcoinsTip = NULL;
+    delete pcoinsdbview;
+    pcoinsdbview = NULL;
+    delete pblocktree;
+    pblocktree = NULL;
+    ECC_Stop();
+
+    return fRet ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -10,6 +10,7 @@
 
 #include "zurbank/log.h"
 #include "zurbank/version.h"
+#include "zurbank/zurbank.h"
 
 #include "main.h"
 #include "ui_interface.h"
@@ -91,7 +92,7 @@ void CheckLiveActivations(int blockHeight)
             PrintToLog(msgText);
             PrintToConsole(msgText);
             if (!GetBoolArg("-overrideforcedshutdown", false)) {
-                boost::filesystem::path persistPath = GetDataDir() / "MP_persist";
+                boost::filesystem::path persistPath = GetZusDataDir() / "MP_persist";
                 if (boost::filesystem::exists(persistPath)) boost::filesystem::remove_all(persistPath); // prevent the node being restarted without a reparse after forced shutdown
                 AbortNode(msgText, msgText);
             }
@@ -3,19 +3,314 @@
 #include "zurbank/log.h"
 
 #include "util.h"
+#include "utiltime.h"
 
+#include "leveldb/cache.h"
 #include "leveldb/db.h"
+#include "leveldb/filter_policy.h"
 #include "leveldb/write_batch.h"
 
 #include <boost/filesystem/path.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+/**
+ * Iterates over the entries of the database merged with the staged writes, as
+ * of the creation of the iterator. Staged values replace the values of the
+ * database, and staged deletions hide them. The staged writes are looked up
+ * by key for every step, so that they can change between the steps.
+ */
+class CStagedIterator : public leveldb::Iterator
+{
+private:
+    typedef std::map<std::string, std::vector<CDBStagedWrite> >::const_iterator StagedIterator;
+
+    leveldb::Iterator* base;
+    CCriticalSection& cs_staged;
+    std::shared_ptr<const CDBStagedWrites> pStaged;
+    //! Number of the last write, which is visible
+    uint64_t nSnapshot;
+    //! The current staged write and its key, if fStagedValid
+    bool fStagedValid;
+    std::string strStagedKey;
+    CDBStagedWrite staged;
+    //! Whether the current entry is a staged one
+    bool fStaged;
+    bool fValid;
+    bool fForward;
+
+    /** Returns the visible write of a key, or NULL, if the key was written later. */
+    const CDBStagedWrite* GetVisible(StagedIterator it) const
+    {
+        for (std::vector<CDBStagedWrite>::const_reverse_iterator rit = it->second.rbegin(); rit != it->second.rend(); ++rit) {
+            if (rit->nSequence <= nSnapshot) return &*rit;
+        }
+        return NULL;
+    }
+
+    /** Moves to the first visible staged write at or after the position. */
+    void SettleForward(StagedIterator it)
+    {
+        AssertLockHeld(cs_staged);
+        for (; it != pStaged->mapWrites.end(); ++it) {
+            const CDBStagedWrite* pwrite = GetVisible(it);
+            if (pwrite) {
+                strStagedKey = it->first;
+                staged = *pwrite;
+                fStagedValid = true;
+                return;
+            }
+        }
+        fStagedValid = false;
+    }
+
+    /** Moves to the last visible staged write before the position. */
+    void SettleBackward(StagedIterator it)
+    {
+        AssertLockHeld(cs_staged);
+        while (it != pStaged->mapWrites.begin()) {
+            const CDBStagedWrite* pwrite = GetVisible(--it);
+            if (pwrite) {
+                strStagedKey = it->first;
+                staged = *pwrite;
+                fStagedValid = true;
+                return;
+            }
+        }
+        fStagedValid = false;
+    }
+
+    void StagedSeek(const std::string& key)
+    {
+        LOCK(cs_staged);
+        SettleForward(pStaged->mapWrites.lower_bound(key));
+    }
+
+    void StagedSeekBefore(const std::string& key)
+    {
+        LOCK(cs_staged);
+        SettleBackward(pStaged->mapWrites.lower_bound(key));
+    }
+
+    void StagedNext()
+    {
+        LOCK(cs_staged);
+        SettleForward(pStaged->mapWrites.upper_bound(strStagedKey));
+    }
+
+    void StagedPrev()
+    {
+        std::string strKey = strStagedKey;
+        StagedSeekBefore(strKey);
+    }
+
+    /** Settles on the smallest visible entry at or after both positions. */
+    void FindForward()
+    {
+        fForward = true;
+        while (true) {
+            bool fBase = base->Valid();
+            if (!fBase && !fStagedValid) break;
+            int c = !fBase ? 1 : !fStagedValid ? -1 : base->key().compare(strStagedKey);
+            if (c < 0) {
+                fStaged = false;
+                fValid = true;
+                return;
+            }
+            if (c == 0) base->Next();
+            if (!staged.fErase) {
+                fStaged = true;
+                fValid = true;
+                return;
+            }
+            StagedNext();
+        }
+        fValid = false;
+    }
+
+    /** Settles on the largest visible entry at or before both positions. */
+    void FindBackward()
+    {
+        fForward = false;
+        while (true) {
+            bool fBase = base->Valid();
+            if (!fBase && !fStagedValid) break;
+            int c = !fBase ? -1 : !fStagedValid ? 1 : base->key().compare(strStagedKey);
+            if (c > 0) {
+                fStaged = false;
+                fValid = true;
+                return;
+            }
+            if (c == 0) base->Prev();
+            if (!staged.fErase) {
+                fStaged = true;
+                fValid = true;
+                return;
+            }
+            StagedPrev();
+        }
+        fValid = false;
+    }
+
+public:
+    CStagedIterator(leveldb::Iterator* baseIn, CCriticalSection& csStagedIn, const std::shared_ptr<const CDBStagedWrites>& pStagedIn, uint64_t nSnapshotIn)
+        : base(baseIn), cs_staged(csStagedIn), pStaged(pStagedIn), nSnapshot(nSnapshotIn), fStagedValid(false), fStaged(false), fValid(false), fForward(true) {}
+
+    ~CStagedIterator() { delete base; }
+
+    bool Valid() const { return fValid; }
+
+    void SeekToFirst()
+    {
+        base->SeekToFirst();
+        {
+            LOCK(cs_staged);
+            SettleForward(pStaged->mapWrites.begin());
+        }
+        FindForward();
+    }
+
+    void SeekToLast()
+    {
+        base->SeekToLast();
+        {
+            LOCK(cs_staged);
+            SettleBackward(pStaged->mapWrites.end());
+        }
+        FindBackward();
+    }
+
+    void Seek(const leveldb::Slice& target)
+    {
+        base->Seek(target);
+        StagedSeek(target.ToString());
+        FindForward();
+    }
+
+    void Next()
+    {
+        assert(fValid);
+        if (!fForward) {
+            // reposition both sides at the current key
+            std::string strKey = key().ToString();
+            Seek(strKey);
+        }
+        if (fStaged) {
+            StagedNext();
+        } else {
+            base->Next();
+        }
+        FindForward();
+    }
+
+    void Prev()
+    {
+        assert(fValid);
+        if (fForward) {
+            // position both sides before the current key
+            std::string strKey = key().ToString();
+            base->Seek(strKey);
+            if (base->Valid()) {
+                base->Prev();
+            } else {
+                base->SeekToLast();
+            }
+            StagedSeekBefore(strKey);
+        } else if (fStaged) {
+            StagedPrev();
+        } else {
+            base->Prev();
+        }
+        FindBackward();
+    }
+
+    leveldb::Slice key() const { return fStaged ? leveldb::Slice(strStagedKey) : base->key(); }
+    leveldb::Slice value() const { return fStaged ? leveldb::Slice(staged.value) : base->value(); }
+    leveldb::Status status() const { return base->status(); }
+};
+
+/** Stages the changes of a WriteBatch. */
+class CStagingHandler : public leveldb::WriteBatch::Handler
+{
+private:
+    CDBStagedWrites& staged;
+
+    /** Returns the write to fill in for a key, which replaces the last one, if no iterator can see it. */
+    CDBStagedWrite& Stage(const leveldb::Slice& key)
+    {
+        std::vector<CDBStagedWrite>& vWrites = staged.mapWrites[key.ToString()];
+        if (vWrites.empty() || vWrites.back().nSequence <= staged.nSnapshot) {
+            vWrites.push_back(CDBStagedWrite());
+        }
+        CDBStagedWrite& write = vWrites.back();
+        write.nSequence = ++staged.nSequence;
+        return write;
+    }
+
+public:
+    explicit CStagingHandler(CDBStagedWrites& stagedIn) : staged(stagedIn) {}
+
+    void Put(const leveldb::Slice& key, const leveldb::Slice& value)
+    {
+        CDBStagedWrite& write = Stage(key);
+        write.fErase = false;
+        write.value.assign(value.data(), value.size());
+    }
+
+    void Delete(const leveldb::Slice& key)
+    {
+        CDBStagedWrite& write = Stage(key);
+        write.fErase = true;
+        write.value.clear();
+    }
+};
+
+/** The block cache and the filter policy, which are shared by all databases. */
+class CDBSharedResources
+{
+public:
+    leveldb::Cache* blockCache;
+    const leveldb::FilterPolicy* filterPolicy;
+
+    CDBSharedResources()
+    {
+        int64_t nCacheSize = std::max(GetArg("-omnidbcache", DEFAULT_OMNI_DB_CACHE), (int64_t) 1) << 20;
+        blockCache = leveldb::NewLRUCache(nCacheSize);
+        filterPolicy = leveldb::NewBloomFilterPolicy(10);
+    }
+
+    ~CDBSharedResources()
+    {
+        delete blockCache;
+        delete filterPolicy;
+    }
+};
+
+/** Returns the shared resources, which are created when the first database is opened. */
+CDBSharedResources& GetSharedResources()
+{
+    static CDBSharedResources resources;
+    return resources;
+}
+} // anonymous namespace
 
 /**
  * Opens or creates a LevelDB based database.
  */
 leveldb::Status CDBBase::Open(const boost::filesystem::path& path, bool fWipe)
 {
+    CDBSharedResources& resources = GetSharedResources();
+    options.block_cache = resources.blockCache;
+    options.filter_policy = resources.filterPolicy;
+
     if (fWipe) {
         if (msc_debug_persistence) PrintToLog("Wiping LevelDB in %s\n", path.string());
         leveldb::DestroyDB(path.string(), options);
@@ -26,11 +321,202 @@ leveldb::Status CDBBase::Open(const boost::filesystem::path& path, bool fWipe)
     return leveldb::DB::Open(options, path.string(), &pdb);
 }
 
+/**
+ * Creates and returns a new LevelDB iterator, which includes the staged writes.
+ */
+leveldb::Iterator* CDBBase::NewIterator() const
+{
+    assert(pdb != NULL);
+    leveldb::Iterator* it = pdb->NewIterator(iteroptions);
+
+    LOCK(cs_staged);
+    if (pStaged->mapWrites.empty()) {
+        return it;
+    }
+    pStaged->nSnapshot = pStaged->nSequence;
+    return new CStagedIterator(it, cs_staged, pStaged, pStaged->nSnapshot);
+}
+
+/**
+ * Reads an entry, taking staged writes into account.
+ */
+leveldb::Status CDBBase::Get(const leveldb::Slice& key, std::string* value) const
+{
+    assert(pdb != NULL);
+    {
+        LOCK(cs_staged);
+        if (!pStaged->mapWrites.empty()) {
+            std::map<std::string, std::vector<CDBStagedWrite> >::const_iterator it = pStaged->mapWrites.find(key.ToString());
+            if (it != pStaged->mapWrites.end()) {
+                const CDBStagedWrite& write = it->second.back();
+                if (write.fErase) {
+                    return leveldb::Status::NotFound(key);
+                }
+                *value = write.value;
+                return leveldb::Status::OK();
+            }
+        }
+    }
+    int64_t nTimeStart = GetTimeMicros();
+    leveldb::Status status = pdb->Get(readoptions, key, value);
+    ++nLookups;
+    if (status.IsNotFound()) ++nLookupMisses;
+    nLookupMicros += GetTimeMicros() - nTimeStart;
+    return status;
+}
+
+/**
+ * Writes an entry, or stages it, if a batch is open.
+ */
+leveldb::Status CDBBase::Put(const leveldb::Slice& key, const leveldb::Slice& value)
+{
+    assert(pdb != NULL);
+    {
+        LOCK(cs_staged);
+        if (fBatching) {
+            CStagingHandler(*pStaged).Put(key, value);
+            return leveldb::Status::OK();
+        }
+    }
+    LOCK(cs_single);
+    batchSingle.Clear();
+    batchSingle.Put(key, value);
+    return WriteToDB(batchSingle, false);
+}
+
+/**
+ * Deletes an entry, or stages the deletion, if a batch is open.
+ */
+leveldb::Status CDBBase::Delete(const leveldb::Slice& key)
+{
+    assert(pdb != NULL);
+    {
+        LOCK(cs_staged);
+        if (fBatching) {
+            CStagingHandler(*pStaged).Delete(key);
+            return leveldb::Status::OK();
+        }
+    }
+    LOCK(cs_single);
+    batchSingle.Clear();
+    batchSingle.Delete(key);
+    return WriteToDB(batchSingle, false);
+}
+
+/**
+ * Writes a batch of changes atomically, or stages them, if a batch is open.
+ */
+leveldb::Status CDBBase::Write(leveldb::WriteBatch& batch, bool fSync)
+{
+    assert(pdb != NULL);
+    {
+        LOCK(cs_staged);
+        if (fBatching) {
+            CStagingHandler handler(*pStaged);
+            fStagedSync |= fSync;
+            return batch.Iterate(&handler);
+        }
+    }
+    return WriteToDB(batch, fSync);
+}
+
+/**
+ * Writes a batch of changes directly to the database, even if a batch is open.
+ */
+leveldb::Status CDBBase::WriteToDB(leveldb::WriteBatch& batch, bool fSync)
+{
+    int64_t nTimeStart = GetTimeMicros();
+    leveldb::Status status = pdb->Write(fSync ? syncoptions : writeoptions, &batch);
+    ++nWrites;
+    nWriteMicros += GetTimeMicros() - nTimeStart;
+    return status;
+}
+
+/**
+ * Starts staging all writes in memory, until the batch is committed or discarded.
+ */
+void CDBBase::BeginBatch()
+{
+    LOCK(cs_staged);
+    fBatching = true;
+}
+
+/**
+ * Writes all staged changes with a single atomic write, and stops staging.
+ */
+leveldb::Status CDBBase::CommitBatch()
+{
+    assert(pdb != NULL);
+    LOCK(cs_staged);
+    fBatching = false;
+    if (pStaged->mapWrites.empty()) {
+        return leveldb::Status::OK();
+    }
+
+    leveldb::WriteBatch batch;
+    for (std::map<std::string, std::vector<CDBStagedWrite> >::const_iterator it = pStaged->mapWrites.begin(); it != pStaged->mapWrites.end(); ++it) {
+        const CDBStagedWrite& write = it->second.back();
+        if (write.fErase) {
+            batch.Delete(it->first);
+        } else {
+            batch.Put(it->first, write.value);
+        }
+    }
+    leveldb::Status status = WriteToDB(batch, fStagedSync);
+
+    if (msc_debug_persistence) PrintToLog("Committed %d staged writes: %s\n", pStaged->mapWrites.size(), status.ToString());
+
+    // iterators, which are still open, keep the writes they see
+    pStaged.reset(new CDBStagedWrites());
+    fStagedSync = false;
+    return status;
+}
+
+/**
+ * Drops all staged changes, and stops staging.
+ */
+void CDBBase::DiscardBatch()
+{
+    LOCK(cs_staged);
+    fBatching = false;
+    fStagedSync = false;
+    pStaged.reset(new CDBStagedWrites());
+}
+
+/**
+ * Returns the number of staged changes.
+ */
+size_t CDBBase::GetStagedCount() const
+{
+    LOCK(cs_staged);
+    return pStaged->mapWrites.size();
+}
+
+/**
+ * Returns the lookup and write counters since the database was opened or cleared.
+ */
+CDBAccessStats CDBBase::GetAccessStats() const
+{
+    CDBAccessStats stats;
+    stats.nLookups = nLookups;
+    stats.nLookupMisses = nLookupMisses;
+    stats.nLookupMicros = nLookupMicros;
+    stats.nWrites = nWrites;
+    stats.nWriteMicros = nWriteMicros;
+    return stats;
+}
+
 /**
  * Deletes all entries of the database, and resets the counters.
  */
 void CDBBase::Clear()
 {
+    {
+        LOCK(cs_staged);
+        pStaged.reset(new CDBStagedWrites());
+        fStagedSync = false;
+    }
+
     int64_t nTimeStart = GetTimeMicros();
     unsigned int n = 0;
     leveldb::WriteBatch batch;
@@ -44,8 +530,11 @@ void CDBBase::Clear()
     delete it;
 
     leveldb::Status status = pdb->Write(writeoptions, &batch);
-    nRead = 0;
-    nWritten = 0;
+    nLookups = 0;
+    nLookupMisses = 0;
+    nLookupMicros = 0;
+    nWrites = 0;
+    nWriteMicros = 0;
 
     int64_t nTime = GetTimeMicros() - nTimeStart;
     if (msc_debug_persistence)
@@ -58,6 +547,7 @@ void CDBBase::Clear()
  */
 void CDBBase::Close()
 {
+    DiscardBatch();
     if (pdb) {
         delete pdb;
         pdb = NULL;
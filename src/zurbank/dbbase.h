@@ -1,14 +1,75 @@
 #ifndef ZURBANK_DBBASE_H
 #define ZURBANK_DBBASE_H
 
+#include "sync.h"
+
 #include "leveldb/db.h"
+#include "leveldb/write_batch.h"
 
 #include <boost/filesystem/path.hpp>
 
 #include <assert.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! Default size of the block cache shared by the Zus databases, in MiB
+static const int64_t DEFAULT_OMNI_DB_CACHE = 32;
+
+/** A write, which is staged until the block is committed.
+ */
+struct CDBStagedWrite
+{
+    //! Whether the key is deleted, instead of set to the value
+    bool fErase;
+    std::string value;
+    //! Number of the write within the batch, to tell which iterators can see it
+    uint64_t nSequence;
+
+    CDBStagedWrite() : fErase(false), nSequence(0) {}
+};
+
+/** The staged writes of a batch, which are shared with the iterators.
+ *
+ * An earlier write of a key is only replaced, if no iterator was created since,
+ * otherwise the new write is added after it. The iterators read the writes in
+ * place, instead of copying them, and keep them after the batch is done.
+ */
+struct CDBStagedWrites
+{
+    //! The writes by key, oldest first
+    std::map<std::string, std::vector<CDBStagedWrite> > mapWrites;
+    //! Number of the last write
+    uint64_t nSequence;
+    //! Number of the last write, when the last iterator was created
+    uint64_t nSnapshot;
+
+    CDBStagedWrites() : nSequence(0), nSnapshot(0) {}
+};
+
+/** Counters of the accesses to a database, which are maintained automatically.
+ */
+struct CDBAccessStats
+{
+    //! Number of point lookups, and of those, which found no entry
+    uint64_t nLookups;
+    uint64_t nLookupMisses;
+    int64_t nLookupMicros;
+    //! Number of writes to the database, where a committed batch counts once
+    uint64_t nWrites;
+    int64_t nWriteMicros;
+
+    CDBAccessStats() : nLookups(0), nLookupMisses(0), nLookupMicros(0), nWrites(0), nWriteMicros(0) {}
+};
 
 /** Base class for LevelDB based storage.
+ *
+ * All databases share one block cache, sized by -omnidbcache, and use bloom
+ * filters, so that most lookups of missing keys don't touch the disk.
  */
 class CDBBase
 {
@@ -16,6 +77,31 @@ private:
     //! Options used when iterating over values of the database
     leveldb::ReadOptions iteroptions;
 
+    //! Protects the staged writes, which are also read by other threads
+    mutable CCriticalSection cs_staged;
+
+    //! Whether writes are staged, instead of written to the database
+    bool fBatching;
+
+    //! Whether one of the staged writes asked for a synchronous write
+    bool fStagedSync;
+
+    //! The staged writes
+    std::shared_ptr<CDBStagedWrites> pStaged;
+
+    //! Protects the batch of single writes
+    CCriticalSection cs_single;
+
+    //! Reused by single writes, which are not staged, so that they don't allocate a batch each
+    leveldb::WriteBatch batchSingle;
+
+    //! Access counters, see CDBAccessStats
+    mutable std::atomic<uint64_t> nLookups;
+    mutable std::atomic<uint64_t> nLookupMisses;
+    mutable std::atomic<int64_t> nLookupMicros;
+    std::atomic<uint64_t> nWrites;
+    std::atomic<int64_t> nWriteMicros;
+
 protected:
     //! Database options used
     leveldb::Options options;
@@ -32,13 +118,8 @@ protected:
     //! The database itself
     leveldb::DB* pdb;
 
-    //! Number of entries read
-    unsigned int nRead;
-
-    //! Number of entries written
-    unsigned int nWritten;
-
-    CDBBase() : pdb(NULL), nRead(0), nWritten(0)
+    CDBBase() : fBatching(false), fStagedSync(false), pStaged(new CDBStagedWrites()), nLookups(0), nLookupMisses(0), nLookupMicros(0), nWrites(0), nWriteMicros(0),
+        pdb(NULL)
     {
         options.paranoid_checks = true;
         options.create_if_missing = true;
@@ -59,19 +140,51 @@ protected:
      * Creates and returns a new LevelDB iterator.
      *
      * It is expected that the database is not closed. The iterator is owned by the
-     * caller, and the object has to be deleted explicitly.
+     * caller, and the object has to be deleted explicitly. Staged writes are
+     * visible through the iterator, as of the time it was created, without
+     * being copied.
      *
      * @return A new LevelDB iterator
      */
-    leveldb::Iterator* NewIterator() const
-    {
-        assert(pdb != NULL);
-        return pdb->NewIterator(iteroptions);
-    }
+    leveldb::Iterator* NewIterator() const;
+
+    /**
+     * Reads an entry, taking staged writes into account.
+     */
+    leveldb::Status Get(const leveldb::Slice& key, std::string* value) const;
+
+    /**
+     * Writes an entry, or stages it, if a batch is open.
+     */
+    leveldb::Status Put(const leveldb::Slice& key, const leveldb::Slice& value);
+
+    /**
+     * Deletes an entry, or stages the deletion, if a batch is open.
+     */
+    leveldb::Status Delete(const leveldb::Slice& key);
+
+    /**
+     * Writes a batch of changes atomically, or stages them, if a batch is open.
+     *
+     * @param batch  The changes to write
+     * @param fSync  Whether to wait until the changes are on disk
+     */
+    leveldb::Status Write(leveldb::WriteBatch& batch, bool fSync = false);
+
+    /**
+     * Writes a batch of changes directly to the database, even if a batch is open.
+     *
+     * @param batch  The changes to write
+     * @param fSync  Whether to wait until the changes are on disk
+     */
+    leveldb::Status WriteToDB(leveldb::WriteBatch& batch, bool fSync);
 
     /**
      * Opens or creates a LevelDB based database.
      *
+     * The shared block cache and bloom filter policy are used. Blocks are not
+     * compressed, as LevelDB is built without Snappy.
+     *
      * If the database is wiped before opening, it's content is destroyed, including
      * all log files and meta data.
      *
@@ -91,6 +204,29 @@ public:
      * Deletes all entries of the database, and resets the counters.
      */
     void Clear();
+
+    /**
+     * Starts staging all writes in memory, until the batch is committed or discarded.
+     */
+    void BeginBatch();
+
+    /**
+     * Writes all staged changes with a single atomic write, and stops staging.
+     *
+     * @return A Status object, indicating success or failure
+     */
+    leveldb::Status CommitBatch();
+
+    /**
+     * Drops all staged changes, and stops staging.
+     */
+    void DiscardBatch();
+
+    /** Returns the number of staged changes. */
+    size_t GetStagedCount() const;
+
+    /** Returns the lookup and write counters since the database was opened or cleared. */
+    CDBAccessStats GetAccessStats() const;
 };
 
 
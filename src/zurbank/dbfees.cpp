@@ -24,6 +24,7 @@
 
 #include <limits>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -95,9 +96,8 @@ void COmniFeeCache::ClearCache(const uint32_t &propertyId, int block)
     }
     if (msc_debug_fees) PrintToLog("   Adding zero valued entry: block %d\n", block);
     newValue += strprintf("%d:%d", block, 0);
-    leveldb::Status status = pdb->Put(writeoptions, key, newValue);
+    leveldb::Status status = Put(key, newValue);
     assert(status.ok());
-    ++nWritten;
 
     PruneCache(propertyId, block);
 
@@ -119,7 +119,7 @@ void COmniFeeCache::AddFee(const uint32_t &propertyId, int block, const int64_t
         const std::string& msg = strprintf("Shutting down due to fee cache overflow (block %d property %d current %d amount %d)\n", block, propertyId, currentCachedAmount, amount);
         PrintToLog(msg);
         if (!GetBoolArg("-overrideforcedshutdown", false)) {
-            boost::filesystem::path persistPath = GetDataDir() / "MP_persist";
+            boost::filesystem::path persistPath = GetZusDataDir() / "MP_persist";
             if (boost::filesystem::exists(persistPath)) boost::filesystem::remove_all(persistPath); // prevent the node being restarted without a reparse after forced shutdown
             AbortNode(msg, msg);
         }
@@ -143,9 +143,8 @@ void COmniFeeCache::AddFee(const uint32_t &propertyId, int block, const int64_t
     }
     if (msc_debug_fees) PrintToLog("   Adding requested entry: block %d new amount %d\n", block, newCachedAmount);
     newValue += strprintf("%d:%d", block, newCachedAmount);
-    leveldb::Status status = pdb->Put(writeoptions, key, newValue);
+    leveldb::Status status = Put(key, newValue);
     assert(status.ok());
-    ++nWritten;
     if (msc_debug_fees) PrintToLog("AddFee completed for property %d (new=%s [%s])\n", propertyId, newValue, status.ToString());
 
     // Call for pruning (we only prune when we update a record)
@@ -178,7 +177,7 @@ void COmniFeeCache::RollBackCache(int block)
                     if (!newValue.empty()) newValue += ",";
                     newValue += strprintf("%d:%d", tempItem.first, tempItem.second);
                 }
-                leveldb::Status status = pdb->Put(writeoptions, key, newValue);
+                leveldb::Status status = Put(key, newValue);
                 assert(status.ok());
                 PrintToLog("Rolling back fee cache for property %d, new=%s [%s])\n", propertyId, newValue, status.ToString());
             }
@@ -276,7 +275,7 @@ void COmniFeeCache::PruneCache(const uint32_t &propertyId, int block)
             newValue = strprintf("%d:%d", mostRecentItem.first, mostRecentItem.second);
             if (msc_debug_fees) PrintToLog("   All entries matured and pruned - readding most recent entry: block %d amount %d\n", mostRecentItem.first, mostRecentItem.second);
         }
-        leveldb::Status status = pdb->Put(writeoptions, key, newValue);
+        leveldb::Status status = Put(key, newValue);
         assert(status.ok());
         if (msc_debug_fees) PrintToLog("PruneCache completed for property %d (new=%s [%s])\n", propertyId, newValue, status.ToString());
     } else {
@@ -287,7 +286,8 @@ void COmniFeeCache::PruneCache(const uint32_t &propertyId, int block)
 // Show Fee Cache DB statistics
 void COmniFeeCache::printStats()
 {
-    PrintToConsole("COmniFeeCache stats: nWritten= %d , nRead= %d\n", nWritten, nRead);
+    CDBAccessStats stats = GetAccessStats();
+    PrintToConsole("COmniFeeCache stats: nWrites= %d , nLookups= %d\n", stats.nWrites, stats.nLookups);
 }
 
 // Show Fee Cache DB records
@@ -311,7 +311,7 @@ std::set<feeCacheItem> COmniFeeCache::GetCacheHistory(const uint32_t &propertyId
 
     std::set<feeCacheItem> sCacheHistoryItems;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    leveldb::Status status = Get(key, &strValue);
     if (status.IsNotFound()) {
         return sCacheHistoryItems; // no cache, return empty set
     }
@@ -348,7 +348,8 @@ COmniFeeHistory::~COmniFeeHistory()
 // Show Fee History DB statistics
 void COmniFeeHistory::printStats()
 {
-    PrintToConsole("COmniFeeHistory stats: nWritten= %d , nRead= %d\n", nWritten, nRead);
+    CDBAccessStats stats = GetAccessStats();
+    PrintToConsole("COmniFeeHistory stats: nWrites= %d , nLookups= %d\n", stats.nWrites, stats.nLookups);
 }
 
 // Show Fee History DB records
@@ -396,7 +397,7 @@ void COmniFeeHistory::RollBackHistory(int block)
         int feeBlock = boost::lexical_cast<int>(vFeeHistoryDetail[0]);
         if (feeBlock >= block) {
             PrintToLog("%s() deleting from fee history DB: %s %s\n", __FUNCTION__, strKey, strValue);
-            pdb->Delete(writeoptions, strKey);
+            Delete(strKey);
         }
     }
     delete it;
@@ -436,7 +437,7 @@ bool COmniFeeHistory::GetDistributionData(int id, uint32_t *propertyId, int *blo
 
     const std::string key = strprintf("%d", id);
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    leveldb::Status status = Get(key, &strValue);
     if (status.IsNotFound()) {
         return false; // fee distribution not found
     }
@@ -462,7 +463,7 @@ std::set<feeHistoryItem> COmniFeeHistory::GetFeeDistribution(int id)
     const std::string key = strprintf("%d", id);
     std::set<feeHistoryItem> sFeeHistoryItems;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    leveldb::Status status = Get(key, &strValue);
     if (status.IsNotFound()) {
         return sFeeHistoryItems; // fee distribution not found, return empty set
     }
@@ -511,7 +512,7 @@ void COmniFeeHistory::RecordFeeDistribution(const uint32_t &propertyId, int bloc
     }
 
     std::string value = strprintf("%d:%d:%d:%s", block, propertyId, total, feeRecipientsStr);
-    leveldb::Status status = pdb->Put(writeoptions, key, value);
+    leveldb::Status status = Put(key, value);
     if (msc_debug_fees) PrintToLog("Added fee distribution to feeCacheHistory - key=%s value=%s [%s]\n", key, value, status.ToString());
 }
 
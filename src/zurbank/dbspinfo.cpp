@@ -180,11 +180,11 @@ bool CMPSPInfo::updateSP(uint32_t propertyId, const Entry& info)
     std::string strSpPrevValue;
 
     // if a value exists move it to the old key
-    if (!pdb->Get(readoptions, slSpKey, &strSpPrevValue).IsNotFound()) {
+    if (!Get(slSpKey, &strSpPrevValue).IsNotFound()) {
         batch.Put(slSpPrevKey, strSpPrevValue);
     }
     batch.Put(slSpKey, slSpValue);
-    leveldb::Status status = pdb->Write(syncoptions, &batch);
+    leveldb::Status status = Write(batch, true);
 
     if (!status.ok()) {
         PrintToLog("%s(): ERROR for SP %d: %s\n", __func__, propertyId, status.ToString());
@@ -234,10 +234,10 @@ uint32_t CMPSPInfo::putSP(uint8_t ecosystem, const Entry& info)
 
     // sanity checking
     std::string existingEntry;
-    if (!pdb->Get(readoptions, slSpKey, &existingEntry).IsNotFound() && slSpValue.compare(existingEntry) != 0) {
+    if (!Get(slSpKey, &existingEntry).IsNotFound() && slSpValue.compare(existingEntry) != 0) {
         std::string strError = strprintf("writing SP %d to DB, when a different SP already exists for that identifier", propertyId);
         PrintToLog("%s() ERROR: %s\n", __func__, strError);
-    } else if (!pdb->Get(readoptions, slTxIndexKey, &existingEntry).IsNotFound() && slTxValue.compare(existingEntry) != 0) {
+    } else if (!Get(slTxIndexKey, &existingEntry).IsNotFound() && slTxValue.compare(existingEntry) != 0) {
         std::string strError = strprintf("writing index txid %s : SP %d is overwriting a different value", info.txid.ToString(), propertyId);
         PrintToLog("%s() ERROR: %s\n", __func__, strError);
     }
@@ -247,7 +247,7 @@ uint32_t CMPSPInfo::putSP(uint8_t ecosystem, const Entry& info)
     batch.Put(slSpKey, slSpValue);
     batch.Put(slTxIndexKey, slTxValue);
 
-    leveldb::Status status = pdb->Write(syncoptions, &batch);
+    leveldb::Status status = Write(batch, true);
 
     if (!status.ok()) {
         PrintToLog("%s(): ERROR for SP %d: %s\n", __func__, propertyId, status.ToString());
@@ -274,7 +274,7 @@ bool CMPSPInfo::getSP(uint32_t propertyId, Entry& info) const
 
     // DB value for property entry
     std::string strSpValue;
-    leveldb::Status status = pdb->Get(readoptions, slSpKey, &strSpValue);
+    leveldb::Status status = Get(slSpKey, &strSpValue);
     if (!status.ok()) {
         if (!status.IsNotFound()) {
             PrintToLog("%s(): ERROR for SP %d: %s\n", __func__, propertyId, status.ToString());
@@ -307,7 +307,7 @@ bool CMPSPInfo::hasSP(uint32_t propertyId) const
 
     // DB value for property entry
     std::string strSpValue;
-    leveldb::Status status = pdb->Get(readoptions, slSpKey, &strSpValue);
+    leveldb::Status status = Get(slSpKey, &strSpValue);
 
     return status.ok();
 }
@@ -323,7 +323,7 @@ uint32_t CMPSPInfo::findSPByTX(const uint256& txid) const
 
     // DB value for identifier
     std::string strTxIndexValue;
-    if (!pdb->Get(readoptions, slTxIndexKey, &strTxIndexValue).ok()) {
+    if (!Get(slTxIndexKey, &strTxIndexValue).ok()) {
         std::string strError = strprintf("failed to find property created with %s", txid.GetHex());
         PrintToLog("%s(): ERROR: %s", __func__, strError);
         return 0;
@@ -390,7 +390,7 @@ int64_t CMPSPInfo::popBlock(const uint256& block_hash)
                 leveldb::Slice slSpPrevKey(&ssSpPrevKey[0], ssSpPrevKey.size());
 
                 std::string strSpPrevValue;
-                if (!pdb->Get(readoptions, slSpPrevKey, &strSpPrevValue).IsNotFound()) {
+                if (!Get(slSpPrevKey, &strSpPrevValue).IsNotFound()) {
                     // copy the prev state to the current state and delete the old state
                     commitBatch.Put(slSpKey, strSpPrevValue);
                     commitBatch.Delete(slSpPrevKey);
@@ -409,7 +409,7 @@ int64_t CMPSPInfo::popBlock(const uint256& block_hash)
     // clean up the iterator
     delete iter;
 
-    leveldb::Status status = pdb->Write(syncoptions, &commitBatch);
+    leveldb::Status status = Write(commitBatch, true);
 
     if (!status.ok()) {
         PrintToLog("%s(): ERROR: %s\n", __func__, status.ToString());
@@ -435,7 +435,7 @@ void CMPSPInfo::setWatermark(const uint256& watermark)
     batch.Delete(slKey);
     batch.Put(slKey, slValue);
 
-    leveldb::Status status = pdb->Write(syncoptions, &batch);
+    leveldb::Status status = Write(batch, true);
     if (!status.ok()) {
         PrintToLog("%s(): ERROR: failed to write watermark: %s\n", __func__, status.ToString());
     }
@@ -448,7 +448,7 @@ bool CMPSPInfo::getWatermark(uint256& watermark) const
     leveldb::Slice slKey(&ssKey[0], ssKey.size());
 
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+    leveldb::Status status = Get(slKey, &strValue);
     if (!status.ok()) {
         if (!status.IsNotFound()) {
             PrintToLog("%s(): ERROR: failed to retrieve watermark: %s\n", __func__, status.ToString());
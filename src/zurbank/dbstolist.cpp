@@ -14,6 +14,7 @@
 #include "leveldb/iterator.h"
 #include "leveldb/slice.h"
 #include "leveldb/status.h"
+#include "leveldb/write_batch.h"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/path.hpp>
@@ -23,6 +24,7 @@
 #include <stdint.h>
 
 #include <string>
+#include <utility>
 #include <vector>
 
 using mastercore::IsMyAddress;
@@ -175,7 +177,7 @@ int CMPSTOList::deleteAboveBlock(int blockNum)
         }
         if (needsUpdate) { // rewrite record with existing key and new value
             ++n_found;
-            leveldb::Status status = pdb->Put(writeoptions, it->key().ToString(), newValue);
+            leveldb::Status status = Put(it->key().ToString(), newValue);
             PrintToLog("DEBUG STO - rewriting STO data after reorg\n");
             PrintToLog("STODBDEBUG : %s(): %s, line %d, file: %s\n", __FUNCTION__, status.ToString(), __LINE__, __FILE__);
         }
@@ -190,7 +192,8 @@ int CMPSTOList::deleteAboveBlock(int blockNum)
 
 void CMPSTOList::printStats()
 {
-    PrintToLog("CMPSTOList stats: tWritten= %d , tRead= %d\n", nWritten, nRead);
+    CDBAccessStats stats = GetAccessStats();
+    PrintToLog("CMPSTOList stats: tWrites= %d , tLookups= %d\n", stats.nWrites, stats.nLookups);
 }
 
 void CMPSTOList::printAll()
@@ -214,7 +217,7 @@ bool CMPSTOList::exists(std::string address)
     if (!pdb) return false;
 
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, address, &strValue);
+    leveldb::Status status = Get(address, &strValue);
 
     if (!status.ok()) {
         if (status.IsNotFound()) return false;
@@ -232,7 +235,7 @@ void CMPSTOList::recordSTOReceive(std::string address, const uint256 &txid, int
         // retrieve existing record
         std::vector<std::string> vstr;
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, address, &strValue);
+        leveldb::Status status = Get(address, &strValue);
         if (status.ok()) {
             // add details to record
             // see if we are overwriting (check)
@@ -245,7 +248,7 @@ void CMPSTOList::recordSTOReceive(std::string address, const uint256 &txid, int
             // write updated record
             leveldb::Status status;
             if (pdb) {
-                status = pdb->Put(writeoptions, key, strValue);
+                status = Put(key, strValue);
                 PrintToLog("STODBDEBUG : %s(): %s, line %d, file: %s\n", __FUNCTION__, status.ToString(), __LINE__, __FILE__);
             }
         }
@@ -254,8 +257,40 @@ void CMPSTOList::recordSTOReceive(std::string address, const uint256 &txid, int
         const std::string value = strprintf("%s:%d:%u:%lu,", txid.ToString(), nBlock, propertyId, amount);
         leveldb::Status status;
         if (pdb) {
-            status = pdb->Put(writeoptions, key, value);
+            status = Put(key, value);
             PrintToLog("STODBDEBUG : %s(): %s, line %d, file: %s\n", __FUNCTION__, status.ToString(), __LINE__, __FILE__);
         }
     }
 }
+
+/**
+ * Records all receivers of a send to owners transaction with one batch.
+ *
+ * Each receiver is only read once, and no log line is written per receiver.
+ */
+void CMPSTOList::recordSTOReceives(const std::vector<std::pair<int64_t, std::string> >& receivers, const uint256& txid, int nBlock, unsigned int propertyId)
+{
+    if (!pdb) return;
+
+    const std::string strTxid = txid.ToString();
+    leveldb::WriteBatch batch;
+
+    for (std::vector<std::pair<int64_t, std::string> >::const_iterator it = receivers.begin(); it != receivers.end(); ++it) {
+        const std::string& address = it->second;
+        uint64_t amount = it->first;
+
+        // retrieve existing record, if there is one
+        std::string strValue;
+        leveldb::Status status = Get(address, &strValue);
+        if (!status.ok() && !status.IsNotFound()) continue;
+
+        // see if we are overwriting (check)
+        if (strValue.find(strTxid) != std::string::npos) PrintToLog("STODEBUG : Duplicating entry for %s : %s\n", address, strTxid);
+
+        strValue += strprintf("%s:%d:%u:%lu,", strTxid, nBlock, propertyId, amount);
+        batch.Put(address, strValue);
+    }
+
+    leveldb::Status status = Write(batch);
+    PrintToLog("STODBDEBUG : %s(): %s, %d receivers\n", __FUNCTION__, status.ToString(), receivers.size());
+}
@@ -12,6 +12,8 @@
 #include <stdint.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 /** LevelDB based storage for STO recipients.
  */
@@ -34,6 +36,8 @@ public:
     void printAll();
     bool exists(std::string address);
     void recordSTOReceive(std::string, const uint256&, int, unsigned int, uint64_t);
+    /** Records all receivers of a send to owners transaction with one batch. */
+    void recordSTOReceives(const std::vector<std::pair<int64_t, std::string> >& receivers, const uint256& txid, int nBlock, unsigned int propertyId);
 };
 
 namespace mastercore
@@ -5,8 +5,12 @@
 #include "zurbank/sp.h"
 
 #include "amount.h"
+#include "rpc/jsonstream.h"
+#include "sync.h"
 #include "uint256.h"
+#include "util.h"
 #include "utilstrencodings.h"
+#include "utiltime.h"
 #include "tinyformat.h"
 
 #include <univalue.h>
@@ -14,11 +18,15 @@
 #include "leveldb/iterator.h"
 #include "leveldb/slice.h"
 #include "leveldb/status.h"
+#include "leveldb/write_batch.h"
 
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
 
+#include <limits.h>
 #include <stddef.h>
 
 #include <algorithm>
@@ -30,6 +38,8 @@
 using mastercore::isPropertyDivisible;
 
 CMPTradeList::CMPTradeList(const boost::filesystem::path& path, bool fWipe)
+  : archive(path / "archive", fWipe), nArchiveGeneration(0), nArchiveDepth(0), nArchiveTip(-1), nArchiveScheduled(-1),
+    pArchiveThread(NULL), fArchiveWakeup(false), fArchiveStop(false)
 {
     leveldb::Status status = Open(path, fWipe);
     PrintToConsole("Loading trades database: %s\n", status.ToString());
@@ -37,16 +47,91 @@ CMPTradeList::CMPTradeList(const boost::filesystem::path& path, bool fWipe)
 
 CMPTradeList::~CMPTradeList()
 {
+    StopArchiving();
     if (msc_debug_persistence) PrintToLog("CMPTradeList closed\n");
 }
 
+void CMPTradeList::Clear()
+{
+    LOCK(cs_archive);
+    ++nArchiveGeneration;
+    nArchiveTip = -1;
+    nArchiveScheduled = -1;
+    archive.Clear();
+    // wipe database via parent class
+    CDBBase::Clear();
+}
+
+static std::string FormatMatchedTradeValue(const CMPMatchedTrade& trade)
+{
+    return strprintf("%s:%s:%u:%u:%lu:%lu:%d:%d", trade.address1, trade.address2, trade.prop1, trade.prop2,
+            trade.amount1, trade.amount2, trade.block, trade.fee);
+}
+
+/** Decodes a matched trade of the database, and returns false for other entries. */
+static bool ParseMatchedTrade(const std::string& strKey, const std::string& strValue, CMPMatchedTrade& trade)
+{
+    if (strKey.size() != 129) return false; // only interested in matches
+
+    std::vector<std::string> vecValues;
+    boost::split(vecValues, strValue, boost::is_any_of(":"), boost::token_compress_on);
+    if (vecValues.size() != 8) {
+        PrintToLog("TRADEDB error - unexpected number of tokens in value (%s)\n", strValue);
+        return false;
+    }
+    try {
+        trade.txid1.SetHex(strKey.substr(0, 64));
+        trade.txid2.SetHex(strKey.substr(65, 64));
+        trade.address1 = vecValues[0];
+        trade.address2 = vecValues[1];
+        trade.prop1 = boost::lexical_cast<uint32_t>(vecValues[2]);
+        trade.prop2 = boost::lexical_cast<uint32_t>(vecValues[3]);
+        trade.amount1 = boost::lexical_cast<int64_t>(vecValues[4]);
+        trade.amount2 = boost::lexical_cast<int64_t>(vecValues[5]);
+        trade.block = atoi(vecValues[6]);
+        trade.fee = boost::lexical_cast<int64_t>(vecValues[7]);
+    } catch (const boost::bad_lexical_cast& e) {
+        PrintToLog("TRADEDB error - invalid value (%s)\n", strValue);
+        return false;
+    }
+    return true;
+}
+
+/** Returns the key of the index entry, which finds a matched trade by its second transaction. */
+static std::string GetMatchedTradeIndexKey(const uint256& txid1, const uint256& txid2)
+{
+    return strprintf("idx:%s:%s", txid2.ToString(), txid1.ToString());
+}
+
+/** Whether the key belongs to an index entry. */
+static bool IsIndexKey(const leveldb::Slice& key)
+{
+    return key.starts_with("idx:");
+}
+
+static bool CompareMatchedTradeByBlock(const CMPMatchedTrade& lhs, const CMPMatchedTrade& rhs)
+{
+    return lhs.block < rhs.block;
+}
+
 void CMPTradeList::recordMatchedTrade(const uint256& txid1, const uint256& txid2, const std::string& address1, const std::string& address2, uint32_t prop1, uint32_t prop2, int64_t amount1, int64_t amount2, int blockNum, int64_t fee)
 {
     if (!pdb) return;
-    const std::string key = txid1.ToString() + "+" + txid2.ToString();
-    const std::string value = strprintf("%s:%s:%u:%u:%lu:%lu:%d:%d", address1, address2, prop1, prop2, amount1, amount2, blockNum, fee);
-    leveldb::Status status = pdb->Put(writeoptions, key, value);
-    ++nWritten;
+    CMPMatchedTrade trade;
+    trade.txid1 = txid1;
+    trade.txid2 = txid2;
+    trade.address1 = address1;
+    trade.address2 = address2;
+    trade.prop1 = prop1;
+    trade.prop2 = prop2;
+    trade.amount1 = amount1;
+    trade.amount2 = amount2;
+    trade.block = blockNum;
+    trade.fee = fee;
+    leveldb::WriteBatch batch;
+    batch.Put(trade.GetKey(), FormatMatchedTradeValue(trade));
+    batch.Put(GetMatchedTradeIndexKey(txid1, txid2), "");
+    leveldb::Status status = Write(batch);
     if (msc_debug_tradedb) PrintToLog("%s: %s\n", __func__, status.ToString());
 }
 
@@ -54,22 +139,31 @@ void CMPTradeList::recordNewTrade(const uint256& txid, const std::string& addres
 {
     if (!pdb) return;
     std::string strValue = strprintf("%s:%d:%d:%d:%d", address, propertyIdForSale, propertyIdDesired, blockNum, blockIndex);
-    leveldb::Status status = pdb->Put(writeoptions, txid.ToString(), strValue);
-    ++nWritten;
+    leveldb::Status status = Put(txid.ToString(), strValue);
     if (msc_debug_tradedb) PrintToLog("%s: %s\n", __func__, status.ToString());
 }
 
 /**
  * This function deletes records of trades above/equal to a specific block from the trade database.
  *
- * Returns the number of records changed.
+ * Archived trades of the affected segments, which are before the block, are moved back into the database.
+ *
+ * Returns the number of records changed, or -1, if the archived trades could
+ * not be restored. The archive is left as it is in this case, and the state
+ * has to be reparsed.
  */
 int CMPTradeList::deleteAboveBlock(int blockNum)
 {
+    LOCK(cs_archive);
+
+    // invalidate running compactions, which may have seen the deleted trades
+    ++nArchiveGeneration;
+    nArchiveTip = std::min(nArchiveTip, blockNum - 1);
+    nArchiveScheduled = std::min(nArchiveScheduled, blockNum - 1);
+
     leveldb::Slice skey, svalue;
     unsigned int count = 0;
     std::vector<std::string> vstr;
-    int block = 0;
     unsigned int n_found = 0;
     leveldb::Iterator* it = NewIterator();
     for (it->SeekToFirst(); it->Valid(); it->Next()) {
@@ -78,25 +172,274 @@ int CMPTradeList::deleteAboveBlock(int blockNum)
         ++count;
         std::string strvalue = it->value().ToString();
         boost::split(vstr, strvalue, boost::is_any_of(":"), boost::token_compress_on);
-        if (7 == vstr.size()) block = atoi(vstr[6]); // trade matches have 7 tokens, key is txid+txid, only care about block
+        int block = -1;
+        if (8 == vstr.size()) block = atoi(vstr[6]); // trade matches have 8 tokens, key is txid+txid, only care about block
         if (5 == vstr.size()) block = atoi(vstr[3]); // trades have 5 tokens, key is txid, only care about block
         if (block >= blockNum) {
             ++n_found;
             PrintToLog("%s() DELETING FROM TRADEDB: %s=%s\n", __func__, skey.ToString(), svalue.ToString());
-            pdb->Delete(writeoptions, skey);
+            Delete(skey);
+            CMPMatchedTrade trade;
+            if (ParseMatchedTrade(skey.ToString(), strvalue, trade)) {
+                Delete(GetMatchedTradeIndexKey(trade.txid1, trade.txid2));
+            }
         }
     }
     
     delete it;
 
+    if (archive.GetArchivedHeight() >= blockNum) {
+        // the restored trades are written, before the segments are removed
+        std::vector<CMPMatchedTrade> vRestored;
+        if (!archive.ReadTail(blockNum, vRestored)) {
+            PrintToLog("%s(): ERROR: failed to restore archived trades before block %d\n", __func__, blockNum);
+            return -1;
+        }
+        leveldb::WriteBatch batch;
+        for (std::vector<CMPMatchedTrade>::const_iterator itTrade = vRestored.begin(); itTrade != vRestored.end(); ++itTrade) {
+            batch.Put(itTrade->GetKey(), FormatMatchedTradeValue(*itTrade));
+            batch.Put(GetMatchedTradeIndexKey(itTrade->txid1, itTrade->txid2), "");
+        }
+        leveldb::Status status = WriteToDB(batch, true);
+        if (!status.ok()) {
+            PrintToLog("%s(): ERROR: failed to restore archived trades: %s\n", __func__, status.ToString());
+            return -1;
+        }
+        archive.Truncate(blockNum);
+        n_found += vRestored.size();
+        PrintToLog("%s(%d); restored %d archived trades, archived height is %d\n", __func__, blockNum, vRestored.size(), archive.GetArchivedHeight());
+    }
+
     PrintToLog("%s(%d); tradedb n_found= %d\n", __func__, blockNum, n_found);
 
     return n_found;
 }
 
+/**
+ * Selects matched trades, sorted by block, from the archive and the database.
+ *
+ * A null transaction hash, or property identifiers of 0, select any trade.
+ * Returns false, if a segment of the archive can't be read, in which case the
+ * selection is incomplete.
+ */
+bool CMPTradeList::LoadMatchedTrades(const uint256& txid, uint32_t propertyIdSideA, uint32_t propertyIdSideB, int nFirstBlock, int nLastBlock, bool fDetails, std::vector<CMPMatchedTrade>& vTrades) const
+{
+    const bool fAnyTxid = txid.IsNull();
+    const bool fAnyPair = (propertyIdSideA == 0 || propertyIdSideB == 0);
+
+    LOCK(cs_archive);
+
+    const std::vector<CMPTradeSegment>& vSegments = archive.GetSegments();
+    for (std::vector<CMPTradeSegment>::const_iterator it = vSegments.begin(); it != vSegments.end(); ++it) {
+        if (it->nLastBlock < nFirstBlock || it->nFirstBlock > nLastBlock) continue;
+        if (!fAnyPair && !it->HasPair(propertyIdSideA, propertyIdSideB)) continue;
+        std::vector<CMPMatchedTrade> vSegmentTrades;
+        if (!archive.ReadSegment(*it, vSegmentTrades, fDetails || !fAnyTxid)) {
+            PrintToLog("%s(): ERROR: failed to read archived trades of blocks %d to %d from %s\n",
+                    __func__, it->nFirstBlock, it->nLastBlock, it->path.string());
+            return false;
+        }
+        for (std::vector<CMPMatchedTrade>::const_iterator itTrade = vSegmentTrades.begin(); itTrade != vSegmentTrades.end(); ++itTrade) {
+            const CMPMatchedTrade& trade = *itTrade;
+            if (trade.block < nFirstBlock || trade.block > nLastBlock) continue;
+            if (!fAnyTxid && trade.txid1 != txid && trade.txid2 != txid) continue;
+            if (!fAnyPair && !(trade.prop1 == propertyIdSideA && trade.prop2 == propertyIdSideB) &&
+                    !(trade.prop1 == propertyIdSideB && trade.prop2 == propertyIdSideA)) continue;
+            vTrades.push_back(trade);
+        }
+    }
+
+    // the database may still hold trades, which were already archived, which are skipped
+    const int nArchivedHeight = archive.GetArchivedHeight();
+    if (!pdb || nLastBlock <= nArchivedHeight) return true;
+
+    std::vector<CMPMatchedTrade> vRecent;
+    std::vector<std::pair<std::string, std::string> > vEntries;
+    leveldb::Iterator* it = NewIterator();
+    if (fAnyTxid) {
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            if (it->key().size() != 129) continue;
+            vEntries.push_back(std::make_pair(it->key().ToString(), it->value().ToString()));
+        }
+    } else {
+        // the trades of the transaction as first side share the prefix of the key
+        const std::string strPrefix = txid.ToString() + "+";
+        for (it->Seek(strPrefix); it->Valid() && it->key().starts_with(strPrefix); it->Next()) {
+            vEntries.push_back(std::make_pair(it->key().ToString(), it->value().ToString()));
+        }
+        // and the trades as second side are found by the index
+        const std::string strIndexPrefix = strprintf("idx:%s:", txid.ToString());
+        std::vector<std::string> vKeys;
+        for (it->Seek(strIndexPrefix); it->Valid() && it->key().starts_with(strIndexPrefix); it->Next()) {
+            vKeys.push_back(it->key().ToString().substr(strIndexPrefix.size()) + "+" + txid.ToString());
+        }
+        for (std::vector<std::string>::const_iterator itKey = vKeys.begin(); itKey != vKeys.end(); ++itKey) {
+            std::string strValue;
+            if (Get(*itKey, &strValue).ok()) vEntries.push_back(std::make_pair(*itKey, strValue));
+        }
+    }
+    delete it;
+
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator itEntry = vEntries.begin(); itEntry != vEntries.end(); ++itEntry) {
+        CMPMatchedTrade trade;
+        if (!ParseMatchedTrade(itEntry->first, itEntry->second, trade)) continue;
+        if (trade.block <= nArchivedHeight || trade.block < nFirstBlock || trade.block > nLastBlock) continue;
+        if (!fAnyPair && !(trade.prop1 == propertyIdSideA && trade.prop2 == propertyIdSideB) &&
+                !(trade.prop1 == propertyIdSideB && trade.prop2 == propertyIdSideA)) continue;
+        vRecent.push_back(trade);
+    }
+
+    std::stable_sort(vRecent.begin(), vRecent.end(), CompareMatchedTradeByBlock);
+    vTrades.insert(vTrades.end(), vRecent.begin(), vRecent.end());
+
+    return true;
+}
+
+void CMPTradeList::StartArchiving(int nDepth)
+{
+    if (pArchiveThread || nDepth <= 0) return;
+    {
+        LOCK(cs_archive);
+        nArchiveDepth = nDepth;
+    }
+    fArchiveStop = false;
+    pArchiveThread = new boost::thread(boost::bind(&CMPTradeList::ArchiveThread, this));
+}
+
+void CMPTradeList::ScheduleArchiving(int nBlockNow)
+{
+    if (!pArchiveThread) return;
+    {
+        LOCK(cs_archive);
+        nArchiveTip = nBlockNow;
+        int nCutoff = nBlockNow - nArchiveDepth;
+        if (nCutoff - std::max(archive.GetArchivedHeight(), nArchiveScheduled) < TRADE_ARCHIVE_INTERVAL) return;
+        nArchiveScheduled = nCutoff;
+    }
+    boost::unique_lock<boost::mutex> lock(mutexArchiveThread);
+    fArchiveWakeup = true;
+    condArchiveThread.notify_one();
+}
+
+void CMPTradeList::StopArchiving()
+{
+    if (!pArchiveThread) return;
+    {
+        boost::unique_lock<boost::mutex> lock(mutexArchiveThread);
+        fArchiveStop = true;
+        condArchiveThread.notify_one();
+    }
+    pArchiveThread->join();
+    delete pArchiveThread;
+    pArchiveThread = NULL;
+}
+
+void CMPTradeList::ArchiveThread()
+{
+    RenameThread("zurcoin-tradearchive");
+
+    while (true) {
+        {
+            boost::unique_lock<boost::mutex> lock(mutexArchiveThread);
+            while (!fArchiveWakeup && !fArchiveStop) {
+                condArchiveThread.wait(lock);
+            }
+            if (fArchiveStop) return;
+            fArchiveWakeup = false;
+        }
+
+        int nLastBlock = -1;
+        uint64_t nGeneration = 0;
+        {
+            LOCK(cs_archive);
+            nLastBlock = nArchiveTip - nArchiveDepth;
+            nGeneration = nArchiveGeneration;
+        }
+        ArchiveTrades(nLastBlock, nGeneration);
+    }
+}
+
+int CMPTradeList::archiveTrades(int nLastBlock)
+{
+    uint64_t nGeneration = 0;
+    {
+        LOCK(cs_archive);
+        nGeneration = nArchiveGeneration;
+    }
+    return ArchiveTrades(nLastBlock, nGeneration);
+}
+
+/**
+ * Moves the matched trades up to the block into a new segment.
+ *
+ * The database is scanned without holding the lock. If trades were removed in
+ * the meantime, as indicated by the generation, the segment is discarded.
+ */
+int CMPTradeList::ArchiveTrades(int nLastBlock, uint64_t nGeneration)
+{
+    if (!pdb) return -1;
+
+    int nFirstBlock = 0;
+    {
+        LOCK(cs_archive);
+        nFirstBlock = archive.GetArchivedHeight() + 1;
+    }
+    if (nLastBlock < nFirstBlock) return 0;
+
+    int64_t nTimeStart = GetTimeMicros();
+    std::vector<CMPMatchedTrade> vTrades;
+    std::vector<std::string> vKeys;
+    leveldb::Iterator* it = NewIterator();
+    for (it->SeekToFirst(); it->Valid() && !fArchiveStop; it->Next()) {
+        CMPMatchedTrade trade;
+        std::string strKey = it->key().ToString();
+        if (!ParseMatchedTrade(strKey, it->value().ToString(), trade)) continue;
+        if (trade.block > nLastBlock) continue;
+        // trades, which are already archived, are removed as well
+        vKeys.push_back(strKey);
+        vKeys.push_back(GetMatchedTradeIndexKey(trade.txid1, trade.txid2));
+        if (trade.block >= nFirstBlock) vTrades.push_back(trade);
+    }
+    delete it;
+    if (fArchiveStop) return 0;
+
+    std::stable_sort(vTrades.begin(), vTrades.end(), CompareMatchedTradeByBlock);
+    CMPTradeSegment segment;
+    if (!vTrades.empty() && !archive.WriteSegment(vTrades, nFirstBlock, nLastBlock, segment)) {
+        return -1;
+    }
+
+    LOCK(cs_archive);
+    if (nGeneration != nArchiveGeneration || nFirstBlock != archive.GetArchivedHeight() + 1) {
+        if (!vTrades.empty()) archive.DiscardSegment(segment);
+        PrintToLog("%s(): trades were removed, discarding the archive segment of blocks %d to %d\n", __func__, nFirstBlock, nLastBlock);
+        return 0;
+    }
+    if (!vTrades.empty()) archive.AddSegment(segment);
+
+    // the trades are safe in the segment, and removed right away, independent of the block batches
+    leveldb::WriteBatch batch;
+    for (std::vector<std::string>::const_iterator itKey = vKeys.begin(); itKey != vKeys.end(); ++itKey) {
+        batch.Delete(*itKey);
+    }
+    leveldb::Status status = WriteToDB(batch, false);
+
+    PrintToLog("%s(): archived %d trades of blocks %d to %d, removed %d entries (%s) [%.3f ms]\n", __func__,
+            vTrades.size(), nFirstBlock, nLastBlock, vKeys.size(), status.ToString(), 0.001 * (GetTimeMicros() - nTimeStart));
+
+    return vTrades.size();
+}
+
+int CMPTradeList::getArchivedHeight() const
+{
+    LOCK(cs_archive);
+    return archive.GetArchivedHeight();
+}
+
 void CMPTradeList::printStats()
 {
-    PrintToLog("CMPTradeList stats: tWritten= %d , tRead= %d\n", nWritten, nRead);
+    CDBAccessStats stats = GetAccessStats();
+    PrintToLog("CMPTradeList stats: tWrites= %d , tLookups= %d\n", stats.nWrites, stats.nLookups);
 }
 
 void CMPTradeList::printAll()
@@ -115,51 +458,48 @@ void CMPTradeList::printAll()
     delete it;
 }
 
-bool CMPTradeList::getMatchingTrades(const uint256& txid, uint32_t propertyId, UniValue& tradeArray, int64_t& totalSold, int64_t& totalReceived)
+int CMPTradeList::getMatchingTrades(const uint256& txid, uint32_t propertyId, UniValue& tradeArray, int64_t& totalSold, int64_t& totalReceived)
 {
-    if (!pdb) return false;
+    if (!pdb) return 0;
 
     int count = 0;
     totalReceived = 0;
     totalSold = 0;
 
-    std::vector<std::string> vstr;
-    std::string txidStr = txid.ToString();
-    leveldb::Iterator* it = NewIterator();
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        // search key to see if this is a matching trade
-        std::string strKey = it->key().ToString();
-        std::string strValue = it->value().ToString();
-        std::string matchTxid;
-        size_t txidMatch = strKey.find(txidStr);
-        if (txidMatch == std::string::npos) continue; // no match
+    // matches are in the block of the trade or later, so older segments of the archive are skipped
+    int nFirstBlock = 0;
+    std::string strValue;
+    if (Get(txid.ToString(), &strValue).ok()) {
+        std::vector<std::string> vstr;
+        boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
+        if (5 == vstr.size()) nFirstBlock = atoi(vstr[3]);
+    }
 
-        // sanity check key is the correct length for a matched trade
-        if (strKey.length() != 129) continue;
+    std::vector<CMPMatchedTrade> vTrades;
+    if (!LoadMatchedTrades(txid, 0, 0, nFirstBlock, INT_MAX, true, vTrades)) return -1;
 
-        // obtain the txid of the match
-        if (txidMatch == 0) {
-            matchTxid = strKey.substr(65, 64);
-        } else {
-            matchTxid = strKey.substr(0, 64);
-        }
+    // list the trades in the order of their keys
+    std::vector<std::pair<std::string, size_t> > vOrder;
+    for (size_t n = 0; n < vTrades.size(); ++n) {
+        vOrder.push_back(std::make_pair(vTrades[n].GetKey(), n));
+    }
+    std::sort(vOrder.begin(), vOrder.end());
 
-        // ensure correct amount of tokens in value string
-        boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
-        if (vstr.size() != 8) {
-            PrintToLog("TRADEDB error - unexpected number of tokens in value (%s)\n", strValue);
-            continue;
-        }
+    for (std::vector<std::pair<std::string, size_t> >::const_iterator it = vOrder.begin(); it != vOrder.end(); ++it) {
+        const CMPMatchedTrade& match = vTrades[it->second];
 
-        // decode the details from the value string
-        std::string address1 = vstr[0];
-        std::string address2 = vstr[1];
-        uint32_t prop1 = boost::lexical_cast<uint32_t>(vstr[2]);
-        uint32_t prop2 = boost::lexical_cast<uint32_t>(vstr[3]);
-        int64_t amount1 = boost::lexical_cast<int64_t>(vstr[4]);
-        int64_t amount2 = boost::lexical_cast<int64_t>(vstr[5]);
-        int blockNum = atoi(vstr[6]);
-        int64_t tradingFee = boost::lexical_cast<int64_t>(vstr[7]);
+        // obtain the txid of the match
+        std::string matchTxid = (match.txid1 == txid) ? match.txid2.ToString() : match.txid1.ToString();
+
+        // decode the details of the trade
+        const std::string& address1 = match.address1;
+        const std::string& address2 = match.address2;
+        uint32_t prop1 = match.prop1;
+        uint32_t prop2 = match.prop2;
+        int64_t amount1 = match.amount1;
+        int64_t amount2 = match.amount2;
+        int blockNum = match.block;
+        int64_t tradingFee = match.fee;
 
         std::string strAmount1 = FormatMP(prop1, amount1);
         std::string strAmount2 = FormatMP(prop2, amount2);
@@ -189,13 +529,7 @@ bool CMPTradeList::getMatchingTrades(const uint256& txid, uint32_t propertyId, U
         ++count;
     }
 
-    // clean up
-    delete it;
-    if (count) {
-        return true;
-    } else {
-        return false;
-    }
+    return count;
 }
 
 
@@ -236,53 +570,56 @@ void CMPTradeList::getTradesForAddress(const std::string& address, std::vector<u
     }
 }
 
-static bool CompareTradePair(const std::pair<int64_t, UniValue>& firstJSONObj, const std::pair<int64_t, UniValue>& secondJSONObj)
+static bool CompareTradeByBlockDesc(const CMPMatchedTrade& lhs, const CMPMatchedTrade& rhs)
 {
-    return firstJSONObj.first > secondJSONObj.first;
+    return lhs.block > rhs.block;
 }
 
-// obtains an array of matching trades with pricing and volume details for a pair sorted by blocknumber
-void CMPTradeList::getTradesForPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB, UniValue& responseArray, uint64_t count)
+// the most recent count trades of a pair, after skipping the most recent skip trades, in ascending order
+bool CMPTradeList::getRecentTradesForPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB, int64_t count, int64_t skip, std::vector<CMPMatchedTrade>& vTrades) const
+{
+    if (!pdb) return true;
+    std::vector<CMPMatchedTrade> vMatches;
+    if (!LoadMatchedTrades(uint256(), propertyIdSideA, propertyIdSideB, 0, INT_MAX, true, vMatches)) return false;
+
+    // sort the trades most recent first, and select the requested window
+    std::stable_sort(vMatches.begin(), vMatches.end(), CompareTradeByBlockDesc);
+    int64_t nTrades = vMatches.size();
+    int64_t nFirst = std::min(skip, nTrades);
+    int64_t nLast = (count > nTrades - nFirst) ? nTrades : nFirst + count;
+
+    for (int64_t n = nLast - 1; n >= nFirst; --n) {
+        vTrades.push_back(vMatches[n]);
+    }
+
+    return true;
+}
+
+// writes an array of matching trades with pricing and volume details for a pair sorted by blocknumber
+// the most recent count trades, after skipping the most recent skip trades, are written in ascending order
+bool CMPTradeList::getTradesForPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB, JSONStreamWriter& writer, int64_t count, int64_t skip)
+{
+    std::vector<CMPMatchedTrade> vTrades;
+    if (!getRecentTradesForPair(propertyIdSideA, propertyIdSideB, count, skip, vTrades)) return false;
+    TradesForPairToJSON(propertyIdSideA, propertyIdSideB, vTrades, writer);
+    return true;
+}
+
+void TradesForPairToJSON(uint32_t propertyIdSideA, uint32_t propertyIdSideB, const std::vector<CMPMatchedTrade>& vTrades, JSONStreamWriter& writer)
 {
-    if (!pdb) return;
-    leveldb::Iterator* it = NewIterator();
-    std::vector<std::pair<int64_t, UniValue> > vecResponse;
     bool propertyIdSideAIsDivisible = isPropertyDivisible(propertyIdSideA);
     bool propertyIdSideBIsDivisible = isPropertyDivisible(propertyIdSideB);
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        std::string strKey = it->key().ToString();
-        std::string strValue = it->value().ToString();
-        std::vector<std::string> vecKeys;
-        std::vector<std::string> vecValues;
-        uint256 sellerTxid, matchingTxid;
-        std::string sellerAddress, matchingAddress;
-        int64_t amountReceived = 0, amountSold = 0;
-        if (strKey.size() != 129) continue; // only interested in matches
-        boost::split(vecKeys, strKey, boost::is_any_of("+"), boost::token_compress_on);
-        boost::split(vecValues, strValue, boost::is_any_of(":"), boost::token_compress_on);
-        if (vecKeys.size() != 2 || vecValues.size() != 8) {
-            PrintToLog("TRADEDB error - unexpected number of tokens (%s:%s)\n", strKey, strValue);
-            continue;
-        }
-        uint32_t tradePropertyIdSideA = boost::lexical_cast<uint32_t>(vecValues[2]);
-        uint32_t tradePropertyIdSideB = boost::lexical_cast<uint32_t>(vecValues[3]);
-        if (tradePropertyIdSideA == propertyIdSideA && tradePropertyIdSideB == propertyIdSideB) {
-            sellerTxid.SetHex(vecKeys[1]);
-            sellerAddress = vecValues[1];
-            amountSold = boost::lexical_cast<int64_t>(vecValues[4]);
-            matchingTxid.SetHex(vecKeys[0]);
-            matchingAddress = vecValues[0];
-            amountReceived = boost::lexical_cast<int64_t>(vecValues[5]);
-        } else if (tradePropertyIdSideB == propertyIdSideA && tradePropertyIdSideA == propertyIdSideB) {
-            sellerTxid.SetHex(vecKeys[0]);
-            sellerAddress = vecValues[0];
-            amountSold = boost::lexical_cast<int64_t>(vecValues[5]);
-            matchingTxid.SetHex(vecKeys[1]);
-            matchingAddress = vecValues[1];
-            amountReceived = boost::lexical_cast<int64_t>(vecValues[4]);
-        } else {
-            continue;
-        }
+
+    writer.BeginArray();
+    for (std::vector<CMPMatchedTrade>::const_iterator it = vTrades.begin(); it != vTrades.end(); ++it) {
+        // orient the trade towards the requested pair
+        bool fSideA = (it->prop1 == propertyIdSideA);
+        const uint256& sellerTxid = fSideA ? it->txid2 : it->txid1;
+        const std::string& sellerAddress = fSideA ? it->address2 : it->address1;
+        const uint256& matchingTxid = fSideA ? it->txid1 : it->txid2;
+        const std::string& matchingAddress = fSideA ? it->address1 : it->address2;
+        int64_t amountSold = fSideA ? it->amount1 : it->amount2;
+        int64_t amountReceived = fSideA ? it->amount2 : it->amount1;
 
         rational_t unitPrice(amountReceived, amountSold);
         rational_t inversePrice(amountSold, amountReceived);
@@ -291,53 +628,46 @@ void CMPTradeList::getTradesForPair(uint32_t propertyIdSideA, uint32_t propertyI
         std::string unitPriceStr = xToString(unitPrice); // TODO: not here!
         std::string inversePriceStr = xToString(inversePrice);
 
-        int64_t blockNum = boost::lexical_cast<int64_t>(vecValues[6]);
-
-        UniValue trade(UniValue::VOBJ);
-        trade.push_back(Pair("block", blockNum));
-        trade.push_back(Pair("unitprice", unitPriceStr));
-        trade.push_back(Pair("inverseprice", inversePriceStr));
-        trade.push_back(Pair("sellertxid", sellerTxid.GetHex()));
-        trade.push_back(Pair("selleraddress", sellerAddress));
+        writer.BeginObject();
+        writer.Pair("block", it->block);
+        writer.Pair("unitprice", unitPriceStr);
+        writer.Pair("inverseprice", inversePriceStr);
+        writer.Pair("sellertxid", sellerTxid.GetHex());
+        writer.Pair("selleraddress", sellerAddress);
         if (propertyIdSideAIsDivisible) {
-            trade.push_back(Pair("amountsold", FormatDivisibleMP(amountSold)));
+            writer.Pair("amountsold", FormatDivisibleMP(amountSold));
         } else {
-            trade.push_back(Pair("amountsold", FormatIndivisibleMP(amountSold)));
+            writer.Pair("amountsold", FormatIndivisibleMP(amountSold));
         }
         if (propertyIdSideBIsDivisible) {
-            trade.push_back(Pair("amountreceived", FormatDivisibleMP(amountReceived)));
+            writer.Pair("amountreceived", FormatDivisibleMP(amountReceived));
         } else {
-            trade.push_back(Pair("amountreceived", FormatIndivisibleMP(amountReceived)));
+            writer.Pair("amountreceived", FormatIndivisibleMP(amountReceived));
         }
-        trade.push_back(Pair("matchingtxid", matchingTxid.GetHex()));
-        trade.push_back(Pair("matchingaddress", matchingAddress));
-        vecResponse.push_back(std::make_pair(blockNum, trade));
-    }
-
-    // sort the response most recent first before adding to the array
-    std::sort(vecResponse.begin(), vecResponse.end(), CompareTradePair);
-    uint64_t processed = 0;
-    for (std::vector<std::pair<int64_t, UniValue> >::iterator it = vecResponse.begin(); it != vecResponse.end(); ++it) {
-        responseArray.push_back(it->second);
-        processed++;
-        if (processed >= count) break;
-    }
-
-    std::vector<UniValue> responseArrayValues = responseArray.getValues();
-    std::reverse(responseArrayValues.begin(), responseArrayValues.end());
-    responseArray.clear();
-    for (std::vector<UniValue>::iterator it = responseArrayValues.begin(); it != responseArrayValues.end(); ++it) {
-        responseArray.push_back(*it);
+        writer.Pair("matchingtxid", matchingTxid.GetHex());
+        writer.Pair("matchingaddress", matchingAddress);
+        writer.EndObject();
     }
+    writer.EndArray();
+}
 
-    delete it;
+// the trades of a pair in either direction, with blocks, properties and amounts only, sorted by block
+bool CMPTradeList::getTradesForPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB, int nFirstBlock, int nLastBlock, std::vector<CMPMatchedTrade>& vTrades) const
+{
+    return LoadMatchedTrades(uint256(), propertyIdSideA, propertyIdSideB, nFirstBlock, nLastBlock, false, vTrades);
 }
 
 int CMPTradeList::getMPTradeCountTotal()
 {
-    int count = 0;
+    LOCK(cs_archive);
+    const int nArchivedHeight = archive.GetArchivedHeight();
+    int count = archive.GetTradeCount();
     leveldb::Iterator* it = NewIterator();
     for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        if (IsIndexKey(it->key())) continue;
+        // skip trades, which were archived, but not yet removed
+        CMPMatchedTrade trade;
+        if (nArchivedHeight >= 0 && ParseMatchedTrade(it->key().ToString(), it->value().ToString(), trade) && trade.block <= nArchivedHeight) continue;
         ++count;
     }
     delete it;
@@ -2,38 +2,113 @@
 #define ZURBANK_DBTRADELIST_H
 
 #include "zurbank/dbbase.h"
+#include "zurbank/tradearchive.h"
 
+#include "sync.h"
 #include "uint256.h"
 
 #include <univalue.h>
 
 #include <boost/filesystem/path.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <stdint.h>
 
+#include <atomic>
+
 #include <string>
 #include <vector>
 
+class JSONStreamWriter;
+
+namespace boost
+{
+class thread;
+}
+
+//! Default number of blocks, after which matched trades are archived, 0 to disable archiving
+static const int DEFAULT_TRADE_ARCHIVE_DEPTH = 1000;
+//! Minimum number of blocks covered by a new archive segment
+static const int TRADE_ARCHIVE_INTERVAL = 10000;
+
 /** LevelDB based storage for the MetaDEx trade history. Trades are listed with key "txid1+txid2".
+ *
+ * Each matched trade has an index entry with key "idx:txid2:txid1", so that the
+ * trades of a transaction are found with two prefix seeks.
+ *
+ * Old matched trades are moved into a column oriented archive by a background
+ * thread. The archive holds the trades up to the archived height, and the
+ * database the later ones.
  */
 class CMPTradeList : public CDBBase
 {
+private:
+    //! Protects the archive and the compaction state
+    mutable CCriticalSection cs_archive;
+
+    //! Matched trades, which were moved out of the database
+    CMPTradeArchive archive;
+
+    //! Incremented whenever trades are removed, which invalidates running compactions
+    uint64_t nArchiveGeneration;
+
+    //! Number of blocks, after which trades are archived
+    int nArchiveDepth;
+
+    //! The last processed block, as reported to the compaction
+    int nArchiveTip;
+
+    //! The last block, up to which a compaction was scheduled
+    int nArchiveScheduled;
+
+    //! The background compaction, if running
+    boost::thread* pArchiveThread;
+    boost::mutex mutexArchiveThread;
+    boost::condition_variable condArchiveThread;
+    bool fArchiveWakeup;
+    std::atomic<bool> fArchiveStop;
+
+    void ArchiveThread();
+    int ArchiveTrades(int nLastBlock, uint64_t nGeneration);
+    bool LoadMatchedTrades(const uint256& txid, uint32_t propertyIdSideA, uint32_t propertyIdSideB, int nFirstBlock, int nLastBlock, bool fDetails, std::vector<CMPMatchedTrade>& vTrades) const;
+
 public:
     CMPTradeList(const boost::filesystem::path& path, bool fWipe);
     virtual ~CMPTradeList();
 
+    /** Extends clearing of CDBBase. */
+    void Clear();
+
+    /** Starts moving trades older than the depth into the archive in the background. */
+    void StartArchiving(int nDepth);
+    /** Signals a new block to the compaction, which runs, once enough blocks passed. */
+    void ScheduleArchiving(int nBlockNow);
+    /** Stops the compaction, and waits until it's done. */
+    void StopArchiving();
+    /** Moves the matched trades up to the block into a new archive segment, and returns their number, or -1 on failure. */
+    int archiveTrades(int nLastBlock);
+    int getArchivedHeight() const;
+
     void recordMatchedTrade(const uint256& txid1, const uint256& txid2, const std::string& address1, const std::string& address2, uint32_t prop1, uint32_t prop2, int64_t amount1, int64_t amount2, int blockNum, int64_t fee);
     void recordNewTrade(const uint256& txid, const std::string& address, uint32_t propertyIdForSale, uint32_t propertyIdDesired, int blockNum, int blockIndex);
     int deleteAboveBlock(int blockNum);
     bool exists(const uint256 &txid);
     void printStats();
     void printAll();
-    bool getMatchingTrades(const uint256& txid, uint32_t propertyId, UniValue& tradeArray, int64_t& totalSold, int64_t& totalBought);
+    /** Adds the matches of a trade to the array, and returns their number, or -1, if archived trades can't be read. */
+    int getMatchingTrades(const uint256& txid, uint32_t propertyId, UniValue& tradeArray, int64_t& totalSold, int64_t& totalBought);
     void getTradesForAddress(const std::string& address, std::vector<uint256>& vecTransactions, uint32_t propertyIdFilter = 0);
-    void getTradesForPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB, UniValue& response, uint64_t count);
+    /** The pair functions return false, if archived trades can't be read. */
+    bool getRecentTradesForPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB, int64_t count, int64_t skip, std::vector<CMPMatchedTrade>& vTrades) const;
+    bool getTradesForPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB, JSONStreamWriter& writer, int64_t count, int64_t skip = 0);
+    bool getTradesForPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB, int nFirstBlock, int nLastBlock, std::vector<CMPMatchedTrade>& vTrades) const;
     int getMPTradeCountTotal();
 };
 
+/** Writes matched trades with pricing and volume details, as seen from the first property of the pair. */
+void TradesForPairToJSON(uint32_t propertyIdSideA, uint32_t propertyIdSideB, const std::vector<CMPMatchedTrade>& vTrades, JSONStreamWriter& writer);
+
 namespace mastercore
 {
     //! LevelDB based storage for the MetaDEx trade history
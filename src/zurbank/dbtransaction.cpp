@@ -2,9 +2,13 @@
 
 #include "zurbank/errors.h"
 #include "zurbank/log.h"
+#include "zurbank/tx.h"
 
+#include "clientversion.h"
+#include "streams.h"
 #include "uint256.h"
 #include "tinyformat.h"
+#include "utilstrencodings.h"
 
 #include "leveldb/status.h"
 
@@ -38,7 +42,7 @@ std::vector<std::string> COmniTransactionDB::FetchTransactionDetails(const uint2
     std::string strValue;
     std::vector<std::string> vTransactionDetails;
 
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &strValue);
+    leveldb::Status status = Get(txid.ToString(), &strValue);
     if (status.ok()) {
         std::vector<std::string> vStr;
         boost::split(vStr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -65,8 +69,7 @@ void COmniTransactionDB::RecordTransaction(const uint256& txid, uint32_t posInBl
     const std::string key = txid.ToString();
     const std::string value = strprintf("%d:%d", posInBlock, processingResult);
 
-    leveldb::Status status = pdb->Put(writeoptions, key, value);
-    ++nWritten;
+    leveldb::Status status = Put(key, value);
 }
 
 /**
@@ -98,3 +101,59 @@ std::string COmniTransactionDB::FetchInvalidReason(const uint256& txid)
 
     return error_str(processingResult);
 }
+
+/**
+ * Stores the decoded fields of a processed transaction.
+ */
+void COmniTransactionDB::RecordDecodedTransaction(const CMPTransaction& mp_obj, const uint256& blockHash, int processingResult)
+{
+    assert(pdb);
+
+    CDecodedTransaction decoded;
+    decoded.blockHash = blockHash;
+    decoded.block = mp_obj.getBlock();
+    decoded.posInBlock = mp_obj.getIndexInBlock();
+    decoded.processingResult = processingResult;
+    decoded.encodingClass = mp_obj.getEncodingClass();
+    decoded.sender = mp_obj.getSender();
+    decoded.reference = mp_obj.getReceiver();
+    decoded.type = mp_obj.getType();
+    decoded.version = mp_obj.getVersion();
+    decoded.property = mp_obj.getProperty();
+    decoded.amount = mp_obj.getAmount();
+    decoded.fee = mp_obj.getFeePaid();
+    decoded.payload = ParseHex(mp_obj.getPayload());
+
+    CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+    ssValue.reserve(ssValue.GetSerializeSize(decoded));
+    ssValue << decoded;
+
+    leveldb::Status status = Put(mp_obj.getHash().ToString() + "-D", leveldb::Slice(&ssValue[0], ssValue.size()));
+    if (!status.ok()) {
+        PrintToLog("%s(): ERROR for transaction %s: %s\n", __func__, mp_obj.getHash().GetHex(), status.ToString());
+    }
+}
+
+/**
+ * Retrieves the decoded fields of a processed transaction.
+ */
+bool COmniTransactionDB::FetchDecodedTransaction(const uint256& txid, CDecodedTransaction& decoded)
+{
+    assert(pdb);
+    std::string strValue;
+
+    leveldb::Status status = Get(txid.ToString() + "-D", &strValue);
+    if (!status.ok()) {
+        return false;
+    }
+
+    try {
+        CDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+        ssValue >> decoded;
+    } catch (const std::exception& e) {
+        PrintToLog("%s(): ERROR for transaction %s: %s\n", __func__, txid.GetHex(), e.what());
+        return false;
+    }
+
+    return true;
+}
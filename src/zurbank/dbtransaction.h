@@ -3,6 +3,7 @@
 
 #include "zurbank/dbbase.h"
 
+#include "serialize.h"
 #include "uint256.h"
 
 #include <boost/filesystem/path.hpp>
@@ -12,6 +13,52 @@
 #include <string>
 #include <vector>
 
+class CMPTransaction;
+
+/** The decoded fields of a processed transaction, so that it can be described without parsing it again.
+ */
+struct CDecodedTransaction
+{
+    uint256 blockHash;
+    int block;
+    uint32_t posInBlock;
+    int processingResult;
+    int encodingClass;
+    std::string sender;
+    std::string reference;
+    uint32_t type;
+    uint16_t version;
+    uint32_t property;
+    int64_t amount;
+    int64_t fee;
+    std::vector<unsigned char> payload;
+
+    CDecodedTransaction() : block(0), posInBlock(0), processingResult(0), encodingClass(0),
+        type(0), version(0), property(0), amount(0), fee(0) {}
+
+    /** Whether the transaction was valid, when it was processed. */
+    bool isValid() const { return processingResult >= 0; }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(blockHash);
+        READWRITE(block);
+        READWRITE(posInBlock);
+        READWRITE(processingResult);
+        READWRITE(encodingClass);
+        READWRITE(sender);
+        READWRITE(reference);
+        READWRITE(type);
+        READWRITE(version);
+        READWRITE(property);
+        READWRITE(amount);
+        READWRITE(fee);
+        READWRITE(payload);
+    }
+};
+
 /** LevelDB based storage for storing Zus transaction validation and position in block data.
  */
 class COmniTransactionDB : public CDBBase
@@ -29,6 +76,12 @@ public:
     /** Returns the reason why a transaction is invalid. */
     std::string FetchInvalidReason(const uint256& txid);
 
+    /** Stores the decoded fields of a processed transaction. */
+    void RecordDecodedTransaction(const CMPTransaction& mp_obj, const uint256& blockHash, int processingResult);
+
+    /** Retrieves the decoded fields of a processed transaction. */
+    bool FetchDecodedTransaction(const uint256& txid, CDecodedTransaction& decoded);
+
 private:
     /** Retrieves the serialized transaction details from the DB. */
     std::vector<std::string> FetchTransactionDetails(const uint256& txid);
@@ -70,8 +70,7 @@ void CMPTxList::recordTX(const uint256 &txid, bool fValid, int nBlock, unsigned
     PrintToLog("%s(%s, valid=%s, block= %d, type= %d, value= %lu)\n",
             __func__, txid.ToString(), fValid ? "YES" : "NO", nBlock, type, nValue);
 
-    status = pdb->Put(writeoptions, key, value);
-    ++nWritten;
+    status = Put(key, value);
 }
 
 void CMPTxList::recordPaymentTX(const uint256& txid, bool fValid, int nBlock, unsigned int vout, unsigned int propertyId, uint64_t nValue, std::string buyer, std::string seller)
@@ -93,7 +92,7 @@ void CMPTxList::recordPaymentTX(const uint256& txid, bool fValid, int nBlock, un
         //retrieve old numberOfPayments
         std::vector<std::string> vstr;
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &strValue);
+        leveldb::Status status = Get(txid.ToString(), &strValue);
         if (status.ok()) {
             // parse the string returned
             boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -112,7 +111,7 @@ void CMPTxList::recordPaymentTX(const uint256& txid, bool fValid, int nBlock, un
     const std::string value = strprintf("%u:%d:%u:%lu", fValid ? 1 : 0, nBlock, type, numberOfPayments);
     leveldb::Status status;
     PrintToLog("DEXPAYDEBUG : Writing master record %s(%s, valid=%s, block= %d, type= %d, number of payments= %lu)\n", __func__, txid.ToString(), fValid ? "YES" : "NO", nBlock, type, numberOfPayments);
-    status = pdb->Put(writeoptions, key, value);
+    status = Put(key, value);
 
     // Step 4 - Write sub-record with payment details
     const std::string txidStr = txid.ToString();
@@ -120,7 +119,7 @@ void CMPTxList::recordPaymentTX(const uint256& txid, bool fValid, int nBlock, un
     const std::string subValue = strprintf("%d:%s:%s:%d:%lu", vout, buyer, seller, propertyId, nValue);
     leveldb::Status subStatus;
     PrintToLog("DEXPAYDEBUG : Writing sub-record %s with value %s\n", subKey, subValue);
-    subStatus = pdb->Put(writeoptions, subKey, subValue);
+    subStatus = Put(subKey, subValue);
 }
 
 void CMPTxList::recordMetaDExCancelTX(const uint256& txidMaster, const uint256& txidSub, bool fValid, int nBlock, unsigned int propertyId, uint64_t nValue)
@@ -138,7 +137,7 @@ void CMPTxList::recordMetaDExCancelTX(const uint256& txidMaster, const uint256&
     // Step 2b - If does exist add +1 to existing ref and set this ref as new number of affected
     std::vector<std::string> vstr;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txidMasterStr, &strValue);
+    leveldb::Status status = Get(txidMasterStr, &strValue);
     if (status.ok()) {
         // parse the string returned
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -154,14 +153,14 @@ void CMPTxList::recordMetaDExCancelTX(const uint256& txidMaster, const uint256&
     const std::string key = txidMasterStr;
     const std::string value = strprintf("%u:%d:%u:%lu", fValid ? 1 : 0, nBlock, type, refNumber);
     PrintToLog("METADEXCANCELDEBUG : Writing master record %s(%s, valid=%s, block= %d, type= %d, number of affected transactions= %d)\n", __func__, txidMaster.ToString(), fValid ? "YES" : "NO", nBlock, type, refNumber);
-    status = pdb->Put(writeoptions, key, value);
+    status = Put(key, value);
 
     // Step 4 - Write sub-record with cancel details
     const std::string txidStr = txidMaster.ToString() + "-C";
     const std::string subKey = STR_REF_SUBKEY_TXID_REF_COMBO(txidStr, refNumber);
     const std::string subValue = strprintf("%s:%d:%lu", txidSub.ToString(), propertyId, nValue);
     PrintToLog("METADEXCANCELDEBUG : Writing sub-record %s with value %s\n", subKey, subValue);
-    status = pdb->Put(writeoptions, subKey, subValue);
+    status = Put(subKey, subValue);
     if (msc_debug_txdb) PrintToLog("%s(): store: %s=%s, status: %s\n", __func__, subKey, subValue, status.ToString());
 }
 
@@ -174,8 +173,7 @@ void CMPTxList::recordSendAllSubRecord(const uint256& txid, int subRecordNumber,
     std::string strKey = strprintf("%s-%d", txid.ToString(), subRecordNumber);
     std::string strValue = strprintf("%d:%d", propertyId, nValue);
 
-    leveldb::Status status = pdb->Put(writeoptions, strKey, strValue);
-    ++nWritten;
+    leveldb::Status status = Put(strKey, strValue);
     if (msc_debug_txdb) PrintToLog("%s(): store: %s=%s, status: %s\n", __func__, strKey, strValue, status.ToString());
 }
 
@@ -184,7 +182,7 @@ std::string CMPTxList::getKeyValue(std::string key)
 {
     if (!pdb) return "";
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    leveldb::Status status = Get(key, &strValue);
     if (status.ok()) {
         return strValue;
     } else {
@@ -226,7 +224,7 @@ int CMPTxList::getNumberOfSubRecords(const uint256& txid)
     int numberOfSubRecords = 0;
 
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &strValue);
+    leveldb::Status status = Get(txid.ToString(), &strValue);
     if (status.ok()) {
         std::vector<std::string> vstr;
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -244,7 +242,7 @@ int CMPTxList::getNumberOfMetaDExCancels(const uint256 txid)
     int numberOfCancels = 0;
     std::vector<std::string> vstr;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString() + "-C", &strValue);
+    leveldb::Status status = Get(txid.ToString() + "-C", &strValue);
     if (status.ok()) {
         // parse the string returned
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -261,7 +259,7 @@ bool CMPTxList::getPurchaseDetails(const uint256 txid, int purchaseNumber, std::
     if (!pdb) return 0;
     std::vector<std::string> vstr;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString() + "-" + boost::to_string(purchaseNumber), &strValue);
+    leveldb::Status status = Get(txid.ToString() + "-" + boost::to_string(purchaseNumber), &strValue);
     if (status.ok()) {
         // parse the string returned
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -285,7 +283,7 @@ bool CMPTxList::getSendAllDetails(const uint256& txid, int subSend, uint32_t& pr
 {
     std::string strKey = strprintf("%s-%d", txid.ToString(), subSend);
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, strKey, &strValue);
+    leveldb::Status status = Get(strKey, &strValue);
     if (status.ok()) {
         std::vector<std::string> vstr;
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -374,7 +372,7 @@ int CMPTxList::getDBVersion()
     std::string strValue;
     int verDB = 0;
 
-    leveldb::Status status = pdb->Get(readoptions, "dbversion", &strValue);
+    leveldb::Status status = Get("dbversion", &strValue);
     if (status.ok()) {
         verDB = boost::lexical_cast<uint64_t>(strValue);
     }
@@ -392,7 +390,7 @@ int CMPTxList::getDBVersion()
 int CMPTxList::setDBVersion()
 {
     std::string verStr = boost::lexical_cast<std::string>(DB_VERSION);
-    leveldb::Status status = pdb->Put(writeoptions, "dbversion", verStr);
+    leveldb::Status status = Put("dbversion", verStr);
 
     if (msc_debug_txdb) PrintToLog("%s(): dbversion %s status %s, line %d, file: %s\n", __func__, verStr, status.ToString(), __LINE__, __FILE__);
 
@@ -404,7 +402,7 @@ bool CMPTxList::exists(const uint256 &txid)
     if (!pdb) return false;
 
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &strValue);
+    leveldb::Status status = Get(txid.ToString(), &strValue);
 
     if (!status.ok()) {
         if (status.IsNotFound()) return false;
@@ -415,8 +413,7 @@ bool CMPTxList::exists(const uint256 &txid)
 
 bool CMPTxList::getTX(const uint256 &txid, std::string& value)
 {
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &value);
-    ++nRead;
+    leveldb::Status status = Get(txid.ToString(), &value);
 
     if (status.ok()) {
         return true;
@@ -751,7 +748,8 @@ bool CMPTxList::CheckForFreezeTxs(int blockHeight)
 
 void CMPTxList::printStats()
 {
-    PrintToLog("CMPTxList stats: nWritten= %d , nRead= %d\n", nWritten, nRead);
+    CDBAccessStats stats = GetAccessStats();
+    PrintToLog("CMPTxList stats: nWrites= %d , nLookups= %d\n", stats.nWrites, stats.nLookups);
 }
 
 void CMPTxList::printAll()
@@ -801,7 +799,9 @@ bool CMPTxList::isMPinBlockRange(int starting_block, int ending_block, bool bDel
             if ((starting_block <= block) && (block <= ending_block)) {
                 ++n_found;
                 PrintToLog("%s() DELETING: %s=%s\n", __func__, skey.ToString(), svalue.ToString());
-                if (bDeleteFound) pdb->Delete(writeoptions, skey);
+                if (bDeleteFound) {
+                    Delete(skey);
+                }
             }
         }
     }
@@ -32,6 +32,7 @@ enum MPRPCErrorCode
     MP_CROWDSALE_WITHOUT_PROPERTY = -3334,  // Potential database corruption: "Crowdsale Purchase" without valid property identifier.
     MP_INVALID_TX_IN_DB_FOUND     = -3335,  // Potential database corruption: Invalid transaction found.
     MP_TX_IS_NOT_OMNI_PROTOCOL    = -3336,  // No Zus Layer Protocol transaction.
+    MP_TRADE_ARCHIVE_UNREADABLE   = -3337,  // Potential database corruption: Archived trades can't be read.
 };
 
 inline std::string error_str(int ec) {
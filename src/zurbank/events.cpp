@@ -0,0 +1,82 @@
+/**
+ * @file events.cpp
+ *
+ * This file contains signals for external consumers of Zus layer events.
+ */
+
+#include "zurbank/events.h"
+
+#include "zurbank/tally.h"
+
+#include "uint256.h"
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mastercore
+{
+static CZusSignals g_zusSignals;
+
+//! Whether signals are suspended, e.g. during the initial scan
+static bool fSignalsSuspended = false;
+
+//! Net balance changes of the current block, keyed by address, property and tally type
+static std::map<std::tuple<std::string, uint32_t, int>, int64_t> mapBalanceDeltas;
+
+//! Whether balance changes are collected, only true while processing a block with listeners
+static bool fCollectBalanceDeltas = false;
+
+CZusSignals& GetZusSignals()
+{
+    return g_zusSignals;
+}
+
+void SuspendZusSignals(bool fSuspend)
+{
+    fSignalsSuspended = fSuspend;
+}
+
+bool ZusSignalsActive()
+{
+    return !fSignalsSuspended;
+}
+
+void BeginBalanceDeltas()
+{
+    mapBalanceDeltas.clear();
+    fCollectBalanceDeltas = !fSignalsSuspended && !g_zusSignals.BalancesChanged.empty();
+}
+
+void RecordBalanceDelta(const std::string& address, uint32_t propertyId, int64_t amount, TallyType ttype)
+{
+    if (!fCollectBalanceDeltas || ttype == PENDING) return;
+
+    mapBalanceDeltas[std::make_tuple(address, propertyId, (int) ttype)] += amount;
+}
+
+void EndBalanceDeltas(int block, const uint256& blockHash)
+{
+    if (!fCollectBalanceDeltas) return;
+    fCollectBalanceDeltas = false;
+
+    std::vector<CZusBalanceDelta> vDeltas;
+    vDeltas.reserve(mapBalanceDeltas.size());
+    for (std::map<std::tuple<std::string, uint32_t, int>, int64_t>::const_iterator it = mapBalanceDeltas.begin(); it != mapBalanceDeltas.end(); ++it) {
+        if (it->second == 0) continue; // changes within the block cancelled out
+        CZusBalanceDelta delta;
+        delta.address = std::get<0>(it->first);
+        delta.propertyId = std::get<1>(it->first);
+        delta.ttype = (TallyType) std::get<2>(it->first);
+        delta.amount = it->second;
+        vDeltas.push_back(delta);
+    }
+    mapBalanceDeltas.clear();
+
+    if (!vDeltas.empty()) {
+        g_zusSignals.BalancesChanged(block, blockHash, vDeltas);
+    }
+}
+}
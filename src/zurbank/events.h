@@ -0,0 +1,90 @@
+#ifndef ZURBANK_EVENTS_H
+#define ZURBANK_EVENTS_H
+
+#include "zurbank/tally.h"
+
+#include "uint256.h"
+
+#include <boost/signals2/signal.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class CMPTransaction;
+
+namespace mastercore
+{
+/** A matched trade on the distributed exchange, as recorded in the trade database.
+ */
+struct CZusTradeEvent
+{
+    //! Block of the trade
+    int block;
+    //! Hash of the existing order
+    uint256 txid1;
+    //! Hash of the new order
+    uint256 txid2;
+    //! Address of the existing order
+    std::string address1;
+    //! Address of the new order
+    std::string address2;
+    //! Property received by the existing order
+    uint32_t property1;
+    //! Property received by the new order
+    uint32_t property2;
+    //! Amount received by the existing order
+    int64_t amount1;
+    //! Amount received by the new order, after fees
+    int64_t amount2;
+    //! Trading fee paid by the new order
+    int64_t fee;
+};
+
+/** A net change of a balance of an address within a block.
+ */
+struct CZusBalanceDelta
+{
+    std::string address;
+    uint32_t propertyId;
+    TallyType ttype;
+    int64_t amount;
+};
+
+/** Signals for consumers of Zus layer events, such as the ZMQ publishers.
+ *
+ * The signals are emitted while processing blocks, with cs_tally held.
+ *
+ * They are suspended, while the state is caught up with the chain during
+ * startup, so blocks processed by the initial scan are not announced. During a
+ * reindex the blocks are connected again, and the events are emitted again.
+ */
+struct CZusSignals
+{
+    /** A transaction was parsed and interpreted; result is the return value of interpretPacket(). */
+    boost::signals2::signal<void (const CMPTransaction& mptx, int result)> TransactionProcessed;
+    /** Two orders on the distributed exchange were matched. */
+    boost::signals2::signal<void (const CZusTradeEvent& trade)> TradeMatched;
+    /** Balances changed within the block; only emitted, when there were changes. */
+    boost::signals2::signal<void (int block, const uint256& blockHash, const std::vector<CZusBalanceDelta>& deltas)> BalancesChanged;
+    /** A block is disconnected, and the state is going to be rolled back. */
+    boost::signals2::signal<void (int block, const uint256& blockHash)> Reorg;
+};
+
+/** Returns the signals for Zus layer events. */
+CZusSignals& GetZusSignals();
+
+/** Suspends or resumes all signals for Zus layer events. */
+void SuspendZusSignals(bool fSuspend);
+/** Whether the signals for Zus layer events are emitted. */
+bool ZusSignalsActive();
+
+/** Starts collecting balance changes for a new block, if anyone is listening. */
+void BeginBalanceDeltas();
+/** Records a balance change, while collecting. Changes of pending amounts are ignored. */
+void RecordBalanceDelta(const std::string& address, uint32_t propertyId, int64_t amount, TallyType ttype);
+/** Emits the collected balance changes of the block, and stops collecting. */
+void EndBalanceDeltas(int block, const uint256& blockHash);
+}
+
+#endif // ZURBANK_EVENTS_H
@@ -4,6 +4,7 @@
 #include "zurbank/dbtradelist.h"
 #include "zurbank/dbtxlist.h"
 #include "zurbank/errors.h"
+#include "zurbank/events.h"
 #include "zurbank/log.h"
 #include "zurbank/zurbank.h"
 #include "zurbank/rules.h"
@@ -14,6 +15,7 @@
 #include "arith_uint256.h"
 #include "chain.h"
 #include "main.h"
+#include "sync.h"
 #include "tinyformat.h"
 #include "uint256.h"
 
@@ -27,11 +29,16 @@
 #include <assert.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <limits>
 #include <map>
-#include <set>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 typedef boost::multiprecision::cpp_dec_float_100 dec_float;
 typedef boost::multiprecision::checked_int128_t int128_t;
@@ -44,6 +51,94 @@ using namespace mastercore;
 //! Global map for price and order data
 md_PropertiesMap mastercore::metadex;
 
+//! Aggregated depth of each market, maintained alongside the order data
+static md_MarketsMap mapMarketDepth;
+
+namespace
+{
+/**
+ * The table of interned addresses.
+ *
+ * The addresses are split into shards with their own lock, so that orders,
+ * which are created by different threads, rarely wait for each other. An
+ * address is removed, once the last order, which refers to it, is gone.
+ */
+class CAddressTable
+{
+private:
+    static const size_t NUM_SHARDS = 16;
+
+    struct CShard
+    {
+        CCriticalSection cs;
+        //! The interned copy of each address, by address
+        std::unordered_map<std::string, std::pair<const std::string*, std::weak_ptr<const std::string> > > mapAddresses;
+    };
+    CShard shards[NUM_SHARDS];
+
+    CShard& GetShard(const std::string& addr)
+    {
+        return shards[std::hash<std::string>()(addr) % NUM_SHARDS];
+    }
+
+    /** Removes an address, unless it was interned again in the meantime. */
+    void Release(const std::string* pAddr)
+    {
+        CShard& shard = GetShard(*pAddr);
+        {
+            LOCK(shard.cs);
+            auto it = shard.mapAddresses.find(*pAddr);
+            if (it != shard.mapAddresses.end() && it->second.first == pAddr) {
+                shard.mapAddresses.erase(it);
+            }
+        }
+        delete pAddr;
+    }
+
+public:
+    std::shared_ptr<const std::string> Intern(const std::string& addr)
+    {
+        CShard& shard = GetShard(addr);
+        LOCK(shard.cs);
+        auto& entry = shard.mapAddresses[addr];
+        std::shared_ptr<const std::string> pAddr = entry.second.lock();
+        if (!pAddr) {
+            const std::string* pNew = new std::string(addr);
+            pAddr.reset(pNew, [this](const std::string* p) { Release(p); });
+            entry = std::make_pair(pNew, std::weak_ptr<const std::string>(pAddr));
+        }
+        return pAddr;
+    }
+
+    size_t Size()
+    {
+        size_t nSize = 0;
+        for (size_t i = 0; i < NUM_SHARDS; ++i) {
+            LOCK(shards[i].cs);
+            nSize += shards[i].mapAddresses.size();
+        }
+        return nSize;
+    }
+};
+
+/** Returns the table, which is never destroyed, as orders may outlive any static object. */
+CAddressTable& GetAddressTable()
+{
+    static CAddressTable* pTable = new CAddressTable();
+    return *pTable;
+}
+}
+
+std::shared_ptr<const std::string> mastercore::MetaDEx_InternAddress(const std::string& addr)
+{
+    return GetAddressTable().Intern(addr);
+}
+
+size_t mastercore::MetaDEx_InternedAddressCount()
+{
+    return GetAddressTable().Size();
+}
+
 md_PricesMap* mastercore::get_Prices(uint32_t prop)
 {
     md_PropertiesMap::iterator it = metadex.find(prop);
@@ -62,6 +157,54 @@ md_Set* mastercore::get_Indexes(md_PricesMap* p, rational_t price)
     return (md_Set*) NULL;
 }
 
+/** Converts a sum of amounts, which is never negative, and caps it at the largest amount. */
+static int64_t ClampAmount(const int128_t& value)
+{
+    assert(value >= 0);
+    if (value > std::numeric_limits<int64_t>::max()) return std::numeric_limits<int64_t>::max();
+    return value.convert_to<int64_t>();
+}
+
+int64_t CMPMetaDExLevel::getAmountForSale() const
+{
+    return ClampAmount(amountForSale);
+}
+
+int64_t CMPMetaDExLevel::getAmountToFill() const
+{
+    return ClampAmount(amountToFill);
+}
+
+/** Adds an order to the aggregated depth of its market. */
+static void DepthAddOrder(const CMPMetaDEx& obj)
+{
+    md_DepthMap& levels = mapMarketDepth[std::make_pair(obj.getProperty(), obj.getDesProperty())];
+    CMPMetaDExLevel& level = levels[obj.unitPrice()];
+    if (level.orders == 0) level.price = obj.unitPrice();
+    level.amountForSale += obj.getAmountRemaining();
+    level.amountToFill += obj.getAmountToFill();
+    level.orders++;
+}
+
+/** Removes an order from the aggregated depth of its market. */
+static void DepthRemoveOrder(const CMPMetaDEx& obj)
+{
+    md_MarketsMap::iterator itMarket = mapMarketDepth.find(std::make_pair(obj.getProperty(), obj.getDesProperty()));
+    assert(itMarket != mapMarketDepth.end());
+    md_DepthMap& levels = itMarket->second;
+    md_DepthMap::iterator itLevel = levels.find(obj.unitPrice());
+    assert(itLevel != levels.end());
+    CMPMetaDExLevel& level = itLevel->second;
+    level.amountForSale -= obj.getAmountRemaining();
+    level.amountToFill -= obj.getAmountToFill();
+    level.orders--;
+    if (level.orders == 0) {
+        assert(level.amountForSale == 0 && level.amountToFill == 0);
+        levels.erase(itLevel);
+        if (levels.empty()) mapMarketDepth.erase(itMarket);
+    }
+}
+
 enum MatchReturnType
 {
     NOTHING = 0,
@@ -292,9 +435,6 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
 
             NewReturn = TRADED;
 
-            CMPMetaDEx seller_replacement = *pold; // < can be moved into last if block
-            seller_replacement.setAmountRemaining(seller_amountLeft, "seller_replacement");
-
             pnew->setAmountRemaining(buyer_amountLeft, "buyer");
 
             if (0 < buyer_amountLeft) {
@@ -315,14 +455,31 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
             pDbTradeList->recordMatchedTrade(pold->getHash(), pnew->getHash(), // < might just pass pold, pnew
                 pold->getAddr(), pnew->getAddr(), pold->getDesProperty(), pnew->getDesProperty(), seller_amountGot, buyer_amountGotAfterFee, pnew->getBlock(), tradingFee);
 
-            if (msc_debug_metadex1) PrintToLog("++ erased old: %s\n", offerIt->ToString());
-            // erase the old seller element
-            pofferSet->erase(offerIt++);
+            // publish the trade, if anyone is listening
+            if (ZusSignalsActive() && !GetZusSignals().TradeMatched.empty()) {
+                CZusTradeEvent trade;
+                trade.block = pnew->getBlock();
+                trade.txid1 = pold->getHash();
+                trade.txid2 = pnew->getHash();
+                trade.address1 = pold->getAddr();
+                trade.address2 = pnew->getAddr();
+                trade.property1 = pold->getDesProperty();
+                trade.property2 = pnew->getDesProperty();
+                trade.amount1 = seller_amountGot;
+                trade.amount2 = buyer_amountGotAfterFee;
+                trade.fee = tradingFee;
+                GetZusSignals().TradeMatched(trade);
+            }
 
-            // insert the updated one in place of the old
-            if (0 < seller_replacement.getAmountRemaining()) {
-                PrintToLog("++ inserting seller_replacement: %s\n", seller_replacement.ToString());
-                pofferSet->insert(seller_replacement);
+            DepthRemoveOrder(*offerIt);
+            if (0 < seller_amountLeft) {
+                // update the old seller element in place, its position in the price level doesn't change
+                pofferSet->setAmountRemaining(offerIt, seller_amountLeft, "seller");
+                DepthAddOrder(*offerIt);
+                ++offerIt;
+            } else {
+                if (msc_debug_metadex1) PrintToLog("++ erased old: %s\n", offerIt->ToString());
+                offerIt = pofferSet->erase(offerIt);
             }
 
             if (bBuyerSatisfied) {
@@ -424,14 +581,14 @@ void CMPMetaDEx::setAmountRemaining(int64_t amount, const std::string& label)
 std::string CMPMetaDEx::ToString() const
 {
     return strprintf("%s:%34s in %d/%03u, txid: %s , trade #%u %s for #%u %s",
-        xToString(unitPrice()), addr, block, idx, txid.ToString().substr(0, 10),
+        xToString(unitPrice()), *addr, block, idx, txid.ToString().substr(0, 10),
         property, FormatMP(property, amount_forsale), desired_property, FormatMP(desired_property, amount_desired));
 }
 
 void CMPMetaDEx::saveOffer(std::ofstream& file, SHA256_CTX* shaCtx) const
 {
     std::string lineOut = strprintf("%s,%d,%d,%d,%d,%d,%d,%d,%s,%d",
-        addr,
+        *addr,
         block,
         amount_forsale,
         property,
@@ -456,37 +613,73 @@ bool MetaDEx_compare::operator()(const CMPMetaDEx &lhs, const CMPMetaDEx &rhs) c
     else return lhs.getBlock() < rhs.getBlock();
 }
 
-bool mastercore::MetaDEx_INSERT(const CMPMetaDEx& objMetaDEx)
+std::pair<md_Set::iterator, bool> md_Set::insert(const CMPMetaDEx& obj)
 {
-    // Create an empty price map (to use in case price map for this property does not already exist)
-    md_PricesMap temp_prices;
-    // Attempt to obtain the price map for the property
-    md_PricesMap *p_prices = get_Prices(objMetaDEx.getProperty());
+    MetaDEx_compare compare;
+
+    // fast path for the latest order
+    if (orders.empty() || compare(orders.back(), obj)) {
+        orders.push_back(obj);
+        return std::make_pair(iterator(orders.end() - 1), true);
+    }
 
-    // Create an empty set of metadex objects (to use in case no set currently exists at this price)
-    md_Set temp_indexes;
-    md_Set *p_indexes = NULL;
+    std::vector<CMPMetaDEx>::iterator it = std::lower_bound(orders.begin(), orders.end(), obj, compare);
+    if (it != orders.end() && !compare(obj, *it)) return std::make_pair(iterator(it), false);
+
+    return std::make_pair(iterator(orders.insert(it, obj)), true);
+}
+
+md_Set::iterator md_Set::erase(iterator it)
+{
+    return orders.erase(orders.begin() + (it - orders.begin()));
+}
 
-    // Prepare for return code
-    std::pair <md_Set::iterator, bool> ret;
+void md_Set::setAmountRemaining(iterator it, int64_t amount, const std::string& label)
+{
+    orders[it - orders.begin()].setAmountRemaining(amount, label);
+}
 
-    // Attempt to obtain a set of metadex objects for this price from the price map
-    if (p_prices) p_indexes = get_Indexes(p_prices, objMetaDEx.unitPrice());
-    // See if the set was populated, if not no set exists at this price level, use the empty set that we created earlier
-    if (!p_indexes) p_indexes = &temp_indexes;
+bool mastercore::MetaDEx_INSERT(const CMPMetaDEx& objMetaDEx)
+{
+    // Obtain the set of metadex objects at this price, which creates the price level, if needed
+    md_Set& indexes = metadex[objMetaDEx.getProperty()][objMetaDEx.unitPrice()];
 
     // Attempt to insert the metadex object into the set
-    ret = p_indexes->insert(objMetaDEx);
-    if (false == ret.second) return false;
+    if (!indexes.insert(objMetaDEx).second) return false;
 
-    // If a prices map did not exist for this property, set p_prices to the temp empty price map
-    if (!p_prices) p_prices = &temp_prices;
+    DepthAddOrder(objMetaDEx);
 
-    // Update the prices map with the new set at this price
-    (*p_prices)[objMetaDEx.unitPrice()] = *p_indexes;
+    return true;
+}
 
-    // Set the metadex map for the property to the updated (or new if it didn't exist) price map
-    metadex[objMetaDEx.getProperty()] = *p_prices;
+void mastercore::MetaDEx_CLEAR()
+{
+    metadex.clear();
+    mapMarketDepth.clear();
+}
+
+void mastercore::MetaDEx_getDepth(uint32_t propertyForSale, uint32_t propertyDesired, size_t nLevels, std::vector<CMPMetaDExLevel>& vLevels)
+{
+    md_MarketsMap::const_iterator itMarket = mapMarketDepth.find(std::make_pair(propertyForSale, propertyDesired));
+    if (itMarket == mapMarketDepth.end()) return;
+
+    const md_DepthMap& levels = itMarket->second;
+    for (md_DepthMap::const_iterator it = levels.begin(); it != levels.end(); ++it) {
+        if (nLevels > 0 && vLevels.size() >= nLevels) break;
+        vLevels.push_back(it->second);
+    }
+}
+
+bool mastercore::MetaDEx_getSpread(uint32_t propertyForSale, uint32_t propertyDesired, rational_t& bestAsk, rational_t& bestBid)
+{
+    md_MarketsMap::const_iterator itAsks = mapMarketDepth.find(std::make_pair(propertyForSale, propertyDesired));
+    md_MarketsMap::const_iterator itBids = mapMarketDepth.find(std::make_pair(propertyDesired, propertyForSale));
+    if (itAsks == mapMarketDepth.end() || itBids == mapMarketDepth.end()) return false;
+
+    bestAsk = itAsks->second.begin()->first;
+    // the lowest price of the other side is the highest price offered for this side
+    const rational_t& bidPrice = itBids->second.begin()->first;
+    bestBid = rational_t(bidPrice.denominator(), bidPrice.numerator());
 
     return true;
 }
@@ -572,7 +765,8 @@ int mastercore::MetaDEx_CANCEL_AT_PRICE(const uint256& txid, unsigned int block,
             bool bValid = true;
             pDbTransactionList->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
 
-            indexes->erase(iitt++);
+            DepthRemoveOrder(*p_mdex);
+            iitt = indexes->erase(iitt);
         }
     }
 
@@ -621,7 +815,8 @@ int mastercore::MetaDEx_CANCEL_ALL_FOR_PAIR(const uint256& txid, unsigned int bl
             bool bValid = true;
             pDbTransactionList->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
 
-            indexes->erase(iitt++);
+            DepthRemoveOrder(*p_mdex);
+            iitt = indexes->erase(iitt);
         }
     }
 
@@ -678,7 +873,8 @@ int mastercore::MetaDEx_CANCEL_EVERYTHING(const uint256& txid, unsigned int bloc
                 bool bValid = true;
                 pDbTransactionList->recordMetaDExCancelTX(txid, it->getHash(), bValid, block, it->getProperty(), it->getAmountRemaining());
 
-                indexes.erase(it++);
+                DepthRemoveOrder(*it);
+                it = indexes.erase(it);
             }
         }
     }
@@ -706,7 +902,10 @@ int mastercore::MetaDEx_SHUTDOWN_ALLPAIR()
                     // move from reserve to balance
                     assert(update_tally_map(it->getAddr(), it->getProperty(), -it->getAmountRemaining(), METADEX_RESERVE));
                     assert(update_tally_map(it->getAddr(), it->getProperty(), it->getAmountRemaining(), BALANCE));
-                    indexes.erase(it++);
+                    DepthRemoveOrder(*it);
+                    it = indexes.erase(it);
+                } else {
+                    ++it;
                 }
             }
         }
@@ -730,7 +929,8 @@ int mastercore::MetaDEx_SHUTDOWN()
                 // move from reserve to balance
                 assert(update_tally_map(it->getAddr(), it->getProperty(), -it->getAmountRemaining(), METADEX_RESERVE));
                 assert(update_tally_map(it->getAddr(), it->getProperty(), it->getAmountRemaining(), BALANCE));
-                indexes.erase(it++);
+                DepthRemoveOrder(*it);
+                it = indexes.erase(it);
             }
         }
     }
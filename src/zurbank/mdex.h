@@ -12,12 +12,16 @@
 
 #include <openssl/sha.h>
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <fstream>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 typedef boost::rational<boost::multiprecision::checked_int128_t> rational_t;
 
@@ -32,6 +36,21 @@ typedef boost::rational<boost::multiprecision::checked_int128_t> rational_t;
 /** Converts price to string. */
 std::string xToString(const rational_t& value);
 
+namespace mastercore
+{
+/**
+ * Returns the shared copy of an address used by the MetaDEx.
+ *
+ * Each distinct address is stored once, for as long as an order refers to it,
+ * so orders only carry a pointer, and the same address yields the same pointer
+ * while it's in use. The memory is bounded by the addresses of live orders.
+ */
+std::shared_ptr<const std::string> MetaDEx_InternAddress(const std::string& addr);
+
+/** Returns the number of addresses, which are currently interned. */
+size_t MetaDEx_InternedAddressCount();
+}
+
 /** A trade on the distributed exchange.
  */
 class CMPMetaDEx
@@ -46,7 +65,7 @@ private:
     int64_t amount_desired;
     int64_t amount_remaining;
     uint8_t subaction;
-    std::string addr;
+    std::shared_ptr<const std::string> addr;
 
 public:
     uint256 getHash() const { return txid; }
@@ -63,7 +82,7 @@ public:
 
     uint8_t getAction() const { return subaction; }
 
-    const std::string& getAddr() const { return addr; }
+    const std::string& getAddr() const { return *addr; }
 
     int getBlock() const { return block; }
     unsigned int getIdx() const { return idx; }
@@ -72,22 +91,22 @@ public:
 
     CMPMetaDEx()
       : block(0), idx(0), property(0), amount_forsale(0), desired_property(0), amount_desired(0),
-        amount_remaining(0), subaction(0) {}
+        amount_remaining(0), subaction(0), addr(mastercore::MetaDEx_InternAddress("")) {}
 
     CMPMetaDEx(const std::string& addr, int b, uint32_t c, int64_t nValue, uint32_t cd, int64_t ad,
                const uint256& tx, uint32_t i, uint8_t suba)
       : block(b), txid(tx), idx(i), property(c), amount_forsale(nValue), desired_property(cd), amount_desired(ad),
-        amount_remaining(nValue), subaction(suba), addr(addr) {}
+        amount_remaining(nValue), subaction(suba), addr(mastercore::MetaDEx_InternAddress(addr)) {}
 
     CMPMetaDEx(const std::string& addr, int b, uint32_t c, int64_t nValue, uint32_t cd, int64_t ad,
                const uint256& tx, uint32_t i, uint8_t suba, int64_t ar)
       : block(b), txid(tx), idx(i), property(c), amount_forsale(nValue), desired_property(cd), amount_desired(ad),
-        amount_remaining(ar), subaction(suba), addr(addr) {}
+        amount_remaining(ar), subaction(suba), addr(mastercore::MetaDEx_InternAddress(addr)) {}
 
     CMPMetaDEx(const CMPTransaction& tx)
       : block(tx.block), txid(tx.txid), idx(tx.tx_idx), property(tx.property), amount_forsale(tx.nValue),
         desired_property(tx.desired_property), amount_desired(tx.desired_value), amount_remaining(tx.nValue),
-        subaction(tx.subaction), addr(tx.sender) {}
+        subaction(tx.subaction), addr(mastercore::MetaDEx_InternAddress(tx.sender)) {}
 
     std::string ToString() const;
 
@@ -110,8 +129,35 @@ struct MetaDEx_compare
 };
 
 // ---------------
-//! Set of objects sorted by block+idx
-typedef std::set<CMPMetaDEx, MetaDEx_compare> md_Set; 
+/**
+ * Orders of a single price level, sorted by block+idx.
+ *
+ * The orders are stored contiguously, and new orders are almost always the
+ * latest, so they are appended at the end. The position of an order only
+ * depends on block+idx, so partial fills update it in place.
+ */
+class md_Set
+{
+private:
+    std::vector<CMPMetaDEx> orders;
+
+public:
+    typedef std::vector<CMPMetaDEx>::const_iterator iterator;
+    typedef std::vector<CMPMetaDEx>::const_iterator const_iterator;
+
+    iterator begin() const { return orders.begin(); }
+    iterator end() const { return orders.end(); }
+    size_t size() const { return orders.size(); }
+    bool empty() const { return orders.empty(); }
+
+    /** Inserts an order, unless one with the same block+idx exists. */
+    std::pair<iterator, bool> insert(const CMPMetaDEx& obj);
+    /** Removes an order, and returns the position of the next one. */
+    iterator erase(iterator it);
+    /** Updates the amount still for sale of an order. */
+    void setAmountRemaining(iterator it, int64_t amount, const std::string& label = "");
+};
+
 //! Map of prices; there is a set of sorted objects for each price
 typedef std::map<rational_t, md_Set> md_PricesMap;
 //! Map of properties; there is a map of prices for each property
@@ -125,6 +171,45 @@ md_PricesMap* get_Prices(uint32_t prop);
 md_Set* get_Indexes(md_PricesMap* p, rational_t price);
 // ---------------
 
+/** Aggregated open orders of a market at a single price level.
+ *
+ * The amount desired of an order is not capped, so the sums are kept in 128 bit,
+ * which can't overflow, and are clamped to 64 bit, when they are presented.
+ */
+struct CMPMetaDExLevel
+{
+    //! Unit price, in desired units per unit for sale
+    rational_t price;
+    //! Sum of the amounts still for sale
+    boost::multiprecision::checked_int128_t amountForSale;
+    //! Sum of the amounts required to fill the orders
+    boost::multiprecision::checked_int128_t amountToFill;
+    //! Number of orders
+    uint32_t orders;
+
+    CMPMetaDExLevel() : amountForSale(0), amountToFill(0), orders(0) {}
+
+    /** Returns the sum of the amounts still for sale, at most INT64_MAX. */
+    int64_t getAmountForSale() const;
+    /** Returns the sum of the amounts required to fill the orders, at most INT64_MAX. */
+    int64_t getAmountToFill() const;
+};
+
+//! Map of price levels of a market, best (lowest) price first
+typedef std::map<rational_t, CMPMetaDExLevel> md_DepthMap;
+//! Map of markets, keyed by property for sale and desired property
+typedef std::map<std::pair<uint32_t, uint32_t>, md_DepthMap> md_MarketsMap;
+
+/** Returns up to nLevels aggregated price levels of a market, best price first; 0 for all levels. */
+void MetaDEx_getDepth(uint32_t propertyForSale, uint32_t propertyDesired, size_t nLevels, std::vector<CMPMetaDExLevel>& vLevels);
+/**
+ * Returns the best prices of a market, both in units of propertyDesired per unit of propertyForSale.
+ *
+ * The best ask is the lowest price of orders selling propertyForSale, and the best bid is the
+ * highest price offered by orders selling propertyDesired. Returns false, if one side is empty.
+ */
+bool MetaDEx_getSpread(uint32_t propertyForSale, uint32_t propertyDesired, rational_t& bestAsk, rational_t& bestBid);
+
 int MetaDEx_ADD(const std::string& sender_addr, uint32_t, int64_t, int block, uint32_t property_desired, int64_t amount_desired, const uint256& txid, unsigned int idx);
 int MetaDEx_CANCEL_AT_PRICE(const uint256&, uint32_t, const std::string&, uint32_t, int64_t, uint32_t, int64_t);
 int MetaDEx_CANCEL_ALL_FOR_PAIR(const uint256&, uint32_t, const std::string&, uint32_t, uint32_t);
@@ -132,6 +217,8 @@ int MetaDEx_CANCEL_EVERYTHING(const uint256& txid, uint32_t block, const std::st
 int MetaDEx_SHUTDOWN();
 int MetaDEx_SHUTDOWN_ALLPAIR();
 bool MetaDEx_INSERT(const CMPMetaDEx& objMetaDEx);
+/** Removes all orders, without touching balances. */
+void MetaDEx_CLEAR();
 void MetaDEx_debug_print(bool bShowPriceLevel = false, bool bDisplay = false);
 bool MetaDEx_isOpen(const uint256& txid, uint32_t propertyIdForSale = 0);
 int MetaDEx_getStatus(const uint256& txid, uint32_t propertyIdForSale, int64_t amountForSale, int64_t totalSold = -1);
@@ -3,17 +3,25 @@
 #include "zurbank/log.h"
 #include "zurbank/zurbank.h"
 #include "zurbank/sp.h"
+#include "zurbank/tx.h"
 #include "zurbank/walletcache.h"
 #include "zurbank/mdex.h"
+#include "zurbank/parsing.h"
+#include "zurbank/utilszurcoin.h"
 
 #include "amount.h"
 #include "main.h"
+#include "primitives/transaction.h"
 #include "sync.h"
 #include "txmempool.h"
 #include "uint256.h"
 #include "ui_interface.h"
 
+#include <map>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace mastercore
 {
@@ -24,9 +32,10 @@ CCriticalSection cs_pending;
 PendingMap my_pending;
 
 /**
- * Adds a transaction to the pending map using supplied parameters.
+ * Subtracts the amount from the pending tally, and adds the pending object,
+ * without refreshing the wallet totals.
  */
-void PendingAdd(const uint256& txid, const std::string& sendingAddress, uint16_t type, uint32_t propertyId, int64_t amount, bool fSubtract)
+static bool AddPending(const uint256& txid, const std::string& sendingAddress, uint16_t type, uint32_t propertyId, int64_t amount, bool fSubtract)
 {
     if (msc_debug_pending) PrintToLog("%s(%s,%s,%d,%d,%d,%s)\n", __func__, txid.GetHex(), sendingAddress, type, propertyId, amount, fSubtract);
 
@@ -34,7 +43,7 @@ void PendingAdd(const uint256& txid, const std::string& sendingAddress, uint16_t
     if (fSubtract) {
         if (!update_tally_map(sendingAddress, propertyId, -amount, PENDING)) {
             PrintToLog("ERROR - Update tally for pending failed! %s(%s,%s,%d,%d,%d,%s)\n", __func__, txid.GetHex(), sendingAddress, type, propertyId, amount, fSubtract);
-            return;
+            return false;
         }
     }
 
@@ -48,11 +57,45 @@ void PendingAdd(const uint256& txid, const std::string& sendingAddress, uint16_t
         LOCK(cs_pending);
         my_pending.insert(std::make_pair(txid, pending));
     }
+    return true;
+}
+
+/**
+ * Adds a transaction to the pending map using supplied parameters.
+ */
+void PendingAdd(const uint256& txid, const std::string& sendingAddress, uint16_t type, uint32_t propertyId, int64_t amount, bool fSubtract)
+{
+    if (!AddPending(txid, sendingAddress, type, propertyId, amount, fSubtract)) {
+        return;
+    }
     // after adding a transaction to pending the available balance may now be reduced, refresh wallet totals
     CheckWalletUpdate(true); // force an update since some outbound pending (eg MetaDEx cancel) may not change balances
     uiInterface.OmniPendingChanged(true);
 }
 
+/**
+ * Adds several transactions to the pending map, whose amounts are subtracted
+ * from the pending tally.
+ *
+ * NOTE: the wallet totals are refreshed once for the whole batch, which is
+ *       the expensive part of adding a pending transaction.
+ */
+void PendingAdd(const std::vector<std::pair<uint256, CMPPending> >& vPending)
+{
+    bool fAdded = false;
+    for (std::vector<std::pair<uint256, CMPPending> >::const_iterator it = vPending.begin(); it != vPending.end(); ++it) {
+        const CMPPending& pending = it->second;
+        if (AddPending(it->first, pending.src, pending.type, pending.prop, pending.amount, true)) {
+            fAdded = true;
+        }
+    }
+    if (!fAdded) {
+        return;
+    }
+    CheckWalletUpdate(true);
+    uiInterface.OmniPendingChanged(true);
+}
+
 /**
  * Deletes a transaction from the pending map and credits the amount back to the pending tally for the address.
  *
@@ -85,16 +128,169 @@ void PendingCheck()
 {
     LOCK(cs_pending);
 
-    std::vector<uint256> vecMemPoolTxids;
-    mempool.queryHashes(vecMemPoolTxids);
-
+    std::vector<uint256> vToDelete;
     for (PendingMap::iterator it = my_pending.begin(); it != my_pending.end(); ++it) {
         const uint256& txid = it->first;
-        if (std::find(vecMemPoolTxids.begin(), vecMemPoolTxids.end(), txid) == vecMemPoolTxids.end()) {
+        if (!mempool.exists(txid)) {
             PrintToLog("WARNING: Pending transaction %s is no longer in this nodes mempool and will be discarded\n", txid.GetHex());
-            PendingDelete(txid);
+            vToDelete.push_back(txid);
+        }
+    }
+    for (std::vector<uint256>::const_iterator it = vToDelete.begin(); it != vToDelete.end(); ++it) {
+        PendingDelete(*it);
+    }
+}
+
+/** A simple send in the mempool, as parsed when it entered. */
+struct CMPUnconfirmed
+{
+    std::string sender;
+    std::string receiver;
+    uint32_t prop;
+    int64_t amount;
+
+    CMPUnconfirmed() : prop(0), amount(0) {}
+};
+
+//! Guards the unconfirmed state
+static CCriticalSection cs_unconfirmed;
+
+//! Simple sends in the mempool
+static std::map<uint256, CMPUnconfirmed> mapUnconfirmed;
+
+//! Amounts by address and property
+typedef std::unordered_map<std::string, std::map<uint32_t, int64_t> > UnconfirmedAmountMap;
+
+//! Net balance changes of those sends, by address and property
+static UnconfirmedAmountMap mapUnconfirmedDeltas;
+
+//! Amounts sent by those sends, by address and property
+static UnconfirmedAmountMap mapUnconfirmedDebits;
+
+static void UpdateUnconfirmedAmount(UnconfirmedAmountMap& mapAmounts, const std::string& address, uint32_t propertyId, int64_t amount)
+{
+    UnconfirmedAmountMap::iterator it = mapAmounts.find(address);
+    if (it == mapAmounts.end()) {
+        it = mapAmounts.insert(std::make_pair(address, std::map<uint32_t, int64_t>())).first;
+    }
+    int64_t& total = it->second[propertyId];
+    total += amount;
+    if (total == 0) {
+        it->second.erase(propertyId);
+        if (it->second.empty()) mapAmounts.erase(it);
+    }
+}
+
+static int64_t GetUnconfirmedAmount(const UnconfirmedAmountMap& mapAmounts, const std::string& address, uint32_t propertyId)
+{
+    UnconfirmedAmountMap::const_iterator it = mapAmounts.find(address);
+    if (it == mapAmounts.end()) return 0;
+    std::map<uint32_t, int64_t>::const_iterator itProp = it->second.find(propertyId);
+    if (itProp == it->second.end()) return 0;
+    return itProp->second;
+}
+
+/**
+ * Parses a transaction, which entered the mempool, and records its provisional balance changes.
+ *
+ * NOTE: only simple sends are tracked, and only if the confirmed balance of the
+ *       sender covers the amount, after the other unconfirmed sends of the
+ *       sender. Unconfirmed credits are not spendable, so that a send, which
+ *       relies on another transaction in the mempool, is not counted. The
+ *       transaction is parsed once, when it enters the mempool, and not again
+ *       when the balances are queried.
+ */
+void UnconfirmedAdd(const CTransaction& tx)
+{
+    const uint256& txid = tx.GetHash();
+    {
+        LOCK(cs_unconfirmed);
+        if (mapUnconfirmed.count(txid)) return;
+    }
+    if (!mempool.exists(txid)) return;
+
+    CMPTransaction mp_obj;
+    if (0 != ParseTransaction(tx, GetHeight() + 1, 0, mp_obj)) return;
+    if (!mp_obj.interpret_Transaction()) return;
+    if (mp_obj.getType() != MSC_TYPE_SIMPLE_SEND) return;
+    if (mp_obj.getReceiver().empty() || mp_obj.getSender() == mp_obj.getReceiver()) return;
+
+    int64_t amount = static_cast<int64_t>(mp_obj.getAmount());
+    if (amount <= 0) return;
+
+    CMPUnconfirmed unconfirmed;
+    unconfirmed.sender = mp_obj.getSender();
+    unconfirmed.receiver = mp_obj.getReceiver();
+    unconfirmed.prop = mp_obj.getProperty();
+    unconfirmed.amount = amount;
+
+    if (msc_debug_pending) PrintToLog("%s(%s): %s -> %s, property: %d, amount: %d\n", __func__, txid.GetHex(),
+            unconfirmed.sender, unconfirmed.receiver, unconfirmed.prop, unconfirmed.amount);
+
+    // the balance and the other sends are checked and updated at once
+    LOCK2(cs_tally, cs_unconfirmed);
+    if (mapUnconfirmed.count(txid)) return;
+
+    int64_t nBalance = GetTokenBalance(unconfirmed.sender, unconfirmed.prop, BALANCE);
+    int64_t nDebits = GetUnconfirmedAmount(mapUnconfirmedDebits, unconfirmed.sender, unconfirmed.prop);
+    if (nBalance - nDebits < unconfirmed.amount) {
+        if (msc_debug_pending) PrintToLog("%s(%s): insufficient balance: %d, unconfirmed debits: %d\n", __func__,
+                txid.GetHex(), nBalance, nDebits);
+        return;
+    }
+
+    mapUnconfirmed.insert(std::make_pair(txid, unconfirmed));
+    UpdateUnconfirmedAmount(mapUnconfirmedDebits, unconfirmed.sender, unconfirmed.prop, unconfirmed.amount);
+    UpdateUnconfirmedAmount(mapUnconfirmedDeltas, unconfirmed.sender, unconfirmed.prop, -unconfirmed.amount);
+    UpdateUnconfirmedAmount(mapUnconfirmedDeltas, unconfirmed.receiver, unconfirmed.prop, unconfirmed.amount);
+}
+
+/**
+ * Removes the provisional balance changes of a transaction, which was confirmed or left the mempool.
+ */
+void UnconfirmedDelete(const uint256& txid)
+{
+    LOCK(cs_unconfirmed);
+
+    std::map<uint256, CMPUnconfirmed>::iterator it = mapUnconfirmed.find(txid);
+    if (it == mapUnconfirmed.end()) return;
+
+    const CMPUnconfirmed& unconfirmed = it->second;
+    if (msc_debug_pending) PrintToLog("%s(%s)\n", __func__, txid.GetHex());
+    UpdateUnconfirmedAmount(mapUnconfirmedDebits, unconfirmed.sender, unconfirmed.prop, -unconfirmed.amount);
+    UpdateUnconfirmedAmount(mapUnconfirmedDeltas, unconfirmed.sender, unconfirmed.prop, unconfirmed.amount);
+    UpdateUnconfirmedAmount(mapUnconfirmedDeltas, unconfirmed.receiver, unconfirmed.prop, -unconfirmed.amount);
+    mapUnconfirmed.erase(it);
+}
+
+/**
+ * Removes the provisional balance changes of transactions, which are no longer in the mempool.
+ *
+ * NOTE: confirmed and conflicted transactions are removed right away, but
+ *       the mempool doesn't signal evictions, which are caught here.
+ */
+void UnconfirmedCheck()
+{
+    std::vector<uint256> vToDelete;
+    {
+        LOCK(cs_unconfirmed);
+        for (std::map<uint256, CMPUnconfirmed>::const_iterator it = mapUnconfirmed.begin(); it != mapUnconfirmed.end(); ++it) {
+            if (!mempool.exists(it->first)) vToDelete.push_back(it->first);
         }
     }
+    for (std::vector<uint256>::const_iterator it = vToDelete.begin(); it != vToDelete.end(); ++it) {
+        UnconfirmedDelete(*it);
+    }
+}
+
+/**
+ * Returns the net change of the balance of an address, caused by transactions in the mempool.
+ */
+int64_t GetUnconfirmedTokenDelta(const std::string& address, uint32_t propertyId)
+{
+    LOCK(cs_unconfirmed);
+
+    return GetUnconfirmedAmount(mapUnconfirmedDeltas, address, propertyId);
 }
 
 } // namespace mastercore
@@ -1,6 +1,7 @@
 #ifndef ZURBANK_PENDING_H
 #define ZURBANK_PENDING_H
 
+class CTransaction;
 class uint256;
 struct CMPPending;
 
@@ -9,6 +10,8 @@ struct CMPPending;
 #include <stdint.h>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace mastercore
 {
@@ -22,12 +25,27 @@ extern PendingMap my_pending;
 /** Adds a transaction to the pending map using supplied parameters. */
 void PendingAdd(const uint256& txid, const std::string& sendingAddress, uint16_t type, uint32_t propertyId, int64_t amount, bool fSubtract = true);
 
+/** Adds several transactions to the pending map, and refreshes the wallet totals only once. */
+void PendingAdd(const std::vector<std::pair<uint256, CMPPending> >& vPending);
+
 /** Deletes a transaction from the pending map and credits the amount back to the pending tally for the address. */
 void PendingDelete(const uint256& txid);
 
 /** Performs a check to ensure all pending transactions are still in the mempool. */
 void PendingCheck();
 
+/** Parses a transaction, which entered the mempool, and records its provisional balance changes. */
+void UnconfirmedAdd(const CTransaction& tx);
+
+/** Removes the provisional balance changes of a transaction, which was confirmed or left the mempool. */
+void UnconfirmedDelete(const uint256& txid);
+
+/** Removes the provisional balance changes of transactions, which are no longer in the mempool. */
+void UnconfirmedCheck();
+
+/** Returns the net change of the balance of an address, caused by transactions in the mempool. */
+int64_t GetUnconfirmedTokenDelta(const std::string& address, uint32_t propertyId);
+
 }
 
 /** Structure to hold information about pending transactions.
@@ -0,0 +1,241 @@
+/**
+ * @file perfstats.cpp
+ *
+ * This file contains timing statistics of the Zus processing pipeline.
+ */
+
+#include "zurbank/perfstats.h"
+
+#include "zurbank/dbfees.h"
+#include "zurbank/dbspinfo.h"
+#include "zurbank/dbstolist.h"
+#include "zurbank/dbtradelist.h"
+#include "zurbank/dbtransaction.h"
+#include "zurbank/dbtxlist.h"
+#include "zurbank/log.h"
+#include "zurbank/sp.h"
+#include "zurbank/zurbank.h"
+
+#include "sync.h"
+#include "utiltime.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mastercore
+{
+/** Histogram, which can be updated concurrently without a lock.
+ *
+ * Stages are recorded several times per transaction, so they don't take a lock.
+ * A snapshot may therefore miss parts of a concurrent update.
+ */
+struct CAtomicPerfHistogram
+{
+    std::atomic<uint64_t> nCount;
+    std::atomic<int64_t> nTotalMicros;
+    std::atomic<int64_t> nMaxMicros;
+    std::atomic<uint64_t> vBuckets[CPerfHistogram::NUM_BUCKETS];
+
+    void Add(int64_t nMicros)
+    {
+        if (nMicros < 0) nMicros = 0;
+
+        nCount.fetch_add(1, std::memory_order_relaxed);
+        nTotalMicros.fetch_add(nMicros, std::memory_order_relaxed);
+        int64_t nMax = nMaxMicros.load(std::memory_order_relaxed);
+        while (nMicros > nMax && !nMaxMicros.compare_exchange_weak(nMax, nMicros, std::memory_order_relaxed)) {}
+        vBuckets[CPerfHistogram::GetBucket(nMicros)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Get(CPerfHistogram& histogram) const
+    {
+        histogram.nCount = nCount.load(std::memory_order_relaxed);
+        histogram.nTotalMicros = nTotalMicros.load(std::memory_order_relaxed);
+        histogram.nMaxMicros = nMaxMicros.load(std::memory_order_relaxed);
+        for (int n = 0; n < CPerfHistogram::NUM_BUCKETS; ++n) {
+            histogram.vBuckets[n] = vBuckets[n].load(std::memory_order_relaxed);
+        }
+    }
+
+    void Reset()
+    {
+        nCount = 0;
+        nTotalMicros = 0;
+        nMaxMicros = 0;
+        for (int n = 0; n < CPerfHistogram::NUM_BUCKETS; ++n) {
+            vBuckets[n] = 0;
+        }
+    }
+};
+
+//! Durations of the processing stages, zero initialized as static object
+static CAtomicPerfHistogram vStageStats[NUM_PERF_STAGES];
+
+//! Guards the statistics of the transaction types
+static CCriticalSection cs_perfstats;
+
+//! Durations of the transaction logic, by transaction type
+static std::map<uint16_t, CPerfHistogram> mapTxTypeStats;
+
+CPerfHistogram::CPerfHistogram() : nCount(0), nTotalMicros(0), nMaxMicros(0)
+{
+    for (int n = 0; n < NUM_BUCKETS; ++n) {
+        vBuckets[n] = 0;
+    }
+}
+
+void CPerfHistogram::Add(int64_t nMicros)
+{
+    if (nMicros < 0) nMicros = 0;
+
+    ++nCount;
+    nTotalMicros += nMicros;
+    if (nMicros > nMaxMicros) nMaxMicros = nMicros;
+    ++vBuckets[GetBucket(nMicros)];
+}
+
+int CPerfHistogram::GetBucket(int64_t nMicros)
+{
+    int nBucket = 0;
+    while (nBucket < NUM_BUCKETS - 1 && nMicros >= GetBucketLimit(nBucket)) {
+        ++nBucket;
+    }
+    return nBucket;
+}
+
+int64_t CPerfHistogram::GetBucketLimit(int nBucket)
+{
+    return int64_t(2) << nBucket;
+}
+
+std::string GetPerfStageName(int stage)
+{
+    switch (stage) {
+        case PERF_STAGE_MARKER: return "marker";
+        case PERF_STAGE_INPUTS: return "inputs";
+        case PERF_STAGE_PARSE: return "parse";
+        case PERF_STAGE_DECODE: return "decode";
+        case PERF_STAGE_LOGIC: return "logic";
+        case PERF_STAGE_DBWRITE: return "dbwrite";
+        case PERF_STAGE_BLOCK_END: return "blockend";
+        case PERF_STAGE_PERSIST: return "persist";
+        case PERF_STAGE_CONSENSUS_HASH: return "consensushash";
+        default: return "unknown";
+    }
+}
+
+void RecordPerfStage(PerfStage stage, int64_t nMicros)
+{
+    vStageStats[stage].Add(nMicros);
+}
+
+void RecordPerfTxType(uint16_t txType, int64_t nMicros)
+{
+    vStageStats[PERF_STAGE_LOGIC].Add(nMicros);
+
+    LOCK(cs_perfstats);
+    mapTxTypeStats[txType].Add(nMicros);
+}
+
+void GetPerfStats(std::map<int, CPerfHistogram>& mapStages, std::map<uint16_t, CPerfHistogram>& mapTxTypes)
+{
+    for (int n = 0; n < NUM_PERF_STAGES; ++n) {
+        vStageStats[n].Get(mapStages[n]);
+    }
+
+    LOCK(cs_perfstats);
+    mapTxTypes = mapTxTypeStats;
+}
+
+static void AddDBStats(std::vector<CPerfDBStats>& vStats, const std::string& name, const CDBBase* pdb)
+{
+    if (pdb == NULL) return;
+
+    CPerfDBStats stats;
+    stats.name = name;
+    CDBAccessStats access = pdb->GetAccessStats();
+    stats.nLookups = access.nLookups;
+    stats.nLookupMisses = access.nLookupMisses;
+    stats.nLookupMicros = access.nLookupMicros;
+    stats.nWrites = access.nWrites;
+    stats.nWriteMicros = access.nWriteMicros;
+    vStats.push_back(stats);
+}
+
+void GetPerfDBStats(std::vector<CPerfDBStats>& vStats)
+{
+    // the databases are deleted at shutdown with cs_tally held
+    LOCK(cs_tally);
+    AddDBStats(vStats, "tradelist", pDbTradeList);
+    AddDBStats(vStats, "stolist", pDbStoList);
+    AddDBStats(vStats, "txlist", pDbTransactionList);
+    AddDBStats(vStats, "spinfo", pDbSpInfo);
+    AddDBStats(vStats, "transactions", pDbTransaction);
+    AddDBStats(vStats, "feecache", pDbFeeCache);
+    AddDBStats(vStats, "feehistory", pDbFeeHistory);
+}
+
+void ResetPerfStats()
+{
+    for (int n = 0; n < NUM_PERF_STAGES; ++n) {
+        vStageStats[n].Reset();
+    }
+
+    LOCK(cs_perfstats);
+    mapTxTypeStats.clear();
+}
+
+static void LogHistogram(const std::string& name, const CPerfHistogram& histogram)
+{
+    if (histogram.nCount == 0) return;
+
+    PrintToLog("  %-32s count=%d avg=%dus max=%dus total=%dms\n", name, histogram.nCount,
+            histogram.nTotalMicros / (int64_t) histogram.nCount, histogram.nMaxMicros, histogram.nTotalMicros / 1000);
+}
+
+void LogPerfStats()
+{
+    std::map<int, CPerfHistogram> mapStages;
+    std::map<uint16_t, CPerfHistogram> mapTxTypes;
+    GetPerfStats(mapStages, mapTxTypes);
+
+    PrintToLog("Zus processing statistics:\n");
+    for (std::map<int, CPerfHistogram>::const_iterator it = mapStages.begin(); it != mapStages.end(); ++it) {
+        LogHistogram(GetPerfStageName(it->first), it->second);
+    }
+    for (std::map<uint16_t, CPerfHistogram>::const_iterator it = mapTxTypes.begin(); it != mapTxTypes.end(); ++it) {
+        LogHistogram(strTransactionType(it->first), it->second);
+    }
+
+    std::vector<CPerfDBStats> vDBStats;
+    GetPerfDBStats(vDBStats);
+    for (std::vector<CPerfDBStats>::const_iterator it = vDBStats.begin(); it != vDBStats.end(); ++it) {
+        PrintToLog("  %-32s lookups=%d misses=%d lookup=%dms writes=%d write=%dms\n", it->name,
+                it->nLookups, it->nLookupMisses, it->nLookupMicros / 1000, it->nWrites, it->nWriteMicros / 1000);
+    }
+}
+
+CPerfStageTimer::CPerfStageTimer(PerfStage stageIn, bool fEnabledIn)
+  : stage(stageIn), nStartMicros(0), fEnabled(fEnabledIn)
+{
+    if (fEnabled) nStartMicros = GetTimeMicros();
+}
+
+CPerfStageTimer::~CPerfStageTimer()
+{
+    if (fEnabled) RecordPerfStage(stage, GetTimeMicros() - nStartMicros);
+}
+
+CPerfTxTimer::CPerfTxTimer(uint16_t txTypeIn)
+  : txType(txTypeIn), nStartMicros(GetTimeMicros())
+{
+}
+
+CPerfTxTimer::~CPerfTxTimer()
+{
+    RecordPerfTxType(txType, GetTimeMicros() - nStartMicros);
+}
+}
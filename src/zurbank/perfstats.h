@@ -0,0 +1,116 @@
+#ifndef ZURBANK_PERFSTATS_H
+#define ZURBANK_PERFSTATS_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mastercore
+{
+/** Stages of the Zus processing pipeline, which are timed.
+ */
+enum PerfStage
+{
+    PERF_STAGE_MARKER = 0,      //!< Encoding class and marker detection
+    PERF_STAGE_INPUTS,          //!< Fetching of transaction inputs into the cache
+    PERF_STAGE_PARSE,           //!< Parsing of a transaction, including the stages above
+    PERF_STAGE_DECODE,          //!< Decoding of the payload
+    PERF_STAGE_LOGIC,           //!< Execution of the transaction logic
+    PERF_STAGE_DBWRITE,         //!< Recording of a processed transaction in the databases
+    PERF_STAGE_BLOCK_END,       //!< End of block processing, including persistence
+    PERF_STAGE_PERSIST,         //!< Storing of the in-memory state in files
+    PERF_STAGE_CONSENSUS_HASH,  //!< Calculation of the consensus hash
+    NUM_PERF_STAGES
+};
+
+/** Histogram of durations with power of two buckets.
+ *
+ * Bucket n counts durations of less than 2^(n+1) microseconds, which are not
+ * counted in a lower bucket. The last bucket also counts all longer durations.
+ */
+struct CPerfHistogram
+{
+    static const int NUM_BUCKETS = 25;
+
+    uint64_t nCount;
+    int64_t nTotalMicros;
+    int64_t nMaxMicros;
+    uint64_t vBuckets[NUM_BUCKETS];
+
+    CPerfHistogram();
+
+    /** Adds a duration to the histogram. */
+    void Add(int64_t nMicros);
+
+    /** Returns the bucket, which counts the duration. */
+    static int GetBucket(int64_t nMicros);
+
+    /** Returns the upper bound of the given bucket in microseconds. */
+    static int64_t GetBucketLimit(int nBucket);
+};
+
+/** Number of lookups and writes of one of the Zus databases, and the time
+ * spent in them.
+ */
+struct CPerfDBStats
+{
+    std::string name;
+    uint64_t nLookups;
+    uint64_t nLookupMisses;
+    int64_t nLookupMicros;
+    uint64_t nWrites;
+    int64_t nWriteMicros;
+};
+
+/** Returns the name of a stage, as used in the RPC interface and the log. */
+std::string GetPerfStageName(int stage);
+
+/** Records the duration of a stage. */
+void RecordPerfStage(PerfStage stage, int64_t nMicros);
+
+/** Records the duration of the logic of a transaction of the given type. */
+void RecordPerfTxType(uint16_t txType, int64_t nMicros);
+
+/** Returns a snapshot of the statistics of all stages and transaction types. */
+void GetPerfStats(std::map<int, CPerfHistogram>& mapStages, std::map<uint16_t, CPerfHistogram>& mapTxTypes);
+
+/** Returns the read and write counters of the Zus databases. */
+void GetPerfDBStats(std::vector<CPerfDBStats>& vStats);
+
+/** Resets all statistics. */
+void ResetPerfStats();
+
+/** Writes a summary of the statistics and database counters to the log. */
+void LogPerfStats();
+
+/** Measures the time until the object goes out of scope, and records it for a stage.
+ */
+class CPerfStageTimer
+{
+private:
+    PerfStage stage;
+    int64_t nStartMicros;
+    bool fEnabled;
+
+public:
+    explicit CPerfStageTimer(PerfStage stageIn, bool fEnabledIn = true);
+    ~CPerfStageTimer();
+};
+
+/** Measures the time until the object goes out of scope, and records it for
+ * the logic stage and the given transaction type.
+ */
+class CPerfTxTimer
+{
+private:
+    uint16_t txType;
+    int64_t nStartMicros;
+
+public:
+    explicit CPerfTxTimer(uint16_t txTypeIn);
+    ~CPerfTxTimer();
+};
+}
+
+#endif // ZURBANK_PERFSTATS_H
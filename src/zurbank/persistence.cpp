@@ -44,16 +44,6 @@ extern int64_t exodus_prev;
 //! Path for file based persistence
 extern boost::filesystem::path pathStateFiles;
 
-enum FILETYPES {
-  FILETYPE_BALANCES = 0,
-  FILETYPE_OFFERS,
-  FILETYPE_ACCEPTS,
-  FILETYPE_GLOBALS,
-  FILETYPE_CROWDSALES,
-  FILETYPE_MDEXORDERS,
-  NUM_FILETYPES
-};
-
 static char const * const statePrefix[NUM_FILETYPES] = {
     "balances",
     "offers",
@@ -510,6 +500,11 @@ static void prune_state_files(const CBlockIndex* topIndex)
  * Indicates whether persistence is enabled and the state is stored.
  */
 bool IsPersistenceEnabled(int blockHeight) {
+    // disabled, e.g. to measure the processing of blocks only
+    if (!GetBoolArg("-omnipersist", true)) {
+        return false;
+    }
+
     // if too far away from the top -- do not write
     if (GetHeight() > (blockHeight + MAX_STATE_HISTORY)
             && (blockHeight % STORE_EVERY_N_BLOCK != 0)) {
@@ -581,7 +576,7 @@ int RestoreInMemoryState(const std::string& filename, int what, bool verifyHash)
             // memory leak ... gotta unallocate inner layers first....
             // TODO
             // ...
-            metadex.clear();
+            MetaDEx_CLEAR();
             inputLineFunc = input_mp_mdexorder_string;
             break;
 
@@ -5,6 +5,17 @@
 
 class CBlockIndex;
 
+/** Kinds of state files written for each persisted block. */
+enum FILETYPES {
+  FILETYPE_BALANCES = 0,
+  FILETYPE_OFFERS,
+  FILETYPE_ACCEPTS,
+  FILETYPE_GLOBALS,
+  FILETYPE_CROWDSALES,
+  FILETYPE_MDEXORDERS,
+  NUM_FILETYPES
+};
+
 /** Indicates whether persistence is enabled and the state is stored. */
 bool IsPersistenceEnabled(int blockHeight);
 
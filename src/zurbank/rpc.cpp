@@ -21,6 +21,8 @@
 #include "zurbank/notifications.h"
 #include "zurbank/zurbank.h"
 #include "zurbank/parsing.h"
+#include "zurbank/pending.h"
+#include "zurbank/perfstats.h"
 #include "zurbank/rpcrequirements.h"
 #include "zurbank/rpctx.h"
 #include "zurbank/rpctxobject.h"
@@ -42,6 +44,7 @@
 #include "main.h"
 #include "primitives/block.h"
 #include "primitives/transaction.h"
+#include "rpc/jsonstream.h"
 #include "rpc/server.h"
 #include "tinyformat.h"
 #include "txmempool.h"
@@ -54,10 +57,14 @@
 #include <univalue.h>
 
 #include <stdint.h>
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <tuple>
+#include <vector>
 
 using std::runtime_error;
 using namespace mastercore;
@@ -81,6 +88,8 @@ void PopulateFailure(int error)
             throw JSONRPCError(RPC_INTERNAL_ERROR, "Potential database corruption: Invalid transaction found");
         case MP_TX_IS_NOT_OMNI_PROTOCOL:
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No Zus Layer Protocol transaction");
+        case MP_TRADE_ARCHIVE_UNREADABLE:
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Potential database corruption: Archived trades can't be read");
     }
     throw JSONRPCError(RPC_INTERNAL_ERROR, "Generic transaction population failure");
 }
@@ -116,6 +125,29 @@ void MetaDexObjectToJSON(const CMPMetaDEx& obj, UniValue& metadex_obj)
     metadex_obj.push_back(Pair("blocktime", obj.getBlockTime()));
 }
 
+void MetaDexObjectToJSON(const CMPMetaDEx& obj, JSONStreamWriter& writer)
+{
+    bool propertyIdForSaleIsDivisible = isPropertyDivisible(obj.getProperty());
+    bool propertyIdDesiredIsDivisible = isPropertyDivisible(obj.getDesProperty());
+    // write data as JSON object
+    writer.BeginObject();
+    writer.Pair("address", obj.getAddr());
+    writer.Pair("txid", obj.getHash().GetHex());
+    if (obj.getAction() == 4) writer.Pair("ecosystem", isTestEcosystemProperty(obj.getProperty()) ? "test" : "main");
+    writer.Pair("propertyidforsale", (uint64_t) obj.getProperty());
+    writer.Pair("propertyidforsaleisdivisible", propertyIdForSaleIsDivisible);
+    writer.Pair("amountforsale", FormatMP(obj.getProperty(), obj.getAmountForSale()));
+    writer.Pair("amountremaining", FormatMP(obj.getProperty(), obj.getAmountRemaining()));
+    writer.Pair("propertyiddesired", (uint64_t) obj.getDesProperty());
+    writer.Pair("propertyiddesiredisdivisible", propertyIdDesiredIsDivisible);
+    writer.Pair("amountdesired", FormatMP(obj.getDesProperty(), obj.getAmountDesired()));
+    writer.Pair("amounttofill", FormatMP(obj.getDesProperty(), obj.getAmountToFill()));
+    writer.Pair("action", (int) obj.getAction());
+    writer.Pair("block", obj.getBlock());
+    writer.Pair("blocktime", obj.getBlockTime());
+    writer.EndObject();
+}
+
 void MetaDexObjectsToJSON(std::vector<CMPMetaDEx>& vMetaDexObjs, UniValue& response)
 {
     MetaDEx_compare compareByHeight;
@@ -151,6 +183,43 @@ bool BalanceToJSON(const std::string& address, uint32_t property, UniValue& bala
     return (nAvailable || nReserved || nFrozen);
 }
 
+/** The balances of an address, collected to be written after releasing the lock. */
+struct AddressBalance
+{
+    std::string address;
+    int64_t nAvailable;
+    int64_t nReserved;
+    int64_t nFrozen;
+};
+
+/** Writes the balance of an address as JSON object. */
+static void BalanceToJSON(const AddressBalance& balance, JSONStreamWriter& writer, bool divisible)
+{
+    writer.BeginObject();
+    writer.Pair("address", balance.address);
+    if (divisible) {
+        writer.Pair("balance", FormatDivisibleMP(balance.nAvailable));
+        writer.Pair("reserved", FormatDivisibleMP(balance.nReserved));
+        writer.Pair("frozen", FormatDivisibleMP(balance.nFrozen));
+    } else {
+        writer.Pair("balance", FormatIndivisibleMP(balance.nAvailable));
+        writer.Pair("reserved", FormatIndivisibleMP(balance.nReserved));
+        writer.Pair("frozen", FormatIndivisibleMP(balance.nFrozen));
+    }
+    writer.EndObject();
+}
+
+/** Parses optional count and skip parameters for paginated results. */
+static void ParsePagination(const UniValue& params, size_t nCountIndex, int64_t defaultCount, int64_t& nCount, int64_t& nSkip)
+{
+    nCount = defaultCount;
+    if (params.size() > nCountIndex) nCount = params[nCountIndex].get_int64();
+    if (nCount < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+    nSkip = 0;
+    if (params.size() > nCountIndex + 1) nSkip = params[nCountIndex + 1].get_int64();
+    if (nSkip < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative skip");
+}
+
 // Obtains details of a fee distribution
 UniValue zus_getfeedistribution(const UniValue& params, bool fHelp)
 {
@@ -746,18 +815,20 @@ UniValue mscrpc(const UniValue& params, bool fHelp)
 // display an MP balance via RPC
 UniValue zus_getbalance(const UniValue& params, bool fHelp)
 {
-    if (fHelp || params.size() != 2)
+    if (fHelp || params.size() < 2 || params.size() > 3)
         throw runtime_error(
-            "zus_getbalance \"address\" propertyid\n"
+            "zus_getbalance \"address\" propertyid ( includeunconfirmed )\n"
             "\nReturns the token balance for a given address and property.\n"
             "\nArguments:\n"
             "1. address              (string, required) the address\n"
             "2. propertyid           (number, required) the property identifier\n"
+            "3. includeunconfirmed   (boolean, optional) also return the change by simple sends in the mempool (default: false)\n"
             "\nResult:\n"
             "{\n"
             "  \"balance\" : \"n.nnnnnnnn\",   (string) the available balance of the address\n"
             "  \"reserved\" : \"n.nnnnnnnn\"   (string) the amount reserved by sell offers and accepts\n"
             "  \"frozen\" : \"n.nnnnnnnn\"     (string) the amount frozen by the issuer (applies to managed properties only)\n"
+            "  \"unconfirmed\" : \"n.nnnnnnnn\" (string) the net change by unconfirmed simple sends, which the confirmed balances of their senders cover, if requested\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("zus_getbalance", "\"UrpY6GsjF5WK33TzeiS8mQCPxzMdvbizp6\" 1")
@@ -766,25 +837,136 @@ UniValue zus_getbalance(const UniValue& params, bool fHelp)
 
     std::string address = ParseAddress(params[0]);
     uint32_t propertyId = ParsePropertyId(params[1]);
+    bool fIncludeUnconfirmed = (params.size() > 2) ? params[2].get_bool() : false;
 
     RequireExistingProperty(propertyId);
 
     UniValue balanceObj(UniValue::VOBJ);
     BalanceToJSON(address, propertyId, balanceObj, isPropertyDivisible(propertyId));
 
+    if (fIncludeUnconfirmed) {
+        // tracked when transactions enter the mempool, so no parsing is needed here
+        int64_t nUnconfirmed = GetUnconfirmedTokenDelta(address, propertyId);
+        balanceObj.push_back(Pair("unconfirmed", FormatMP(propertyId, nUnconfirmed, true)));
+    }
+
     return balanceObj;
 }
 
-UniValue zus_getallbalancesforid(const UniValue& params, bool fHelp)
+UniValue zus_getbalances(const UniValue& params, bool fHelp)
 {
-    if (fHelp || params.size() != 1)
+    if (fHelp || params.size() != 2)
         throw runtime_error(
-            "zus_getallbalancesforid propertyid\n"
+            "zus_getbalances [\"address\",...] [propertyid,...]\n"
+            "\nReturns the token balances for each combination of the given addresses and properties.\n"
+            "\nAll balances are taken from the same state, which is not updated in between.\n"
+            "\nArguments:\n"
+            "1. addresses            (array, required) the addresses\n"
+            "2. propertyids          (array, required) the property identifiers\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"block\" : nnnnnn,                  (number) the index of the last processed block\n"
+            "  \"addresses\" : [\"address\",...],     (array of strings) the addresses, in the order given\n"
+            "  \"propertyids\" : [n,...],           (array of numbers) the property identifiers, in the order given\n"
+            "  \"balance\" : [[\"n.nnnnnnnn\",...],...],   (array of arrays) the available balances, one row per address, one column per property\n"
+            "  \"reserved\" : [[\"n.nnnnnnnn\",...],...],  (array of arrays) the amounts reserved by sell offers and accepts\n"
+            "  \"frozen\" : [[\"n.nnnnnnnn\",...],...]     (array of arrays) the amounts frozen by the issuer\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("zus_getbalances", "\"[\\\"UrpY6GsjF5WK33TzeiS8mQCPxzMdvbizp6\\\"]\" \"[1,3]\"")
+            + HelpExampleRpc("zus_getbalances", "[\"UrpY6GsjF5WK33TzeiS8mQCPxzMdvbizp6\"], [1,3]")
+        );
+
+    const UniValue& addressParams = params[0].get_array();
+    const UniValue& propertyParams = params[1].get_array();
+
+    std::vector<std::string> vAddresses;
+    vAddresses.reserve(addressParams.size());
+    for (size_t i = 0; i < addressParams.size(); ++i) {
+        vAddresses.push_back(ParseAddress(addressParams[i]));
+    }
+
+    // obtain divisibility outside the loop to avoid repeatedly loading properties
+    std::vector<uint32_t> vPropertyIds;
+    std::vector<bool> vDivisible;
+    vPropertyIds.reserve(propertyParams.size());
+    vDivisible.reserve(propertyParams.size());
+    for (size_t i = 0; i < propertyParams.size(); ++i) {
+        uint32_t propertyId = ParsePropertyId(propertyParams[i]);
+        RequireExistingProperty(propertyId);
+        vPropertyIds.push_back(propertyId);
+        vDivisible.push_back(isPropertyDivisible(propertyId));
+    }
+
+    UniValue addresses(UniValue::VARR);
+    for (std::vector<std::string>::const_iterator it = vAddresses.begin(); it != vAddresses.end(); ++it) {
+        addresses.push_back(*it);
+    }
+    UniValue propertyIds(UniValue::VARR);
+    for (std::vector<uint32_t>::const_iterator it = vPropertyIds.begin(); it != vPropertyIds.end(); ++it) {
+        propertyIds.push_back((uint64_t) *it);
+    }
+
+    UniValue balances(UniValue::VARR);
+    UniValue reserved(UniValue::VARR);
+    UniValue frozen(UniValue::VARR);
+
+    // no block is processed in between, so all balances refer to the same block
+    LOCK2(cs_main, cs_tally);
+    int nBlock = GetHeight();
+
+    for (std::vector<std::string>::const_iterator itAddr = vAddresses.begin(); itAddr != vAddresses.end(); ++itAddr) {
+        UniValue balanceRow(UniValue::VARR);
+        UniValue reservedRow(UniValue::VARR);
+        UniValue frozenRow(UniValue::VARR);
+        for (size_t n = 0; n < vPropertyIds.size(); ++n) {
+            uint32_t propertyId = vPropertyIds[n];
+            int64_t nAvailable = GetAvailableTokenBalance(*itAddr, propertyId);
+            int64_t nReserved = GetReservedTokenBalance(*itAddr, propertyId);
+            int64_t nFrozen = GetFrozenTokenBalance(*itAddr, propertyId);
+            if (vDivisible[n]) {
+                balanceRow.push_back(FormatDivisibleMP(nAvailable));
+                reservedRow.push_back(FormatDivisibleMP(nReserved));
+                frozenRow.push_back(FormatDivisibleMP(nFrozen));
+            } else {
+                balanceRow.push_back(FormatIndivisibleMP(nAvailable));
+                reservedRow.push_back(FormatIndivisibleMP(nReserved));
+                frozenRow.push_back(FormatIndivisibleMP(nFrozen));
+            }
+        }
+        balances.push_back(balanceRow);
+        reserved.push_back(reservedRow);
+        frozen.push_back(frozenRow);
+    }
+
+    UniValue response(UniValue::VOBJ);
+    response.push_back(Pair("block", nBlock));
+    response.push_back(Pair("addresses", addresses));
+    response.push_back(Pair("propertyids", propertyIds));
+    response.push_back(Pair("balance", balances));
+    response.push_back(Pair("reserved", reserved));
+    response.push_back(Pair("frozen", frozen));
+
+    return response;
+}
+
+static bool CompareAddressPtr(const std::string* lhs, const std::string* rhs)
+{
+    return *lhs < *rhs;
+}
+
+static void zus_getallbalancesforid_stream(const UniValue& params, bool fHelp, JSONStreamWriter& writer)
+{
+    if (fHelp || params.size() < 1 || params.size() > 3)
+        throw runtime_error(
+            "zus_getallbalancesforid propertyid ( count skip )\n"
             "\nReturns a list of token balances for a given currency or property identifier.\n"
             "\nArguments:\n"
             "1. propertyid           (number, required) the property identifier\n"
+            "2. count                (number, optional) show at most n balances (default: all)\n"
+            "3. skip                 (number, optional) skip the first n balances (default: 0)\n"
             "\nResult:\n"
-            "[                           (array of JSON objects)\n"
+            "[                           (array of JSON objects, sorted by address)\n"
             "  {\n"
             "    \"address\" : \"address\",      (string) the address\n"
             "    \"balance\" : \"n.nnnnnnnn\",   (string) the available balance of the address\n"
@@ -799,38 +981,60 @@ UniValue zus_getallbalancesforid(const UniValue& params, bool fHelp)
         );
 
     uint32_t propertyId = ParsePropertyId(params[0]);
+    int64_t nCount = 0;
+    int64_t nSkip = 0;
+    ParsePagination(params, 1, std::numeric_limits<int64_t>::max(), nCount, nSkip);
 
     RequireExistingProperty(propertyId);
 
-    UniValue response(UniValue::VARR);
     bool isDivisible = isPropertyDivisible(propertyId); // we want to check this BEFORE the loop
 
-    LOCK(cs_tally);
+    // collect the balances of the page, since writing may wait for the client
+    std::vector<AddressBalance> vBalances;
+    {
+        LOCK(cs_tally);
 
-    for (std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-        uint32_t id = 0;
-        bool includeAddress = false;
-        std::string address = it->first;
-        (it->second).init();
-        while (0 != (id = (it->second).next())) {
-            if (id == propertyId) {
-                includeAddress = true;
-                break;
+        // collect addresses with records for the property, and sort them for stable pagination
+        std::vector<const std::string*> vAddresses;
+        for (std::unordered_map<std::string, CMPTally>::const_iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
+            for (int ttype = 0; ttype < TALLY_TYPE_COUNT; ++ttype) {
+                if ((it->second).getMoney(propertyId, (TallyType) ttype) != 0) {
+                    vAddresses.push_back(&(it->first));
+                    break;
+                }
             }
         }
-        if (!includeAddress) {
-            continue; // ignore this address, has never transacted in this propertyId
+        std::sort(vAddresses.begin(), vAddresses.end(), CompareAddressPtr);
+
+        for (std::vector<const std::string*>::const_iterator it = vAddresses.begin(); it != vAddresses.end() && nCount > 0; ++it) {
+            // confirmed balance minus unconfirmed, spent amounts
+            AddressBalance balance;
+            balance.nAvailable = GetAvailableTokenBalance(**it, propertyId);
+            balance.nReserved = GetReservedTokenBalance(**it, propertyId);
+            balance.nFrozen = GetFrozenTokenBalance(**it, propertyId);
+            if (!balance.nAvailable && !balance.nReserved && !balance.nFrozen) {
+                continue;
+            }
+            if (nSkip > 0) {
+                --nSkip;
+                continue;
+            }
+            balance.address = **it;
+            vBalances.push_back(balance);
+            --nCount;
         }
-        UniValue balanceObj(UniValue::VOBJ);
-        balanceObj.push_back(Pair("address", address));
-        bool nonEmptyBalance = BalanceToJSON(address, propertyId, balanceObj, isDivisible);
+    }
 
-        if (nonEmptyBalance) {
-            response.push_back(balanceObj);
-        }
+    writer.BeginArray();
+    for (std::vector<AddressBalance>::const_iterator it = vBalances.begin(); it != vBalances.end(); ++it) {
+        BalanceToJSON(*it, writer, isDivisible);
     }
+    writer.EndArray();
+}
 
-    return response;
+UniValue zus_getallbalancesforid(const UniValue& params, bool fHelp)
+{
+    return CallStreamingRPC(&zus_getallbalancesforid_stream, params, fHelp);
 }
 
 UniValue zus_getallbalancesforaddress(const UniValue& params, bool fHelp)
@@ -1518,15 +1722,22 @@ UniValue zus_getgrants(const UniValue& params, bool fHelp)
     return response;
 }
 
-UniValue zus_getorderbook(const UniValue& params, bool fHelp)
+static bool CompareMetaDExPtr(const CMPMetaDEx* lhs, const CMPMetaDEx* rhs)
 {
-    if (fHelp || params.size() < 1 || params.size() > 2)
+    return MetaDEx_compare()(*lhs, *rhs);
+}
+
+static void zus_getorderbook_stream(const UniValue& params, bool fHelp, JSONStreamWriter& writer)
+{
+    if (fHelp || params.size() < 1 || params.size() > 4)
         throw runtime_error(
-            "zus_getorderbook propertyid ( propertyid )\n"
+            "zus_getorderbook propertyid ( propertyid count skip )\n"
             "\nList active offers on the distributed token exchange.\n"
             "\nArguments:\n"
             "1. propertyid           (number, required) filter orders by property identifier for sale\n"
             "2. propertyid           (number, optional) filter orders by property identifier desired\n"
+            "3. count                (number, optional) show at most n orders (default: all)\n"
+            "4. skip                 (number, optional) skip the first n orders (default: 0)\n"
             "\nResult:\n"
             "[                                              (array of JSON objects)\n"
             "  {\n"
@@ -1555,6 +1766,9 @@ UniValue zus_getorderbook(const UniValue& params, bool fHelp)
     bool filterDesired = (params.size() > 1);
     uint32_t propertyIdForSale = ParsePropertyId(params[0]);
     uint32_t propertyIdDesired = 0;
+    int64_t nCount = 0;
+    int64_t nSkip = 0;
+    ParsePagination(params, 2, std::numeric_limits<int64_t>::max(), nCount, nSkip);
 
     RequireExistingProperty(propertyIdForSale);
 
@@ -1566,24 +1780,154 @@ UniValue zus_getorderbook(const UniValue& params, bool fHelp)
         RequireDifferentIds(propertyIdForSale, propertyIdDesired);
     }
 
-    std::vector<CMPMetaDEx> vecMetaDexObjects;
+    // copy the orders of the page, since writing may wait for the client
+    std::vector<CMPMetaDEx> vecPage;
     {
         LOCK(cs_tally);
-        for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-            const md_PricesMap& prices = my_it->second;
-            for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
+
+        // all orders for sale of a property are in the price map of that property
+        std::vector<const CMPMetaDEx*> vecMetaDexObjects;
+        const md_PricesMap* prices = get_Prices(propertyIdForSale);
+        if (prices != NULL) {
+            for (md_PricesMap::const_iterator it = prices->begin(); it != prices->end(); ++it) {
                 const md_Set& indexes = it->second;
                 for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
                     const CMPMetaDEx& obj = *it;
-                    if (obj.getProperty() != propertyIdForSale) continue;
-                    if (!filterDesired || obj.getDesProperty() == propertyIdDesired) vecMetaDexObjects.push_back(obj);
+                    if (!filterDesired || obj.getDesProperty() == propertyIdDesired) vecMetaDexObjects.push_back(&obj);
                 }
             }
         }
+
+        // sorts metadex objects based on block height and position in block
+        std::sort(vecMetaDexObjects.begin(), vecMetaDexObjects.end(), CompareMetaDExPtr);
+
+        for (std::vector<const CMPMetaDEx*>::const_iterator it = vecMetaDexObjects.begin(); it != vecMetaDexObjects.end() && nCount > 0; ++it) {
+            if (nSkip > 0) {
+                --nSkip;
+                continue;
+            }
+            vecPage.push_back(**it);
+            --nCount;
+        }
     }
 
-    UniValue response(UniValue::VARR);
-    MetaDexObjectsToJSON(vecMetaDexObjects, response);
+    writer.BeginArray();
+    for (std::vector<CMPMetaDEx>::const_iterator it = vecPage.begin(); it != vecPage.end(); ++it) {
+        MetaDexObjectToJSON(*it, writer);
+    }
+    writer.EndArray();
+}
+
+UniValue zus_getorderbook(const UniValue& params, bool fHelp)
+{
+    return CallStreamingRPC(&zus_getorderbook_stream, params, fHelp);
+}
+
+/** Formats a price of a pair, in units of propertyIdSideB per unit of propertyIdSideA, for display. */
+static std::string FormatPairPrice(const rational_t& price, bool fDivisibleSideA, bool fDivisibleSideB)
+{
+    rational_t displayPrice = price;
+    if (fDivisibleSideA && !fDivisibleSideB) displayPrice = displayPrice * COIN;
+    if (!fDivisibleSideA && fDivisibleSideB) displayPrice = displayPrice / COIN;
+    return xToString(displayPrice);
+}
+
+UniValue zus_getorderbookdepth(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() < 2 || params.size() > 3)
+        throw runtime_error(
+            "zus_getorderbookdepth propertyid propertyid ( levels )\n"
+            "\nReturns the aggregated depth of a market on the distributed token exchange.\n"
+            "\nAll prices are in units of the second property per unit of the first property.\n"
+            "\nArguments:\n"
+            "1. propertyid           (number, required) the first side of the market\n"
+            "2. propertyid           (number, required) the second side of the market\n"
+            "3. levels               (number, optional) show at most n price levels per side, 0 for all (default: 10)\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"propertyida\" : n,                 (number) the identifier of the first side of the market\n"
+            "  \"propertyidb\" : n,                 (number) the identifier of the second side of the market\n"
+            "  \"bestask\" : \"n.nnnnnnnnnnn...\",    (string) the lowest price of offers selling the first property (if any)\n"
+            "  \"bestbid\" : \"n.nnnnnnnnnnn...\",    (string) the highest price of offers buying the first property (if any)\n"
+            "  \"spread\" : \"n.nnnnnnnnnnn...\",     (string) the difference between best ask and best bid (if both exist)\n"
+            "  \"asks\" : [                        (array of JSON objects) offers selling the first property, lowest price first\n"
+            "    {\n"
+            "      \"unitprice\" : \"n.nnnnnnnnnnn...\", (string) the price of the level\n"
+            "      \"amount\" : \"n.nnnnnnnn\",          (string) the amount of the first property offered at this price\n"
+            "      \"total\" : \"n.nnnnnnnn\",           (string) the amount of the second property in exchange\n"
+            "      \"orders\" : n                      (number) the number of orders at this price\n"
+            "    },\n"
+            "    ...\n"
+            "  ],\n"
+            "  \"bids\" : [                        (array of JSON objects) offers buying the first property, highest price first\n"
+            "    ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("zus_getorderbookdepth", "1 3")
+            + HelpExampleRpc("zus_getorderbookdepth", "1, 3")
+        );
+
+    uint32_t propertyIdSideA = ParsePropertyId(params[0]);
+    uint32_t propertyIdSideB = ParsePropertyId(params[1]);
+    int64_t nLevels = 10;
+    if (params.size() > 2) nLevels = params[2].get_int64();
+    if (nLevels < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative levels");
+
+    RequireExistingProperty(propertyIdSideA);
+    RequireExistingProperty(propertyIdSideB);
+    RequireSameEcosystem(propertyIdSideA, propertyIdSideB);
+    RequireDifferentIds(propertyIdSideA, propertyIdSideB);
+
+    bool fDivisibleSideA = isPropertyDivisible(propertyIdSideA);
+    bool fDivisibleSideB = isPropertyDivisible(propertyIdSideB);
+
+    std::vector<CMPMetaDExLevel> vAsks;
+    std::vector<CMPMetaDExLevel> vBids;
+    rational_t bestAsk;
+    rational_t bestBid;
+    bool fSpread = false;
+    {
+        LOCK(cs_tally);
+        MetaDEx_getDepth(propertyIdSideA, propertyIdSideB, nLevels, vAsks);
+        MetaDEx_getDepth(propertyIdSideB, propertyIdSideA, nLevels, vBids);
+        fSpread = MetaDEx_getSpread(propertyIdSideA, propertyIdSideB, bestAsk, bestBid);
+    }
+
+    UniValue asks(UniValue::VARR);
+    for (std::vector<CMPMetaDExLevel>::const_iterator it = vAsks.begin(); it != vAsks.end(); ++it) {
+        UniValue level(UniValue::VOBJ);
+        level.push_back(Pair("unitprice", FormatPairPrice(it->price, fDivisibleSideA, fDivisibleSideB)));
+        level.push_back(Pair("amount", FormatMP(propertyIdSideA, it->getAmountForSale())));
+        level.push_back(Pair("total", FormatMP(propertyIdSideB, it->getAmountToFill())));
+        level.push_back(Pair("orders", (uint64_t) it->orders));
+        asks.push_back(level);
+    }
+
+    // bids are offers of the other side, so their prices are inverted
+    UniValue bids(UniValue::VARR);
+    for (std::vector<CMPMetaDExLevel>::const_iterator it = vBids.begin(); it != vBids.end(); ++it) {
+        rational_t price(it->price.denominator(), it->price.numerator());
+        UniValue level(UniValue::VOBJ);
+        level.push_back(Pair("unitprice", FormatPairPrice(price, fDivisibleSideA, fDivisibleSideB)));
+        level.push_back(Pair("amount", FormatMP(propertyIdSideA, it->getAmountToFill())));
+        level.push_back(Pair("total", FormatMP(propertyIdSideB, it->getAmountForSale())));
+        level.push_back(Pair("orders", (uint64_t) it->orders));
+        bids.push_back(level);
+    }
+
+    UniValue response(UniValue::VOBJ);
+    response.push_back(Pair("propertyida", (uint64_t) propertyIdSideA));
+    response.push_back(Pair("propertyidb", (uint64_t) propertyIdSideB));
+    if (!vAsks.empty()) response.push_back(Pair("bestask", FormatPairPrice(vAsks.front().price, fDivisibleSideA, fDivisibleSideB)));
+    if (!vBids.empty()) {
+        rational_t price(vBids.front().price.denominator(), vBids.front().price.numerator());
+        response.push_back(Pair("bestbid", FormatPairPrice(price, fDivisibleSideA, fDivisibleSideB)));
+    }
+    if (fSpread) response.push_back(Pair("spread", FormatPairPrice(bestAsk - bestBid, fDivisibleSideA, fDivisibleSideB)));
+    response.push_back(Pair("asks", asks));
+    response.push_back(Pair("bids", bids));
+
     return response;
 }
 
@@ -1661,6 +2005,8 @@ UniValue zus_gettradehistoryforaddress(const UniValue& params, bool fHelp)
     for(std::vector<uint256>::reverse_iterator it = vecTransactions.rbegin(); it != vecTransactions.rend(); ++it) {
         UniValue txobj(UniValue::VOBJ);
         int populateResult = populateRPCTransactionObject(*it, txobj, "", true);
+        // an incomplete history is not returned
+        if (MP_TRADE_ARCHIVE_UNREADABLE == populateResult) PopulateFailure(populateResult);
         if (0 == populateResult) {
             response.push_back(txobj);
             processed++;
@@ -1671,16 +2017,17 @@ UniValue zus_gettradehistoryforaddress(const UniValue& params, bool fHelp)
     return response;
 }
 
-UniValue zus_gettradehistoryforpair(const UniValue& params, bool fHelp)
+static void zus_gettradehistoryforpair_stream(const UniValue& params, bool fHelp, JSONStreamWriter& writer)
 {
-    if (fHelp || params.size() < 2 || params.size() > 3)
+    if (fHelp || params.size() < 2 || params.size() > 4)
         throw runtime_error(
-            "zus_gettradehistoryforpair propertyid propertyid ( count )\n"
+            "zus_gettradehistoryforpair propertyid propertyid ( count skip )\n"
             "\nRetrieves the history of trades on the distributed token exchange for the specified market.\n"
             "\nArguments:\n"
             "1. propertyid           (number, required) the first side of the traded pair\n"
             "2. propertyid           (number, required) the second side of the traded pair\n"
             "3. count                (number, optional) number of trades to retrieve (default: 10)\n"
+            "4. skip                 (number, optional) skip the n most recent trades (default: 0)\n"
             "\nResult:\n"
             "[                                      (array of JSON objects)\n"
             "  {\n"
@@ -1704,7 +2051,9 @@ UniValue zus_gettradehistoryforpair(const UniValue& params, bool fHelp)
     // obtain property identifiers for pair & check valid parameters
     uint32_t propertyIdSideA = ParsePropertyId(params[0]);
     uint32_t propertyIdSideB = ParsePropertyId(params[1]);
-    uint64_t count = (params.size() > 2) ? params[2].get_int64() : 10;
+    int64_t nCount = 0;
+    int64_t nSkip = 0;
+    ParsePagination(params, 2, 10, nCount, nSkip);
 
     RequireExistingProperty(propertyIdSideA);
     RequireExistingProperty(propertyIdSideB);
@@ -1712,9 +2061,163 @@ UniValue zus_gettradehistoryforpair(const UniValue& params, bool fHelp)
     RequireDifferentIds(propertyIdSideA, propertyIdSideB);
 
     // request pair trade history from trade db
+    std::vector<CMPMatchedTrade> vTrades;
+    {
+        LOCK(cs_tally);
+        if (!pDbTradeList->getRecentTradesForPair(propertyIdSideA, propertyIdSideB, nCount, nSkip, vTrades)) {
+            PopulateFailure(MP_TRADE_ARCHIVE_UNREADABLE);
+        }
+    }
+
+    // writing may wait for the client, so it's done without holding the lock
+    TradesForPairToJSON(propertyIdSideA, propertyIdSideB, vTrades, writer);
+}
+
+UniValue zus_gettradehistoryforpair(const UniValue& params, bool fHelp)
+{
+    return CallStreamingRPC(&zus_gettradehistoryforpair_stream, params, fHelp);
+}
+
+/** Aggregated trades of a period. */
+struct TradeCandle
+{
+    int64_t nTime;
+    int nFirstBlock;
+    int nLastBlock;
+    rational_t open;
+    rational_t high;
+    rational_t low;
+    rational_t close;
+    int64_t volume;
+    int64_t total;
+    int64_t nTrades;
+};
+
+static int64_t SaturatingAdd(int64_t a, int64_t b)
+{
+    return (a > std::numeric_limits<int64_t>::max() - b) ? std::numeric_limits<int64_t>::max() : a + b;
+}
+
+UniValue zus_gettradecandles(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() < 2 || params.size() > 5)
+        throw runtime_error(
+            "zus_gettradecandles propertyid propertyid ( interval startblock endblock )\n"
+            "\nReturns the trades on the distributed token exchange for the specified market, aggregated per period.\n"
+            "\nAll prices are in units of the second property per unit of the first property. Trades are assigned to periods by the time of their\n"
+            "blocks, which isn't strictly increasing, so a later block may belong to an earlier period. Within a period, the trades are ordered\n"
+            "by block, which determines the open and close prices.\n"
+            "\nArguments:\n"
+            "1. propertyid           (number, required) the first side of the traded pair\n"
+            "2. propertyid           (number, required) the second side of the traded pair\n"
+            "3. interval             (number, optional) the length of a period in seconds (default: 86400)\n"
+            "4. startblock           (number, optional) the first block to consider (default: 0)\n"
+            "5. endblock             (number, optional) the last block to consider (default: 999999999)\n"
+            "\nResult:\n"
+            "[                                      (array of JSON objects) the periods with trades, oldest first\n"
+            "  {\n"
+            "    \"time\" : nnnnnnnnnn,                   (number) the start of the period as Unix timestamp\n"
+            "    \"firstblock\" : nnnnnn,                 (number) the index of the block of the first trade, in block order\n"
+            "    \"lastblock\" : nnnnnn,                  (number) the index of the block of the last trade, in block order\n"
+            "    \"open\" : \"n.nnnnnnnnnnn...\",          (string) the unit price of the first trade, in block order\n"
+            "    \"high\" : \"n.nnnnnnnnnnn...\",          (string) the highest unit price\n"
+            "    \"low\" : \"n.nnnnnnnnnnn...\",           (string) the lowest unit price\n"
+            "    \"close\" : \"n.nnnnnnnnnnn...\",         (string) the unit price of the last trade, in block order\n"
+            "    \"volume\" : \"n.nnnnnnnn\",              (string) the amount of the first property traded\n"
+            "    \"total\" : \"n.nnnnnnnn\",               (string) the amount of the second property traded in exchange\n"
+            "    \"trades\" : n                          (number) the number of trades\n"
+            "  },\n"
+            "  ...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("zus_gettradecandles", "1 12 3600")
+            + HelpExampleRpc("zus_gettradecandles", "1, 12, 3600")
+        );
+
+    uint32_t propertyIdSideA = ParsePropertyId(params[0]);
+    uint32_t propertyIdSideB = ParsePropertyId(params[1]);
+    int64_t nInterval = 86400;
+    int nStartBlock = 0;
+    int nEndBlock = 999999999;
+    if (params.size() > 2) nInterval = params[2].get_int64();
+    if (params.size() > 3) nStartBlock = params[3].get_int();
+    if (params.size() > 4) nEndBlock = params[4].get_int();
+    if (nInterval <= 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Interval must be positive");
+    if (nStartBlock < 0 || nEndBlock < nStartBlock) throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid block range");
+
+    RequireExistingProperty(propertyIdSideA);
+    RequireExistingProperty(propertyIdSideB);
+    RequireSameEcosystem(propertyIdSideA, propertyIdSideB);
+    RequireDifferentIds(propertyIdSideA, propertyIdSideB);
+
+    bool fDivisibleSideA = isPropertyDivisible(propertyIdSideA);
+    bool fDivisibleSideB = isPropertyDivisible(propertyIdSideB);
+
+    // old trades are read from the trade archive, where only the needed columns are decoded
+    std::vector<CMPMatchedTrade> vTrades;
+    {
+        LOCK(cs_tally);
+        if (!pDbTradeList->getTradesForPair(propertyIdSideA, propertyIdSideB, nStartBlock, nEndBlock, vTrades)) {
+            PopulateFailure(MP_TRADE_ARCHIVE_UNREADABLE);
+        }
+    }
+
+    // block times are not monotonic, so the trades are bucketed by period, and visited in block order
+    std::map<int64_t, TradeCandle> mapCandles;
+    {
+        LOCK(cs_main);
+        for (std::vector<CMPMatchedTrade>::const_iterator it = vTrades.begin(); it != vTrades.end(); ++it) {
+            const CBlockIndex* pBlockIndex = chainActive[it->block];
+            if (pBlockIndex == NULL) continue;
+            int64_t nTime = pBlockIndex->GetBlockTime();
+            int64_t nPeriod = nTime - (nTime % nInterval);
+
+            int64_t amountSold = (it->prop1 == propertyIdSideA) ? it->amount1 : it->amount2;
+            int64_t amountReceived = (it->prop1 == propertyIdSideA) ? it->amount2 : it->amount1;
+            if (amountSold <= 0) continue;
+            rational_t price(amountReceived, amountSold);
+
+            std::map<int64_t, TradeCandle>::iterator itCandle = mapCandles.find(nPeriod);
+            if (itCandle == mapCandles.end()) {
+                TradeCandle candle;
+                candle.nTime = nPeriod;
+                candle.nFirstBlock = it->block;
+                candle.open = price;
+                candle.high = price;
+                candle.low = price;
+                candle.volume = 0;
+                candle.total = 0;
+                candle.nTrades = 0;
+                itCandle = mapCandles.insert(std::make_pair(nPeriod, candle)).first;
+            }
+            TradeCandle& candle = itCandle->second;
+            candle.nLastBlock = it->block;
+            if (price > candle.high) candle.high = price;
+            if (price < candle.low) candle.low = price;
+            candle.close = price;
+            candle.volume = SaturatingAdd(candle.volume, amountSold);
+            candle.total = SaturatingAdd(candle.total, amountReceived);
+            ++candle.nTrades;
+        }
+    }
+
     UniValue response(UniValue::VARR);
-    LOCK(cs_tally);
-    pDbTradeList->getTradesForPair(propertyIdSideA, propertyIdSideB, response, count);
+    for (std::map<int64_t, TradeCandle>::const_iterator it = mapCandles.begin(); it != mapCandles.end(); ++it) {
+        const TradeCandle& period = it->second;
+        UniValue candle(UniValue::VOBJ);
+        candle.push_back(Pair("time", period.nTime));
+        candle.push_back(Pair("firstblock", period.nFirstBlock));
+        candle.push_back(Pair("lastblock", period.nLastBlock));
+        candle.push_back(Pair("open", FormatPairPrice(period.open, fDivisibleSideA, fDivisibleSideB)));
+        candle.push_back(Pair("high", FormatPairPrice(period.high, fDivisibleSideA, fDivisibleSideB)));
+        candle.push_back(Pair("low", FormatPairPrice(period.low, fDivisibleSideA, fDivisibleSideB)));
+        candle.push_back(Pair("close", FormatPairPrice(period.close, fDivisibleSideA, fDivisibleSideB)));
+        candle.push_back(Pair("volume", FormatMP(propertyIdSideA, period.volume)));
+        candle.push_back(Pair("total", FormatMP(propertyIdSideB, period.total)));
+        candle.push_back(Pair("trades", period.nTrades));
+        response.push_back(candle);
+    }
+
     return response;
 }
 
@@ -1970,7 +2473,7 @@ UniValue zus_gettransaction(const UniValue& params, bool fHelp)
     return txobj;
 }
 
-UniValue zus_listtransactions(const UniValue& params, bool fHelp)
+static void zus_listtransactions_stream(const UniValue& params, bool fHelp, JSONStreamWriter& writer)
 {
     if (fHelp || params.size() > 5)
         throw runtime_error(
@@ -2027,21 +2530,25 @@ UniValue zus_listtransactions(const UniValue& params, bool fHelp)
     std::map<std::string,uint256> walletTransactions = FetchWalletOmniTransactions(nFrom+nCount, nStartBlock, nEndBlock);
 
     // reverse iterate over (now ordered) transactions and populate RPC objects for each one
-    UniValue response(UniValue::VARR);
+    writer.BeginArray();
     for (std::map<std::string,uint256>::reverse_iterator it = walletTransactions.rbegin(); it != walletTransactions.rend(); it++) {
         if (nFrom <= 0 && nCount > 0) {
             uint256 txHash = it->second;
             UniValue txobj(UniValue::VOBJ);
             int populateResult = populateRPCTransactionObject(txHash, txobj, addressParam);
             if (0 == populateResult) {
-                response.push_back(txobj);
+                writer.Value(txobj);
                 nCount--;
             }
         }
         nFrom--;
     }
+    writer.EndArray();
+}
 
-    return response;
+UniValue zus_listtransactions(const UniValue& params, bool fHelp)
+{
+    return CallStreamingRPC(&zus_listtransactions_stream, params, fHelp);
 }
 
 UniValue zus_listpendingtransactions(const UniValue& params, bool fHelp)
@@ -2352,6 +2859,134 @@ UniValue zus_gettrade(const UniValue& params, bool fHelp)
     return txobj;
 }
 
+static UniValue PerfHistogramToJSON(const CPerfHistogram& histogram)
+{
+    UniValue response(UniValue::VOBJ);
+    response.push_back(Pair("count", (uint64_t) histogram.nCount));
+    response.push_back(Pair("totalmicros", histogram.nTotalMicros));
+    response.push_back(Pair("avgmicros", histogram.nCount ? histogram.nTotalMicros / (int64_t) histogram.nCount : 0));
+    response.push_back(Pair("maxmicros", histogram.nMaxMicros));
+
+    UniValue buckets(UniValue::VARR);
+    for (int n = 0; n < CPerfHistogram::NUM_BUCKETS; ++n) {
+        if (histogram.vBuckets[n] == 0) continue;
+        UniValue bucket(UniValue::VOBJ);
+        if (n < CPerfHistogram::NUM_BUCKETS - 1) {
+            bucket.push_back(Pair("below", CPerfHistogram::GetBucketLimit(n)));
+        } else {
+            bucket.push_back(Pair("below", NullUniValue));
+        }
+        bucket.push_back(Pair("count", (uint64_t) histogram.vBuckets[n]));
+        buckets.push_back(bucket);
+    }
+    response.push_back(Pair("histogram", buckets));
+
+    return response;
+}
+
+UniValue zus_getperfstats(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() > 1)
+        throw runtime_error(
+            "zus_getperfstats ( reset )\n"
+            "\nReturns timing statistics of the Zus transaction processing and the database counters.\n"
+            "\nArguments:\n"
+            "1. reset                (boolean, optional) reset the timing statistics after returning them (default: false)\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"stages\" : [                    (array of JSON objects) the processing stages\n"
+            "    {\n"
+            "      \"stage\" : \"name\",              (string) the name of the stage\n"
+            "      \"count\" : n,                   (number) the number of times the stage was processed\n"
+            "      \"totalmicros\" : n,             (number) the total time spent in microseconds\n"
+            "      \"avgmicros\" : n,               (number) the average time spent in microseconds\n"
+            "      \"maxmicros\" : n,               (number) the longest time spent in microseconds\n"
+            "      \"histogram\" : [                (array of JSON objects) the non-empty buckets of the distribution\n"
+            "        {\n"
+            "          \"below\" : n,                 (number) the upper bound in microseconds, null for the last bucket\n"
+            "          \"count\" : n                  (number) the number of durations in this bucket\n"
+            "        },\n"
+            "        ...\n"
+            "      ]\n"
+            "    },\n"
+            "    ...\n"
+            "  ],\n"
+            "  \"txtypes\" : [                   (array of JSON objects) the transaction logic by transaction type\n"
+            "    {\n"
+            "      \"type_int\" : n,                (number) the transaction type as number\n"
+            "      \"type\" : \"type\",               (string) the transaction type as string\n"
+            "      ...                            the same statistics as for stages\n"
+            "    },\n"
+            "    ...\n"
+            "  ],\n"
+            "  \"databases\" : [                 (array of JSON objects) the database counters since startup\n"
+            "    {\n"
+            "      \"name\" : \"name\",               (string) the name of the database\n"
+            "      \"lookups\" : n,                 (number) the number of point lookups\n"
+            "      \"lookupmisses\" : n,            (number) the number of lookups of missing entries\n"
+            "      \"lookupmicros\" : n,            (number) the total time spent in lookups in microseconds\n"
+            "      \"writes\" : n,                  (number) the number of writes to the database, a block counts once\n"
+            "      \"writemicros\" : n              (number) the total time spent in writes in microseconds\n"
+            "    },\n"
+            "    ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("zus_getperfstats", "")
+            + HelpExampleRpc("zus_getperfstats", "")
+        );
+
+    bool fReset = false;
+    if (params.size() > 0) {
+        fReset = params[0].get_bool();
+    }
+
+    std::map<int, CPerfHistogram> mapStages;
+    std::map<uint16_t, CPerfHistogram> mapTxTypes;
+    GetPerfStats(mapStages, mapTxTypes);
+    if (fReset) {
+        ResetPerfStats();
+    }
+
+    UniValue stages(UniValue::VARR);
+    for (std::map<int, CPerfHistogram>::const_iterator it = mapStages.begin(); it != mapStages.end(); ++it) {
+        UniValue stage(UniValue::VOBJ);
+        stage.push_back(Pair("stage", GetPerfStageName(it->first)));
+        stage.pushKVs(PerfHistogramToJSON(it->second));
+        stages.push_back(stage);
+    }
+
+    UniValue txTypes(UniValue::VARR);
+    for (std::map<uint16_t, CPerfHistogram>::const_iterator it = mapTxTypes.begin(); it != mapTxTypes.end(); ++it) {
+        UniValue txType(UniValue::VOBJ);
+        txType.push_back(Pair("type_int", (uint64_t) it->first));
+        txType.push_back(Pair("type", strTransactionType(it->first)));
+        txType.pushKVs(PerfHistogramToJSON(it->second));
+        txTypes.push_back(txType);
+    }
+
+    std::vector<CPerfDBStats> vDBStats;
+    GetPerfDBStats(vDBStats);
+    UniValue databases(UniValue::VARR);
+    for (std::vector<CPerfDBStats>::const_iterator it = vDBStats.begin(); it != vDBStats.end(); ++it) {
+        UniValue database(UniValue::VOBJ);
+        database.push_back(Pair("name", it->name));
+        database.push_back(Pair("lookups", it->nLookups));
+        database.push_back(Pair("lookupmisses", it->nLookupMisses));
+        database.push_back(Pair("lookupmicros", it->nLookupMicros));
+        database.push_back(Pair("writes", it->nWrites));
+        database.push_back(Pair("writemicros", it->nWriteMicros));
+        databases.push_back(database);
+    }
+
+    UniValue response(UniValue::VOBJ);
+    response.push_back(Pair("stages", stages));
+    response.push_back(Pair("txtypes", txTypes));
+    response.push_back(Pair("databases", databases));
+
+    return response;
+}
+
 UniValue zus_getcurrentconsensushash(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() != 0)
@@ -2477,8 +3112,9 @@ static const CRPCCommand commands[] =
   //  ------------------------------------ ------------------------------- ------------------------------ ----------
     { "omni layer (data retrieval)", "zus_getinfo",                   &zus_getinfo,                    true  },
     { "omni layer (data retrieval)", "zus_getactivations",            &zus_getactivations,             true  },
-    { "omni layer (data retrieval)", "zus_getallbalancesforid",       &zus_getallbalancesforid,        false },
+    { "omni layer (data retrieval)", "zus_getallbalancesforid",       &zus_getallbalancesforid,        false, &zus_getallbalancesforid_stream },
     { "omni layer (data retrieval)", "zus_getbalance",                &zus_getbalance,                 false },
+    { "omni layer (data retrieval)", "zus_getbalances",               &zus_getbalances,                false },
     { "omni layer (data retrieval)", "zus_gettransaction",            &zus_gettransaction,             false },
     { "omni layer (data retrieval)", "zus_getproperty",               &zus_getproperty,                false },
     { "omni layer (data retrieval)", "zus_listproperties",            &zus_listproperties,             false },
@@ -2486,7 +3122,8 @@ static const CRPCCommand commands[] =
     { "omni layer (data retrieval)", "zus_getgrants",                 &zus_getgrants,                  false },
     { "omni layer (data retrieval)", "zus_getactivedexsells",         &zus_getactivedexsells,          false },
     { "omni layer (data retrieval)", "zus_getactivecrowdsales",       &zus_getactivecrowdsales,        false },
-    { "omni layer (data retrieval)", "zus_getorderbook",              &zus_getorderbook,               false },
+    { "omni layer (data retrieval)", "zus_getorderbook",              &zus_getorderbook,               false, &zus_getorderbook_stream },
+    { "omni layer (data retrieval)", "zus_getorderbookdepth",         &zus_getorderbookdepth,          false },
     { "omni layer (data retrieval)", "zus_gettrade",                  &zus_gettrade,                   false },
     { "omni layer (data retrieval)", "zus_getsto",                    &zus_getsto,                     false },
     { "omni layer (data retrieval)", "zus_listblocktransactions",     &zus_listblocktransactions,      false },
@@ -2494,8 +3131,10 @@ static const CRPCCommand commands[] =
     { "omni layer (data retrieval)", "zus_listpendingtransactions",   &zus_listpendingtransactions,    false },
     { "omni layer (data retrieval)", "zus_getallbalancesforaddress",  &zus_getallbalancesforaddress,   false },
     { "omni layer (data retrieval)", "zus_gettradehistoryforaddress", &zus_gettradehistoryforaddress,  false },
-    { "omni layer (data retrieval)", "zus_gettradehistoryforpair",    &zus_gettradehistoryforpair,     false },
+    { "omni layer (data retrieval)", "zus_gettradehistoryforpair",    &zus_gettradehistoryforpair,     false, &zus_gettradehistoryforpair_stream },
+    { "omni layer (data retrieval)", "zus_gettradecandles",           &zus_gettradecandles,            false },
     { "omni layer (data retrieval)", "zus_getcurrentconsensushash",   &zus_getcurrentconsensushash,    false },
+    { "omni layer (data retrieval)", "zus_getperfstats",              &zus_getperfstats,               true  },
     { "omni layer (data retrieval)", "zus_getpayload",                &zus_getpayload,                 false },
     { "omni layer (data retrieval)", "zus_getseedblocks",             &zus_getseedblocks,              false },
     { "omni layer (data retrieval)", "zus_getmetadexhash",            &zus_getmetadexhash,             false },
@@ -2505,7 +3144,7 @@ static const CRPCCommand commands[] =
     { "omni layer (data retrieval)", "zus_getfeedistributions",       &zus_getfeedistributions,        false },
     { "omni layer (data retrieval)", "zus_getbalanceshash",           &zus_getbalanceshash,            false },
 #ifdef ENABLE_WALLET
-    { "omni layer (data retrieval)", "zus_listtransactions",          &zus_listtransactions,           false },
+    { "omni layer (data retrieval)", "zus_listtransactions",          &zus_listtransactions,           false, &zus_listtransactions_stream },
     { "omni layer (data retrieval)", "zus_getfeeshare",               &zus_getfeeshare,                false },
     { "omni layer (configuration)",  "zus_setautocommit",             &zus_setautocommit,              true  },
     { "omni layer (data retrieval)", "zus_getwalletbalances",         &zus_getwalletbalances,          false },
@@ -93,11 +93,11 @@ UniValue zus_decodetransaction(const UniValue& params, bool fHelp)
     {
         LOCK2(cs_main, cs_tx_cache);
         // temporarily switch global coins view cache for transaction inputs
-        std::swap(view, viewTemp);
+        view.Swap(viewTemp);
         // then get the results
         populateResult = populateRPCTransactionObject(tx, uint256(), txObj, "", false, "", blockHeight);
         // and restore the original, unpolluted coins view cache
-        std::swap(viewTemp, view);
+        view.Swap(viewTemp);
     }
 
     if (populateResult != 0) PopulateFailure(populateResult);
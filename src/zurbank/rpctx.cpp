@@ -28,8 +28,12 @@
 #include <univalue.h>
 
 #include <stdint.h>
+#include <limits>
+#include <map>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 using std::runtime_error;
 using namespace mastercore;
@@ -281,6 +285,117 @@ UniValue zus_sendall(const UniValue& params, bool fHelp)
     }
 }
 
+UniValue zus_sendmany(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 1)
+        throw runtime_error(
+            "zus_sendmany [{\"fromaddress\":\"address\",\"toaddress\":\"address\",\"propertyid\":n,\"amount\":\"n.nnnnnnnn\"},...]\n"
+
+            "\nCreate and broadcast several simple send transactions in one pass.\n"
+
+            "\nThe transactions are created in the given order, and a sender may spend the change of its earlier transactions.\n"
+            "If -autocommit is disabled, the transactions are not sent, and their inputs stay available to other transactions.\n"
+
+            "\nArguments:\n"
+            "1. sends                (array, required) the sends to create\n"
+            "     [\n"
+            "       {\n"
+            "         \"fromaddress\":\"address\",  (string, required) the address to send from\n"
+            "         \"toaddress\":\"address\",    (string, required) the address of the receiver\n"
+            "         \"propertyid\":n,             (number, required) the identifier of the tokens to send\n"
+            "         \"amount\":\"n.nnnnnnnn\"      (string, required) the amount to send\n"
+            "       }\n"
+            "       ,...\n"
+            "     ]\n"
+
+            "\nResult:\n"
+            "[                       (array of JSON objects) one object per send, in the given order\n"
+            "  {\n"
+            "    \"txid\" : \"hash\",        (string) the hex-encoded transaction hash, if the transaction was sent\n"
+            "    \"hex\" : \"rawtx\",         (string) the hex-encoded raw transaction instead, if -autocommit is disabled\n"
+            "    \"error\" : \"message\"     (string) the reason, if the transaction could not be created or sent\n"
+            "  },\n"
+            "  ...\n"
+            "]\n"
+
+            "\nExamples:\n"
+            + HelpExampleCli("zus_sendmany", "\"[{\\\"fromaddress\\\":\\\"3M9qvHKtgARhqcMtM5cRT9VaiDJ5PSfQGY\\\",\\\"toaddress\\\":\\\"37FaKponF7zqoMLUjEiko25pDiuVH5YLEa\\\",\\\"propertyid\\\":1,\\\"amount\\\":\\\"100.0\\\"}]\"")
+            + HelpExampleRpc("zus_sendmany", "[{\"fromaddress\":\"3M9qvHKtgARhqcMtM5cRT9VaiDJ5PSfQGY\",\"toaddress\":\"37FaKponF7zqoMLUjEiko25pDiuVH5YLEa\",\"propertyid\":1,\"amount\":\"100.0\"}]")
+        );
+
+    // obtain parameters & info
+    const UniValue& sends = params[0].get_array();
+    if (sends.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "No sends specified");
+    }
+
+    std::vector<CWalletTxRequest> requests;
+    std::vector<std::pair<uint256, CMPPending> > vPending;
+    std::map<std::pair<std::string, uint32_t>, int64_t> totals;
+    requests.reserve(sends.size());
+
+    for (size_t i = 0; i < sends.size(); ++i) {
+        if (!sends[i].isObject()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Expected object with {\"fromaddress\",\"toaddress\",\"propertyid\",\"amount\"}");
+        }
+        const UniValue& send = sends[i].get_obj();
+        std::string fromAddress = ParseAddress(find_value(send, "fromaddress"));
+        std::string toAddress = ParseAddress(find_value(send, "toaddress"));
+        uint32_t propertyId = ParsePropertyId(find_value(send, "propertyid"));
+
+        // perform checks
+        RequireExistingProperty(propertyId);
+        int64_t amount = ParseAmount(find_value(send, "amount"), isPropertyDivisible(propertyId));
+
+        // the balance must cover all sends of the sender
+        int64_t& total = totals[std::make_pair(fromAddress, propertyId)];
+        if (total > std::numeric_limits<int64_t>::max() - amount) {
+            throw JSONRPCError(RPC_TYPE_ERROR, "Sender has insufficient balance");
+        }
+        total += amount;
+        RequireBalance(fromAddress, propertyId, total);
+
+        CWalletTxRequest request;
+        request.senderAddress = fromAddress;
+        request.receiverAddress = toAddress;
+        request.payload = CreatePayload_SimpleSend(propertyId, amount);
+        requests.push_back(request);
+
+        CMPPending pending;
+        pending.src = fromAddress;
+        pending.prop = propertyId;
+        pending.amount = amount;
+        pending.type = MSC_TYPE_SIMPLE_SEND;
+        vPending.push_back(std::make_pair(uint256(), pending));
+    }
+
+    // request the wallet build the transactions (and if needed commit them)
+    WalletTxBuilder(requests, autoCommit);
+
+    // return the txids (or raw hex depending on autocommit) and errors
+    UniValue response(UniValue::VARR);
+    std::vector<std::pair<uint256, CMPPending> > vSent;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const CWalletTxRequest& request = requests[i];
+        UniValue result(UniValue::VOBJ);
+        if (request.result != 0) {
+            result.push_back(Pair("error", error_str(request.result)));
+        } else if (!autoCommit) {
+            result.push_back(Pair("hex", request.rawTx));
+        } else {
+            result.push_back(Pair("txid", request.txid.GetHex()));
+            vPending[i].first = request.txid;
+            vSent.push_back(vPending[i]);
+        }
+        response.push_back(result);
+    }
+    if (!vSent.empty()) {
+        PendingAdd(vSent);
+    }
+
+    return response;
+}
+
 UniValue zus_senddexsell(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() != 7)
@@ -1538,6 +1653,7 @@ static const CRPCCommand commands[] =
 #ifdef ENABLE_WALLET
     { "omni layer (transaction creation)", "zus_sendrawtx",               &zus_sendrawtx,               false },
     { "omni layer (transaction creation)", "zus_send",                    &zus_send,                    false },
+    { "omni layer (transaction creation)", "zus_sendmany",                &zus_sendmany,                false },
     { "omni layer (transaction creation)", "zus_senddexsell",             &zus_senddexsell,             false },
     { "omni layer (transaction creation)", "zus_senddexaccept",           &zus_senddexaccept,           false },
     { "omni layer (transaction creation)", "zus_sendissuancecrowdsale",   &zus_sendissuancecrowdsale,   false },
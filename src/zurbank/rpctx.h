@@ -5,6 +5,7 @@
 
 UniValue zus_sendrawtx(const UniValue& params, bool fHelp);
 UniValue zus_send(const UniValue& params, bool fHelp);
+UniValue zus_sendmany(const UniValue& params, bool fHelp);
 UniValue zus_sendall(const UniValue& params, bool fHelp);
 UniValue zus_senddexsell(const UniValue& params, bool fHelp);
 UniValue zus_senddexaccept(const UniValue& params, bool fHelp);
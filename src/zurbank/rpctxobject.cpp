@@ -37,11 +37,151 @@
 
 #include <stdint.h>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Namespaces
 using namespace mastercore;
 
+/** The maximum number of rendered transactions kept for RPC lookups */
+static const size_t MAX_RPC_TX_CACHE_SIZE = 10000;
+
+//! Rendered transactions for RPC lookups
+static CRPCTransactionCache rpcTxCache(MAX_RPC_TX_CACHE_SIZE);
+
+uint64_t CRPCTransactionCache::GetGeneration() const
+{
+    LOCK(cs_cache);
+    return nGeneration;
+}
+
+bool CRPCTransactionCache::Get(const uint256& txid, CRenderedTransaction& rendered)
+{
+    LOCK(cs_cache);
+    CacheMap::iterator it = mapCache.find(txid);
+    if (it == mapCache.end()) return false;
+    listOrder.splice(listOrder.end(), listOrder, it->second.second);
+    rendered = it->second.first;
+    return true;
+}
+
+void CRPCTransactionCache::Add(const uint256& txid, const CRenderedTransaction& rendered, uint64_t nGenerationIn)
+{
+    LOCK(cs_cache);
+    if (nGenerationIn != nGeneration || mapCache.count(txid)) return;
+    if (mapCache.size() >= nMaxSize) {
+        mapCache.erase(listOrder.front());
+        listOrder.pop_front();
+    }
+    CacheOrder::iterator itOrder = listOrder.insert(listOrder.end(), txid);
+    mapCache.insert(std::make_pair(txid, std::make_pair(rendered, itOrder)));
+}
+
+void CRPCTransactionCache::Clear()
+{
+    LOCK(cs_cache);
+    mapCache.clear();
+    listOrder.clear();
+    ++nGeneration;
+}
+
+size_t CRPCTransactionCache::Size() const
+{
+    LOCK(cs_cache);
+    return mapCache.size();
+}
+
+/**
+ * Drops all rendered transactions, which is needed when blocks are disconnected.
+ */
+void ClearRPCTransactionCache()
+{
+    rpcTxCache.Clear();
+}
+
+/**
+ * Copies a rendered transaction, and fills in the fields that change over time.
+ */
+static void populateRPCCachedTransaction(const CRenderedTransaction& rendered, UniValue& txobj)
+{
+    int confirmations = 1 + GetHeight() - rendered.block;
+    bool fMine = IsMyAddress(rendered.sender) || IsMyAddress(rendered.reference);
+
+    const std::vector<std::string> keys = rendered.txobj.getKeys();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == "ismine") {
+            txobj.push_back(Pair(keys[i], fMine));
+        } else if (keys[i] == "confirmations") {
+            txobj.push_back(Pair(keys[i], confirmations));
+        } else {
+            txobj.push_back(Pair(keys[i], rendered.txobj[i]));
+        }
+    }
+}
+
+/**
+ * Populates the object of a parsed Zus transaction.
+ *
+ * The validity and position in the block are taken from the decoded fields,
+ * if available, or looked up otherwise.
+ */
+static int populateRPCOmniTransaction(CMPTransaction& mp_obj, const CDecodedTransaction* pDecoded, const uint256& blockHash, int blockHeight, int64_t blockTime, int confirmations, UniValue& txobj, bool extendedDetails, const std::string& extendedDetailsFilter)
+{
+    const uint256& txid = mp_obj.getHash();
+
+    // obtain validity - only confirmed transactions can be valid
+    bool valid = false;
+    int positionInBlock = 0;
+    if (confirmations > 0) {
+        if (pDecoded) {
+            valid = pDecoded->isValid();
+            positionInBlock = pDecoded->posInBlock;
+        } else {
+            LOCK(cs_tally);
+            valid = pDbTransactionList->getValidMPTX(txid);
+            positionInBlock = pDbTransaction->FetchTransactionPosition(txid);
+        }
+    }
+
+    // populate some initial info for the transaction
+    bool fMine = false;
+    if (IsMyAddress(mp_obj.getSender()) || IsMyAddress(mp_obj.getReceiver())) fMine = true;
+    txobj.push_back(Pair("txid", txid.GetHex()));
+    txobj.push_back(Pair("fee", FormatDivisibleMP(mp_obj.getFeePaid())));
+    txobj.push_back(Pair("sendingaddress", mp_obj.getSender()));
+    if (showRefForTx(mp_obj.getType())) txobj.push_back(Pair("referenceaddress", mp_obj.getReceiver()));
+    txobj.push_back(Pair("ismine", fMine));
+    txobj.push_back(Pair("version", (uint64_t)mp_obj.getVersion()));
+    txobj.push_back(Pair("type_int", (uint64_t)mp_obj.getType()));
+    if (mp_obj.getType() != MSC_TYPE_SIMPLE_SEND) { // Type 0 will add "Type" attribute during populateRPCTypeSimpleSend
+        txobj.push_back(Pair("type", mp_obj.getTypeString()));
+    }
+
+    // populate type specific info and extended details if requested
+    // extended details are not available for unconfirmed transactions
+    if (confirmations <= 0) extendedDetails = false;
+    int rc = populateRPCTypeInfo(mp_obj, txobj, mp_obj.getType(), extendedDetails, extendedDetailsFilter, confirmations);
+    if (rc != 0) return rc;
+
+    // state and chain related information
+    if (confirmations != 0 && !blockHash.IsNull()) {
+        txobj.push_back(Pair("valid", valid));
+        if (!valid) {
+            txobj.push_back(Pair("invalidreason", pDecoded ? error_str(pDecoded->processingResult) : pDbTransaction->FetchInvalidReason(txid)));
+        }
+        txobj.push_back(Pair("blockhash", blockHash.GetHex()));
+        txobj.push_back(Pair("blocktime", blockTime));
+        txobj.push_back(Pair("positioninblock", positionInBlock));
+    }
+    if (confirmations != 0) {
+        txobj.push_back(Pair("block", blockHeight));
+    }
+    txobj.push_back(Pair("confirmations", confirmations));
+
+    // finished
+    return 0;
+}
+
 /**
  * Function to standardize RPC output for transactions into a JSON object in either basic or extended mode.
  *
@@ -49,24 +189,78 @@ using namespace mastercore;
  * Use extended mode for transaction specific calls (e.g. zus_getsto, zus_gettrade etc.)
  *
  * DEx payments and the extended mode are only available for confirmed transactions.
+ *
+ * Confirmed transactions are described by the fields decoded when they were processed,
+ * and their objects in basic mode are cached, so they are not parsed again.
  */
 int populateRPCTransactionObject(const uint256& txid, UniValue& txobj, std::string filterAddress, bool extendedDetails, std::string extendedDetailsFilter)
 {
-    // retrieve the transaction from the blockchain and obtain it's height/confs/time
-    CTransaction tx;
-    uint256 blockHash;
-    if (!GetTransaction(txid, tx, Params().GetConsensus(), blockHash, true)) {
-        return MP_TX_NOT_FOUND;
+    if (!extendedDetails) {
+        CRenderedTransaction rendered;
+        if (rpcTxCache.Get(txid, rendered)) {
+            if (!filterAddress.empty() && rendered.sender != filterAddress && rendered.reference != filterAddress) return -1;
+            populateRPCCachedTransaction(rendered, txobj);
+            return 0;
+        }
+    }
+    uint64_t nGeneration = rpcTxCache.GetGeneration();
+
+    // look for the decoded fields of a transaction in the active chain
+    CDecodedTransaction decoded;
+    bool fDecoded = false;
+    {
+        LOCK(cs_tally);
+        fDecoded = pDbTransaction->FetchDecodedTransaction(txid, decoded);
+    }
+    CBlockIndex* pBlockIndex = NULL;
+    int blockHeight = 0;
+    if (fDecoded) {
+        LOCK(cs_main);
+        pBlockIndex = GetBlockIndex(decoded.blockHash);
+        if (pBlockIndex != NULL && !chainActive.Contains(pBlockIndex)) pBlockIndex = NULL;
+        blockHeight = GetHeight();
+    }
+
+    if (pBlockIndex == NULL) {
+        // retrieve the transaction from the blockchain and obtain it's height/confs/time
+        CTransaction tx;
+        uint256 blockHash;
+        if (!GetTransaction(txid, tx, Params().GetConsensus(), blockHash, true)) {
+            return MP_TX_NOT_FOUND;
+        }
+
+        return populateRPCTransactionObject(tx, blockHash, txobj, filterAddress, extendedDetails, extendedDetailsFilter);
+    }
+
+    // check if we're filtering from listtransactions_MP, and if so whether we have a non-match we want to skip
+    if (!filterAddress.empty() && decoded.sender != filterAddress && decoded.reference != filterAddress) return -1;
+
+    // rebuild the transaction from the decoded fields
+    CMPTransaction mp_obj;
+    mp_obj.Set(decoded.sender, decoded.reference, 0, txid, pBlockIndex->nHeight, decoded.posInBlock,
+            decoded.payload.data(), decoded.payload.size(), decoded.encodingClass, decoded.fee);
+    mp_obj.Set(txid, pBlockIndex->nHeight, decoded.posInBlock, pBlockIndex->GetBlockTime());
+    if (!mp_obj.interpret_Transaction()) return MP_TX_IS_NOT_OMNI_PROTOCOL;
+
+    int confirmations = 1 + blockHeight - pBlockIndex->nHeight;
+    int rc = populateRPCOmniTransaction(mp_obj, &decoded, decoded.blockHash, pBlockIndex->nHeight, pBlockIndex->nTime, confirmations, txobj, extendedDetails, extendedDetailsFilter);
+
+    if (rc == 0 && !extendedDetails) {
+        CRenderedTransaction rendered;
+        rendered.txobj = txobj;
+        rendered.block = pBlockIndex->nHeight;
+        rendered.sender = decoded.sender;
+        rendered.reference = decoded.reference;
+        rpcTxCache.Add(txid, rendered, nGeneration);
     }
 
-    return populateRPCTransactionObject(tx, blockHash, txobj, filterAddress, extendedDetails, extendedDetailsFilter);
+    return rc;
 }
 
 int populateRPCTransactionObject(const CTransaction& tx, const uint256& blockHash, UniValue& txobj, std::string filterAddress, bool extendedDetails, std::string extendedDetailsFilter, int blockHeight)
 {
     int confirmations = 0;
     int64_t blockTime = 0;
-    int positionInBlock = 0;
 
     if (blockHeight == 0) {
         blockHeight = GetHeight();
@@ -119,55 +313,13 @@ int populateRPCTransactionObject(const CTransaction& tx, const uint256& blockHas
     // parse packet and populate mp_obj
     if (!mp_obj.interpret_Transaction()) return MP_TX_IS_NOT_OMNI_PROTOCOL;
 
-    // obtain validity - only confirmed transactions can be valid
-    bool valid = false;
-    if (confirmations > 0) {
-        LOCK(cs_tally);
-        valid = pDbTransactionList->getValidMPTX(txid);
-        positionInBlock = pDbTransaction->FetchTransactionPosition(txid);
-    }
-
-    // populate some initial info for the transaction
-    bool fMine = false;
-    if (IsMyAddress(mp_obj.getSender()) || IsMyAddress(mp_obj.getReceiver())) fMine = true;
-    txobj.push_back(Pair("txid", txid.GetHex()));
-    txobj.push_back(Pair("fee", FormatDivisibleMP(mp_obj.getFeePaid())));
-    txobj.push_back(Pair("sendingaddress", mp_obj.getSender()));
-    if (showRefForTx(mp_obj.getType())) txobj.push_back(Pair("referenceaddress", mp_obj.getReceiver()));
-    txobj.push_back(Pair("ismine", fMine));
-    txobj.push_back(Pair("version", (uint64_t)mp_obj.getVersion()));
-    txobj.push_back(Pair("type_int", (uint64_t)mp_obj.getType()));
-    if (mp_obj.getType() != MSC_TYPE_SIMPLE_SEND) { // Type 0 will add "Type" attribute during populateRPCTypeSimpleSend
-        txobj.push_back(Pair("type", mp_obj.getTypeString()));
-    }
-
-    // populate type specific info and extended details if requested
-    // extended details are not available for unconfirmed transactions
-    if (confirmations <= 0) extendedDetails = false;
-    populateRPCTypeInfo(mp_obj, txobj, mp_obj.getType(), extendedDetails, extendedDetailsFilter, confirmations);
-
-    // state and chain related information
-    if (confirmations != 0 && !blockHash.IsNull()) {
-        txobj.push_back(Pair("valid", valid));
-        if (!valid) {
-            txobj.push_back(Pair("invalidreason", pDbTransaction->FetchInvalidReason(txid)));
-        }
-        txobj.push_back(Pair("blockhash", blockHash.GetHex()));
-        txobj.push_back(Pair("blocktime", blockTime));
-        txobj.push_back(Pair("positioninblock", positionInBlock));
-    }
-    if (confirmations != 0) {
-        txobj.push_back(Pair("block", blockHeight));
-    }
-    txobj.push_back(Pair("confirmations", confirmations));
-
-    // finished
-    return 0;
+    return populateRPCOmniTransaction(mp_obj, NULL, blockHash, blockHeight, blockTime, confirmations, txobj, extendedDetails, extendedDetailsFilter);
 }
 
 /* Function to call respective populators based on message type
+ * Returns 0 on success, or an error code, if the extended details can't be obtained
  */
-void populateRPCTypeInfo(CMPTransaction& mp_obj, UniValue& txobj, uint32_t txType, bool extendedDetails, std::string extendedDetailsFilter, int confirmations)
+int populateRPCTypeInfo(CMPTransaction& mp_obj, UniValue& txobj, uint32_t txType, bool extendedDetails, std::string extendedDetailsFilter, int confirmations)
 {
     switch (txType) {
         case MSC_TYPE_SIMPLE_SEND:
@@ -183,8 +335,7 @@ void populateRPCTypeInfo(CMPTransaction& mp_obj, UniValue& txobj, uint32_t txTyp
             populateRPCTypeTradeOffer(mp_obj, txobj);
             break;
         case MSC_TYPE_METADEX_TRADE:
-            populateRPCTypeMetaDExTrade(mp_obj, txobj, extendedDetails);
-            break;
+            return populateRPCTypeMetaDExTrade(mp_obj, txobj, extendedDetails);
         case MSC_TYPE_METADEX_CANCEL_PRICE:
             populateRPCTypeMetaDExCancelPrice(mp_obj, txobj, extendedDetails);
             break;
@@ -234,6 +385,7 @@ void populateRPCTypeInfo(CMPTransaction& mp_obj, UniValue& txobj, uint32_t txTyp
             populateRPCTypeActivation(mp_obj, txobj);
             break;
     }
+    return 0;
 }
 
 /* Function to determine whether to display the reference address based on transaction type
@@ -360,7 +512,7 @@ void populateRPCTypeTradeOffer(CMPTransaction& omniObj, UniValue& txobj)
     if (sellSubAction == 3) txobj.push_back(Pair("action", "cancel"));
 }
 
-void populateRPCTypeMetaDExTrade(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails)
+int populateRPCTypeMetaDExTrade(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails)
 {
     CMPMetaDEx metaObj(omniObj);
 
@@ -376,7 +528,8 @@ void populateRPCTypeMetaDExTrade(CMPTransaction& omniObj, UniValue& txobj, bool
     txobj.push_back(Pair("propertyiddesiredisdivisible", propertyIdDesiredIsDivisible));
     txobj.push_back(Pair("amountdesired", FormatMP(metaObj.getDesProperty(), metaObj.getAmountDesired())));
     txobj.push_back(Pair("unitprice", unitPriceStr));
-    if (extendedDetails) populateRPCExtendedTypeMetaDExTrade(omniObj.getHash(), omniObj.getProperty(), omniObj.getAmount(), txobj);
+    if (extendedDetails) return populateRPCExtendedTypeMetaDExTrade(omniObj.getHash(), omniObj.getProperty(), omniObj.getAmount(), txobj);
+    return 0;
 }
 
 void populateRPCTypeMetaDExCancelPrice(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails)
@@ -574,12 +727,13 @@ void populateRPCExtendedTypeSendToOwners(const uint256 txid, std::string extende
     txobj.push_back(Pair("recipients", receiveArray));
 }
 
-void populateRPCExtendedTypeMetaDExTrade(const uint256& txid, uint32_t propertyIdForSale, int64_t amountForSale, UniValue& txobj)
+int populateRPCExtendedTypeMetaDExTrade(const uint256& txid, uint32_t propertyIdForSale, int64_t amountForSale, UniValue& txobj)
 {
     UniValue tradeArray(UniValue::VARR);
     int64_t totalReceived = 0, totalSold = 0;
     LOCK(cs_tally);
-    pDbTradeList->getMatchingTrades(txid, propertyIdForSale, tradeArray, totalSold, totalReceived);
+    // the matches and the status would be incomplete
+    if (pDbTradeList->getMatchingTrades(txid, propertyIdForSale, tradeArray, totalSold, totalReceived) < 0) return MP_TRADE_ARCHIVE_UNREADABLE;
     int tradeStatus = MetaDEx_getStatus(txid, propertyIdForSale, amountForSale, totalSold);
     if (tradeStatus == TRADE_OPEN || tradeStatus == TRADE_OPEN_PART_FILLED) {
         const CMPMetaDEx* tradeObj = MetaDEx_RetrieveTrade(txid);
@@ -593,6 +747,7 @@ void populateRPCExtendedTypeMetaDExTrade(const uint256& txid, uint32_t propertyI
         txobj.push_back(Pair("canceltxid", pDbTransactionList->findMetaDExCancel(txid).GetHex()));
     }
     txobj.push_back(Pair("matches", tradeArray));
+    return 0;
 }
 
 void populateRPCExtendedTypeMetaDExCancel(const uint256& txid, UniValue& txobj)
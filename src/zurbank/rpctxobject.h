@@ -1,24 +1,82 @@
 #ifndef ZURBANK_RPCTXOBJECT_H
 #define ZURBANK_RPCTXOBJECT_H
 
+#include "sync.h"
+#include "uint256.h"
+
 #include <univalue.h>
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <map>
 #include <string>
+#include <utility>
 
-class uint256;
 class CMPTransaction;
 class CTransaction;
 
+/** The object of a confirmed transaction without extended details, and what is needed to update it. */
+struct CRenderedTransaction
+{
+    UniValue txobj;
+    int block;
+    std::string sender;
+    std::string reference;
+
+    CRenderedTransaction() : block(0) {}
+};
+
+/** A cache of rendered transactions, which drops the least recently used ones first.
+ */
+class CRPCTransactionCache
+{
+private:
+    typedef std::list<uint256> CacheOrder;
+    typedef std::map<uint256, std::pair<CRenderedTransaction, CacheOrder::iterator> > CacheMap;
+
+    //! Guards the cache
+    mutable CCriticalSection cs_cache;
+    //! Rendered transactions, and their use order with the most recently used last
+    CacheMap mapCache;
+    CacheOrder listOrder;
+    //! Increased when the cache is cleared, so that objects rendered before are not added afterwards
+    uint64_t nGeneration;
+    size_t nMaxSize;
+
+public:
+    explicit CRPCTransactionCache(size_t nMaxSizeIn) : nGeneration(0), nMaxSize(nMaxSizeIn) {}
+
+    /** Returns the current generation, which is to be passed to Add(). */
+    uint64_t GetGeneration() const;
+
+    /** Retrieves a rendered transaction, and marks it as most recently used. */
+    bool Get(const uint256& txid, CRenderedTransaction& rendered);
+
+    /** Adds a transaction, which was rendered in the given generation, unless the cache was cleared since. */
+    void Add(const uint256& txid, const CRenderedTransaction& rendered, uint64_t nGenerationIn);
+
+    /** Drops all rendered transactions, and starts a new generation. */
+    void Clear();
+
+    /** Returns the number of rendered transactions. */
+    size_t Size() const;
+};
+
 int populateRPCTransactionObject(const uint256& txid, UniValue& txobj, std::string filterAddress = "", bool extendedDetails = false, std::string extendedDetailsFilter = "");
 int populateRPCTransactionObject(const CTransaction& tx, const uint256& blockHash, UniValue& txobj, std::string filterAddress = "", bool extendedDetails = false, std::string extendedDetailsFilter = "", int blockHeight = 0);
 
-void populateRPCTypeInfo(CMPTransaction& mp_obj, UniValue& txobj, uint32_t txType, bool extendedDetails, std::string extendedDetailsFilter, int confirmations);
+/** Drops the cached objects of transactions, which is needed when blocks are disconnected. */
+void ClearRPCTransactionCache();
+
+int populateRPCTypeInfo(CMPTransaction& mp_obj, UniValue& txobj, uint32_t txType, bool extendedDetails, std::string extendedDetailsFilter, int confirmations);
 
 void populateRPCTypeSimpleSend(CMPTransaction& omniObj, UniValue& txobj);
 void populateRPCTypeSendToOwners(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails, std::string extendedDetailsFilter);
 void populateRPCTypeSendAll(CMPTransaction& omniObj, UniValue& txobj, int confirmations);
 void populateRPCTypeTradeOffer(CMPTransaction& omniObj, UniValue& txobj);
-void populateRPCTypeMetaDExTrade(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails);
+int populateRPCTypeMetaDExTrade(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails);
 void populateRPCTypeMetaDExCancelPrice(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails);
 void populateRPCTypeMetaDExCancelPair(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails);
 void populateRPCTypeMetaDExCancelEcosystem(CMPTransaction& omniObj, UniValue& txobj, bool extendedDetails);
@@ -37,7 +95,7 @@ void populateRPCTypeFreezeTokens(CMPTransaction& omniObj, UniValue& txobj);
 void populateRPCTypeUnfreezeTokens(CMPTransaction& omniObj, UniValue& txobj);
 
 void populateRPCExtendedTypeSendToOwners(const uint256 txid, std::string extendedDetailsFilter, UniValue& txobj, uint16_t version);
-void populateRPCExtendedTypeMetaDExTrade(const uint256& txid, uint32_t propertyIdForSale, int64_t amountForSale, UniValue& txobj);
+int populateRPCExtendedTypeMetaDExTrade(const uint256& txid, uint32_t propertyIdForSale, int64_t amountForSale, UniValue& txobj);
 void populateRPCExtendedTypeMetaDExCancel(const uint256& txid, UniValue& txobj);
 
 int populateRPCDExPurchases(const CTransaction& wtx, UniValue& purchases, std::string filterAddress);
@@ -7,13 +7,18 @@
 
 #include "arith_uint256.h"
 #include "sync.h"
+#include "util.h"
 
 #include <assert.h>
 #include <stdint.h>
-#include <map>
-#include <set>
+#include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
 
 namespace mastercore
 {
@@ -27,16 +32,37 @@ bool SendToOwners_compare::operator()(const std::pair<int64_t, std::string>& p1,
     else return p1.first < p2.first;
 }
 
+/**
+ * Calculates the shares of the owners in the range [nBegin, nEnd), which are
+ * ceil(owned * amount / total).
+ */
+static void CalculateShares(const OwnerAddrType& owners, int64_t amount, int64_t totalTokens,
+        std::vector<int64_t>& shares, size_t nBegin, size_t nEnd)
+{
+    const arith_uint256 amount256 = ConvertTo256(amount);
+    const arith_uint256 total256 = ConvertTo256(totalTokens);
+
+    for (size_t i = nBegin; i < nEnd; ++i) {
+        arith_uint256 temp = ConvertTo256(owners[i].first) * amount256;
+        shares[i] = ConvertTo64(DivideAndRoundUp(temp, total256));
+    }
+}
+
 /**
  * Determines the receivers and amounts to distribute.
  *
  * The sender is excluded from the result set.
+ *
+ * The holders are collected in a flat list and sorted, so they are visited in
+ * the same order as before. Each share only depends on the holder's balance,
+ * so the shares of many holders are calculated in parallel. Afterwards a single
+ * pass ensures no more than the amount is distributed.
  */
 OwnerAddrType STO_GetReceivers(const std::string& sender, uint32_t property, int64_t amount)
 {
     int64_t totalTokens = 0;
     int64_t senderTokens = 0;
-    OwnerAddrType ownerAddrSet;
+    OwnerAddrType owners;
 
     {
         LOCK(cs_tally);
@@ -62,24 +88,41 @@ OwnerAddrType STO_GetReceivers(const std::string& sender, uint32_t property, int
 
             // Only holders with balance are relevant
             if (0 < tokens) {
-                ownerAddrSet.insert(std::make_pair(tokens, address));
+                owners.push_back(std::make_pair(tokens, address));
             }
         }
     }
 
+    // Largest holders first, as the remainder is allocated in this order
+    std::sort(owners.begin(), owners.end(), SendToOwners_compare());
+    std::reverse(owners.begin(), owners.end());
+
+    // Calculate the shares, using several threads for many holders
+    std::vector<int64_t> shares(owners.size(), 0);
+    int nThreads = std::min(std::max((int) GetArg("-omnithreads", GetNumCores()), 1), STO_MAX_THREADS);
+    if (owners.size() < STO_PARALLEL_MIN_HOLDERS || nThreads < 2) {
+        CalculateShares(owners, amount, totalTokens, shares, 0, owners.size());
+    } else {
+        boost::thread_group threadGroup;
+        size_t nChunk = (owners.size() + nThreads - 1) / nThreads;
+        for (size_t nBegin = nChunk; nBegin < owners.size(); nBegin += nChunk) {
+            size_t nEnd = std::min(nBegin + nChunk, owners.size());
+            threadGroup.create_thread(boost::bind(&CalculateShares, boost::cref(owners), amount, totalTokens,
+                    boost::ref(shares), nBegin, nEnd));
+        }
+        CalculateShares(owners, amount, totalTokens, shares, 0, std::min(nChunk, owners.size()));
+        threadGroup.join_all();
+    }
+
     // Split up what was taken and distribute between all holders
     int64_t sent_so_far = 0;
-    OwnerAddrType receiversSet;
-
-    for (OwnerAddrType::reverse_iterator it = ownerAddrSet.rbegin(); it != ownerAddrSet.rend(); ++it) {
-        const std::string& address = it->second;
+    OwnerAddrType receivers;
 
-        arith_uint256 owns = ConvertTo256(it->first);
-        arith_uint256 temp = owns * ConvertTo256(amount);
-        arith_uint256 piece = DivideAndRoundUp(temp, ConvertTo256(totalTokens));
+    for (size_t i = 0; i < owners.size(); ++i) {
+        const std::string& address = owners[i].second;
 
         int64_t will_really_receive = 0;
-        int64_t should_receive = ConvertTo64(piece);
+        int64_t should_receive = shares[i];
 
         // Ensure that no more than available is distributed
         if ((amount - sent_so_far) < should_receive) {
@@ -91,24 +134,28 @@ OwnerAddrType STO_GetReceivers(const std::string& sender, uint32_t property, int
         sent_so_far += will_really_receive;
 
         if (msc_debug_sto) {
+            arith_uint256 temp = ConvertTo256(owners[i].first) * ConvertTo256(amount);
             PrintToLog("%14d = %s, temp= %38s, should_get= %19d, will_really_get= %14d, sent_so_far= %14d\n",
-                it->first, address, temp.ToString(), should_receive, will_really_receive, sent_so_far);
+                owners[i].first, address, temp.ToString(), should_receive, will_really_receive, sent_so_far);
         }
 
         // Stop, once the whole amount is allocated
         if (will_really_receive > 0) {
-            receiversSet.insert(std::make_pair(will_really_receive, address));
+            receivers.push_back(std::make_pair(will_really_receive, address));
         } else {
             break;
         }
     }
 
-    uint64_t numberOfOwners = receiversSet.size();
+    // Sorted by amount received, as the receivers are processed in this order
+    std::sort(receivers.begin(), receivers.end(), SendToOwners_compare());
+
+    uint64_t numberOfOwners = receivers.size();
     PrintToLog("\t    Total Tokens: %s\n", FormatMP(property, totalTokens + senderTokens));
     PrintToLog("\tExcluding Sender: %s\n", FormatMP(property, totalTokens));
     PrintToLog("\t          Owners: %d\n", numberOfOwners);
 
-    return receiversSet;
+    return receivers;
 }
 
 } // namespace mastercore
@@ -2,9 +2,9 @@
 #define ZURBANK_STO_H
 
 #include <stdint.h>
-#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace mastercore
 {
@@ -18,8 +18,13 @@ struct SendToOwners_compare
 const int64_t TRANSFER_FEE_PER_OWNER = 1;
 const int64_t TRANSFER_FEE_PER_OWNER_V1 = 1000;
 
-//! Set of owner/receivers, sorted by amount they own or might receive
-typedef std::set<std::pair<int64_t, std::string>, SendToOwners_compare> OwnerAddrType;
+//! Minimum number of holders, before the shares are calculated by several threads
+const size_t STO_PARALLEL_MIN_HOLDERS = 10000;
+//! Maximum number of threads to calculate the shares
+const int STO_MAX_THREADS = 8;
+
+//! List of owner/receivers, sorted by amount they own or might receive
+typedef std::vector<std::pair<int64_t, std::string> > OwnerAddrType;
 
 /** Determines the receivers and amounts to distribute. */
 OwnerAddrType STO_GetReceivers(const std::string& sender, uint32_t property, int64_t amount);
@@ -0,0 +1,200 @@
+#include "zurbank/dbbase.h"
+
+#include "test/test_zurcoin.h"
+
+#include "leveldb/write_batch.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+namespace
+{
+/** Exposes the protected accessors of CDBBase. */
+class CTestDB : public CDBBase
+{
+public:
+    using CDBBase::NewIterator;
+
+    CTestDB(const boost::filesystem::path& path, bool fWipe)
+    {
+        leveldb::Status status = Open(path, fWipe);
+        BOOST_CHECK(status.ok());
+    }
+
+    std::string Read(const std::string& key) const
+    {
+        std::string value;
+        return Get(key, &value).ok() ? value : "<none>";
+    }
+
+    void Set(const std::string& key, const std::string& value) { BOOST_CHECK(Put(key, value).ok()); }
+    void Erase(const std::string& key) { BOOST_CHECK(Delete(key).ok()); }
+
+    void SetBatch(const std::string& key, const std::string& value, const std::string& erase)
+    {
+        leveldb::WriteBatch batch;
+        batch.Put(key, value);
+        batch.Delete(erase);
+        BOOST_CHECK(Write(batch, true).ok());
+    }
+
+    /** Returns all entries in order, or in reverse order. */
+    std::string Dump(bool fReverse = false) const
+    {
+        std::string str;
+        leveldb::Iterator* it = NewIterator();
+        if (fReverse) {
+            for (it->SeekToLast(); it->Valid(); it->Prev()) {
+                str += it->key().ToString() + "=" + it->value().ToString() + " ";
+            }
+        } else {
+            for (it->SeekToFirst(); it->Valid(); it->Next()) {
+                str += it->key().ToString() + "=" + it->value().ToString() + " ";
+            }
+        }
+        delete it;
+        return str;
+    }
+};
+}
+
+BOOST_FIXTURE_TEST_SUITE(zurbank_dbbatch_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(staged_writes)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CTestDB db(path, true);
+        db.Set("b", "1");
+        db.Set("d", "2");
+        db.Set("f", "3");
+
+        db.BeginBatch();
+        db.Set("a", "4");
+        db.Set("d", "5");
+        db.Erase("f");
+        db.SetBatch("e", "6", "b");
+        BOOST_CHECK_EQUAL(db.GetStagedCount(), 5U);
+
+        // staged writes are visible while the batch is open
+        BOOST_CHECK_EQUAL(db.Read("a"), "4");
+        BOOST_CHECK_EQUAL(db.Read("b"), "<none>");
+        BOOST_CHECK_EQUAL(db.Read("d"), "5");
+        BOOST_CHECK_EQUAL(db.Read("f"), "<none>");
+        BOOST_CHECK_EQUAL(db.Dump(), "a=4 d=5 e=6 ");
+        BOOST_CHECK_EQUAL(db.Dump(true), "e=6 d=5 a=4 ");
+
+        // changing direction in the middle
+        leveldb::Iterator* it = db.NewIterator();
+        it->Seek("c");
+        BOOST_CHECK_EQUAL(it->key().ToString(), "d");
+        it->Prev();
+        BOOST_CHECK_EQUAL(it->key().ToString(), "a");
+        it->Next();
+        it->Next();
+        BOOST_CHECK_EQUAL(it->key().ToString(), "e");
+        it->Next();
+        BOOST_CHECK(!it->Valid());
+        delete it;
+
+        // discarded changes are gone
+        db.DiscardBatch();
+        BOOST_CHECK_EQUAL(db.GetStagedCount(), 0U);
+        BOOST_CHECK_EQUAL(db.Dump(), "b=1 d=2 f=3 ");
+
+        // committed changes are written
+        db.BeginBatch();
+        db.Set("a", "4");
+        db.Erase("d");
+        BOOST_CHECK(db.CommitBatch().ok());
+        BOOST_CHECK_EQUAL(db.GetStagedCount(), 0U);
+
+        // writes after the commit are not staged
+        db.Set("c", "7");
+        BOOST_CHECK_EQUAL(db.GetStagedCount(), 0U);
+    }
+    {
+        CTestDB db(path, false);
+        BOOST_CHECK_EQUAL(db.Dump(), "a=4 b=1 c=7 f=3 ");
+    }
+    boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(staged_iterator_snapshot)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CTestDB db(path, true);
+        db.Set("b", "1");
+
+        db.BeginBatch();
+        db.Set("a", "2");
+        db.Set("c", "3");
+        leveldb::Iterator* it = db.NewIterator();
+
+        // writes after the creation of the iterator are not visible through it
+        db.Set("a", "4");
+        db.Erase("c");
+        db.Set("d", "5");
+        db.Set("d", "6");
+        BOOST_CHECK_EQUAL(db.GetStagedCount(), 3U);
+        BOOST_CHECK_EQUAL(db.Read("a"), "4");
+        BOOST_CHECK_EQUAL(db.Dump(), "a=4 b=1 d=6 ");
+
+        std::string str;
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            str += it->key().ToString() + "=" + it->value().ToString() + " ";
+        }
+        BOOST_CHECK_EQUAL(str, "a=2 b=1 c=3 ");
+
+        // nor are they after the batch is committed
+        BOOST_CHECK(db.CommitBatch().ok());
+        str.clear();
+        for (it->SeekToLast(); it->Valid(); it->Prev()) {
+            str += it->key().ToString() + "=" + it->value().ToString() + " ";
+        }
+        BOOST_CHECK_EQUAL(str, "c=3 b=1 a=2 ");
+        delete it;
+
+        BOOST_CHECK_EQUAL(db.Dump(), "a=4 b=1 d=6 ");
+    }
+    boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(access_stats)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CTestDB db(path, true);
+        db.Set("a", "1");
+        db.Set("b", "2");
+        BOOST_CHECK_EQUAL(db.Read("a"), "1");
+        BOOST_CHECK_EQUAL(db.Read("c"), "<none>");
+
+        CDBAccessStats stats = db.GetAccessStats();
+        BOOST_CHECK_EQUAL(stats.nLookups, 2U);
+        BOOST_CHECK_EQUAL(stats.nLookupMisses, 1U);
+        BOOST_CHECK_EQUAL(stats.nWrites, 2U);
+
+        // staged writes are written once, and staged entries are not looked up
+        db.BeginBatch();
+        db.Set("c", "3");
+        db.Erase("a");
+        BOOST_CHECK_EQUAL(db.Read("c"), "3");
+        BOOST_CHECK_EQUAL(db.GetAccessStats().nWrites, 2U);
+        BOOST_CHECK(db.CommitBatch().ok());
+
+        stats = db.GetAccessStats();
+        BOOST_CHECK_EQUAL(stats.nLookups, 2U);
+        BOOST_CHECK_EQUAL(stats.nWrites, 3U);
+
+        db.Clear();
+        BOOST_CHECK_EQUAL(db.GetAccessStats().nLookups, 0U);
+        BOOST_CHECK_EQUAL(db.GetAccessStats().nWrites, 0U);
+    }
+    boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+#include "zurbank/events.h"
+#include "zurbank/tally.h"
+#include "zurbank/zurbank.h"
+
+#include "test/test_zurcoin.h"
+#include "uint256.h"
+
+#include <boost/bind.hpp>
+#include <boost/signals2/connection.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+namespace
+{
+struct BalanceListener
+{
+    int nCalls;
+    int nBlock;
+    std::vector<CZusBalanceDelta> vDeltas;
+
+    BalanceListener() : nCalls(0), nBlock(-1) {}
+
+    void BalancesChanged(int block, const uint256& blockHash, const std::vector<CZusBalanceDelta>& deltas)
+    {
+        ++nCalls;
+        nBlock = block;
+        vDeltas = deltas;
+    }
+};
+}
+
+BOOST_FIXTURE_TEST_SUITE(zurbank_events_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(balance_deltas_netted)
+{
+    BalanceListener listener;
+    boost::signals2::scoped_connection conn = GetZusSignals().BalancesChanged.connect(
+            boost::bind(&BalanceListener::BalancesChanged, &listener, _1, _2, _3));
+
+    BeginBalanceDeltas();
+    RecordBalanceDelta("1B", 3, 100, BALANCE);
+    RecordBalanceDelta("1A", 3, -40, BALANCE);
+    RecordBalanceDelta("1A", 3, 40, SELLOFFER_RESERVE);
+    RecordBalanceDelta("1B", 3, 25, BALANCE);
+    RecordBalanceDelta("1A", 4, 7, BALANCE);
+    RecordBalanceDelta("1A", 4, -7, BALANCE);  // cancels out
+    RecordBalanceDelta("1C", 3, 500, PENDING); // pending amounts are ignored
+    EndBalanceDeltas(42, uint256());
+
+    BOOST_CHECK_EQUAL(listener.nCalls, 1);
+    BOOST_CHECK_EQUAL(listener.nBlock, 42);
+    BOOST_REQUIRE_EQUAL(listener.vDeltas.size(), 3U);
+    // sorted by address, property and tally type
+    BOOST_CHECK_EQUAL(listener.vDeltas[0].address, "1A");
+    BOOST_CHECK_EQUAL(listener.vDeltas[0].ttype, BALANCE);
+    BOOST_CHECK_EQUAL(listener.vDeltas[0].amount, -40);
+    BOOST_CHECK_EQUAL(listener.vDeltas[1].address, "1A");
+    BOOST_CHECK_EQUAL(listener.vDeltas[1].ttype, SELLOFFER_RESERVE);
+    BOOST_CHECK_EQUAL(listener.vDeltas[1].amount, 40);
+    BOOST_CHECK_EQUAL(listener.vDeltas[2].address, "1B");
+    BOOST_CHECK_EQUAL(listener.vDeltas[2].propertyId, 3U);
+    BOOST_CHECK_EQUAL(listener.vDeltas[2].amount, 125);
+
+    // changes of the previous block are not carried over
+    BeginBalanceDeltas();
+    RecordBalanceDelta("1D", 1, 1, BALANCE);
+    EndBalanceDeltas(43, uint256());
+    BOOST_CHECK_EQUAL(listener.nCalls, 2);
+    BOOST_REQUIRE_EQUAL(listener.vDeltas.size(), 1U);
+    BOOST_CHECK_EQUAL(listener.vDeltas[0].address, "1D");
+
+    // nothing is emitted for blocks without net changes
+    BeginBalanceDeltas();
+    RecordBalanceDelta("1D", 1, 5, BALANCE);
+    RecordBalanceDelta("1D", 1, -5, BALANCE);
+    EndBalanceDeltas(44, uint256());
+    BOOST_CHECK_EQUAL(listener.nCalls, 2);
+}
+
+BOOST_AUTO_TEST_CASE(balance_deltas_not_collected)
+{
+    BalanceListener listener;
+
+    // without listeners at the beginning of the block, nothing is collected
+    BeginBalanceDeltas();
+    RecordBalanceDelta("1A", 3, 100, BALANCE);
+    {
+        boost::signals2::scoped_connection conn = GetZusSignals().BalancesChanged.connect(
+                boost::bind(&BalanceListener::BalancesChanged, &listener, _1, _2, _3));
+        EndBalanceDeltas(42, uint256());
+        BOOST_CHECK_EQUAL(listener.nCalls, 0);
+
+        // and while the signals are suspended
+        SuspendZusSignals(true);
+        BOOST_CHECK(!ZusSignalsActive());
+        BeginBalanceDeltas();
+        RecordBalanceDelta("1A", 3, 100, BALANCE);
+        EndBalanceDeltas(43, uint256());
+        SuspendZusSignals(false);
+        BOOST_CHECK(ZusSignalsActive());
+        BOOST_CHECK_EQUAL(listener.nCalls, 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(balance_deltas_from_tally)
+{
+    BalanceListener listener;
+    boost::signals2::scoped_connection conn = GetZusSignals().BalancesChanged.connect(
+            boost::bind(&BalanceListener::BalancesChanged, &listener, _1, _2, _3));
+
+    BeginBalanceDeltas();
+    BOOST_CHECK(update_tally_map("1EventsTest", 3, 1000, BALANCE));
+    BOOST_CHECK(update_tally_map("1EventsTest", 3, -300, BALANCE));
+    BOOST_CHECK(update_tally_map("1EventsTest", 3, 300, METADEX_RESERVE));
+    BOOST_CHECK(!update_tally_map("1EventsTest", 3, -5000, BALANCE)); // failed updates are not recorded
+    EndBalanceDeltas(42, uint256());
+
+    BOOST_REQUIRE_EQUAL(listener.vDeltas.size(), 2U);
+    BOOST_CHECK_EQUAL(listener.vDeltas[0].ttype, BALANCE);
+    BOOST_CHECK_EQUAL(listener.vDeltas[0].amount, 700);
+    BOOST_CHECK_EQUAL(listener.vDeltas[1].ttype, METADEX_RESERVE);
+    BOOST_CHECK_EQUAL(listener.vDeltas[1].amount, 300);
+
+    BOOST_CHECK(update_tally_map("1EventsTest", 3, -700, BALANCE));
+    BOOST_CHECK(update_tally_map("1EventsTest", 3, -300, METADEX_RESERVE));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
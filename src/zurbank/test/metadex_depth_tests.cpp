@@ -0,0 +1,111 @@
+#include "zurbank/mdex.h"
+#include "zurbank/tally.h"
+#include "zurbank/tx.h"
+#include "zurbank/zurbank.h"
+
+#include "test/test_zurcoin.h"
+#include "uint256.h"
+
+#include <stdint.h>
+#include <limits>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mastercore;
+
+static CMPMetaDEx MakeOrder(uint32_t property, int64_t amountForSale, uint32_t propertyDesired, int64_t amountDesired, unsigned int idx)
+{
+    uint256 txid;
+    *txid.begin() = (unsigned char) idx;
+    return CMPMetaDEx("1PxejjeWZc9ZHph7A3SYDo2sk2Up4AcysH", 100, property, amountForSale, propertyDesired, amountDesired, txid, idx, CMPTransaction::ADD);
+}
+
+BOOST_FIXTURE_TEST_SUITE(zurbank_metadex_depth_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(depth_aggregates_levels)
+{
+    MetaDEx_CLEAR();
+
+    // two orders at a price of 2, one at a price of 3
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(3, 100, 4, 300, 1)));
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(3, 50, 4, 100, 2)));
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(3, 25, 4, 50, 3)));
+    // same property for sale, but another market
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(3, 10, 5, 10, 4)));
+
+    std::vector<CMPMetaDExLevel> vLevels;
+    MetaDEx_getDepth(3, 4, 0, vLevels);
+    BOOST_CHECK_EQUAL(vLevels.size(), 2U);
+    BOOST_CHECK(vLevels[0].price == rational_t(2, 1));
+    BOOST_CHECK_EQUAL(vLevels[0].amountForSale, 75);
+    BOOST_CHECK_EQUAL(vLevels[0].amountToFill, 150);
+    BOOST_CHECK_EQUAL(vLevels[0].orders, 2U);
+    BOOST_CHECK(vLevels[1].price == rational_t(3, 1));
+    BOOST_CHECK_EQUAL(vLevels[1].amountForSale, 100);
+    BOOST_CHECK_EQUAL(vLevels[1].orders, 1U);
+
+    // top levels only
+    vLevels.clear();
+    MetaDEx_getDepth(3, 4, 1, vLevels);
+    BOOST_CHECK_EQUAL(vLevels.size(), 1U);
+
+    vLevels.clear();
+    MetaDEx_getDepth(4, 3, 0, vLevels);
+    BOOST_CHECK(vLevels.empty());
+
+    MetaDEx_CLEAR();
+    vLevels.clear();
+    MetaDEx_getDepth(3, 4, 0, vLevels);
+    BOOST_CHECK(vLevels.empty());
+}
+
+BOOST_AUTO_TEST_CASE(depth_spread)
+{
+    MetaDEx_CLEAR();
+
+    rational_t bestAsk;
+    rational_t bestBid;
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(3, 100, 4, 300, 1)));
+    BOOST_CHECK(!MetaDEx_getSpread(3, 4, bestAsk, bestBid));
+
+    // offers 200 of property 4 for 100 of property 3, a bid of 2 per unit
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(4, 200, 3, 100, 2)));
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(4, 100, 3, 100, 3)));
+    BOOST_CHECK(MetaDEx_getSpread(3, 4, bestAsk, bestBid));
+    BOOST_CHECK(bestAsk == rational_t(3, 1));
+    BOOST_CHECK(bestBid == rational_t(2, 1));
+
+    MetaDEx_CLEAR();
+}
+
+// cancelled orders are recorded, so the full setup is used
+BOOST_FIXTURE_TEST_CASE(depth_large_amounts_desired, TestingSetup)
+{
+    MetaDEx_CLEAR();
+    const std::string address = "1PxejjeWZc9ZHph7A3SYDo2sk2Up4AcysH";
+    const int64_t amountDesired = std::numeric_limits<int64_t>::max() - 1;
+    BOOST_CHECK(update_tally_map(address, 3, 2, METADEX_RESERVE));
+
+    // two orders, which each sell 1 unit and desire almost the largest amount
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(3, 1, 4, amountDesired, 1)));
+    BOOST_CHECK(MetaDEx_INSERT(MakeOrder(3, 1, 4, amountDesired, 2)));
+
+    std::vector<CMPMetaDExLevel> vLevels;
+    MetaDEx_getDepth(3, 4, 0, vLevels);
+    BOOST_CHECK_EQUAL(vLevels.size(), 1U);
+    BOOST_CHECK(vLevels[0].amountToFill == boost::multiprecision::checked_int128_t(amountDesired) * 2);
+    BOOST_CHECK_EQUAL(vLevels[0].getAmountToFill(), std::numeric_limits<int64_t>::max());
+    BOOST_CHECK_EQUAL(vLevels[0].getAmountForSale(), 2);
+
+    // the level is removed with its last order
+    BOOST_CHECK_EQUAL(MetaDEx_CANCEL_ALL_FOR_PAIR(uint256(), 101, address, 3, 4), 0);
+    vLevels.clear();
+    MetaDEx_getDepth(3, 4, 0, vLevels);
+    BOOST_CHECK(vLevels.empty());
+
+    BOOST_CHECK(update_tally_map(address, 3, -2, BALANCE));
+    MetaDEx_CLEAR();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
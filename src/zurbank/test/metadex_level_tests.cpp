@@ -0,0 +1,84 @@
+#include "zurbank/mdex.h"
+#include "zurbank/tx.h"
+
+#include "test/test_zurcoin.h"
+#include "uint256.h"
+
+#include <stdint.h>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mastercore;
+
+static CMPMetaDEx MakeOrder(const std::string& address, int block, unsigned int idx, int64_t amountForSale)
+{
+    uint256 txid;
+    *txid.begin() = (unsigned char) idx;
+    return CMPMetaDEx(address, block, 3, amountForSale, 4, 2 * amountForSale, txid, idx, CMPTransaction::ADD);
+}
+
+// updates of orders are logged with the amounts, which are formatted by the properties
+BOOST_FIXTURE_TEST_SUITE(zurbank_metadex_level_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(level_sorted_by_block_and_idx)
+{
+    md_Set level;
+    BOOST_CHECK(level.insert(MakeOrder("1A", 100, 2, 10)).second);
+    BOOST_CHECK(level.insert(MakeOrder("1B", 101, 1, 10)).second);
+    BOOST_CHECK(level.insert(MakeOrder("1C", 100, 5, 10)).second);
+    BOOST_CHECK(level.insert(MakeOrder("1D", 99, 7, 10)).second);
+    // same block and index
+    BOOST_CHECK(!level.insert(MakeOrder("1E", 100, 5, 20)).second);
+    BOOST_CHECK_EQUAL(level.size(), 4U);
+
+    std::string order;
+    for (md_Set::const_iterator it = level.begin(); it != level.end(); ++it) {
+        order += it->getAddr();
+    }
+    BOOST_CHECK_EQUAL(order, "1D1A1C1B");
+
+    // partial fills don't move the order
+    md_Set::iterator it = level.begin() + 1;
+    level.setAmountRemaining(it, 4);
+    BOOST_CHECK_EQUAL(level.begin()[1].getAddr(), "1A");
+    BOOST_CHECK_EQUAL(level.begin()[1].getAmountRemaining(), 4);
+    BOOST_CHECK_EQUAL(level.begin()[1].getAmountToFill(), 8);
+
+    it = level.erase(it);
+    BOOST_CHECK_EQUAL(it->getAddr(), "1C");
+    it = level.erase(level.end() - 1);
+    BOOST_CHECK(it == level.end());
+    BOOST_CHECK_EQUAL(level.size(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(interned_addresses)
+{
+    CMPMetaDEx first = MakeOrder("1PxejjeWZc9ZHph7A3SYDo2sk2Up4AcysH", 100, 1, 10);
+    CMPMetaDEx second = MakeOrder(std::string("1PxejjeWZc9ZHph7A3SYDo2sk2Up4AcysH"), 100, 2, 10);
+    BOOST_CHECK(&first.getAddr() == &second.getAddr());
+    BOOST_CHECK(&first.getAddr() != &MakeOrder("1AgAGm4oMSXXisApuvr1dZwSvRDn4ZtEM1", 100, 3, 10).getAddr());
+    BOOST_CHECK_EQUAL(CMPMetaDEx().getAddr(), "");
+}
+
+BOOST_AUTO_TEST_CASE(interned_addresses_released)
+{
+    size_t nInterned = MetaDEx_InternedAddressCount();
+    {
+        md_Set level;
+        BOOST_CHECK(level.insert(MakeOrder("1InternReleasedA", 100, 1, 10)).second);
+        BOOST_CHECK(level.insert(MakeOrder("1InternReleasedA", 100, 2, 10)).second);
+        BOOST_CHECK(level.insert(MakeOrder("1InternReleasedB", 100, 3, 10)).second);
+        BOOST_CHECK_EQUAL(MetaDEx_InternedAddressCount(), nInterned + 2);
+
+        // the address stays, while an order refers to it
+        level.erase(level.begin());
+        BOOST_CHECK_EQUAL(MetaDEx_InternedAddressCount(), nInterned + 2);
+        level.erase(level.begin());
+        BOOST_CHECK_EQUAL(MetaDEx_InternedAddressCount(), nInterned + 1);
+        BOOST_CHECK_EQUAL(level.begin()->getAddr(), "1InternReleasedB");
+    }
+    BOOST_CHECK_EQUAL(MetaDEx_InternedAddressCount(), nInterned);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+#include "zurbank/perfstats.h"
+
+#include "test/test_zurcoin.h"
+
+#include <stdint.h>
+#include <map>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+using namespace mastercore;
+
+static void RecordStages(int nTimes)
+{
+    for (int n = 0; n < nTimes; ++n) {
+        RecordPerfStage(PERF_STAGE_DECODE, n % 100);
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(zurbank_perfstats_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(histogram_buckets)
+{
+    CPerfHistogram histogram;
+    histogram.Add(0);
+    histogram.Add(1);
+    histogram.Add(2);
+    histogram.Add(3);
+    histogram.Add(4);
+    histogram.Add(1000);
+    histogram.Add(-5);
+
+    BOOST_CHECK_EQUAL(histogram.nCount, 7U);
+    BOOST_CHECK_EQUAL(histogram.nTotalMicros, 1010);
+    BOOST_CHECK_EQUAL(histogram.nMaxMicros, 1000);
+    BOOST_CHECK_EQUAL(histogram.vBuckets[0], 3U); // 0, 1 and the negative duration
+    BOOST_CHECK_EQUAL(histogram.vBuckets[1], 2U); // 2 and 3
+    BOOST_CHECK_EQUAL(histogram.vBuckets[2], 1U); // 4
+    BOOST_CHECK_EQUAL(histogram.vBuckets[9], 1U); // 1000 < 1024
+}
+
+BOOST_AUTO_TEST_CASE(histogram_overflow)
+{
+    CPerfHistogram histogram;
+    histogram.Add(CPerfHistogram::GetBucketLimit(CPerfHistogram::NUM_BUCKETS - 1) * 10);
+
+    BOOST_CHECK_EQUAL(histogram.vBuckets[CPerfHistogram::NUM_BUCKETS - 1], 1U);
+}
+
+BOOST_AUTO_TEST_CASE(stage_recording)
+{
+    ResetPerfStats();
+    {
+        CPerfStageTimer timer(PERF_STAGE_PARSE);
+    }
+    {
+        CPerfStageTimer timer(PERF_STAGE_PARSE, false);
+    }
+    RecordPerfTxType(0, 10);
+    RecordPerfTxType(0, 20);
+
+    std::map<int, CPerfHistogram> mapStages;
+    std::map<uint16_t, CPerfHistogram> mapTxTypes;
+    GetPerfStats(mapStages, mapTxTypes);
+
+    BOOST_CHECK_EQUAL(mapStages[PERF_STAGE_PARSE].nCount, 1U);
+    BOOST_CHECK_EQUAL(mapStages[PERF_STAGE_LOGIC].nCount, 2U);
+    BOOST_CHECK_EQUAL(mapStages[PERF_STAGE_LOGIC].nTotalMicros, 30);
+    BOOST_CHECK_EQUAL(mapTxTypes.size(), 1U);
+    BOOST_CHECK_EQUAL(mapTxTypes[0].nMaxMicros, 20);
+
+    ResetPerfStats();
+    GetPerfStats(mapStages, mapTxTypes);
+    BOOST_CHECK_EQUAL(mapStages[PERF_STAGE_LOGIC].nCount, 0U);
+    BOOST_CHECK(mapTxTypes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_stage_recording)
+{
+    ResetPerfStats();
+    boost::thread_group threads;
+    for (int n = 0; n < 4; ++n) {
+        threads.create_thread(boost::bind(&RecordStages, 10000));
+    }
+    threads.join_all();
+
+    std::map<int, CPerfHistogram> mapStages;
+    std::map<uint16_t, CPerfHistogram> mapTxTypes;
+    GetPerfStats(mapStages, mapTxTypes);
+
+    const CPerfHistogram& histogram = mapStages[PERF_STAGE_DECODE];
+    BOOST_CHECK_EQUAL(histogram.nCount, 40000U);
+    BOOST_CHECK_EQUAL(histogram.nTotalMicros, 4 * 100 * 4950);
+    BOOST_CHECK_EQUAL(histogram.nMaxMicros, 99);
+    uint64_t nBucketed = 0;
+    for (int n = 0; n < CPerfHistogram::NUM_BUCKETS; ++n) {
+        nBucketed += histogram.vBuckets[n];
+    }
+    BOOST_CHECK_EQUAL(nBucketed, 40000U);
+    ResetPerfStats();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+#include "zurbank/tally.h"
+#include "zurbank/zurbank.h"
+
+#include "base58.h"
+#include "pubkey.h"
+#include "rpc/server.h"
+#include "sync.h"
+#include "test/test_zurcoin.h"
+#include "uint256.h"
+#include "utilstrencodings.h"
+
+#include <univalue.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+
+#include <string>
+
+using namespace mastercore;
+
+namespace
+{
+UniValue CallGetBalances(const std::string& address1, const std::string& address2)
+{
+    UniValue addresses(UniValue::VARR);
+    addresses.push_back(address1);
+    addresses.push_back(address2);
+    UniValue propertyIds(UniValue::VARR);
+    propertyIds.push_back(1);
+    propertyIds.push_back(2);
+    UniValue params(UniValue::VARR);
+    params.push_back(addresses);
+    params.push_back(propertyIds);
+    return tableRPC["zus_getbalances"]->actor(params, false);
+}
+
+UniValue CallGetBalance(const std::string& address, uint32_t propertyId)
+{
+    UniValue params(UniValue::VARR);
+    params.push_back(address);
+    params.push_back((int64_t) propertyId);
+    return tableRPC["zus_getbalance"]->actor(params, false);
+}
+}
+
+// the Zus state is initialized, when the genesis block is connected
+BOOST_FIXTURE_TEST_SUITE(zurbank_rpc_getbalances_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(getbalances_matches_getbalance)
+{
+    const std::string address1 = CBitcoinAddress(CKeyID(uint160(ParseHex("65a16059864a2fdbc7c99a4723a8395bc6f188eb")))).ToString();
+    const std::string address2 = CBitcoinAddress(CKeyID(uint160(ParseHex("74f209f6ea907e2ea48f74fae05782ae8a665257")))).ToString();
+    {
+        LOCK(cs_tally);
+        BOOST_CHECK(update_tally_map(address1, 1, 100000, BALANCE));
+        BOOST_CHECK(update_tally_map(address1, 1, -30000, PENDING));
+        BOOST_CHECK(update_tally_map(address1, 1, 5000, SELLOFFER_RESERVE));
+        BOOST_CHECK(update_tally_map(address1, 1, 2000, ACCEPT_RESERVE));
+        BOOST_CHECK(update_tally_map(address1, 1, 500, METADEX_RESERVE));
+        BOOST_CHECK(update_tally_map(address1, 2, 7, BALANCE));
+        BOOST_CHECK(update_tally_map(address1, 2, 9, PENDING));
+        freezeAddress(address1, 2);
+    }
+
+    UniValue result = CallGetBalances(address1, address2);
+    BOOST_CHECK_EQUAL(result["addresses"][0].get_str(), address1);
+    BOOST_CHECK_EQUAL(result["addresses"][1].get_str(), address2);
+
+    // pending debits reduce the available balance, credits don't
+    BOOST_CHECK_EQUAL(result["balance"][0][0].get_str(), FormatDivisibleMP(70000));
+    BOOST_CHECK_EQUAL(result["reserved"][0][0].get_str(), FormatDivisibleMP(7500));
+    BOOST_CHECK_EQUAL(result["frozen"][0][0].get_str(), FormatDivisibleMP(0));
+    BOOST_CHECK_EQUAL(result["balance"][0][1].get_str(), FormatDivisibleMP(7));
+    BOOST_CHECK_EQUAL(result["frozen"][0][1].get_str(), FormatDivisibleMP(7));
+
+    // each entry is the same as returned by zus_getbalance
+    for (size_t nAddress = 0; nAddress < 2; ++nAddress) {
+        for (size_t nProperty = 0; nProperty < 2; ++nProperty) {
+            std::string address = result["addresses"][nAddress].get_str();
+            UniValue single = CallGetBalance(address, nProperty + 1);
+            BOOST_CHECK_EQUAL(result["balance"][nAddress][nProperty].get_str(), single["balance"].get_str());
+            BOOST_CHECK_EQUAL(result["reserved"][nAddress][nProperty].get_str(), single["reserved"].get_str());
+            BOOST_CHECK_EQUAL(result["frozen"][nAddress][nProperty].get_str(), single["frozen"].get_str());
+        }
+    }
+
+    {
+        LOCK(cs_tally);
+        unfreezeAddress(address1, 2);
+        BOOST_CHECK(update_tally_map(address1, 1, -100000, BALANCE));
+        BOOST_CHECK(update_tally_map(address1, 1, 30000, PENDING));
+        BOOST_CHECK(update_tally_map(address1, 1, -5000, SELLOFFER_RESERVE));
+        BOOST_CHECK(update_tally_map(address1, 1, -2000, ACCEPT_RESERVE));
+        BOOST_CHECK(update_tally_map(address1, 1, -500, METADEX_RESERVE));
+        BOOST_CHECK(update_tally_map(address1, 2, -7, BALANCE));
+        BOOST_CHECK(update_tally_map(address1, 2, -9, PENDING));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,121 @@
+#include "zurbank/tally.h"
+#include "zurbank/zurbank.h"
+
+#include "rpc/jsonstream.h"
+#include "rpc/server.h"
+#include "sync.h"
+#include "test/test_zurcoin.h"
+#include "tinyformat.h"
+
+#include <univalue.h>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+namespace
+{
+void AppendChunk(std::vector<std::string>* pchunks, const std::string& data)
+{
+    pchunks->push_back(data);
+}
+
+/** Runs the streaming actor of a command, handing small chunks to the sink. */
+std::string CallStreamed(const std::string& strMethod, const UniValue& params, size_t& nChunks)
+{
+    const CRPCCommand* pcmd = tableRPC[strMethod];
+    BOOST_REQUIRE(pcmd && pcmd->streamActor);
+
+    std::vector<std::string> chunks;
+    JSONStreamWriter writer(boost::bind(&AppendChunk, &chunks, _1), 64);
+    (*pcmd->streamActor)(params, false, writer);
+    writer.Flush();
+
+    std::string str;
+    for (std::vector<std::string>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        str += *it;
+    }
+    nChunks = chunks.size();
+    return str;
+}
+
+UniValue Params(uint32_t propertyId, int64_t nCount, int64_t nSkip)
+{
+    UniValue params(UniValue::VARR);
+    params.push_back((int64_t) propertyId);
+    params.push_back(nCount);
+    params.push_back(nSkip);
+    return params;
+}
+}
+
+// the Zus state is initialized, when the genesis block is connected
+BOOST_FIXTURE_TEST_SUITE(zurbank_rpc_stream_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(getallbalancesforid_paginated)
+{
+    const uint32_t propertyId = 1;
+    const int nAddresses = 30;
+
+    UniValue params(UniValue::VARR);
+    params.push_back((int64_t) propertyId);
+
+    // the state of the genesis block may already hold balances
+    const int nBefore = tableRPC["zus_getallbalancesforid"]->actor(params, false).size();
+    {
+        LOCK(cs_tally);
+        for (int n = 0; n < nAddresses; ++n) {
+            std::string strAddress = strprintf("1StreamTest%02d", (n * 7) % nAddresses);
+            BOOST_CHECK(update_tally_map(strAddress, propertyId, 100000000LL + n, BALANCE));
+            if (n % 5 == 0) {
+                BOOST_CHECK(update_tally_map(strAddress, propertyId, n + 1, SELLOFFER_RESERVE));
+            }
+        }
+    }
+
+    // the streamed output is the same as the result built as UniValue
+    size_t nChunks = 0;
+    std::string strStreamed = CallStreamed("zus_getallbalancesforid", params, nChunks);
+    UniValue result = tableRPC["zus_getallbalancesforid"]->actor(params, false);
+    BOOST_CHECK(nChunks > 1);
+    BOOST_CHECK_EQUAL(strStreamed, result.write());
+    BOOST_CHECK_EQUAL(result.size(), (size_t) (nBefore + nAddresses));
+
+    // the balances are sorted by address, so that the pages concatenate to the whole list
+    UniValue concatenated(UniValue::VARR);
+    for (int64_t nSkip = 0; nSkip < nBefore + nAddresses + 10; nSkip += 7) {
+        std::string strPage = CallStreamed("zus_getallbalancesforid", Params(propertyId, 7, nSkip), nChunks);
+        UniValue page;
+        BOOST_CHECK(page.read(strPage));
+        BOOST_CHECK(page.size() <= 7);
+        for (size_t i = 0; i < page.size(); ++i) {
+            concatenated.push_back(page[i]);
+        }
+    }
+    BOOST_CHECK_EQUAL(concatenated.write(), result.write());
+    for (size_t i = 1; i < result.size(); ++i) {
+        BOOST_CHECK(result[i - 1]["address"].get_str() < result[i]["address"].get_str());
+    }
+
+    // an empty page is still a valid array
+    BOOST_CHECK_EQUAL(CallStreamed("zus_getallbalancesforid", Params(propertyId, 10, nBefore + nAddresses), nChunks), "[]");
+
+    {
+        LOCK(cs_tally);
+        for (int n = 0; n < nAddresses; ++n) {
+            std::string strAddress = strprintf("1StreamTest%02d", (n * 7) % nAddresses);
+            BOOST_CHECK(update_tally_map(strAddress, propertyId, -(100000000LL + n), BALANCE));
+            if (n % 5 == 0) {
+                BOOST_CHECK(update_tally_map(strAddress, propertyId, -(n + 1), SELLOFFER_RESERVE));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
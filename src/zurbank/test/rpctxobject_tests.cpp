@@ -0,0 +1,159 @@
+#include "zurbank/createpayload.h"
+#include "zurbank/dbtransaction.h"
+#include "zurbank/errors.h"
+#include "zurbank/parsing.h"
+#include "zurbank/rpctxobject.h"
+#include "zurbank/tally.h"
+#include "zurbank/tx.h"
+#include "zurbank/zurbank.h"
+
+#include "arith_uint256.h"
+#include "chain.h"
+#include "main.h"
+#include "sync.h"
+#include "test/test_zurcoin.h"
+#include "uint256.h"
+
+#include <univalue.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+namespace
+{
+/** Records the decoded fields of a simple send, as if it was processed in the block. */
+void RecordSimpleSend(const uint256& txid, const uint256& blockHash, int64_t amount)
+{
+    std::vector<unsigned char> payload = CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, amount);
+    CMPTransaction mp_obj;
+    mp_obj.Set("1Sender", "1Receiver", 0, txid, 0, 3, payload.data(), payload.size(), OMNI_CLASS_C, 1000);
+    BOOST_CHECK(mp_obj.interpret_Transaction());
+
+    LOCK(cs_tally);
+    pDbTransaction->RecordDecodedTransaction(mp_obj, blockHash, 0);
+}
+
+/** Returns the object of a transaction in basic mode. */
+UniValue Populate(const uint256& txid, int& rc, const std::string& filterAddress = "")
+{
+    UniValue txobj(UniValue::VOBJ);
+    rc = populateRPCTransactionObject(txid, txobj, filterAddress);
+    return txobj;
+}
+}
+
+// the Zus state is initialized, when the genesis block is connected
+BOOST_FIXTURE_TEST_SUITE(zurbank_rpctxobject_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(decoded_transaction_roundtrip)
+{
+    uint256 txid = ArithToUint256(arith_uint256(1001));
+    uint256 blockHash = ArithToUint256(arith_uint256(2002));
+    RecordSimpleSend(txid, blockHash, 150000000);
+
+    CDecodedTransaction decoded;
+    {
+        LOCK(cs_tally);
+        BOOST_CHECK(pDbTransaction->FetchDecodedTransaction(txid, decoded));
+        BOOST_CHECK(!pDbTransaction->FetchDecodedTransaction(blockHash, decoded));
+    }
+    BOOST_CHECK(decoded.blockHash == blockHash);
+    BOOST_CHECK_EQUAL(decoded.posInBlock, 3U);
+    BOOST_CHECK(decoded.isValid());
+    BOOST_CHECK_EQUAL(decoded.encodingClass, OMNI_CLASS_C);
+    BOOST_CHECK_EQUAL(decoded.sender, "1Sender");
+    BOOST_CHECK_EQUAL(decoded.reference, "1Receiver");
+    BOOST_CHECK_EQUAL(decoded.type, (uint32_t) MSC_TYPE_SIMPLE_SEND);
+    BOOST_CHECK_EQUAL(decoded.property, (uint32_t) OMNI_PROPERTY_MSC);
+    BOOST_CHECK_EQUAL(decoded.amount, 150000000);
+    BOOST_CHECK_EQUAL(decoded.fee, 1000);
+    BOOST_CHECK(decoded.payload == CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 150000000));
+}
+
+BOOST_AUTO_TEST_CASE(cache_eviction_and_generation)
+{
+    CRPCTransactionCache cache(3);
+    CRenderedTransaction rendered;
+    std::vector<uint256> vTxids;
+    for (int n = 0; n < 5; ++n) {
+        vTxids.push_back(ArithToUint256(arith_uint256(n + 1)));
+    }
+
+    for (int n = 0; n < 3; ++n) {
+        rendered.block = n;
+        cache.Add(vTxids[n], rendered, cache.GetGeneration());
+    }
+    BOOST_CHECK_EQUAL(cache.Size(), 3U);
+
+    // the least recently used transaction is dropped first
+    BOOST_CHECK(cache.Get(vTxids[0], rendered));
+    BOOST_CHECK_EQUAL(rendered.block, 0);
+    cache.Add(vTxids[3], rendered, cache.GetGeneration());
+    BOOST_CHECK_EQUAL(cache.Size(), 3U);
+    BOOST_CHECK(!cache.Get(vTxids[1], rendered));
+    BOOST_CHECK(cache.Get(vTxids[0], rendered));
+    BOOST_CHECK(cache.Get(vTxids[2], rendered));
+    BOOST_CHECK(cache.Get(vTxids[3], rendered));
+
+    // an object rendered before the cache was cleared is not added
+    uint64_t nGeneration = cache.GetGeneration();
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+    cache.Add(vTxids[4], rendered, nGeneration);
+    BOOST_CHECK(!cache.Get(vTxids[4], rendered));
+    cache.Add(vTxids[4], rendered, cache.GetGeneration());
+    BOOST_CHECK(cache.Get(vTxids[4], rendered));
+}
+
+BOOST_AUTO_TEST_CASE(decoded_object_cache_and_reorg)
+{
+    uint256 genesisHash;
+    {
+        LOCK(cs_main);
+        genesisHash = chainActive.Genesis()->GetBlockHash();
+    }
+    uint256 txid = ArithToUint256(arith_uint256(3003));
+    ClearRPCTransactionCache();
+    RecordSimpleSend(txid, genesisHash, 100000000);
+
+    // the object is rebuilt from the decoded fields
+    int rc = -1;
+    UniValue txobj = Populate(txid, rc);
+    BOOST_CHECK_EQUAL(rc, 0);
+    BOOST_CHECK_EQUAL(txobj["sendingaddress"].get_str(), "1Sender");
+    BOOST_CHECK_EQUAL(txobj["referenceaddress"].get_str(), "1Receiver");
+    BOOST_CHECK_EQUAL(txobj["amount"].get_str(), "1000.00000");
+    BOOST_CHECK_EQUAL(txobj["positioninblock"].get_int(), 3);
+    BOOST_CHECK_EQUAL(txobj["block"].get_int(), 0);
+    BOOST_CHECK_EQUAL(txobj["confirmations"].get_int(), 1);
+    BOOST_CHECK(txobj["valid"].get_bool());
+
+    // the address filter applies to cached objects
+    Populate(txid, rc, "1Other");
+    BOOST_CHECK_EQUAL(rc, -1);
+    Populate(txid, rc, "1Receiver");
+    BOOST_CHECK_EQUAL(rc, 0);
+
+    // the cached object is used, until the cache is cleared
+    RecordSimpleSend(txid, genesisHash, 200000000);
+    txobj = Populate(txid, rc);
+    BOOST_CHECK_EQUAL(rc, 0);
+    BOOST_CHECK_EQUAL(txobj["amount"].get_str(), "1000.00000");
+    ClearRPCTransactionCache();
+    txobj = Populate(txid, rc);
+    BOOST_CHECK_EQUAL(txobj["amount"].get_str(), "2000.00000");
+
+    // a record of a block, which is not in the active chain, is not used after a reorg
+    RecordSimpleSend(txid, ArithToUint256(arith_uint256(4004)), 300000000);
+    ClearRPCTransactionCache();
+    Populate(txid, rc);
+    BOOST_CHECK_EQUAL(rc, MP_TX_NOT_FOUND);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
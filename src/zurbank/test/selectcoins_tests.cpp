@@ -0,0 +1,111 @@
+#include "zurbank/walletutils.h"
+
+#include "base58.h"
+#include "coincontrol.h"
+#include "key.h"
+#include "main.h"
+#include "primitives/transaction.h"
+#include "random.h"
+#include "script/standard.h"
+#include "sync.h"
+#include "uint256.h"
+#ifdef ENABLE_WALLET
+#include "wallet/test/wallet_test_fixture.h"
+#include "wallet/wallet.h"
+#include "wallet/walletdb.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_WALLET
+using namespace mastercore;
+
+namespace
+{
+/** Adds a transaction, which pays 1 coin to every script, to the wallet. */
+uint256 AddWalletTx(const std::vector<CScript>& vScripts, bool fConfirmed)
+{
+    CMutableTransaction tx;
+    tx.vin.push_back(CTxIn(COutPoint(GetRandHash(), 0)));
+    for (std::vector<CScript>::const_iterator it = vScripts.begin(); it != vScripts.end(); ++it) {
+        tx.vout.push_back(CTxOut(COIN, *it));
+    }
+
+    CWalletTx wtx(pwalletMain, tx);
+    if (fConfirmed) {
+        LOCK(cs_main);
+        wtx.hashBlock = chainActive.Genesis()->GetBlockHash();
+        wtx.nIndex = 0;
+    }
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+    BOOST_CHECK(pwalletMain->AddToWallet(wtx, false, &walletdb));
+    return wtx.GetHash();
+}
+
+std::vector<COutPoint> ListSelected(const CCoinControl& coinControl)
+{
+    std::vector<COutPoint> vOutpts;
+    coinControl.ListSelected(vOutpts);
+    std::sort(vOutpts.begin(), vOutpts.end());
+    return vOutpts;
+}
+}
+
+BOOST_FIXTURE_TEST_SUITE(zurbank_selectcoins_tests, WalletTestingSetup)
+
+BOOST_AUTO_TEST_CASE(select_sender_outputs)
+{
+    CKey keySender, keyOther;
+    keySender.MakeNewKey(true);
+    keyOther.MakeNewKey(true);
+    {
+        LOCK(pwalletMain->cs_wallet);
+        BOOST_CHECK(pwalletMain->AddKeyPubKey(keySender, keySender.GetPubKey()));
+        BOOST_CHECK(pwalletMain->AddKeyPubKey(keyOther, keyOther.GetPubKey()));
+    }
+    const std::string strSender = CBitcoinAddress(keySender.GetPubKey().GetID()).ToString();
+    CScript scriptSender = GetScriptForDestination(keySender.GetPubKey().GetID());
+    CScript scriptOther = GetScriptForDestination(keyOther.GetPubKey().GetID());
+
+    std::vector<CScript> vScripts;
+    vScripts.push_back(scriptOther);
+    vScripts.push_back(scriptSender);
+    vScripts.push_back(scriptSender);
+    uint256 hashConfirmed = AddWalletTx(vScripts, true);
+    // unconfirmed outputs from others are not trusted
+    AddWalletTx(std::vector<CScript>(1, scriptSender), false);
+
+    // only the confirmed outputs of the sender are used
+    CCoinControl coinControl;
+    BOOST_CHECK_EQUAL(SelectAllCoins(strSender, coinControl), 2 * COIN);
+    std::vector<COutPoint> vExpected;
+    vExpected.push_back(COutPoint(hashConfirmed, 1));
+    vExpected.push_back(COutPoint(hashConfirmed, 2));
+    BOOST_CHECK(ListSelected(coinControl) == vExpected);
+
+    // the selection stops, once the fees are covered
+    coinControl.SetNull();
+    BOOST_CHECK_EQUAL(SelectCoins(strSender, coinControl, 0), COIN);
+    BOOST_CHECK_EQUAL(ListSelected(coinControl).size(), 1U);
+    coinControl.SetNull();
+    BOOST_CHECK_EQUAL(SelectCoins(strSender, coinControl, COIN), 2 * COIN);
+
+    // locked coins are skipped
+    {
+        LOCK(pwalletMain->cs_wallet);
+        pwalletMain->LockCoin(COutPoint(hashConfirmed, 1));
+    }
+    coinControl.SetNull();
+    BOOST_CHECK_EQUAL(SelectAllCoins(strSender, coinControl), COIN);
+    vExpected.assign(1, COutPoint(hashConfirmed, 2));
+    BOOST_CHECK(ListSelected(coinControl) == vExpected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+#endif // ENABLE_WALLET
@@ -0,0 +1,166 @@
+#include "zurbank/sto.h"
+
+#include "zurbank/tally.h"
+#include "zurbank/zurbank.h"
+
+#include "test/test_zurcoin.h"
+#include "util.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern std::map<std::string, std::string> mapArgs;
+
+using namespace mastercore;
+
+namespace
+{
+const uint32_t STO_TEST_PROPERTY = TEST_ECO_PROPERTY_1 + 100;
+
+/** Credits the holders, and debits them again, when it goes out of scope. */
+class HolderSetup
+{
+private:
+    struct CHolding
+    {
+        std::string address;
+        int64_t amount;
+        TallyType ttype;
+    };
+    std::vector<CHolding> vHoldings;
+
+public:
+    void Add(const std::string& address, int64_t amount, TallyType ttype = BALANCE)
+    {
+        BOOST_CHECK(update_tally_map(address, STO_TEST_PROPERTY, amount, ttype));
+        CHolding holding = {address, amount, ttype};
+        vHoldings.push_back(holding);
+    }
+
+    ~HolderSetup()
+    {
+        for (size_t i = 0; i < vHoldings.size(); ++i) {
+            update_tally_map(vHoldings[i].address, STO_TEST_PROPERTY, -vHoldings[i].amount, vHoldings[i].ttype);
+        }
+    }
+};
+
+/** Determines the receivers with the given number of threads. */
+OwnerAddrType GetReceivers(const std::string& sender, int64_t amount, int nThreads)
+{
+    std::map<std::string, std::string> mapArgsOriginal = mapArgs;
+    mapArgs["-omnithreads"] = strprintf("%d", nThreads);
+    OwnerAddrType receivers = STO_GetReceivers(sender, STO_TEST_PROPERTY, amount);
+    mapArgs = mapArgsOriginal;
+    return receivers;
+}
+
+int64_t SumOf(const OwnerAddrType& receivers)
+{
+    int64_t nSum = 0;
+    for (size_t i = 0; i < receivers.size(); ++i) {
+        nSum += receivers[i].first;
+    }
+    return nSum;
+}
+}
+
+// STO_GetReceivers() logs a summary, so the full setup is used
+BOOST_FIXTURE_TEST_SUITE(zurbank_sto_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(receivers_serial)
+{
+    HolderSetup holders;
+    holders.Add("1StoSender", 100);
+    holders.Add("1StoA", 40);
+    holders.Add("1StoA", 10, METADEX_RESERVE);
+    holders.Add("1StoB", 30);
+    holders.Add("1StoC", 20);
+
+    // the sender is excluded, and the shares are proportional
+    OwnerAddrType receivers = GetReceivers("1StoSender", 10, 1);
+    BOOST_CHECK_EQUAL(receivers.size(), 3U);
+    BOOST_CHECK(receivers[0] == std::make_pair(int64_t(2), std::string("1StoC")));
+    BOOST_CHECK(receivers[1] == std::make_pair(int64_t(3), std::string("1StoB")));
+    BOOST_CHECK(receivers[2] == std::make_pair(int64_t(5), std::string("1StoA")));
+
+    // the shares are rounded up, and the distribution stops, once the amount is used up
+    receivers = GetReceivers("1StoSender", 7, 1);
+    BOOST_CHECK_EQUAL(receivers.size(), 2U);
+    BOOST_CHECK(receivers[0] == std::make_pair(int64_t(3), std::string("1StoB")));
+    BOOST_CHECK(receivers[1] == std::make_pair(int64_t(4), std::string("1StoA")));
+
+    // the last receiver gets the remainder only
+    receivers = GetReceivers("1StoSender", 9, 1);
+    BOOST_CHECK_EQUAL(receivers.size(), 3U);
+    BOOST_CHECK(receivers[0] == std::make_pair(int64_t(1), std::string("1StoC")));
+    BOOST_CHECK(receivers[1] == std::make_pair(int64_t(3), std::string("1StoB")));
+    BOOST_CHECK(receivers[2] == std::make_pair(int64_t(5), std::string("1StoA")));
+
+    // nothing is distributed for a zero amount
+    BOOST_CHECK(GetReceivers("1StoSender", 0, 1).empty());
+}
+
+BOOST_AUTO_TEST_CASE(receivers_equal_holdings)
+{
+    HolderSetup holders;
+    holders.Add("1StoX", 10);
+    holders.Add("1StoY", 10);
+    holders.Add("1StoZ", 10);
+
+    // equal holders are visited by address, and the result lists the larger address first
+    OwnerAddrType receivers = GetReceivers("1StoSender", 3, 1);
+    BOOST_CHECK_EQUAL(receivers.size(), 3U);
+    BOOST_CHECK(receivers[0] == std::make_pair(int64_t(1), std::string("1StoZ")));
+    BOOST_CHECK(receivers[1] == std::make_pair(int64_t(1), std::string("1StoY")));
+    BOOST_CHECK(receivers[2] == std::make_pair(int64_t(1), std::string("1StoX")));
+
+    receivers = GetReceivers("1StoSender", 2, 1);
+    BOOST_CHECK_EQUAL(receivers.size(), 2U);
+    BOOST_CHECK(receivers[0] == std::make_pair(int64_t(1), std::string("1StoY")));
+    BOOST_CHECK(receivers[1] == std::make_pair(int64_t(1), std::string("1StoX")));
+}
+
+BOOST_AUTO_TEST_CASE(receivers_parallel)
+{
+    const int nHolders = STO_PARALLEL_MIN_HOLDERS + 2000;
+    HolderSetup holders;
+    for (int n = 1; n <= nHolders; ++n) {
+        holders.Add(strprintf("1StoHolder%d", n), n);
+    }
+
+    // the result doesn't depend on the number of threads
+    const int64_t amounts[] = {1, 1000, 1000000, 72006000, 100000000};
+    for (size_t i = 0; i < sizeof(amounts) / sizeof(amounts[0]); ++i) {
+        OwnerAddrType serial = GetReceivers("1StoSender", amounts[i], 1);
+        OwnerAddrType parallel = GetReceivers("1StoSender", amounts[i], 4);
+        BOOST_CHECK(serial == parallel);
+        BOOST_CHECK(parallel == GetReceivers("1StoSender", amounts[i], STO_MAX_THREADS + 1));
+
+        // the receivers are sorted, and never get more than the amount
+        BOOST_CHECK(std::is_sorted(parallel.begin(), parallel.end(), SendToOwners_compare()));
+        BOOST_CHECK(SumOf(parallel) <= amounts[i]);
+    }
+
+    // the shares are rounded up, so the smallest holders get nothing
+    OwnerAddrType receivers = GetReceivers("1StoSender", 1000000, 4);
+    BOOST_CHECK_EQUAL(SumOf(receivers), 1000000);
+    BOOST_CHECK(receivers.size() < (size_t) nHolders);
+    BOOST_CHECK(std::find(receivers.begin(), receivers.end(),
+            std::make_pair(int64_t(167), strprintf("1StoHolder%d", nHolders))) != receivers.end());
+
+    // the total of 72006000 tokens is distributed exactly
+    receivers = GetReceivers("1StoSender", 72006000, 4);
+    BOOST_CHECK_EQUAL(receivers.size(), (size_t) nHolders);
+    BOOST_CHECK_EQUAL(SumOf(receivers), 72006000);
+    BOOST_CHECK(receivers.front() == std::make_pair(int64_t(1), std::string("1StoHolder1")));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,252 @@
+#include "zurbank/dbtradelist.h"
+#include "zurbank/tradearchive.h"
+
+#include "arith_uint256.h"
+#include "test/test_zurcoin.h"
+#include "tinyformat.h"
+#include "uint256.h"
+
+#include <univalue.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+/** Records a trade of 1 and 2 in every second block, and of 1 and 3 in every tenth block. */
+void RecordTrades(CMPTradeList& tradeList, int nFirstBlock, int nLastBlock)
+{
+    for (int nBlock = nFirstBlock; nBlock <= nLastBlock; ++nBlock) {
+        uint256 txid1 = ArithToUint256(arith_uint256(nBlock * 2));
+        uint256 txid2 = ArithToUint256(arith_uint256(nBlock * 2 + 1));
+        if (nBlock % 2 == 0) {
+            tradeList.recordMatchedTrade(txid1, txid2, "1Seller", "1Buyer", 2, 1, nBlock * 10, nBlock, nBlock, 1);
+        }
+        if (nBlock % 10 == 0) {
+            tradeList.recordMatchedTrade(txid2, txid1, "1Other", "1Seller", 1, 3, 100, 200, nBlock, 0);
+        }
+    }
+}
+
+/** Returns the blocks and amounts of the trades of a pair. */
+std::string DumpTrades(const CMPTradeList& tradeList, uint32_t propertyIdSideA, uint32_t propertyIdSideB, int nFirstBlock, int nLastBlock)
+{
+    std::vector<CMPMatchedTrade> vTrades;
+    tradeList.getTradesForPair(propertyIdSideA, propertyIdSideB, nFirstBlock, nLastBlock, vTrades);
+    std::string str;
+    for (std::vector<CMPMatchedTrade>::const_iterator it = vTrades.begin(); it != vTrades.end(); ++it) {
+        str += strprintf("%d:%d:%d ", it->block, it->amount1, it->amount2);
+    }
+    return str;
+}
+}
+
+BOOST_FIXTURE_TEST_SUITE(zurbank_tradearchive_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(segment_roundtrip)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    std::vector<CMPMatchedTrade> vTrades;
+    for (int n = 0; n < 50; ++n) {
+        CMPMatchedTrade trade;
+        trade.txid1 = ArithToUint256(arith_uint256(n + 1));
+        trade.txid2 = ArithToUint256(arith_uint256(n + 1000));
+        trade.address1 = (n % 3 == 0) ? "1AddressA" : "1AddressB";
+        trade.address2 = "1AddressC";
+        trade.prop1 = 3 + n % 2;
+        trade.prop2 = 1;
+        trade.amount1 = 5000000000LL * n;
+        trade.amount2 = n;
+        trade.block = 100 + n / 4;
+        trade.fee = n % 5;
+        vTrades.push_back(trade);
+    }
+    {
+        CMPTradeArchive archive(path, true);
+        CMPTradeSegment segment;
+        BOOST_CHECK(archive.WriteSegment(vTrades, 90, 120, segment));
+        archive.AddSegment(segment);
+        BOOST_CHECK_EQUAL(archive.GetArchivedHeight(), 120);
+        BOOST_CHECK_EQUAL(archive.GetTradeCount(), 50U);
+        BOOST_CHECK(segment.HasPair(1, 3));
+        BOOST_CHECK(segment.HasPair(4, 1));
+        BOOST_CHECK(!segment.HasPair(3, 4));
+
+        // unordered trades are rejected
+        std::vector<CMPMatchedTrade> vUnordered(vTrades.rbegin(), vTrades.rend());
+        BOOST_CHECK(!archive.WriteSegment(vUnordered, 121, 130, segment));
+    }
+    {
+        // the segments are loaded when the archive is opened
+        CMPTradeArchive archive(path, false);
+        BOOST_CHECK_EQUAL(archive.GetSegments().size(), 1U);
+        std::vector<CMPMatchedTrade> vRead;
+        BOOST_CHECK(archive.ReadSegment(archive.GetSegments()[0], vRead, true));
+        BOOST_CHECK_EQUAL(vRead.size(), vTrades.size());
+        for (size_t n = 0; n < vRead.size() && n < vTrades.size(); ++n) {
+            BOOST_CHECK_EQUAL(vRead[n].GetKey(), vTrades[n].GetKey());
+            BOOST_CHECK_EQUAL(vRead[n].address1, vTrades[n].address1);
+            BOOST_CHECK_EQUAL(vRead[n].address2, vTrades[n].address2);
+            BOOST_CHECK_EQUAL(vRead[n].prop1, vTrades[n].prop1);
+            BOOST_CHECK_EQUAL(vRead[n].prop2, vTrades[n].prop2);
+            BOOST_CHECK_EQUAL(vRead[n].amount1, vTrades[n].amount1);
+            BOOST_CHECK_EQUAL(vRead[n].amount2, vTrades[n].amount2);
+            BOOST_CHECK_EQUAL(vRead[n].block, vTrades[n].block);
+            BOOST_CHECK_EQUAL(vRead[n].fee, vTrades[n].fee);
+        }
+
+        // without details, the addresses and hashes are not decoded
+        vRead.clear();
+        BOOST_CHECK(archive.ReadSegment(archive.GetSegments()[0], vRead, false));
+        BOOST_CHECK_EQUAL(vRead.size(), vTrades.size());
+        BOOST_CHECK_EQUAL(vRead.back().amount1, vTrades.back().amount1);
+        BOOST_CHECK(vRead.back().txid1.IsNull());
+        BOOST_CHECK(vRead.back().address1.empty());
+
+        // the trades before the block are restored, when the archive is truncated
+        std::vector<CMPMatchedTrade> vTail;
+        BOOST_CHECK(archive.ReadTail(105, vTail));
+        BOOST_CHECK_EQUAL(vTail.size(), 20U);
+        archive.Truncate(105);
+        BOOST_CHECK_EQUAL(archive.GetArchivedHeight(), -1);
+        BOOST_CHECK(archive.GetSegments().empty());
+    }
+    boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(archive_and_rewind)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CMPTradeList tradeList(path, true);
+        RecordTrades(tradeList, 1, 100);
+        std::string strBefore = DumpTrades(tradeList, 1, 2, 0, 1000);
+        int nTotal = tradeList.getMPTradeCountTotal();
+        BOOST_CHECK_EQUAL(nTotal, 60);
+
+        // trades up to block 50 are moved into the archive
+        BOOST_CHECK_EQUAL(tradeList.archiveTrades(50), 30);
+        BOOST_CHECK_EQUAL(tradeList.getArchivedHeight(), 50);
+        BOOST_CHECK_EQUAL(tradeList.getMPTradeCountTotal(), nTotal);
+        BOOST_CHECK_EQUAL(DumpTrades(tradeList, 1, 2, 0, 1000), strBefore);
+        BOOST_CHECK_EQUAL(DumpTrades(tradeList, 2, 1, 48, 52), "48:480:48 50:500:50 52:520:52 ");
+        BOOST_CHECK_EQUAL(DumpTrades(tradeList, 1, 3, 0, 30), "10:100:200 20:100:200 30:100:200 ");
+
+        // nothing left to archive
+        BOOST_CHECK_EQUAL(tradeList.archiveTrades(50), 0);
+        BOOST_CHECK_EQUAL(tradeList.archiveTrades(80), 18);
+        BOOST_CHECK_EQUAL(tradeList.getArchivedHeight(), 80);
+
+        // rewinding into the archive restores the earlier trades of the segment
+        tradeList.deleteAboveBlock(61);
+        BOOST_CHECK_EQUAL(tradeList.getArchivedHeight(), 50);
+        BOOST_CHECK_EQUAL(tradeList.getMPTradeCountTotal(), 36);
+        BOOST_CHECK_EQUAL(DumpTrades(tradeList, 1, 3, 40, 1000), "40:100:200 50:100:200 60:100:200 ");
+
+        // and processing the blocks again yields the same trades
+        RecordTrades(tradeList, 61, 100);
+        BOOST_CHECK_EQUAL(tradeList.getMPTradeCountTotal(), nTotal);
+        BOOST_CHECK_EQUAL(DumpTrades(tradeList, 1, 2, 0, 1000), strBefore);
+    }
+    {
+        // the archive persists
+        CMPTradeList tradeList(path, false);
+        BOOST_CHECK_EQUAL(tradeList.getArchivedHeight(), 50);
+        BOOST_CHECK_EQUAL(tradeList.getMPTradeCountTotal(), 60);
+
+        // and is cleared with the database
+        tradeList.Clear();
+        BOOST_CHECK_EQUAL(tradeList.getArchivedHeight(), -1);
+        BOOST_CHECK_EQUAL(tradeList.getMPTradeCountTotal(), 0);
+    }
+    boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(rewind_with_damaged_archive)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CMPTradeList tradeList(path, true);
+        RecordTrades(tradeList, 1, 100);
+        BOOST_CHECK_EQUAL(tradeList.archiveTrades(50), 30);
+
+        // the trades of the segment can't be restored, so the archive is kept for a reparse
+        boost::filesystem::directory_iterator end;
+        for (boost::filesystem::directory_iterator it(path / "archive"); it != end; ++it) {
+            boost::filesystem::resize_file(it->path(), 16);
+        }
+        BOOST_CHECK_EQUAL(tradeList.deleteAboveBlock(41), -1);
+        BOOST_CHECK_EQUAL(tradeList.getArchivedHeight(), 50);
+    }
+    boost::filesystem::remove_all(path);
+}
+
+// the amounts are formatted based on the properties, which requires the full setup
+BOOST_FIXTURE_TEST_CASE(matching_trades_by_txid, TestingSetup)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CMPTradeList tradeList(path, true);
+        RecordTrades(tradeList, 1, 100);
+        uint256 txid = ArithToUint256(arith_uint256(80));
+        tradeList.recordNewTrade(txid, "1Seller", 2, 1, 40, 1);
+
+        // the trade is the first side of one match, and the second side of another one
+        for (int n = 0; n < 2; ++n) {
+            UniValue tradeArray(UniValue::VARR);
+            int64_t totalSold = 0;
+            int64_t totalReceived = 0;
+            BOOST_CHECK_EQUAL(tradeList.getMatchingTrades(txid, 2, tradeArray, totalSold, totalReceived), 2);
+            BOOST_CHECK_EQUAL(tradeArray.size(), 2U);
+            BOOST_CHECK_EQUAL(totalSold, 600);
+            BOOST_CHECK_EQUAL(totalReceived, 140);
+
+            // the same trades are found in the archive
+            BOOST_CHECK(n > 0 || tradeList.archiveTrades(50) == 30);
+        }
+
+        // the index entries are removed with the trades
+        BOOST_CHECK_EQUAL(tradeList.deleteAboveBlock(1), 31);
+        UniValue tradeArray(UniValue::VARR);
+        int64_t totalSold = 0;
+        int64_t totalReceived = 0;
+        BOOST_CHECK_EQUAL(tradeList.getMatchingTrades(txid, 2, tradeArray, totalSold, totalReceived), 0);
+        BOOST_CHECK_EQUAL(tradeList.getMPTradeCountTotal(), 0);
+    }
+    boost::filesystem::remove_all(path);
+}
+
+BOOST_FIXTURE_TEST_CASE(unreadable_archive, TestingSetup)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CMPTradeList tradeList(path, true);
+        RecordTrades(tradeList, 1, 100);
+        BOOST_CHECK_EQUAL(tradeList.archiveTrades(50), 30);
+        boost::filesystem::directory_iterator end;
+        for (boost::filesystem::directory_iterator it(path / "archive"); it != end; ++it) {
+            boost::filesystem::resize_file(it->path(), 16);
+        }
+
+        // the archived trades are not silently skipped
+        std::vector<CMPMatchedTrade> vTrades;
+        BOOST_CHECK(!tradeList.getTradesForPair(1, 2, 0, 1000, vTrades));
+        BOOST_CHECK(!tradeList.getRecentTradesForPair(1, 2, 10, 0, vTrades));
+        UniValue tradeArray(UniValue::VARR);
+        int64_t totalSold = 0;
+        int64_t totalReceived = 0;
+        BOOST_CHECK_EQUAL(tradeList.getMatchingTrades(ArithToUint256(arith_uint256(80)), 2, tradeArray, totalSold, totalReceived), -1);
+
+        // while recent trades, which are not archived, can still be selected
+        BOOST_CHECK(tradeList.getTradesForPair(1, 2, 51, 1000, vTrades));
+        BOOST_CHECK_EQUAL(vTrades.size(), 25U);
+    }
+    boost::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+#include "zurbank/wallettxbuilder.h"
+
+#include "zurbank/createpayload.h"
+#include "zurbank/errors.h"
+#include "zurbank/zurbank.h"
+
+#include "base58.h"
+#include "core_io.h"
+#include "key.h"
+#include "main.h"
+#include "primitives/transaction.h"
+#include "random.h"
+#include "script/standard.h"
+#include "sync.h"
+#include "uint256.h"
+#ifdef ENABLE_WALLET
+#include "wallet/test/wallet_test_fixture.h"
+#include "wallet/wallet.h"
+#include "wallet/walletdb.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_WALLET
+using namespace mastercore;
+
+BOOST_FIXTURE_TEST_SUITE(zurbank_wallettxbuilder_tests, WalletTestingSetup)
+
+BOOST_AUTO_TEST_CASE(batch_without_commit)
+{
+    CKey keySender;
+    keySender.MakeNewKey(true);
+    {
+        LOCK(pwalletMain->cs_wallet);
+        BOOST_CHECK(pwalletMain->AddKeyPubKey(keySender, keySender.GetPubKey()));
+    }
+    const std::string strSender = CBitcoinAddress(keySender.GetPubKey().GetID()).ToString();
+
+    // a confirmed transaction with more outputs of the sender than fit into one chunk
+    const size_t nOutputs = MAX_WALLET_TX_BATCH_CHUNK + 10;
+    CMutableTransaction tx;
+    tx.vin.push_back(CTxIn(COutPoint(GetRandHash(), 0)));
+    tx.vout.resize(nOutputs, CTxOut(COIN, GetScriptForDestination(keySender.GetPubKey().GetID())));
+    CWalletTx wtx(pwalletMain, tx);
+    {
+        LOCK(cs_main);
+        wtx.hashBlock = chainActive.Genesis()->GetBlockHash();
+        wtx.nIndex = 0;
+    }
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+    BOOST_CHECK(pwalletMain->AddToWallet(wtx, false, &walletdb));
+
+    // every output is spent once, and the last request finds none left
+    CWalletTxRequest request;
+    request.senderAddress = strSender;
+    request.payload = CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 1);
+    std::vector<CWalletTxRequest> requests(nOutputs + 1, request);
+    BOOST_CHECK_EQUAL(WalletTxBuilder(requests, false), (int) nOutputs);
+
+    std::set<COutPoint> setSpent;
+    for (size_t i = 0; i < nOutputs; ++i) {
+        BOOST_CHECK_EQUAL(requests[i].result, 0);
+        BOOST_CHECK(requests[i].txid.IsNull());
+        CTransaction txCreated;
+        BOOST_CHECK(DecodeHexTx(txCreated, requests[i].rawTx));
+        for (size_t n = 0; n < txCreated.vin.size(); ++n) {
+            BOOST_CHECK(setSpent.insert(txCreated.vin[n].prevout).second);
+        }
+    }
+    BOOST_CHECK_EQUAL(setSpent.size(), nOutputs);
+    BOOST_CHECK_EQUAL(requests[nOutputs].result, MP_ERR_INPUTSELECT_FAIL);
+    BOOST_CHECK(requests[nOutputs].rawTx.empty());
+
+    // the inputs are only locked for the duration of the batch
+    std::vector<COutPoint> vLocked;
+    {
+        LOCK(pwalletMain->cs_wallet);
+        pwalletMain->ListLockedCoins(vLocked);
+    }
+    BOOST_CHECK(vLocked.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+#endif // ENABLE_WALLET
@@ -0,0 +1,406 @@
+#include "zurbank/tradearchive.h"
+
+#include "zurbank/log.h"
+
+#include "clientversion.h"
+#include "crypto/common.h"
+#include "hash.h"
+#include "serialize.h"
+#include "streams.h"
+#include "tinyformat.h"
+#include "uint256.h"
+#include "util.h"
+
+#include <boost/filesystem.hpp>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! Identifies segment files of the trade archive
+static const uint32_t SEGMENT_MAGIC = 0x5a545341;
+static const unsigned char SEGMENT_VERSION = 1;
+
+/** The columns of a segment, in the order they are stored. */
+enum SegmentColumn
+{
+    COLUMN_BLOCK = 0,
+    COLUMN_PROP1,
+    COLUMN_PROP2,
+    COLUMN_AMOUNT1,
+    COLUMN_AMOUNT2,
+    COLUMN_FEE,
+    COLUMN_ADDRESS1,
+    COLUMN_ADDRESS2,
+    COLUMN_DICTIONARY,
+    COLUMN_TXID1,
+    COLUMN_TXID2,
+    COLUMN_COUNT
+};
+
+//! The columns needed for queries without details
+static const int COLUMNS_AMOUNTS = COLUMN_AMOUNT2 + 1;
+
+std::string CMPMatchedTrade::GetKey() const
+{
+    return txid1.ToString() + "+" + txid2.ToString();
+}
+
+bool CMPTradeSegment::HasPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB) const
+{
+    for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = vPairs.begin(); it != vPairs.end(); ++it) {
+        if (it->first == propertyIdSideA && it->second == propertyIdSideB) return true;
+        if (it->first == propertyIdSideB && it->second == propertyIdSideA) return true;
+    }
+    return false;
+}
+
+static void WriteColumnValue(CDataStream& stream, uint64_t value)
+{
+    WriteVarInt<CDataStream, uint64_t>(stream, value);
+}
+
+static uint64_t ReadColumnValue(CDataStream& stream)
+{
+    return ReadVarInt<CDataStream, uint64_t>(stream);
+}
+
+/** Returns the checksum of a column, the first four bytes of its hash. */
+static uint32_t ColumnChecksum(const char* pbegin, const char* pend)
+{
+    uint256 hash = Hash(pbegin, pend);
+    return ReadLE32(hash.begin());
+}
+
+static uint32_t ColumnChecksum(const CDataStream& column)
+{
+    if (column.empty()) return ColumnChecksum(NULL, NULL);
+    return ColumnChecksum(&column.begin()[0], &column.begin()[0] + column.size());
+}
+
+/** The decoded header of a segment file. */
+struct SegmentHeader
+{
+    CMPTradeSegment info;
+    std::vector<uint64_t> vColumnSizes;
+    std::vector<uint32_t> vColumnChecksums;
+};
+
+/** Reads the header, after which the file is positioned at the first column. */
+static bool ReadSegmentHeader(FILE* file, SegmentHeader& header)
+{
+    unsigned char sizeBytes[4];
+    if (fread(sizeBytes, 1, sizeof(sizeBytes), file) != sizeof(sizeBytes)) return false;
+    uint32_t nHeaderSize = ReadLE32(sizeBytes);
+    if (nHeaderSize > MAX_SIZE) return false;
+
+    std::vector<char> vHeader(nHeaderSize);
+    if (nHeaderSize > 0 && fread(&vHeader[0], 1, nHeaderSize, file) != nHeaderSize) return false;
+
+    try {
+        CDataStream stream(vHeader, SER_DISK, CLIENT_VERSION);
+        uint32_t nMagic = 0;
+        unsigned char nVersion = 0;
+        stream >> nMagic >> nVersion;
+        if (nMagic != SEGMENT_MAGIC || nVersion != SEGMENT_VERSION) return false;
+
+        header.info.nTrades = ReadColumnValue(stream);
+        header.info.nFirstBlock = ReadColumnValue(stream);
+        header.info.nLastBlock = ReadColumnValue(stream);
+        uint64_t nPairs = ReadColumnValue(stream);
+        header.info.vPairs.clear();
+        for (uint64_t n = 0; n < nPairs; ++n) {
+            uint32_t prop1 = ReadColumnValue(stream);
+            uint32_t prop2 = ReadColumnValue(stream);
+            header.info.vPairs.push_back(std::make_pair(prop1, prop2));
+        }
+        uint64_t nColumns = ReadColumnValue(stream);
+        if (nColumns != COLUMN_COUNT) return false;
+        header.vColumnSizes.resize(COLUMN_COUNT);
+        header.vColumnChecksums.resize(COLUMN_COUNT);
+        for (int n = 0; n < COLUMN_COUNT; ++n) {
+            header.vColumnSizes[n] = ReadColumnValue(stream);
+            stream >> header.vColumnChecksums[n];
+        }
+    } catch (const std::exception& e) {
+        PrintToLog("%s(): failed to decode segment header: %s\n", __func__, e.what());
+        return false;
+    }
+
+    return true;
+}
+
+CMPTradeArchive::CMPTradeArchive(const boost::filesystem::path& path, bool fWipe) : pathArchive(path)
+{
+    if (fWipe && boost::filesystem::exists(pathArchive)) boost::filesystem::remove_all(pathArchive);
+    boost::filesystem::create_directories(pathArchive);
+
+    boost::filesystem::directory_iterator end;
+    for (boost::filesystem::directory_iterator it(pathArchive); it != end; ++it) {
+        const boost::filesystem::path& pathFile = it->path();
+        if (pathFile.extension() == ".tmp") {
+            // left over from an interrupted compaction
+            boost::filesystem::remove(pathFile);
+            continue;
+        }
+        if (pathFile.extension() != ".seg") continue;
+        CMPTradeSegment segment;
+        if (!LoadSegmentInfo(pathFile, segment)) {
+            PrintToLog("%s(): ERROR: ignoring invalid trade segment %s\n", __func__, pathFile.string());
+            continue;
+        }
+        vSegments.push_back(segment);
+    }
+
+    struct CompareByFirstBlock {
+        bool operator()(const CMPTradeSegment& lhs, const CMPTradeSegment& rhs) const { return lhs.nFirstBlock < rhs.nFirstBlock; }
+    };
+    std::sort(vSegments.begin(), vSegments.end(), CompareByFirstBlock());
+}
+
+bool CMPTradeArchive::LoadSegmentInfo(const boost::filesystem::path& path, CMPTradeSegment& segment) const
+{
+    FILE* file = fopen(path.string().c_str(), "rb");
+    if (!file) return false;
+    SegmentHeader header;
+    bool fSuccess = ReadSegmentHeader(file, header);
+    fclose(file);
+    if (!fSuccess) return false;
+
+    segment = header.info;
+    segment.path = path;
+    return true;
+}
+
+int CMPTradeArchive::GetArchivedHeight() const
+{
+    if (vSegments.empty()) return -1;
+    return vSegments.back().nLastBlock;
+}
+
+uint64_t CMPTradeArchive::GetTradeCount() const
+{
+    uint64_t nTrades = 0;
+    for (std::vector<CMPTradeSegment>::const_iterator it = vSegments.begin(); it != vSegments.end(); ++it) {
+        nTrades += it->nTrades;
+    }
+    return nTrades;
+}
+
+bool CMPTradeArchive::WriteSegment(const std::vector<CMPMatchedTrade>& vTrades, int nFirstBlock, int nLastBlock, CMPTradeSegment& segment) const
+{
+    std::vector<CDataStream> vColumns(COLUMN_COUNT, CDataStream(SER_DISK, CLIENT_VERSION));
+    std::map<std::string, uint32_t> mapAddressIds;
+    std::vector<std::string> vAddresses;
+    std::set<std::pair<uint32_t, uint32_t> > setPairs;
+
+    int nPrevBlock = nFirstBlock;
+    for (std::vector<CMPMatchedTrade>::const_iterator it = vTrades.begin(); it != vTrades.end(); ++it) {
+        const CMPMatchedTrade& trade = *it;
+        if (trade.block < nPrevBlock || trade.block > nLastBlock || trade.amount1 < 0 || trade.amount2 < 0 || trade.fee < 0) {
+            PrintToLog("%s(): ERROR: trade %s can't be archived in blocks %d to %d\n", __func__, trade.GetKey(), nFirstBlock, nLastBlock);
+            return false;
+        }
+        WriteColumnValue(vColumns[COLUMN_BLOCK], trade.block - nPrevBlock);
+        nPrevBlock = trade.block;
+        WriteColumnValue(vColumns[COLUMN_PROP1], trade.prop1);
+        WriteColumnValue(vColumns[COLUMN_PROP2], trade.prop2);
+        WriteColumnValue(vColumns[COLUMN_AMOUNT1], trade.amount1);
+        WriteColumnValue(vColumns[COLUMN_AMOUNT2], trade.amount2);
+        WriteColumnValue(vColumns[COLUMN_FEE], trade.fee);
+
+        const std::string* addresses[2] = { &trade.address1, &trade.address2 };
+        for (int n = 0; n < 2; ++n) {
+            std::map<std::string, uint32_t>::iterator itId = mapAddressIds.find(*addresses[n]);
+            if (itId == mapAddressIds.end()) {
+                itId = mapAddressIds.insert(std::make_pair(*addresses[n], (uint32_t) vAddresses.size())).first;
+                vAddresses.push_back(*addresses[n]);
+            }
+            WriteColumnValue(vColumns[n == 0 ? COLUMN_ADDRESS1 : COLUMN_ADDRESS2], itId->second);
+        }
+
+        vColumns[COLUMN_TXID1] << trade.txid1;
+        vColumns[COLUMN_TXID2] << trade.txid2;
+        setPairs.insert(std::make_pair(trade.prop1, trade.prop2));
+    }
+    vColumns[COLUMN_DICTIONARY] << vAddresses;
+
+    segment.nFirstBlock = nFirstBlock;
+    segment.nLastBlock = nLastBlock;
+    segment.nTrades = vTrades.size();
+    segment.vPairs.assign(setPairs.begin(), setPairs.end());
+    segment.path = pathArchive / strprintf("trades-%08d-%08d.seg", nFirstBlock, nLastBlock);
+
+    CDataStream header(SER_DISK, CLIENT_VERSION);
+    header << SEGMENT_MAGIC << SEGMENT_VERSION;
+    WriteColumnValue(header, segment.nTrades);
+    WriteColumnValue(header, segment.nFirstBlock);
+    WriteColumnValue(header, segment.nLastBlock);
+    WriteColumnValue(header, segment.vPairs.size());
+    for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = segment.vPairs.begin(); it != segment.vPairs.end(); ++it) {
+        WriteColumnValue(header, it->first);
+        WriteColumnValue(header, it->second);
+    }
+    WriteColumnValue(header, COLUMN_COUNT);
+    for (int n = 0; n < COLUMN_COUNT; ++n) {
+        WriteColumnValue(header, vColumns[n].size());
+        header << ColumnChecksum(vColumns[n]);
+    }
+
+    // write into a temporary file, which is renamed, once it's complete
+    boost::filesystem::path pathTmp = segment.path;
+    pathTmp.replace_extension(".tmp");
+    FILE* file = fopen(pathTmp.string().c_str(), "wb");
+    if (!file) {
+        PrintToLog("%s(): ERROR: failed to create %s\n", __func__, pathTmp.string());
+        return false;
+    }
+    unsigned char sizeBytes[4];
+    WriteLE32(sizeBytes, header.size());
+    bool fSuccess = fwrite(sizeBytes, 1, sizeof(sizeBytes), file) == sizeof(sizeBytes);
+    fSuccess = fSuccess && fwrite(&header.begin()[0], 1, header.size(), file) == header.size();
+    for (int n = 0; fSuccess && n < COLUMN_COUNT; ++n) {
+        if (vColumns[n].empty()) continue;
+        fSuccess = fwrite(&vColumns[n].begin()[0], 1, vColumns[n].size(), file) == vColumns[n].size();
+    }
+    if (fSuccess) FileCommit(file);
+    fclose(file);
+    if (!fSuccess || !RenameOver(pathTmp, segment.path)) {
+        PrintToLog("%s(): ERROR: failed to write %s\n", __func__, segment.path.string());
+        boost::filesystem::remove(pathTmp);
+        return false;
+    }
+
+    return true;
+}
+
+void CMPTradeArchive::AddSegment(const CMPTradeSegment& segment)
+{
+    assert(segment.nFirstBlock > GetArchivedHeight());
+    vSegments.push_back(segment);
+}
+
+void CMPTradeArchive::DiscardSegment(const CMPTradeSegment& segment) const
+{
+    boost::filesystem::remove(segment.path);
+}
+
+bool CMPTradeArchive::ReadSegment(const CMPTradeSegment& segment, std::vector<CMPMatchedTrade>& vTrades, bool fDetails) const
+{
+    FILE* file = fopen(segment.path.string().c_str(), "rb");
+    if (!file) {
+        PrintToLog("%s(): ERROR: failed to open %s\n", __func__, segment.path.string());
+        return false;
+    }
+
+    // only the needed columns are read, which are at the front of the file
+    SegmentHeader header;
+    bool fSuccess = ReadSegmentHeader(file, header);
+    const int nColumns = fDetails ? COLUMN_COUNT : COLUMNS_AMOUNTS;
+    std::vector<CDataStream> vColumns(nColumns, CDataStream(SER_DISK, CLIENT_VERSION));
+    for (int n = 0; fSuccess && n < nColumns; ++n) {
+        uint64_t nSize = header.vColumnSizes[n];
+        if (nSize > MAX_SIZE) {
+            fSuccess = false;
+            break;
+        }
+        std::vector<char> vData(nSize);
+        if (nSize > 0 && fread(&vData[0], 1, nSize, file) != nSize) {
+            fSuccess = false;
+            break;
+        }
+        const char* pbegin = vData.empty() ? NULL : &vData[0];
+        if (ColumnChecksum(pbegin, pbegin + nSize) != header.vColumnChecksums[n]) {
+            fSuccess = false;
+            break;
+        }
+        vColumns[n].write(pbegin, nSize);
+    }
+    fclose(file);
+    if (!fSuccess) {
+        PrintToLog("%s(): ERROR: segment %s is corrupted\n", __func__, segment.path.string());
+        return false;
+    }
+
+    try {
+        std::vector<std::string> vAddresses;
+        if (fDetails) vColumns[COLUMN_DICTIONARY] >> vAddresses;
+
+        int nBlock = header.info.nFirstBlock;
+        vTrades.reserve(vTrades.size() + header.info.nTrades);
+        for (uint32_t n = 0; n < header.info.nTrades; ++n) {
+            CMPMatchedTrade trade;
+            nBlock += ReadColumnValue(vColumns[COLUMN_BLOCK]);
+            trade.block = nBlock;
+            trade.prop1 = ReadColumnValue(vColumns[COLUMN_PROP1]);
+            trade.prop2 = ReadColumnValue(vColumns[COLUMN_PROP2]);
+            trade.amount1 = ReadColumnValue(vColumns[COLUMN_AMOUNT1]);
+            trade.amount2 = ReadColumnValue(vColumns[COLUMN_AMOUNT2]);
+            if (fDetails) {
+                trade.fee = ReadColumnValue(vColumns[COLUMN_FEE]);
+                uint64_t nAddress1 = ReadColumnValue(vColumns[COLUMN_ADDRESS1]);
+                uint64_t nAddress2 = ReadColumnValue(vColumns[COLUMN_ADDRESS2]);
+                if (nAddress1 >= vAddresses.size() || nAddress2 >= vAddresses.size()) {
+                    throw std::ios_base::failure("invalid address identifier");
+                }
+                trade.address1 = vAddresses[nAddress1];
+                trade.address2 = vAddresses[nAddress2];
+                vColumns[COLUMN_TXID1] >> trade.txid1;
+                vColumns[COLUMN_TXID2] >> trade.txid2;
+            }
+            vTrades.push_back(trade);
+        }
+    } catch (const std::exception& e) {
+        PrintToLog("%s(): ERROR: failed to decode %s: %s\n", __func__, segment.path.string(), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+/** Returns the first segment, which covers the block or later blocks. */
+static std::vector<CMPTradeSegment>::const_iterator FindSegment(const std::vector<CMPTradeSegment>& vSegments, int nBlock)
+{
+    std::vector<CMPTradeSegment>::const_iterator it = vSegments.begin();
+    while (it != vSegments.end() && it->nLastBlock < nBlock) ++it;
+    return it;
+}
+
+bool CMPTradeArchive::ReadTail(int nBlock, std::vector<CMPMatchedTrade>& vTrades) const
+{
+    bool fSuccess = true;
+    for (std::vector<CMPTradeSegment>::const_iterator it = FindSegment(vSegments, nBlock); it != vSegments.end(); ++it) {
+        if (it->nFirstBlock >= nBlock) break;
+        std::vector<CMPMatchedTrade> vSegmentTrades;
+        if (!ReadSegment(*it, vSegmentTrades, true)) fSuccess = false;
+        for (std::vector<CMPMatchedTrade>::const_iterator itTrade = vSegmentTrades.begin(); itTrade != vSegmentTrades.end(); ++itTrade) {
+            if (itTrade->block < nBlock) vTrades.push_back(*itTrade);
+        }
+    }
+    return fSuccess;
+}
+
+void CMPTradeArchive::Truncate(int nBlock)
+{
+    std::vector<CMPTradeSegment>::const_iterator itFirst = FindSegment(vSegments, nBlock);
+    for (std::vector<CMPTradeSegment>::const_iterator it = itFirst; it != vSegments.end(); ++it) {
+        DiscardSegment(*it);
+    }
+    vSegments.erase(vSegments.begin() + (itFirst - vSegments.begin()), vSegments.end());
+}
+
+void CMPTradeArchive::Clear()
+{
+    for (std::vector<CMPTradeSegment>::const_iterator it = vSegments.begin(); it != vSegments.end(); ++it) {
+        DiscardSegment(*it);
+    }
+    vSegments.clear();
+}
@@ -0,0 +1,121 @@
+#ifndef ZURBANK_TRADEARCHIVE_H
+#define ZURBANK_TRADEARCHIVE_H
+
+#include "uint256.h"
+
+#include <boost/filesystem/path.hpp>
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/** A matched trade of the MetaDEx, as recorded in the trade history.
+ *
+ * The first side is the order, which was matched, and the second side the new
+ * order, which paid the fee.
+ */
+struct CMPMatchedTrade
+{
+    uint256 txid1;
+    uint256 txid2;
+    std::string address1;
+    std::string address2;
+    uint32_t prop1;
+    uint32_t prop2;
+    int64_t amount1;
+    int64_t amount2;
+    int block;
+    int64_t fee;
+
+    CMPMatchedTrade() : prop1(0), prop2(0), amount1(0), amount2(0), block(0), fee(0) {}
+
+    /** Returns the key of the trade in the trade database. */
+    std::string GetKey() const;
+};
+
+/** Summary of a segment of the trade archive, which is kept in memory. */
+struct CMPTradeSegment
+{
+    boost::filesystem::path path;
+    int nFirstBlock;
+    int nLastBlock;
+    uint32_t nTrades;
+    //! The distinct pairs traded in the segment, as (prop1, prop2)
+    std::vector<std::pair<uint32_t, uint32_t> > vPairs;
+
+    CMPTradeSegment() : nFirstBlock(0), nLastBlock(-1), nTrades(0) {}
+
+    /** Whether the pair was traded in the segment, in either direction. */
+    bool HasPair(uint32_t propertyIdSideA, uint32_t propertyIdSideB) const;
+};
+
+/** Immutable, column oriented storage of old matched trades.
+ *
+ * Each segment file covers a range of blocks and stores the trades sorted by
+ * block, one column after the other: blocks as deltas, properties, amounts and
+ * fees as varints, addresses as identifiers into a dictionary of the segment,
+ * followed by the raw transaction hashes. The header holds the block range, the
+ * traded pairs and the size of each column, so that queries can skip segments
+ * and columns they don't need.
+ *
+ * The segments cover consecutive block ranges. The archive is not synchronized,
+ * which is left to the owner.
+ */
+class CMPTradeArchive
+{
+private:
+    boost::filesystem::path pathArchive;
+
+    //! The segments, sorted by block range
+    std::vector<CMPTradeSegment> vSegments;
+
+    bool LoadSegmentInfo(const boost::filesystem::path& path, CMPTradeSegment& segment) const;
+
+public:
+    CMPTradeArchive(const boost::filesystem::path& path, bool fWipe);
+
+    /** Returns the last block covered by the archive, or -1, if it's empty. */
+    int GetArchivedHeight() const;
+
+    /** Returns the total number of archived trades. */
+    uint64_t GetTradeCount() const;
+
+    /** Returns the segments, sorted by block range. */
+    const std::vector<CMPTradeSegment>& GetSegments() const { return vSegments; }
+
+    /**
+     * Writes a new segment file with the trades, which must be sorted by block.
+     *
+     * The segment is not part of the archive, until it's added.
+     */
+    bool WriteSegment(const std::vector<CMPMatchedTrade>& vTrades, int nFirstBlock, int nLastBlock, CMPTradeSegment& segment) const;
+
+    /** Adds a written segment, which must follow the last segment. */
+    void AddSegment(const CMPTradeSegment& segment);
+
+    /** Deletes a segment file, which was not added. */
+    void DiscardSegment(const CMPTradeSegment& segment) const;
+
+    /**
+     * Reads the trades of a segment.
+     *
+     * Without details, only blocks, properties and amounts are decoded.
+     */
+    bool ReadSegment(const CMPTradeSegment& segment, std::vector<CMPMatchedTrade>& vTrades, bool fDetails) const;
+
+    /**
+     * Reads the trades before the block of the segments, which cover the block
+     * and above.
+     */
+    bool ReadTail(int nBlock, std::vector<CMPMatchedTrade>& vTrades) const;
+
+    /** Removes the segments, which cover the block and above. */
+    void Truncate(int nBlock);
+
+    /** Deletes all segments. */
+    void Clear();
+};
+
+#endif // ZURBANK_TRADEARCHIVE_H
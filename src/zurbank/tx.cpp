@@ -14,6 +14,7 @@
 #include "zurbank/notifications.h"
 #include "zurbank/zurbank.h"
 #include "zurbank/parsing.h"
+#include "zurbank/perfstats.h"
 #include "zurbank/rules.h"
 #include "zurbank/sp.h"
 #include "zurbank/sto.h"
@@ -862,12 +863,17 @@ int CMPTransaction::interpretPacket()
         return (PKT_ERROR -1);
     }
 
-    if (!interpret_Transaction()) {
-        return (PKT_ERROR -2);
+    {
+        CPerfStageTimer timer(PERF_STAGE_DECODE);
+        if (!interpret_Transaction()) {
+            return (PKT_ERROR -2);
+        }
     }
 
     LOCK(cs_tally);
 
+    CPerfTxTimer txTimer(type);
+
     if (isAddressFrozen(sender, property)) {
         PrintToLog("%s(): REJECTED: address %s is frozen for property %d\n", __func__, sender, property);
         return (PKT_ERROR -3);
@@ -1169,29 +1175,28 @@ int CMPTransaction::logicMath_SendToOwners()
     }
 
     // split up what was taken and distribute between all holders
-    int64_t sent_so_far = 0;
-    for (OwnerAddrType::reverse_iterator it = receiversSet.rbegin(); it != receiversSet.rend(); ++it) {
-        const std::string& address = it->second;
+    assert(update_tally_map(sender, property, -((int64_t) nValue), BALANCE));
 
-        int64_t will_really_receive = it->first;
-        sent_so_far += will_really_receive;
-
-        // real execution of the loop
-        assert(update_tally_map(sender, property, -will_really_receive, BALANCE));
-        assert(update_tally_map(address, property, will_really_receive, BALANCE));
+    int64_t sent_so_far = 0;
+    {
+        LOCK(cs_tally);
+        for (OwnerAddrType::reverse_iterator it = receiversSet.rbegin(); it != receiversSet.rend(); ++it) {
+            const std::string& address = it->second;
 
-        // add to stodb
-        pDbStoList->recordSTOReceive(address, txid, block, property, will_really_receive);
+            int64_t will_really_receive = it->first;
+            sent_so_far += will_really_receive;
 
-        if (sent_so_far != (int64_t)nValue) {
-            PrintToLog("sent_so_far= %14d, nValue= %14d, n_owners= %d\n", sent_so_far, nValue, numberOfReceivers);
-        } else {
-            PrintToLog("SendToOwners: DONE HERE\n");
+            // real execution of the loop
+            assert(update_tally_map(address, property, will_really_receive, BALANCE));
         }
     }
 
     // sent_so_far must equal nValue here
     assert(sent_so_far == (int64_t)nValue);
+    PrintToLog("SendToOwners: DONE HERE, n_owners= %d\n", numberOfReceivers);
+
+    // add to stodb
+    pDbStoList->recordSTOReceives(receiversSet, txid, block, property);
 
     // Number of tokens has changed, update fee distribution thresholds
     if (version == MP_TX_PKT_V0) NotifyTotalTokensChanged(OMNI_PROPERTY_MSC, block); // fee was burned
@@ -2447,7 +2452,7 @@ int CMPTransaction::logicMath_Alert()
             PrintToLog(msgText);
             PrintToConsole(msgText);
             if (!GetBoolArg("-overrideforcedshutdown", false)) {
-                boost::filesystem::path persistPath = GetDataDir() / "MP_persist";
+                boost::filesystem::path persistPath = GetZusDataDir() / "MP_persist";
                 if (boost::filesystem::exists(persistPath)) boost::filesystem::remove_all(persistPath); // prevent the node being restarted without a reparse after forced shutdown
                 AbortNode(msgText, msgText);
             }
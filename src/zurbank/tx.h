@@ -210,6 +210,7 @@ public:
     uint32_t getActivationBlock() const { return activation_block; }
     uint32_t getMinClientVersion() const { return min_client_version; }
     unsigned int getIndexInBlock() const { return tx_idx; }
+    int getBlock() const { return block; }
     uint32_t getDistributionProperty() const { return distribution_property; }
 
     /** Creates a new CMPTransaction object. */
@@ -27,6 +27,7 @@
 #include "wallet/wallet.h"
 #endif
 
+#include <algorithm>
 #include <stdint.h>
 #include <string>
 #include <utility>
@@ -37,32 +38,75 @@ using mastercore::SelectAllCoins;
 using mastercore::SelectCoins;
 using mastercore::UseEncodingClassC;
 
-/** Creates and sends a transaction. */
-int WalletTxBuilder(
+#ifdef ENABLE_WALLET
+/** Locks all available coins that are not in the set of destinations. */
+static void LockUnrelatedCoins(
+        CWallet* pwallet,
+        const std::set<CTxDestination>& destinations,
+        std::vector<COutPoint>& retLockedCoins)
+{
+    if (pwallet == NULL) {
+        return;
+    }
+
+    // NOTE: require: LOCK2(cs_main, pwallet->cs_wallet);
+
+    // lock any other output
+    std::vector<COutput> vCoins;
+    pwallet->AvailableCoins(vCoins, false, nullptr, true);
+
+    for (COutput& output : vCoins) {
+        CTxDestination address;
+        const CScript& scriptPubKey = output.tx->vout[output.i].scriptPubKey;
+        bool fValidAddress = ExtractDestination(scriptPubKey, address);
+
+        // don't lock specified coins, but any other
+        if (fValidAddress && destinations.count(address)) {
+            continue;
+        }
+
+        COutPoint outpointLocked(output.tx->GetHash(), output.i);
+        pwallet->LockCoin(outpointLocked);
+        retLockedCoins.push_back(outpointLocked);
+    }
+}
+
+/** Unlocks all coins, which were previously locked. */
+static void UnlockCoins(
+        CWallet* pwallet,
+        const std::vector<COutPoint>& vToUnlock)
+{
+    if (pwallet == NULL) {
+        return;
+    }
+
+    // NOTE: require: LOCK2(cs_main, pwallet->cs_wallet);
+
+    for (const COutPoint& output : vToUnlock) {
+        pwallet->UnlockCoin(output);
+    }
+}
+
+/** Creates, but does not commit, a transaction. */
+static int CreateWalletTx(
         const std::string& senderAddress,
         const std::string& receiverAddress,
         const std::string& redemptionAddress,
         int64_t referenceAmount,
         const std::vector<unsigned char>& payload,
-        uint256& retTxid,
-        std::string& retRawTx,
-        bool commit)
+        CWalletTx& wtxNew,
+        CReserveKey& reserveKey)
 {
-#ifdef ENABLE_WALLET
-    if (pwalletMain == NULL) return MP_ERR_WALLET_ACCESS;
-
     // Determine the class to send the transaction via - default is Class C
     int omniTxClass = OMNI_CLASS_C;
     if (!UseEncodingClassC(payload.size())) omniTxClass = OMNI_CLASS_B;
 
     // Prepare the transaction - first setup some vars
     CCoinControl coinControl;
-    CWalletTx wtxNew;
     int64_t nFeeRet = 0;
     int nChangePosInOut = -1;
     std::string strFailReason;
     std::vector<std::pair<CScript, int64_t> > vecSend;
-    CReserveKey reserveKey(pwalletMain);
 
     // Next, we set the change address to the sender
     CBitcoinAddress addr = CBitcoinAddress(senderAddress);
@@ -109,13 +153,38 @@ int WalletTxBuilder(
         return MP_ERR_CREATE_TX;
     }
 
+    PrintToLog("%s: %s; nFeeRet = %d\n", __func__, wtxNew.ToString(), nFeeRet);
+
+    return 0;
+}
+#endif
+
+/** Creates and sends a transaction. */
+int WalletTxBuilder(
+        const std::string& senderAddress,
+        const std::string& receiverAddress,
+        const std::string& redemptionAddress,
+        int64_t referenceAmount,
+        const std::vector<unsigned char>& payload,
+        uint256& retTxid,
+        std::string& retRawTx,
+        bool commit)
+{
+#ifdef ENABLE_WALLET
+    if (pwalletMain == NULL) return MP_ERR_WALLET_ACCESS;
+
+    CWalletTx wtxNew;
+    CReserveKey reserveKey(pwalletMain);
+
+    int result = CreateWalletTx(senderAddress, receiverAddress, redemptionAddress, referenceAmount, payload, wtxNew, reserveKey);
+    if (result != 0) return result;
+
     // If this request is only to create, but not commit the transaction then display it and exit
     if (!commit) {
         retRawTx = EncodeHexTx(wtxNew);
         return 0;
     } else {
         // Commit the transaction to the wallet and broadcast)
-        PrintToLog("%s: %s; nFeeRet = %d\n", __func__, wtxNew.ToString(), nFeeRet);
         if (!pwalletMain->CommitTransaction(wtxNew, reserveKey)) return MP_ERR_COMMIT_TX;
         retTxid = wtxNew.GetHash();
         return 0;
@@ -126,55 +195,72 @@ int WalletTxBuilder(
 
 }
 
-#ifdef ENABLE_WALLET
-/** Locks all available coins that are not in the set of destinations. */
-static void LockUnrelatedCoins(
-        CWallet* pwallet,
-        const std::set<CTxDestination>& destinations,
-        std::vector<COutPoint>& retLockedCoins)
+/**
+ * Creates and sends several transactions in one pass.
+ *
+ * The wallet is locked for up to MAX_WALLET_TX_BATCH_CHUNK transactions at a
+ * time, so that a large batch doesn't hold up block processing and the other
+ * users of the wallet until it's done. Committed transactions are added to the
+ * wallet right away, which lets later transactions of the same sender spend
+ * their change. Transactions, which are not committed, lock their inputs until
+ * the batch is done instead, so that they don't conflict with each other.
+ */
+int WalletTxBuilder(std::vector<CWalletTxRequest>& requests, bool commit)
 {
-    if (pwallet == NULL) {
-        return;
-    }
+    int nCreated = 0;
 
-    // NOTE: require: LOCK2(cs_main, pwallet->cs_wallet);
-
-    // lock any other output
-    std::vector<COutput> vCoins;
-    pwallet->AvailableCoins(vCoins, false, nullptr, true);
+#ifdef ENABLE_WALLET
+    if (pwalletMain == NULL) {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            requests[i].result = MP_ERR_WALLET_ACCESS;
+        }
+        return 0;
+    }
 
-    for (COutput& output : vCoins) {
-        CTxDestination address;
-        const CScript& scriptPubKey = output.tx->vout[output.i].scriptPubKey;
-        bool fValidAddress = ExtractDestination(scriptPubKey, address);
+    std::vector<COutPoint> vLockedCoins;
 
-        // don't lock specified coins, but any other
-        if (fValidAddress && destinations.count(address)) {
-            continue;
+    for (size_t nBegin = 0; nBegin < requests.size(); nBegin += MAX_WALLET_TX_BATCH_CHUNK) {
+        size_t nEnd = std::min(requests.size(), nBegin + MAX_WALLET_TX_BATCH_CHUNK);
+        LOCK2(cs_main, pwalletMain->cs_wallet);
+
+        for (size_t i = nBegin; i < nEnd; ++i) {
+            CWalletTxRequest& request = requests[i];
+            CWalletTx wtxNew;
+            CReserveKey reserveKey(pwalletMain);
+
+            request.result = CreateWalletTx(request.senderAddress, request.receiverAddress, request.redemptionAddress,
+                    request.referenceAmount, request.payload, wtxNew, reserveKey);
+            if (request.result != 0) continue;
+
+            if (!commit) {
+                BOOST_FOREACH(const CTxIn& txIn, wtxNew.vin) {
+                    if (pwalletMain->IsLockedCoin(txIn.prevout.hash, txIn.prevout.n)) continue;
+                    pwalletMain->LockCoin(txIn.prevout);
+                    vLockedCoins.push_back(txIn.prevout);
+                }
+                request.rawTx = EncodeHexTx(wtxNew);
+            } else {
+                if (!pwalletMain->CommitTransaction(wtxNew, reserveKey)) {
+                    request.result = MP_ERR_COMMIT_TX;
+                    continue;
+                }
+                request.txid = wtxNew.GetHash();
+            }
+            ++nCreated;
         }
-
-        COutPoint outpointLocked(output.tx->GetHash(), output.i);
-        pwallet->LockCoin(outpointLocked);
-        retLockedCoins.push_back(outpointLocked);
     }
-}
 
-/** Unlocks all coins, which were previously locked. */
-static void UnlockCoins(
-        CWallet* pwallet,
-        const std::vector<COutPoint>& vToUnlock)
-{
-    if (pwallet == NULL) {
-        return;
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+    UnlockCoins(pwalletMain, vLockedCoins);
+#else
+    for (size_t i = 0; i < requests.size(); ++i) {
+        requests[i].result = MP_ERR_WALLET_ACCESS;
     }
+#endif
 
-    // NOTE: require: LOCK2(cs_main, pwallet->cs_wallet);
-
-    for (const COutPoint& output : vToUnlock) {
-        pwallet->UnlockCoin(output);
-    }
+    return nCreated;
 }
-#endif
+
 
 /**
  * Creates and sends a raw transaction by selecting all coins from the sender
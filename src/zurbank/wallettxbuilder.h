@@ -1,8 +1,9 @@
 #ifndef ZURBANK_WALLETTXBUILDER_H
 #define ZURBANK_WALLETTXBUILDER_H
 
-class uint256;
+#include "uint256.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -20,6 +21,32 @@ int WalletTxBuilder(
         std::string& retRawTx,
         bool commit);
 
+//! The maximum number of transactions of a batch, which are created without releasing the wallet lock
+static const size_t MAX_WALLET_TX_BATCH_CHUNK = 50;
+
+/** A transaction to create as part of a batch, and the result. */
+struct CWalletTxRequest
+{
+    std::string senderAddress;
+    std::string receiverAddress;
+    std::string redemptionAddress;
+    int64_t referenceAmount;
+    std::vector<unsigned char> payload;
+
+    int result;
+    uint256 txid;
+    std::string rawTx;
+
+    CWalletTxRequest() : referenceAmount(0), result(0) {}
+};
+
+/**
+ * Creates and sends several transactions in one pass, and returns the number
+ * of transactions that were created. Transactions of the same sender may
+ * spend the change of earlier ones.
+ */
+int WalletTxBuilder(std::vector<CWalletTxRequest>& requests, bool commit);
+
 /**
  * Creates and sends a raw transaction by selecting all coins from the sender
  * and enough coins from a fee source. Change is sent to the fee source!
@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace mastercore
 {
@@ -222,10 +223,18 @@ int64_t SelectCoins(const std::string& fromAddress, CCoinControl& coinControl, i
     int nHeight = GetHeight();
     LOCK2(cs_main, pwalletMain->cs_wallet);
 
-    // iterate over the wallet
-    for (std::map<uint256, CWalletTx>::const_iterator it = pwalletMain->mapWallet.begin(); it != pwalletMain->mapWallet.end(); ++it) {
-        const uint256& txid = it->first;
-        const CWalletTx& wtx = it->second;
+    // only use funds from the sender's address
+    std::vector<COutPoint> vOutpts = pwalletMain->ListAddressOutputs(CBitcoinAddress(fromAddress).Get());
+
+    for (std::vector<COutPoint>::const_iterator it = vOutpts.begin(); it != vOutpts.end(); ++it) {
+        const uint256& txid = it->hash;
+        const unsigned int n = it->n;
+
+        std::map<uint256, CWalletTx>::const_iterator itTx = pwalletMain->mapWallet.find(txid);
+        if (itTx == pwalletMain->mapWallet.end()) {
+            continue;
+        }
+        const CWalletTx& wtx = itTx->second;
 
         if (!wtx.IsTrusted()) {
             continue;
@@ -234,43 +243,31 @@ int64_t SelectCoins(const std::string& fromAddress, CCoinControl& coinControl, i
             continue;
         }
 
-        for (unsigned int n = 0; n < wtx.vout.size(); n++) {
-            const CTxOut& txOut = wtx.vout[n];
-
-            CTxDestination dest;
-            if (!CheckInput(txOut, nHeight, dest)) {
-                continue;
-            }
-            if (!IsMine(*pwalletMain, dest)) {
-                continue;
-            }
-            if (pwalletMain->IsSpent(txid, n)) {
-                continue;
-            }
-            if (pwalletMain->IsLockedCoin(txid, n)) {
-                continue;
-            }
-            if (txOut.nValue < GetEconomicThreshold(txOut)) {
-                if (msc_debug_tokens)
-                    PrintToLog("%s: output value below economic threshold: %s:%d, value: %d\n",
-                            __func__, txid.GetHex(), n, txOut.nValue);
-                continue;
-            }
-
-            std::string sAddress = CBitcoinAddress(dest).ToString();
+        const CTxOut& txOut = wtx.vout[n];
+
+        CTxDestination dest;
+        if (!CheckInput(txOut, nHeight, dest)) {
+            continue;
+        }
+        if (!IsMine(*pwalletMain, dest)) {
+            continue;
+        }
+        if (pwalletMain->IsLockedCoin(txid, n)) {
+            continue;
+        }
+        if (txOut.nValue < GetEconomicThreshold(txOut)) {
             if (msc_debug_tokens)
-                PrintToLog("%s: sender: %s, outpoint: %s:%d, value: %d\n", __func__, sAddress, txid.GetHex(), n, txOut.nValue);
+                PrintToLog("%s: output value below economic threshold: %s:%d, value: %d\n",
+                        __func__, txid.GetHex(), n, txOut.nValue);
+            continue;
+        }
 
-            // only use funds from the sender's address
-            if (fromAddress == sAddress) {
-                COutPoint outpoint(txid, n);
-                coinControl.Select(outpoint);
+        if (msc_debug_tokens)
+            PrintToLog("%s: sender: %s, outpoint: %s:%d, value: %d\n", __func__, fromAddress, txid.GetHex(), n, txOut.nValue);
 
-                nTotal += txOut.nValue;
+        coinControl.Select(*it);
 
-                if (nMax <= nTotal) break;
-            }
-        }
+        nTotal += txOut.nValue;
 
         if (nMax <= nTotal) break;
     }
@@ -295,10 +292,18 @@ int64_t SelectAllCoins(const std::string& fromAddress, CCoinControl& coinControl
     int nHeight = GetHeight();
     LOCK2(cs_main, pwalletMain->cs_wallet);
 
-    // iterate over the wallet
-    for (std::map<uint256, CWalletTx>::const_iterator it = pwalletMain->mapWallet.begin(); it != pwalletMain->mapWallet.end(); ++it) {
-        const uint256& txid = it->first;
-        const CWalletTx& wtx = it->second;
+    // only use funds from the sender's address
+    std::vector<COutPoint> vOutpts = pwalletMain->ListAddressOutputs(CBitcoinAddress(fromAddress).Get());
+
+    for (std::vector<COutPoint>::const_iterator it = vOutpts.begin(); it != vOutpts.end(); ++it) {
+        const uint256& txid = it->hash;
+        const unsigned int n = it->n;
+
+        std::map<uint256, CWalletTx>::const_iterator itTx = pwalletMain->mapWallet.find(txid);
+        if (itTx == pwalletMain->mapWallet.end()) {
+            continue;
+        }
+        const CWalletTx& wtx = itTx->second;
 
         if (!wtx.IsTrusted()) {
             continue;
@@ -307,36 +312,26 @@ int64_t SelectAllCoins(const std::string& fromAddress, CCoinControl& coinControl
             continue;
         }
 
-        for (unsigned int n = 0; n < wtx.vout.size(); n++) {
-            const CTxOut& txOut = wtx.vout[n];
-
-            CTxDestination dest;
-            if (!CheckInput(txOut, nHeight, dest)) {
-                continue;
-            }
-            if (!IsMine(*pwalletMain, dest)) {
-                continue;
-            }
-            if (pwalletMain->IsSpent(txid, n)) {
-                continue;
-            }
-            if (pwalletMain->IsLockedCoin(txid, n)) {
-                continue;
-            }
-
-            std::string sAddress = CBitcoinAddress(dest).ToString();
-            if (msc_debug_tokens) {
-                PrintToLog("%s: sender: %s, outpoint: %s:%d, value: %d\n", __func__, sAddress, txid.GetHex(), n, txOut.nValue);
-            }
-
-            // only use funds from the sender's address
-            if (fromAddress == sAddress) {
-                COutPoint outpoint(txid, n);
-                coinControl.Select(outpoint);
-
-                nTotal += txOut.nValue;
-            }
+        const CTxOut& txOut = wtx.vout[n];
+
+        CTxDestination dest;
+        if (!CheckInput(txOut, nHeight, dest)) {
+            continue;
+        }
+        if (!IsMine(*pwalletMain, dest)) {
+            continue;
+        }
+        if (pwalletMain->IsLockedCoin(txid, n)) {
+            continue;
+        }
+
+        if (msc_debug_tokens) {
+            PrintToLog("%s: sender: %s, outpoint: %s:%d, value: %d\n", __func__, fromAddress, txid.GetHex(), n, txOut.nValue);
         }
+
+        coinControl.Select(*it);
+
+        nTotal += txOut.nValue;
     }
 #endif
 
@@ -19,12 +19,15 @@
 #include "zurbank/dex.h"
 #include "zurbank/encoding.h"
 #include "zurbank/errors.h"
+#include "zurbank/events.h"
 #include "zurbank/log.h"
 #include "zurbank/mdex.h"
 #include "zurbank/notifications.h"
 #include "zurbank/parsing.h"
 #include "zurbank/pending.h"
+#include "zurbank/perfstats.h"
 #include "zurbank/persistence.h"
+#include "zurbank/rpctxobject.h"
 #include "zurbank/rules.h"
 #include "zurbank/script.h"
 #include "zurbank/seedblocks.h"
@@ -120,6 +123,9 @@ static int reorgRecoveryMode = 0;
 //! Block height to recover from after a block reorganization
 static int reorgRecoveryMaxHeight = 0;
 
+//! Number of blocks between logged processing statistics, or 0, if disabled
+static int64_t nPerfStatsInterval = 0;
+
 //! LevelDB based storage for currencies, smart properties and tokens
 CMPSPInfo* mastercore::pDbSpInfo;
 //! LevelDB based storage for transactions, with txid as key and validity bit, and other data as value
@@ -502,6 +508,7 @@ bool mastercore::update_tally_map(const std::string& who, uint32_t propertyId, i
 
     CMPTally& tally = my_it->second;
     bRet = tally.updateMoney(propertyId, amount, ttype);
+    if (bRet) RecordBalanceDelta(who, propertyId, amount, ttype);
 
     after = GetTokenBalance(who, propertyId, ttype);
     if (!bRet) {
@@ -727,16 +734,22 @@ static bool HasMarkerUnsafe(const CTransaction& tx)
 void TryToAddToMarkerCache(const CTransaction& tx)
 {
     if (HasMarkerUnsafe(tx)) {
-        LOCK(cs_marker_cache);
-        setMarkerCache.insert(tx.GetHash());
+        {
+            LOCK(cs_marker_cache);
+            setMarkerCache.insert(tx.GetHash());
+        }
+        UnconfirmedAdd(tx);
     }
 }
 
 /** Removes transaction from marker cache. */
 void RemoveFromMarkerCache(const CTransaction& tx)
 {
-    LOCK(cs_marker_cache);
-    setMarkerCache.erase(tx.GetHash());
+    {
+        LOCK(cs_marker_cache);
+        setMarkerCache.erase(tx.GetHash());
+    }
+    UnconfirmedDelete(tx.GetHash());
 }
 
 /** Checks, if transaction is in marker cache. */
@@ -920,7 +933,11 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
     mp_tx.Set(wtx.GetHash(), nBlock, idx, nTime);
 
     // ### CLASS IDENTIFICATION AND MARKER CHECK ###
-    int omniClass = GetEncodingClass(wtx, nBlock);
+    int omniClass = NO_MARKER;
+    {
+        CPerfStageTimer timer(PERF_STAGE_MARKER, !bRPConly);
+        omniClass = GetEncodingClass(wtx, nBlock);
+    }
 
     if (omniClass == NO_MARKER) {
         return -1; // No Exodus/Omni marker, thus not a valid Zus transaction
@@ -939,9 +956,12 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
     LOCK2(cs_main, cs_tx_cache); // cs_main should be locked first to avoid deadlocks with cs_tx_cache at FillTxInputCache(...)->GetTransaction(...)->LOCK(cs_main)
 
     // Add previous transaction inputs to the cache
-    if (!FillTxInputCache(wtx)) {
-        PrintToLog("%s() ERROR: failed to get inputs for %s\n", __func__, wtx.GetHash().GetHex());
-        return -101;
+    {
+        CPerfStageTimer timer(PERF_STAGE_INPUTS, !bRPConly);
+        if (!FillTxInputCache(wtx)) {
+            PrintToLog("%s() ERROR: failed to get inputs for %s\n", __func__, wtx.GetHash().GetHex());
+            return -101;
+        }
     }
 
     assert(view.HaveInputs(wtx));
@@ -1524,6 +1544,9 @@ static int msc_initial_scan(int nFirstBlock)
     // check if using seed block filter should be disabled
     bool seedBlockFilterEnabled = GetBoolArg("-omniseedblockfilter", true);
 
+    // the blocks were already connected, so don't announce them
+    SuspendZusSignals(true);
+
     for (nBlock = nFirstBlock; nBlock <= nLastBlock; ++nBlock)
     {
         if (ShutdownRequested()) {
@@ -1545,12 +1568,15 @@ static int msc_initial_scan(int nFirstBlock)
 
         unsigned int nTxNum = 0;
         unsigned int nTxsFoundInBlock = 0;
-        mastercore_handler_block_begin(nBlock, pblockindex);
 
-        if (!seedBlockFilterEnabled || !SkipBlock(nBlock)) {
-            CBlock block;
-            if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus())) break;
+        // read the block first, so that the scan doesn't stop in the middle of a block
+        CBlock block;
+        bool fScanBlock = !seedBlockFilterEnabled || !SkipBlock(nBlock);
+        if (fScanBlock && !ReadBlockFromDisk(block, pblockindex, Params().GetConsensus())) break;
 
+        mastercore_handler_block_begin(nBlock, pblockindex);
+
+        if (fScanBlock) {
             BOOST_FOREACH(const CTransaction&tx, block.vtx) {
                 if (mastercore_handler_tx(tx, nBlock, nTxNum, pblockindex)) ++nTxsFoundInBlock;
                 ++nTxNum;
@@ -1562,6 +1588,8 @@ static int msc_initial_scan(int nFirstBlock)
         mastercore_handler_block_end(nBlock, pblockindex, nTxsFoundInBlock);
     }
 
+    SuspendZusSignals(false);
+
     if (nBlock < nLastBlock) {
         PrintToConsole("Scan stopped early at block %d of block %d\n", nBlock, nLastBlock);
     }
@@ -1584,7 +1612,7 @@ void clear_all_state()
     my_offers.clear();
     my_accepts.clear();
     my_crowds.clear();
-    metadex.clear();
+    MetaDEx_CLEAR();
     my_pending.clear();
     ResetConsensusParams();
     ClearActivations();
@@ -1599,10 +1627,58 @@ void clear_all_state()
     pDbTransaction->Clear();
     pDbFeeCache->Clear();
     pDbFeeHistory->Clear();
+    ClearRPCTransactionCache();
     assert(pDbTransactionList->setDBVersion() == DB_VERSION); // new set of databases, set DB version
     exodus_prev = 0;
 }
 
+/** Returns the LevelDB based stores, which are written while processing blocks. */
+static std::vector<CDBBase*> GetBlockDBs()
+{
+    std::vector<CDBBase*> vDBs;
+    if (pDbTransactionList) vDBs.push_back(pDbTransactionList);
+    if (pDbTradeList) vDBs.push_back(pDbTradeList);
+    if (pDbStoList) vDBs.push_back(pDbStoList);
+    if (pDbSpInfo) vDBs.push_back(pDbSpInfo);
+    if (pDbTransaction) vDBs.push_back(pDbTransaction);
+    if (pDbFeeCache) vDBs.push_back(pDbFeeCache);
+    if (pDbFeeHistory) vDBs.push_back(pDbFeeHistory);
+    return vDBs;
+}
+
+/** Stages the writes to the databases until the block is committed. */
+static void BeginBlockBatches()
+{
+    std::vector<CDBBase*> vDBs = GetBlockDBs();
+    for (std::vector<CDBBase*>::iterator it = vDBs.begin(); it != vDBs.end(); ++it) {
+        (*it)->BeginBatch();
+    }
+}
+
+/** Writes the staged changes of the block, with one write per database. */
+static bool CommitBlockBatches()
+{
+    bool fSuccess = true;
+    std::vector<CDBBase*> vDBs = GetBlockDBs();
+    for (std::vector<CDBBase*>::iterator it = vDBs.begin(); it != vDBs.end(); ++it) {
+        leveldb::Status status = (*it)->CommitBatch();
+        if (!status.ok()) {
+            PrintToLog("%s(): ERROR: failed to write block changes: %s\n", __func__, status.ToString());
+            fSuccess = false;
+        }
+    }
+    return fSuccess;
+}
+
+/** Drops the staged changes of the block. */
+static void DiscardBlockBatches()
+{
+    std::vector<CDBBase*> vDBs = GetBlockDBs();
+    for (std::vector<CDBBase*>::iterator it = vDBs.begin(); it != vDBs.end(); ++it) {
+        (*it)->DiscardBatch();
+    }
+}
+
 void RewindDBsAndState(int nHeight, int nBlockPrev = 0, bool fInitialParse = false)
 {
     // Check if any freeze related transactions would be rolled back - if so wipe the state and startclean
@@ -1610,7 +1686,7 @@ void RewindDBsAndState(int nHeight, int nBlockPrev = 0, bool fInitialParse = fal
 
     // NOTE: The blockNum parameter is inclusive, so deleteAboveBlock(1000) will delete records in block 1000 and above.
     pDbTransactionList->isMPinBlockRange(nHeight, reorgRecoveryMaxHeight, true);
-    pDbTradeList->deleteAboveBlock(nHeight);
+    bool fTradesRestored = (pDbTradeList->deleteAboveBlock(nHeight) >= 0);
     pDbStoList->deleteAboveBlock(nHeight);
     pDbFeeCache->RollBackCache(nHeight);
     pDbFeeHistory->RollBackHistory(nHeight);
@@ -1618,7 +1694,10 @@ void RewindDBsAndState(int nHeight, int nBlockPrev = 0, bool fInitialParse = fal
 
     nWaterlineBlock = ConsensusParams().GENESIS_BLOCK - 1;
 
-    if (reorgContainsFreeze && !fInitialParse) {
+    if (!fTradesRestored) {
+       PrintToConsole("Failed to restore archived trades, forcing a reparse...\n");
+       clear_all_state(); // the trade history is incomplete, clear state and reparse
+    } else if (reorgContainsFreeze && !fInitialParse) {
        PrintToConsole("Reorganization containing freeze related transactions detected, forcing a reparse...\n");
        clear_all_state(); // unable to reorg freezes safely, clear state and reparse
     } else {
@@ -1642,6 +1721,20 @@ void RewindDBsAndState(int nHeight, int nBlockPrev = 0, bool fInitialParse = fal
     }
 }
 
+/**
+ * Returns the directory of the Zus databases and state files.
+ *
+ * This is the data directory, unless "-omnidatadir" is set, for example to
+ * process blocks of an existing data directory into a separate state.
+ */
+boost::filesystem::path GetZusDataDir()
+{
+    if (mapArgs.count("-omnidatadir")) {
+        return boost::filesystem::system_complete(mapArgs["-omnidatadir"]);
+    }
+    return GetDataDir();
+}
+
 /**
  * Global handler to initialize ZURBank.
  *
@@ -1675,19 +1768,21 @@ int mastercore_init()
         autoCommit = false;
     }
 
+    nPerfStatsInterval = GetArg("-omniperfstats", 0);
+
     // check for --startclean option and delete MP_ folders if present
     bool startClean = false;
     if (GetBoolArg("-startclean", false)) {
         PrintToLog("Process was started with --startclean option, attempting to clear persistence files..\n");
         try {
-            boost::filesystem::path persistPath = GetDataDir() / "MP_persist";
-            boost::filesystem::path txlistPath = GetDataDir() / "MP_txlist";
-            boost::filesystem::path tradePath = GetDataDir() / "MP_tradelist";
-            boost::filesystem::path spPath = GetDataDir() / "MP_spinfo";
-            boost::filesystem::path stoPath = GetDataDir() / "MP_stolist";
-            boost::filesystem::path omniTXDBPath = GetDataDir() / "Omni_TXDB";
-            boost::filesystem::path feesPath = GetDataDir() / "OMNI_feecache";
-            boost::filesystem::path feeHistoryPath = GetDataDir() / "OMNI_feehistory";
+            boost::filesystem::path persistPath = GetZusDataDir() / "MP_persist";
+            boost::filesystem::path txlistPath = GetZusDataDir() / "MP_txlist";
+            boost::filesystem::path tradePath = GetZusDataDir() / "MP_tradelist";
+            boost::filesystem::path spPath = GetZusDataDir() / "MP_spinfo";
+            boost::filesystem::path stoPath = GetZusDataDir() / "MP_stolist";
+            boost::filesystem::path omniTXDBPath = GetZusDataDir() / "Omni_TXDB";
+            boost::filesystem::path feesPath = GetZusDataDir() / "OMNI_feecache";
+            boost::filesystem::path feeHistoryPath = GetZusDataDir() / "OMNI_feehistory";
             if (boost::filesystem::exists(persistPath)) boost::filesystem::remove_all(persistPath);
             if (boost::filesystem::exists(txlistPath)) boost::filesystem::remove_all(txlistPath);
             if (boost::filesystem::exists(tradePath)) boost::filesystem::remove_all(tradePath);
@@ -1696,7 +1791,7 @@ int mastercore_init()
             if (boost::filesystem::exists(omniTXDBPath)) boost::filesystem::remove_all(omniTXDBPath);
             if (boost::filesystem::exists(feesPath)) boost::filesystem::remove_all(feesPath);
             if (boost::filesystem::exists(feeHistoryPath)) boost::filesystem::remove_all(feeHistoryPath);
-            PrintToLog("Success clearing persistence files in datadir %s\n", GetDataDir().string());
+            PrintToLog("Success clearing persistence files in datadir %s\n", GetZusDataDir().string());
             startClean = true;
         } catch (const boost::filesystem::filesystem_error& e) {
             PrintToLog("Failed to delete persistence folders: %s\n", e.what());
@@ -1704,15 +1799,16 @@ int mastercore_init()
         }
     }
 
-    pDbTradeList = new CMPTradeList(GetDataDir() / "MP_tradelist", fReindex);
-    pDbStoList = new CMPSTOList(GetDataDir() / "MP_stolist", fReindex);
-    pDbTransactionList = new CMPTxList(GetDataDir() / "MP_txlist", fReindex);
-    pDbSpInfo = new CMPSPInfo(GetDataDir() / "MP_spinfo", fReindex);
-    pDbTransaction = new COmniTransactionDB(GetDataDir() / "Omni_TXDB", fReindex);
-    pDbFeeCache = new COmniFeeCache(GetDataDir() / "OMNI_feecache", fReindex);
-    pDbFeeHistory = new COmniFeeHistory(GetDataDir() / "OMNI_feehistory", fReindex);
+    pDbTradeList = new CMPTradeList(GetZusDataDir() / "MP_tradelist", fReindex);
+    pDbTradeList->StartArchiving(GetArg("-omnitradearchivedepth", DEFAULT_TRADE_ARCHIVE_DEPTH));
+    pDbStoList = new CMPSTOList(GetZusDataDir() / "MP_stolist", fReindex);
+    pDbTransactionList = new CMPTxList(GetZusDataDir() / "MP_txlist", fReindex);
+    pDbSpInfo = new CMPSPInfo(GetZusDataDir() / "MP_spinfo", fReindex);
+    pDbTransaction = new COmniTransactionDB(GetZusDataDir() / "Omni_TXDB", fReindex);
+    pDbFeeCache = new COmniFeeCache(GetZusDataDir() / "OMNI_feecache", fReindex);
+    pDbFeeHistory = new COmniFeeHistory(GetZusDataDir() / "OMNI_feehistory", fReindex);
 
-    pathStateFiles = GetDataDir() / "MP_persist";
+    pathStateFiles = GetZusDataDir() / "MP_persist";
     TryCreateDirectory(pathStateFiles);
 
     bool wrongDBVersion = (pDbTransactionList->getDBVersion() != DB_VERSION);
@@ -1889,7 +1985,11 @@ bool mastercore_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx,
     mp_obj.unlockLogic();
 
     bool fFoundTx = false;
-    int pop_ret = parseTransaction(false, tx, nBlock, idx, mp_obj, nBlockTime);
+    int pop_ret = 0;
+    {
+        CPerfStageTimer timer(PERF_STAGE_PARSE);
+        pop_ret = parseTransaction(false, tx, nBlock, idx, mp_obj, nBlockTime);
+    }
 
     if (pop_ret >= 0) {
         assert(mp_obj.getEncodingClass() != NO_MARKER);
@@ -1916,10 +2016,13 @@ bool mastercore_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx,
         // Only structurally valid transactions get recorded in levelDB
         // PKT_ERROR - 2 = interpret_Transaction failed, structurally invalid payload
         if (interp_ret != PKT_ERROR - 2) {
+            CPerfStageTimer timer(PERF_STAGE_DBWRITE);
             bool bValid = (0 <= interp_ret);
             pDbTransactionList->recordTX(tx.GetHash(), bValid, nBlock, mp_obj.getType(), mp_obj.getNewAmount());
             pDbTransaction->RecordTransaction(tx.GetHash(), idx, interp_ret);
+            pDbTransaction->RecordDecodedTransaction(mp_obj, pBlockIndex->GetBlockHash(), interp_ret);
         }
+        if (ZusSignalsActive()) GetZusSignals().TransactionProcessed(mp_obj, interp_ret);
         fFoundTx |= (interp_ret == 0);
     }
 
@@ -1957,11 +2060,17 @@ int mastercore_handler_block_begin(int nBlockPrev, CBlockIndex const * pBlockInd
         RewindDBsAndState(pBlockIndex->nHeight, nBlockPrev);
     }
 
+    // the changes of this block are written at once, when the block is done
+    BeginBlockBatches();
+
     // handle any features that go live with this block
     CheckLiveActivations(pBlockIndex->nHeight);
 
     eraseExpiredCrowdsale(pBlockIndex);
 
+    // collect balance changes of this block for subscribers
+    BeginBalanceDeltas();
+
     return 0;
 }
 
@@ -1977,6 +2086,8 @@ int mastercore_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
         mastercore_init();
     }
 
+    CPerfStageTimer timer(PERF_STAGE_BLOCK_END);
+
     // for every new received block must do:
     // 1) remove expired entries from the accept list (per spec accept entries are
     //    valid until their blocklimit expiration; because the customer can keep
@@ -2003,12 +2114,17 @@ int mastercore_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
 
     // check that pending transactions are still in the mempool
     PendingCheck();
+    UnconfirmedCheck();
 
     // transactions were found in the block, signal the UI accordingly
     if (countMP > 0) CheckWalletUpdate(true);
 
+    // publish balance changes of this block
+    EndBalanceDeltas(nBlockNow, pBlockIndex->GetBlockHash());
+
     // calculate and print a consensus hash if required
     if (ShouldConsensusHashBlock(nBlockNow)) {
+        CPerfStageTimer hashTimer(PERF_STAGE_CONSENSUS_HASH);
         uint256 consensusHash = GetConsensusHash();
         PrintToLog("Consensus hash for block %d: %s\n", nBlockNow, consensusHash.GetHex());
     }
@@ -2016,6 +2132,9 @@ int mastercore_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
     // request checkpoint verification
     bool checkpointValid = VerifyCheckpoint(nBlockNow, pBlockIndex->GetBlockHash());
     if (!checkpointValid) {
+        // don't persist the changes of a block that failed the checkpoint
+        DiscardBlockBatches();
+
         // failed checkpoint, can't be trusted to provide valid data - shutdown client
         const std::string& msg = strprintf(
                 "Shutting down due to failed checkpoint for block %d (hash %s). "
@@ -2023,17 +2142,36 @@ int mastercore_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
                 nBlockNow, pBlockIndex->GetBlockHash().GetHex());
         PrintToLog(msg);
         if (!GetBoolArg("-overrideforcedshutdown", false)) {
-            boost::filesystem::path persistPath = GetDataDir() / "MP_persist";
+            boost::filesystem::path persistPath = GetZusDataDir() / "MP_persist";
             if (boost::filesystem::exists(persistPath)) boost::filesystem::remove_all(persistPath); // prevent the node being restarted without a reparse after forced shutdown
             AbortNode(msg, msg);
         }
+    } else if (!CommitBlockBatches()) {
+        // some of the databases may have the changes of this block, and others not - shutdown client
+        const std::string& msg = strprintf(
+                "Shutting down due to a failed database write for block %d (hash %s). "
+                "Please restart with -startclean flag.\n",
+                nBlockNow, pBlockIndex->GetBlockHash().GetHex());
+        PrintToLog(msg);
+        boost::filesystem::path persistPath = GetZusDataDir() / "MP_persist";
+        if (boost::filesystem::exists(persistPath)) boost::filesystem::remove_all(persistPath); // prevent the node being restarted without a reparse
+        AbortNode(msg, msg);
     } else {
+        // move old trades into the archive in the background, if due
+        pDbTradeList->ScheduleArchiving(nBlockNow);
+
         // save out the state after this block
         if (IsPersistenceEnabled(nBlockNow) && nBlockNow >= ConsensusParams().GENESIS_BLOCK) {
+            CPerfStageTimer persistTimer(PERF_STAGE_PERSIST);
             PersistInMemoryState(pBlockIndex);
         }
     }
 
+    // log the processing statistics periodically, if enabled
+    if (nPerfStatsInterval > 0 && nBlockNow % nPerfStatsInterval == 0) {
+        LogPerfStats();
+    }
+
     return 0;
 }
 
@@ -2042,7 +2180,11 @@ int mastercore_handler_disc_begin(int nBlockNow, CBlockIndex const * pBlockIndex
     LOCK(cs_tally);
 
     reorgRecoveryMode = 1;
+    ClearRPCTransactionCache();
     reorgRecoveryMaxHeight = (pBlockIndex->nHeight > reorgRecoveryMaxHeight) ? pBlockIndex->nHeight: reorgRecoveryMaxHeight;
+
+    if (ZusSignalsActive()) GetZusSignals().Reorg(pBlockIndex->nHeight, pBlockIndex->GetBlockHash());
+
     return 0;
 }
 
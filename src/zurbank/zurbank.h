@@ -30,7 +30,7 @@ int const STORE_EVERY_N_BLOCK = 10000;
 #define TEST_ECO_PROPERTY_1 (0x80000003UL)
 
 // increment this value to force a refresh of the state (similar to --startclean)
-#define DB_VERSION 7
+#define DB_VERSION 8
 
 // could probably also use: int64_t maxInt64 = std::numeric_limits<int64_t>::max();
 // maximum numeric values from the spec:
@@ -144,6 +144,9 @@ int64_t GetAvailableTokenBalance(const std::string& address, uint32_t propertyId
 int64_t GetReservedTokenBalance(const std::string& address, uint32_t propertyId);
 int64_t GetFrozenTokenBalance(const std::string& address, uint32_t propertyId);
 
+/** Returns the directory of the Zus databases and state files. */
+boost::filesystem::path GetZusDataDir();
+
 /** Global handler to initialize ZURBank. */
 int mastercore_init();
 